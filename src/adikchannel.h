@@ -4,6 +4,7 @@
 #include <memory> // Pour std::shared_ptr
 #include <iostream>
 #include <string> // Pour std::string dans displayStatus
+#include <algorithm> // Pour std::copy_backward, std::fill
 
 // Important : AdikInstrument.h DOIT être inclus avant AdikChannel.h
 // car AdikChannel contient un std::shared_ptr<AdikInstrument> et appelle des méthodes sur cet instrument.
@@ -17,28 +18,42 @@ public:
     float currentPan;
     float currentPitch;
     bool isActive; // Indique si ce canal est actuellement en train de jouer un son
-                   //
+    unsigned int startOffsetFrames; // Frames de silence avant le début du son dans le prochain bloc
+    float peakLevel;                // Crête du dernier bloc mixé (mise à jour par AdikMixer)
+    int busIndex;                   // Bus de sortie (AdikMixer::busList), 0 : bus principal
+    bool essential;                 // false : coupé en premier en cas de surcharge (AdikQualityController)
+    size_t playPosition;            // Position de lecture de la voix dans le son de l'instrument, en samples
+    AdikEnvelope envelope;          // Enveloppe d'amplitude de la voix
+    unsigned int silentFrames;      // Frames consécutives sous le seuil de silence (voir trackSilence)
     // Un buffer temporaire pour le son de l'instrument, avant qu'il ne soit mixé.
     // Sa taille sera ajustée dynamiquement.
     std::vector<float> instrumentBuffer;
 
 
     // Constructeur
-    AdikChannel(int channelId) : id(channelId), currentVelocity(0.0f), currentPan(0.0f), currentPitch(0.0f), isActive(false) {
+    AdikChannel(int channelId) : id(channelId), currentVelocity(0.0f), currentPan(0.0f), currentPitch(0.0f), isActive(false),
+                                 startOffsetFrames(0), peakLevel(0.0f), busIndex(0), essential(true), playPosition(0), silentFrames(0) {
         std::cout << "Canal Mixeur " << id << " créé." << std::endl;
     }
 
-    // Reçoit un événement sonore et active le canal
-    void receiveSound(std::shared_ptr<AdikInstrument> instr, float vel, float pan, float pitch) {
+    // Reçoit un événement sonore et active le canal.
+    // startPosition : position de départ dans le son, en samples (reprise d'un rendu figé en cours de boucle).
+    void receiveSound(std::shared_ptr<AdikInstrument> instr, float vel, float pan, float pitch, unsigned int startOffset = 0,
+                      size_t startPosition = 0) {
         currentInstrument = instr;
         currentVelocity = vel;
         currentPan = pan;
         currentPitch = pitch;
+        startOffsetFrames = startOffset;
+        peakLevel = 0.0f; // Nouvelle voix : pas encore de crête mesurée
+        playPosition = startPosition; // La voix lit le son depuis le début (ou la position de reprise)
+        silentFrames = 0;
         isActive = true; // Le canal est maintenant actif et devrait rendre le son
-        std::cout << "receiveSound: le Canal est maintenant actif\n";
+        // std::cout << "receiveSound: le Canal est maintenant actif\n";
+        // Pas de message ici : appelé pour chaque voix, par le thread audio et par les rendus parallèles (AdikStemExporter)
         if (currentInstrument) {
-            currentInstrument->resetPlayback(); // Réinitialise la lecture de l'instrument
-            std::cout << "Canal " << id << " reçoit un son de '" << currentInstrument->name << "'." << std::endl;
+            envelope.start(currentInstrument->envelope, currentInstrument->sound.sampleRate, currentInstrument->sound.getNumFrames());
+            // std::cout << "Canal " << id << " reçoit un son de '" << currentInstrument->name << "'." << std::endl;
         }
     }
 
@@ -49,6 +64,26 @@ public:
         currentVelocity = 0.0f;
         currentPan = 0.0f;
         currentPitch = 0.0f;
+        startOffsetFrames = 0;
+        playPosition = 0;
+        silentFrames = 0;
+    }
+
+    // Suivi du silence après le mixage d'un bloc : 'blockPeak' est la crête mesurée de la voix (gain compris).
+    // Un bloc est silencieux si l'enveloppe a fini son attaque, et que son niveau et la crête sont tous deux sous
+    // 'threshold' : un son peut contenir des silences (coups retardés, boucles hachées) sous une enveloppe ouverte.
+    // Renvoie vrai (et libère la voix) quand le silence dure depuis 'windowFrames' frames.
+    // Un rendu figé peut contenir des silences entre ses événements : il est lu jusqu'au bout.
+    bool trackSilence(float blockPeak, unsigned int numFrames, float threshold, unsigned int windowFrames) {
+        if (!isActive || threshold <= 0.0f || (currentInstrument && currentInstrument->frozen)) return false;
+        if (envelope.isRising() || blockPeak >= threshold || envelope.getLevel() >= threshold) {
+            silentFrames = 0;
+            return false;
+        }
+        silentFrames += numFrames;
+        if (silentFrames < windowFrames) return false;
+        isActive = false;
+        return true;
     }
 
     // Affiche le statut du canal
@@ -72,11 +107,20 @@ public:
             // (numFrames * nombre de canaux de l'instrument)
             // outputBuffer.assign(numFrames * instrChannels, 0.0f);
 
-            currentInstrument->render(outputBuffer, numFrames, currentVelocity, currentPan, currentPitch);
+            const unsigned int offset = (startOffsetFrames > 0 && startOffsetFrames < numFrames) ? startOffsetFrames : 0;
+            const unsigned int frames = numFrames - offset;
+            startOffsetFrames = 0;
+            currentInstrument->render(outputBuffer, frames, playPosition, currentVelocity, currentPan, currentPitch);
+            applyEnvelope(outputBuffer.data(), frames, instrChannels);
+            if (offset > 0) {
+                // Le son commence en cours de bloc : décaler la partie rendue derrière du silence
+                outputBuffer.resize(numFrames * instrChannels, 0.0f);
+                std::copy_backward(outputBuffer.begin(), outputBuffer.begin() + frames * instrChannels, outputBuffer.end());
+                std::fill(outputBuffer.begin(), outputBuffer.begin() + offset * instrChannels, 0.0f);
+            }
 
-            // Le canal est "désactivé" si le son est court (one-shot) et que le buffer a été consommé.
-            // Une logique plus sophistiquée pourrait vérifier si AdikSound a encore des samples à lire.
-            if (currentInstrument->sound.currentSamplePosition >= currentInstrument->sound.audioData.size()) {
+            // La voix se termine à la fin du son ou de son enveloppe
+            if (playPosition >= currentInstrument->sound.getNumSamples() || envelope.isFinished()) {
                 isActive = false;
                 // std::cout << "currentInstrument désactivé, canal id: " << id << "\n";
                 // std::cout << "\a";
@@ -86,6 +130,23 @@ public:
         }
     }
 
+private:
+    // Gain d'enveloppe : calculé en début et en fin de bloc, interpolé linéairement sur chaque frame
+    void applyEnvelope(float* data, unsigned int frames, unsigned int channels) {
+        if (envelope.isUnity() || frames == 0) return;
+        const float startLevel = envelope.getLevel();
+        const float endLevel = envelope.advance(frames);
+        if (startLevel == 1.0f && endLevel == 1.0f) return; // Palier à 1 (one-shot, maintien) : rien à multiplier
+        const float step = (endLevel - startLevel) / frames;
+        float gain = startLevel;
+        for (unsigned int j = 0; j < frames; ++j) {
+            for (unsigned int c = 0; c < channels; ++c) {
+                data[j * channels + c] *= gain;
+            }
+            gain += step;
+        }
+    }
+
 };
 
 #endif // ADIKCHANNEL_H
@@ -0,0 +1,35 @@
+#ifndef ADIKCHECKSUM_H
+#define ADIKCHECKSUM_H
+
+#include <cstdint>
+#include <cstddef>
+
+// CRC-32 (polynôme IEEE 802.3, comme zlib), utilisé pour vérifier l'intégrité
+// des fichiers binaires (projets, cache de sons).
+// 'crc' permet de chaîner plusieurs blocs : adikCrc32(b, n2, adikCrc32(a, n1)).
+struct AdikCrc32Table {
+    uint32_t entries[256];
+
+    AdikCrc32Table() {
+        for (uint32_t i = 0; i < 256; ++i) {
+            uint32_t c = i;
+            for (int k = 0; k < 8; ++k) {
+                c = (c & 1u) ? (0xEDB88320u ^ (c >> 1)) : (c >> 1);
+            }
+            entries[i] = c;
+        }
+    }
+};
+
+inline uint32_t adikCrc32(const void* data, size_t size, uint32_t crc = 0) {
+    static const AdikCrc32Table crcTable; // Initialisation thread-safe (C++11)
+    const uint32_t* table = crcTable.entries;
+    const uint8_t* bytes = static_cast<const uint8_t*>(data);
+    crc = ~crc;
+    for (size_t i = 0; i < size; ++i) {
+        crc = table[(crc ^ bytes[i]) & 0xFFu] ^ (crc >> 8);
+    }
+    return ~crc;
+}
+
+#endif // ADIKCHECKSUM_H
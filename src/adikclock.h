@@ -0,0 +1,124 @@
+#ifndef ADIKCLOCK_H
+#define ADIKCLOCK_H
+
+#include <cstdint> // Pour int64_t
+#include <cmath>   // Pour std::ceil, std::floor, std::llround
+
+#include "adiktempomap.h"
+
+// --- AdikClock ---
+// Horloge musicale du transport, sans dérive.
+// La position est un compteur entier de samples (64 bits). La position musicale
+// (en ticks) en est déduite à partir d'une ancre (anchorSample, anchorTick)
+// posée à chaque changement de tempo ou repositionnement :
+//     tick(s) = anchorTick + (s - anchorSample) * ticksPerSample
+// Chaque frontière de pas est recalculée depuis l'ancre au lieu d'être accumulée,
+// l'erreur reste donc inférieure à un sample, même après des heures de lecture,
+// quel que soit le tempo (fractionnaire) et le taux d'échantillonnage.
+// Si une carte de tempo compilée est attachée (setTempoMap), les frontières de pas
+// sont lues directement dans sa table et l'ancre n'est plus utilisée.
+class AdikClock {
+public:
+    static const int TICKS_PER_BEAT = 960; // Résolution (PPQN)
+
+    unsigned int sampleRate; // Taux d'échantillonnage (samples/seconde)
+    double tempoBPM;         // Tempo, fractionnaire
+    int stepsPerBeat;        // Pas par battement (4 pour des 16èmes de note)
+
+    int64_t samplePosition;  // Position du transport, en samples
+    int64_t nextStep;        // Prochain pas (absolu) à déclencher
+    int64_t anchorSample;    // Sample de l'ancre
+    double anchorTick;       // Tick de l'ancre
+    const AdikTempoMap* tempoMap; // Carte de tempo compilée (non possédée), ou nullptr pour un tempo fixe
+
+    AdikClock(unsigned int sr = 44100, double bpm = 120.0, int spb = 4)
+        : sampleRate(sr), tempoBPM(bpm), stepsPerBeat(spb),
+          samplePosition(0), nextStep(0), anchorSample(0), anchorTick(0.0), tempoMap(nullptr) {
+    }
+
+    int getTicksPerStep() const { return TICKS_PER_BEAT / stepsPerBeat; }
+
+    double getTicksPerSample() const {
+        return tempoBPM * TICKS_PER_BEAT / (60.0 * sampleRate);
+    }
+
+    double getSamplesPerBeat() const { return 60.0 * sampleRate / tempoBPM; }
+    double getSamplesPerStep() const { return getSamplesPerBeat() / stepsPerBeat; }
+
+    // Position musicale courante, en ticks
+    double getTickPosition() const { return tickAtSample(samplePosition); }
+
+    // Position courante, en secondes
+    double getSecondsPosition() const {
+        return static_cast<double>(samplePosition) / sampleRate;
+    }
+
+    double tickAtSample(int64_t sample) const {
+        if (tempoMap) {
+            return tempoMap->stepPositionAtSample(sample) * getTicksPerStep();
+        }
+        return anchorTick + static_cast<double>(sample - anchorSample) * getTicksPerSample();
+    }
+
+    // Premier sample appartenant au pas absolu donné
+    int64_t sampleForStep(int64_t step) const {
+        if (tempoMap) {
+            return tempoMap->sampleForStep(step);
+        }
+        const double ticks = static_cast<double>(step * getTicksPerStep());
+        return anchorSample + static_cast<int64_t>(std::ceil((ticks - anchorTick) / getTicksPerSample()));
+    }
+
+    // Pas absolu contenant le sample donné
+    int64_t stepAtSample(int64_t sample) const {
+        return static_cast<int64_t>(std::floor(tickAtSample(sample) / getTicksPerStep()));
+    }
+
+    // Change le tempo sans saut de position : l'ancre est reposée à la position courante
+    void setTempo(double bpm) {
+        if (bpm <= 0.0) return;
+        anchorTick = getTickPosition();
+        anchorSample = samplePosition;
+        tempoBPM = bpm;
+    }
+
+    void setSampleRate(unsigned int sr) {
+        if (sr == 0) return;
+        anchorTick = getTickPosition();
+        anchorSample = samplePosition;
+        sampleRate = sr;
+    }
+
+    // Attache (ou détache avec nullptr) une carte de tempo compilée.
+    // Le temps restant avant le prochain pas est conservé, pour ne pas créer de saut audible.
+    void setTempoMap(const AdikTempoMap* map) {
+        if (map && !map->isCompiled()) map = nullptr;
+        int64_t remaining = sampleForStep(nextStep) - samplePosition;
+        if (remaining < 0) remaining = 0;
+        tempoMap = map;
+        if (tempoMap) {
+            samplePosition = tempoMap->sampleForStep(nextStep) - remaining;
+            if (samplePosition < 0) samplePosition = 0;
+        } else {
+            anchorTick = static_cast<double>(nextStep * getTicksPerStep());
+            anchorSample = samplePosition + remaining;
+        }
+    }
+
+    // Place le transport au début du pas absolu donné
+    // (tempo supposé constant depuis l'origine en l'absence de carte de tempo)
+    void locateStep(int64_t step) {
+        if (step < 0) step = 0;
+        if (tempoMap) {
+            samplePosition = tempoMap->sampleForStep(step);
+            nextStep = step;
+            return;
+        }
+        anchorTick = static_cast<double>(step * getTicksPerStep());
+        anchorSample = std::llround(anchorTick / getTicksPerSample());
+        samplePosition = anchorSample;
+        nextStep = step;
+    }
+};
+
+#endif // ADIKCLOCK_H
@@ -0,0 +1,40 @@
+#ifndef ADIKCONTROL_H
+#define ADIKCONTROL_H
+
+#include <cstdint>
+#include <type_traits> // Pour std::is_trivially_copyable
+
+#include "adikevent.h" // Pour AdikInstrumentHandle
+
+// --- AdikControlCommand ---
+// Commande temps réel transmise au thread audio par AdikPlayer::controlQueue (file SPSC sans verrou).
+// L'instant d'exécution est exprimé en samples du flux audio (AdikPlayer::streamSamplePosition),
+// qui avance même transport arrêté : un déclenchement distant peut donc être placé au sample près.
+struct AdikControlCommand {
+    enum Type : uint32_t {
+        TRIGGER, // Déclenche un instrument sur un canal du mixeur
+        PLAY,    // Démarre le transport à la position courante
+        PAUSE,   // Arrête le transport sans changer la position
+        STOP,    // Arrête le transport et revient au début
+        LOCATE,  // Place le transport au pas absolu 'step'
+        TEMPO,   // Change le tempo de l'horloge ('bpm', > 0 et fini)
+        RESET    // Revient au début de la séquence ou du morceau, sans changer l'état de lecture
+    };
+
+    static const int64_t IMMEDIATE = -1; // sampleTime : dès le prochain bloc
+
+    uint32_t type;
+    int64_t sampleTime;                 // Instant d'exécution (samples du flux), ou IMMEDIATE
+    AdikInstrumentHandle instrument;    // TRIGGER
+    int mixerChannelIndex;              // TRIGGER (1-based)
+    float velocity;                     // TRIGGER
+    float pan;                          // TRIGGER
+    float pitch;                        // TRIGGER
+    int64_t step;                       // LOCATE
+    double bpm;                         // TEMPO
+};
+
+static_assert(std::is_trivially_copyable<AdikControlCommand>::value,
+              "AdikControlCommand doit rester un POD (copié dans une file sans verrou)");
+
+#endif // ADIKCONTROL_H
@@ -0,0 +1,514 @@
+#include "adikcontrolserver.h"
+#include "adikplayer.h"
+#include "adikproject.h"
+#include "adikkitloader.h"
+#include "adikfreezer.h"
+#include "adikstemexporter.h"
+#include "adikhistory.h"
+
+#include <cstdio>      // Pour std::snprintf
+#include <cstdlib>     // Pour std::strtod, std::strtoll
+#include <cstring>     // Pour std::strncpy
+#include <cerrno>
+#include <cmath>       // Pour std::isfinite
+#include <chrono>
+#include <sstream>
+#include <iostream>
+
+#include <fcntl.h>      // Pour fcntl
+#include <poll.h>       // Pour poll
+#include <sys/socket.h>
+#include <sys/un.h>     // Pour sockaddr_un
+#include <unistd.h>     // Pour close, read, write, pipe, unlink
+
+namespace {
+
+const size_t MAX_CLIENTS = 32;
+const size_t MAX_INPUT_BYTES = 64 * 1024; // Ligne trop longue : connexion fermée
+
+bool setNonBlocking(int fd) {
+    const int flags = ::fcntl(fd, F_GETFL, 0);
+    return flags >= 0 && ::fcntl(fd, F_SETFL, flags | O_NONBLOCK) == 0;
+}
+
+bool parseInt(const std::string& text, long long& value) {
+    if (text.empty()) return false;
+    char* end = nullptr;
+    value = std::strtoll(text.c_str(), &end, 10);
+    return end && *end == '\0';
+}
+
+bool parseNumber(const std::string& text, double& value) {
+    if (text.empty()) return false;
+    char* end = nullptr;
+    value = std::strtod(text.c_str(), &end);
+    return end && *end == '\0';
+}
+
+} // namespace
+
+AdikControlServer::AdikControlServer(std::shared_ptr<AdikPlayer> p, const std::string& path)
+    : player(p), socketPath(path), listenFd(-1), running(false) {
+    wakeFds[0] = -1;
+    wakeFds[1] = -1;
+    if (!player) {
+        std::cerr << "AdikControlServer créé avec un AdikPlayer nul !" << std::endl;
+    }
+}
+
+AdikControlServer::~AdikControlServer() {
+    stop();
+    kitLoader.reset();
+    history.reset();      // Garde un pointeur sur le freezer
+    freezer.reset();
+    stemExporter.reset(); // Attend la fin d'un export en cours
+}
+
+bool AdikControlServer::start() {
+    if (!player || running.load()) return false;
+
+    sockaddr_un address;
+    std::memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+    if (socketPath.size() >= sizeof(address.sun_path)) {
+        std::cerr << "AdikControlServer: Chemin de socket trop long: " << socketPath << std::endl;
+        return false;
+    }
+    std::strncpy(address.sun_path, socketPath.c_str(), sizeof(address.sun_path) - 1);
+
+    listenFd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+    if (listenFd < 0) {
+        std::cerr << "AdikControlServer: socket() a échoué: " << std::strerror(errno) << std::endl;
+        return false;
+    }
+    ::unlink(socketPath.c_str()); // Socket laissé par une exécution précédente
+    if (::bind(listenFd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0
+        || ::listen(listenFd, 16) != 0 || !setNonBlocking(listenFd) || ::pipe(wakeFds) != 0) {
+        std::cerr << "AdikControlServer: Impossible d'écouter sur '" << socketPath << "': " << std::strerror(errno) << std::endl;
+        ::close(listenFd);
+        listenFd = -1;
+        return false;
+    }
+
+    running.store(true);
+    worker = std::thread(&AdikControlServer::run, this);
+    std::cout << "AdikControlServer: En écoute sur '" << socketPath << "'." << std::endl;
+    return true;
+}
+
+void AdikControlServer::stop() {
+    if (!running.exchange(false)) return;
+    const char wake = 'q';
+    if (::write(wakeFds[1], &wake, 1) < 0) {
+        // poll() se réveillera de toute façon à son délai d'attente
+    }
+    if (worker.joinable()) {
+        worker.join();
+    }
+    for (auto& client : clients) {
+        ::close(client.fd);
+    }
+    clients.clear();
+    ::close(listenFd);
+    ::close(wakeFds[0]);
+    ::close(wakeFds[1]);
+    listenFd = wakeFds[0] = wakeFds[1] = -1;
+    ::unlink(socketPath.c_str());
+    std::cout << "AdikControlServer: arrêté." << std::endl;
+}
+
+void AdikControlServer::run() {
+    std::vector<pollfd> fds;
+    while (running.load()) {
+        fds.clear();
+        fds.push_back(pollfd{listenFd, POLLIN, 0});
+        fds.push_back(pollfd{wakeFds[0], POLLIN, 0});
+        for (const auto& client : clients) {
+            fds.push_back(pollfd{client.fd, static_cast<short>(POLLIN | (client.output.empty() ? 0 : POLLOUT)), 0});
+        }
+
+        if (::poll(fds.data(), fds.size(), 500) < 0) {
+            if (errno == EINTR) continue;
+            std::cerr << "AdikControlServer: poll() a échoué: " << std::strerror(errno) << std::endl;
+            break;
+        }
+        if (fds[1].revents) break; // stop()
+
+        // Clients existants (avant d'en accepter de nouveaux : 'fds' suit l'ordre de 'clients')
+        for (size_t i = clients.size(); i-- > 0;) {
+            const short events = fds[i + 2].revents;
+            bool keep = true;
+            if (events & (POLLIN | POLLHUP | POLLERR)) {
+                keep = readClient(clients[i]);
+            }
+            if (keep && (!clients[i].output.empty())) {
+                keep = flushClient(clients[i]);
+            }
+            if (!keep) {
+                ::close(clients[i].fd);
+                clients.erase(clients.begin() + i);
+            }
+        }
+
+        if (fds[0].revents & POLLIN) {
+            int fd;
+            while ((fd = ::accept(listenFd, nullptr, nullptr)) >= 0) {
+                if (clients.size() >= MAX_CLIENTS || !setNonBlocking(fd)) {
+                    ::close(fd);
+                    continue;
+                }
+                clients.push_back(Client{fd, std::string(), std::string()});
+            }
+        }
+    }
+}
+
+// Lit tout ce qui est disponible et traite les lignes complètes. Renvoie false pour fermer la connexion.
+bool AdikControlServer::readClient(Client& client) {
+    char buffer[4096];
+    bool closed = false;
+    while (true) {
+        const ssize_t n = ::read(client.fd, buffer, sizeof(buffer));
+        if (n > 0) {
+            client.input.append(buffer, static_cast<size_t>(n));
+            if (client.input.size() > MAX_INPUT_BYTES) return false;
+            continue;
+        }
+        if (n == 0) closed = true;
+        else if (errno == EINTR) continue;
+        else if (errno != EAGAIN && errno != EWOULDBLOCK) closed = true;
+        break;
+    }
+
+    const size_t lastNewline = client.input.rfind('\n');
+    if (lastNewline != std::string::npos) {
+        bool closeConnection = false;
+        client.output += handleInput(client.input.substr(0, lastNewline + 1), closeConnection);
+        client.input.erase(0, lastNewline + 1);
+        if (closeConnection) {
+            flushClient(client);
+            return false;
+        }
+    }
+    return !closed;
+}
+
+// Envoie les réponses en attente. Renvoie false si la connexion est rompue.
+bool AdikControlServer::flushClient(Client& client) {
+    while (!client.output.empty()) {
+        const ssize_t n = ::send(client.fd, client.output.data(), client.output.size(), MSG_NOSIGNAL);
+        if (n > 0) {
+            client.output.erase(0, static_cast<size_t>(n));
+            continue;
+        }
+        if (n < 0 && errno == EINTR) continue;
+        return n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK); // Réessayer quand le socket sera prêt
+    }
+    return true;
+}
+
+// Historique des éditions, créé avec le freezer dont il versionne les gels. sequenceEditMutex pris par l'appelant.
+AdikHistory& AdikControlServer::editHistory() {
+    if (!freezer) freezer.reset(new AdikFreezer(player));
+    if (!history) history.reset(new AdikHistory(player, freezer.get()));
+    return *history;
+}
+
+std::string AdikControlServer::handleInput(const std::string& lines, bool& closeConnection) {
+    std::string responses;
+    size_t start = 0;
+    while (start < lines.size() && !closeConnection) {
+        size_t end = lines.find('\n', start);
+        if (end == std::string::npos) end = lines.size();
+        std::string line = lines.substr(start, end - start);
+        if (!line.empty() && line.back() == '\r') line.pop_back();
+        if (!line.empty()) {
+            responses += handleCommand(line, closeConnection);
+            responses += '\n';
+        }
+        start = end + 1;
+    }
+    return responses;
+}
+
+std::string AdikControlServer::handleCommand(const std::string& line, bool& closeConnection) {
+    std::istringstream stream(line);
+    std::vector<std::string> args;
+    std::string token;
+    while (stream >> token) {
+        args.push_back(token);
+    }
+    if (args.empty()) return "err commande vide";
+
+    // Instant optionnel en dernier argument
+    int64_t sampleTime = AdikControlCommand::IMMEDIATE;
+    const std::string& last = args.back();
+    if (args.size() > 1 && (last[0] == '@' || last[0] == '+')) {
+        long long value = 0;
+        if (!parseInt(last.substr(1), value) || value < 0) return "err instant invalide: " + last;
+        sampleTime = last[0] == '@' ? value : player->streamSamplePosition.load() + value;
+        args.pop_back();
+    }
+
+    const std::string& name = args[0];
+    char reply[256];
+
+    AdikControlCommand command;
+    std::memset(&command, 0, sizeof(command));
+    command.sampleTime = sampleTime;
+
+    if (name == "ping") {
+        return "ok pong";
+    }
+    if (name == "quit") {
+        closeConnection = true;
+        return "ok bye";
+    }
+
+    if (name == "trig") {
+        long long pad = 0;
+        if (args.size() < 2 || !parseInt(args[1], pad) || pad < 0) {
+            return "err usage: trig <pad> [vel] [pan] [pitch] [@t|+d]";
+        }
+        const AdikInstrumentHandle handle = player->getInstrumentHandleAt(static_cast<size_t>(pad));
+        if (handle == INVALID_INSTRUMENT_HANDLE) return "err pad invalide";
+        double vel = 1.0, pan = 0.0, pitch = 0.0;
+        if ((args.size() > 2 && !parseNumber(args[2], vel)) || (args.size() > 3 && !parseNumber(args[3], pan))
+            || (args.size() > 4 && !parseNumber(args[4], pitch))) {
+            return "err paramètre numérique invalide";
+        }
+        command.type = AdikControlCommand::TRIGGER;
+        command.instrument = handle;
+        command.mixerChannelIndex = static_cast<int>(pad) + 1; // Comme AdikPlayer::playInstrument
+        command.velocity = static_cast<float>(vel);
+        command.pan = static_cast<float>(pan);
+        command.pitch = static_cast<float>(pitch);
+    } else if (name == "play") {
+        command.type = AdikControlCommand::PLAY;
+    } else if (name == "pause") {
+        command.type = AdikControlCommand::PAUSE;
+    } else if (name == "stop") {
+        command.type = AdikControlCommand::STOP;
+    } else if (name == "locate") {
+        long long step = 0;
+        if (args.size() < 2 || !parseInt(args[1], step) || step < 0) return "err usage: locate <step> [@t|+d]";
+        command.type = AdikControlCommand::LOCATE;
+        command.step = step;
+    } else if (name == "tempo") {
+        double bpm = 0.0;
+        if (args.size() < 2 || !parseNumber(args[1], bpm) || !std::isfinite(bpm) || bpm <= 0.0) {
+            return "err usage: tempo <bpm> [@t|+d]"; // Appliqué tel quel par le thread audio
+        }
+        command.type = AdikControlCommand::TEMPO;
+        command.bpm = bpm;
+    } else if (name == "step" || name == "unstep") {
+        long long seq = 0, track = 0, step = 0, pad = 0;
+        double vel = 1.0;
+        const bool add = (name == "step");
+        if (args.size() < (add ? 5u : 4u) || !parseInt(args[1], seq) || !parseInt(args[2], track) || !parseInt(args[3], step)
+            || (add && !parseInt(args[4], pad)) || (add && args.size() > 5 && !parseNumber(args[5], vel))) {
+            return add ? "err usage: step <seq> <track> <step> <pad> [vel]" : "err usage: unstep <seq> <track> <step>";
+        }
+        std::lock_guard<std::mutex> lock(player->sequenceEditMutex);
+        if (seq < 0 || seq >= static_cast<long long>(player->sequenceList.size())) return "err séquence invalide";
+        AdikSequence& sequence = *player->sequenceList[seq];
+        if (track < 0 || track >= static_cast<long long>(sequence.tracks.size())) return "err piste invalide";
+        if (step < 0 || step >= sequence.lengthInSteps) return "err pas invalide";
+        AdikTrack& target = sequence.tracks[track];
+        AdikHistory& history = editHistory(); // Première révision : l'état avant cette édition
+        if (add) {
+            const AdikInstrumentHandle handle = pad < 0 ? INVALID_INSTRUMENT_HANDLE : player->getInstrumentHandleAt(static_cast<size_t>(pad));
+            if (handle == INVALID_INSTRUMENT_HANDLE) return "err pad invalide";
+            target.addEvent(handle, static_cast<int>(step), static_cast<float>(vel));
+        } else {
+            target.events.removeRange(static_cast<int>(step), static_cast<int>(step) + 1);
+        }
+        history.markTrack(static_cast<int>(seq), static_cast<int>(track), static_cast<int>(step), static_cast<int>(step) + 1);
+        history.commit(line);
+        player->invalidateSchedule(); // Replanifier les pas déjà résolus
+        std::snprintf(reply, sizeof(reply), "ok %s %lld %lld %lld events=%zu", name.c_str(), seq, track, step, target.events.size());
+        return reply;
+    } else if (name == "grid") {
+        long long seq = 0, track = 0, pad = 0;
+        const char* usage = "err usage: grid <seq> <track> <pad> toggle <step>|clear|rotate <n>|shift <n>|repeat <measure>"
+                            "|euclid <pulses> [len] [rot]|random <density> [seed]";
+        if (args.size() < 5 || !parseInt(args[1], seq) || !parseInt(args[2], track) || !parseInt(args[3], pad)) return usage;
+        const std::string& op = args[4];
+        long long a = 0, b = 0, c = 0;
+        double density = 0.0;
+        const bool hasA = args.size() > 5 && (op == "random" ? parseNumber(args[5], density) : parseInt(args[5], a));
+        if (args.size() > 6 && !parseInt(args[6], b)) return usage;
+        if (args.size() > 7 && !parseInt(args[7], c)) return usage;
+        std::lock_guard<std::mutex> lock(player->sequenceEditMutex);
+        if (seq < 0 || seq >= static_cast<long long>(player->sequenceList.size())) return "err séquence invalide";
+        AdikSequence& sequence = *player->sequenceList[seq];
+        if (track < 0 || track >= static_cast<long long>(sequence.tracks.size())) return "err piste invalide";
+        const AdikInstrumentHandle handle = pad < 0 ? INVALID_INSTRUMENT_HANDLE : player->getInstrumentHandleAt(static_cast<size_t>(pad));
+        if (handle == INVALID_INSTRUMENT_HANDLE) return "err pad invalide";
+        AdikTrack& target = sequence.tracks[track];
+        AdikHistory& history = editHistory();
+        AdikStepGrid grid = target.getStepGrid(handle, sequence.lengthInSteps, sequence.stepsPerMeasure);
+        if (op == "toggle" && hasA) {
+            grid.toggle(static_cast<int>(a));
+        } else if (op == "clear") {
+            grid.clearAll();
+        } else if (op == "rotate" && hasA) {
+            grid.rotate(static_cast<int>(a));
+        } else if (op == "shift" && hasA) {
+            grid.shift(static_cast<int>(a));
+        } else if (op == "repeat" && hasA) {
+            grid.repeatMeasure(static_cast<int>(a));
+        } else if (op == "euclid" && hasA) {
+            grid.fillEuclidean(static_cast<int>(a), args.size() > 6 ? static_cast<int>(b) : sequence.stepsPerMeasure, static_cast<int>(c));
+        } else if (op == "random" && hasA) {
+            uint64_t seed = args.size() > 6 ? static_cast<uint64_t>(b) : static_cast<uint64_t>(player->streamSamplePosition.load());
+            grid.randomize(static_cast<float>(density), seed);
+        } else {
+            return usage;
+        }
+        target.applyStepGrid(grid);
+        history.markTrack(static_cast<int>(seq), static_cast<int>(track));
+        history.commit(line);
+        player->invalidateSchedule(); // Replanifier les pas déjà résolus
+        // Motif résultant, un caractère par pas
+        std::string pattern(static_cast<size_t>(grid.getLength()), '.');
+        for (int step = grid.nextStep(0); step >= 0; step = grid.nextStep(step + 1)) pattern[step] = 'x';
+        std::snprintf(reply, sizeof(reply), "ok grid %lld %lld %lld steps=%zu events=%zu ", seq, track, pad, grid.count(), target.events.size());
+        return reply + pattern;
+    } else if (name == "load" || name == "save") {
+        if (args.size() < 2) return "err usage: " + name + " <fichier>";
+        if (name == "save") {
+            std::lock_guard<std::mutex> lock(player->sequenceEditMutex);
+            return AdikProject::save(*player, args[1]) ? "ok save" : "err enregistrement impossible";
+        }
+        // Lu ici, adopté par le thread audio au début d'un bloc, transport arrêté (AdikPlayer::publishProject)
+        auto state = std::make_shared<AdikProjectState>();
+        if (!AdikProject::read(args[1], *state, player->sampleAnalysisOptions)) return "err chargement impossible";
+        if (!player->publishProject(state)) return "err le thread audio n'a pas pris le projet";
+        std::lock_guard<std::mutex> lock(player->sequenceEditMutex);
+        if (history) history->reset("load " + args[1]); // Les révisions précédentes décrivent l'ancien projet
+        return "ok load";
+    } else if (name == "undo" || name == "redo" || name == "history") {
+        long long index = -1;
+        if (name == "history" && args.size() > 1 && (!parseInt(args[1], index) || index < 0)) return "err usage: history [n]";
+        std::lock_guard<std::mutex> lock(player->sequenceEditMutex);
+        AdikHistory& history = editHistory();
+        if (name == "undo" && !history.undo()) return "err rien à annuler";
+        if (name == "redo" && !history.redo()) return "err rien à rétablir";
+        if (index >= 0 && !history.publish(static_cast<size_t>(index))) return "err révision invalide";
+        const size_t revision = history.getCurrentRevision();
+        std::snprintf(reply, sizeof(reply), "ok %s rev=%zu/%zu bytes=%zu ", name.c_str(), revision, history.getRevisionCount(),
+                      history.getMemoryBytes());
+        return reply + history.getLabel(revision);
+    } else if (name == "kit") {
+        if (args.size() < 2) return "err usage: kit <fichier> [now|beat|measure|sequence]";
+        AdikKit::Boundary boundary = AdikKit::NEXT_MEASURE;
+        if (args.size() >= 3 && !AdikKit::parseBoundary(args[2], boundary)) return "err frontière invalide";
+        if (!kitLoader) kitLoader.reset(new AdikKitLoader(player));
+        if (!kitLoader->loadProject(args[1], boundary)) return "err kit déjà en préparation";
+        return std::string("ok kit ") + AdikKit::boundaryName(boundary);
+    } else if (name == "freeze" || name == "unfreeze") {
+        long long seq = 0, track = AdikFreezer::WHOLE_SEQUENCE;
+        if (args.size() < 2 || !parseInt(args[1], seq) || (args.size() > 2 && !parseInt(args[2], track))) {
+            return "err usage: " + name + " <seq> [track]";
+        }
+        std::lock_guard<std::mutex> lock(player->sequenceEditMutex);
+        if (seq < 0 || seq >= static_cast<long long>(player->sequenceList.size())) return "err séquence invalide";
+        const std::shared_ptr<AdikSequence> sequence = player->sequenceList[seq];
+        AdikHistory& history = editHistory(); // Crée aussi le freezer ; première révision : les gels avant celui-ci
+        if (name == "freeze" ? !freezer->freezeLocked(sequence, static_cast<int>(track))
+                             : !freezer->unfreezeLocked(sequence, static_cast<int>(track))) {
+            return name == "freeze" ? "err piste invalide ou trop de gels" : "err non figée";
+        }
+        history.markFrozen();
+        history.commit(line);
+        std::snprintf(reply, sizeof(reply), "ok %s %lld %lld frozen=%zu", name.c_str(), seq, track, freezer->getFrozenCount());
+        return reply;
+    } else if (name == "stems") {
+        if (args.size() < 2) {
+            if (!stemExporter) return "err aucun export";
+            std::snprintf(reply, sizeof(reply), "ok stems running=%d progress=%.3f", stemExporter->isRunning() ? 1 : 0,
+                          stemExporter->getProgress());
+            return reply;
+        }
+        AdikStemExporter::Options options;
+        options.directory = args[1];
+        for (size_t i = 2; i < args.size(); ++i) {
+            if (args[i] == "channel") options.mode = AdikStemExporter::BY_CHANNEL;
+            else if (args[i] == "track") options.mode = AdikStemExporter::BY_TRACK;
+            else if (args[i] == "nomix") options.fullMix = false;
+            else return "err usage: stems <dir> [channel|track] [nomix]";
+        }
+        if (!stemExporter) stemExporter.reset(new AdikStemExporter(player));
+        if (stemExporter->isRunning()) return "err export déjà en cours";
+        if (!stemExporter->start(options)) return "err rien à exporter";
+        return "ok stems " + options.directory;
+    } else if (name == "pos") {
+        AdikTimingSnapshot snapshot{};
+        if (!player->timingSnapshot.read(snapshot)) return "err aucun bloc audio traité"; // L'horloge n'est lue que par le thread audio
+        std::snprintf(reply, sizeof(reply),
+                      "ok pos stream=%lld sample=%lld step=%lld seq=%d stepinseq=%d playing=%d tempo=%.3f",
+                      static_cast<long long>(player->streamSamplePosition.load()),
+                      static_cast<long long>(snapshot.clock.samplePosition),
+                      static_cast<long long>(snapshot.clock.nextStep),
+                      snapshot.mode == AdikPlayer::SONG_MODE ? snapshot.currentSequenceIndexInSong : snapshot.selectedSequenceInPlayerIndex,
+                      snapshot.currentStepInSequence, snapshot.playing ? 1 : 0, snapshot.clock.tempoBPM);
+        return reply;
+    } else if (name == "stats") {
+        const int voices = player->mixer.getActiveChannelCount();
+        std::snprintf(reply, sizeof(reply),
+                      "ok stats blocks=%llu load=%.4f peak=%.4f voices=%d rate=%u ctlq=%zu trigq=%zu underflows=%llu overflows=%llu quality=%d stolen=%llu kits=%llu frozen=%zu",
+                      static_cast<unsigned long long>(player->processedBlocks.load()),
+                      player->dspLoad.load(), player->dspLoadPeak.load(), voices, player->sampleRate,
+                      player->controlQueue.size(), player->triggerQueue.size(),
+                      static_cast<unsigned long long>(player->xrunMonitor.getUnderflowCount()),
+                      static_cast<unsigned long long>(player->xrunMonitor.getOverflowCount()),
+                      player->qualityController.getLevel(),
+                      static_cast<unsigned long long>(player->mixer.stolenVoices.load()),
+                      static_cast<unsigned long long>(player->kitSwitches.load()),
+                      freezer ? freezer->getFrozenCount() : static_cast<size_t>(0));
+        return reply;
+    } else if (name == "xruns") {
+        // Derniers incidents : frame, drapeaux, charge, charge précédente, voix, diagnostic
+        std::vector<AdikXrunIncident> incidents;
+        player->xrunMonitor.getRecentIncidents(incidents, 16);
+        std::snprintf(reply, sizeof(reply), "ok xruns total=%llu",
+                      static_cast<unsigned long long>(player->xrunMonitor.getIncidentCount()));
+        std::string result = reply;
+        for (const AdikXrunIncident& incident : incidents) {
+            std::snprintf(reply, sizeof(reply), " %lld:%u:%.3f:%.3f:%d:%s", static_cast<long long>(incident.streamFrame),
+                          incident.flags, incident.dspLoad, incident.previousDspLoad, incident.activeVoices,
+                          AdikXrunMonitor::isOverload(incident) ? "overload" : "driver");
+            result += reply;
+        }
+        return result;
+    } else if (name == "levels") {
+        // Par point de mesure : crête de fenêtre:RMS du dernier bloc:saturations cumulées
+        AdikMeterSnapshot snapshot;
+        if (!player->mixer.meterSnapshot.read(snapshot)) return "err aucun bloc audio traité";
+        auto append = [&](std::string& result, const AdikMeterLevel& level, bool first) {
+            std::snprintf(reply, sizeof(reply), first ? "%.4f:%.4f:%llu" : ",%.4f:%.4f:%llu", level.windowPeak, level.rms,
+                          static_cast<unsigned long long>(level.clips));
+            result += reply;
+        };
+        std::string result = "ok levels out=";
+        for (int i = 0; i < snapshot.numOutputs; ++i) append(result, snapshot.outputs[i], i == 0);
+        result += " ch=";
+        for (int i = 0; i < snapshot.numChannels; ++i) append(result, snapshot.channels[i], i == 0);
+        result += " master=";
+        append(result, snapshot.master, true);
+        return result;
+    } else {
+        return "err commande inconnue: " + name;
+    }
+
+    // Commandes temps réel : vers le thread audio
+    if (!player->postControlCommand(command)) {
+        return "err file de contrôle pleine";
+    }
+    if (sampleTime == AdikControlCommand::IMMEDIATE) {
+        return "ok " + name;
+    }
+    std::snprintf(reply, sizeof(reply), "ok %s @%lld", name.c_str(), static_cast<long long>(sampleTime));
+    return reply;
+}
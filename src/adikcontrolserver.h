@@ -0,0 +1,93 @@
+#ifndef ADIKCONTROLSERVER_H
+#define ADIKCONTROLSERVER_H
+
+#include <string>
+#include <vector>
+#include <memory>
+#include <thread>
+#include <atomic>
+
+class AdikPlayer; // Déclaration anticipée
+class AdikKitLoader;
+class AdikFreezer;
+class AdikStemExporter;
+class AdikHistory;
+
+// --- AdikControlServer ---
+// Serveur de contrôle local sur socket Unix (SOCK_STREAM), pour piloter le moteur depuis d'autres services.
+// Protocole texte, une commande par ligne, une réponse par ligne ("ok ..." ou "err ...").
+// Les commandes peuvent être envoyées à la suite sans attendre les réponses (pipeline) :
+// toutes les lignes reçues d'un coup sont traitées ensemble, leurs commandes temps réel
+// atteignent donc le thread audio dans le même bloc, et les réponses repartent en une seule écriture.
+//
+// Instants : "@<sample>" (absolu, samples du flux) ou "+<samples>" (relatif à la position du flux).
+//
+//   ping                                       -> ok pong
+//   trig <pad> [vel] [pan] [pitch] [@t|+d]     déclenche l'instrument <pad> sur le canal <pad>+1
+//   play|pause|stop [@t|+d]                    transport
+//   locate <step> [@t|+d]                      position (pas absolu)
+//   tempo <bpm> [@t|+d]                        tempo global
+//   step <seq> <track> <step> <pad> [vel]      ajoute un événement à une séquence du Player
+//   unstep <seq> <track> <step>                supprime les événements d'un pas
+//   grid <seq> <track> <pad> <op> [args]       édite la grille de pas du pad sur la piste (voir AdikStepGrid) :
+//                                              toggle <step> | clear | rotate <n> | shift <n> | repeat <measure>
+//                                              | euclid <pulses> [len] [rot] | random <density> [seed]
+//   load <fichier> / save <fichier>            projet (voir AdikProject)
+//   undo / redo                                annule ou rétablit la dernière édition (step, unstep, grid, freeze, unfreeze)
+//   history [n]                                révisions conservées et mémoire ; avec n, rend la révision n courante
+//   kit <fichier> [now|beat|measure|sequence]  kit : instruments d'un projet, préparés en arrière-plan et activés
+//                                              à la frontière donnée (défaut : measure), sans arrêter la lecture
+//   freeze <seq> [track]                       gèle une piste (ou toute la séquence) : rendue en arrière-plan,
+//                                              jouée par une seule voix, rendue à nouveau quand elle est modifiée
+//   unfreeze <seq> [track]                     dégèle une piste (ou la séquence)
+//   stems <dir> [channel|track] [nomix]        exporte les stems (un WAV par canal ou par piste, et le mix) en
+//                                              arrière-plan ; 'stems' seul renvoie l'avancement
+//   pos                                        position du flux et du transport
+//   stats                                      charge DSP, blocs traités, voix actives, files, xruns, niveau de qualité, kits, gels
+//   levels                                     crêtes du dernier bloc, par sortie et par canal
+//   xruns                                      derniers xruns : frame:drapeaux:charge:charge_préc:voix:overload|driver
+//   quit                                       ferme la connexion
+//
+// Les commandes de déclenchement et de transport passent par AdikPlayer::controlQueue (sans verrou) ;
+// les éditions sont faites sur le thread du serveur, sous AdikPlayer::sequenceEditMutex.
+class AdikControlServer {
+public:
+    AdikControlServer(std::shared_ptr<AdikPlayer> p, const std::string& path);
+    ~AdikControlServer();
+
+    bool start();
+    void stop();
+    bool isRunning() const { return running.load(); }
+
+    const std::string& getSocketPath() const { return socketPath; }
+
+    // Traite un bloc de lignes et renvoie les réponses (utilisé par le serveur, exposé pour les tests en local)
+    std::string handleInput(const std::string& lines, bool& closeConnection);
+
+private:
+    struct Client {
+        int fd;
+        std::string input;   // Données reçues, pas encore terminées par '\n'
+        std::string output;  // Réponses pas encore envoyées
+    };
+
+    std::shared_ptr<AdikPlayer> player;
+    std::string socketPath;
+    int listenFd;
+    int wakeFds[2];          // Tube de réveil de poll() pour stop()
+    std::thread worker;
+    std::atomic<bool> running;
+    std::vector<Client> clients;
+    std::unique_ptr<AdikKitLoader> kitLoader; // Créé à la première commande 'kit'
+    std::unique_ptr<AdikFreezer> freezer;     // Créé avec l'historique (editHistory)
+    std::unique_ptr<AdikStemExporter> stemExporter; // Créé à la première commande 'stems'
+    std::unique_ptr<AdikHistory> history;     // Historique des éditions faites par le serveur, gels compris
+
+    void run();
+    std::string handleCommand(const std::string& line, bool& closeConnection);
+    AdikHistory& editHistory();
+    bool readClient(Client& client);
+    bool flushClient(Client& client);
+};
+
+#endif // ADIKCONTROLSERVER_H
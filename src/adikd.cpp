@@ -0,0 +1,152 @@
+/***
+ * File: adikd.cpp
+ * Démon sans interface : AudioEngine + AdikPlayer pilotés par un socket Unix (voir AdikControlServer).
+ * Usage: adikd [chemin_du_socket] [projet.adkp]
+ * Environnement: ADIKD_SOCKET, ADIKD_BIT_DEPTH (16, 24 ou 32 = float), ADIKD_DITHER (none, tpdf, shaped),
+ *   ADIKD_OUTPUTS (nombre de sorties du périphérique, 2 par défaut),
+ *   ADIKD_ROUTING (canal:sortie[m],... ; sorties numérotées à partir de 1, 'm' : une seule sortie, sinon une paire)
+ *   ex: ADIKD_OUTPUTS=8 ADIKD_ROUTING="1:3m,2:4m,3:5m,4:7" -> kick, snare, charley sur 3, 4, 5, canal 4 sur 7-8
+ *   ADIKD_QUALITY (off, ou seuils de charge "0.7,0.8,0.9" ; voir AdikQualityController),
+ *   ADIKD_NONESSENTIAL (canaux coupés en premier sous surcharge, ex: "5,6,7,8")
+ *   Temps réel (tous les programmes) : ADIK_RT, ADIK_RT_MLOCK (off), ADIK_RT_PRIORITY, ADIK_RT_CPU ; voir AdikRealtimeOptions
+ * Test rapide: echo "trig 1" | socat - UNIX-CONNECT:/tmp/adikd.sock
+ *
+ * ***/
+#include "audioinfo.h"
+#include "audioengine.h"
+#include "adikplayer.h"
+#include "adikscheduler.h"
+#include "adikcontrolserver.h"
+#include "adikproject.h"
+
+#include <iostream>
+#include <string>
+#include <memory>
+#include <csignal>
+#include <cstdlib>
+#include <chrono>
+#include <thread>
+#include <sstream>
+#include <cstdio>
+
+namespace {
+
+volatile std::sig_atomic_t gStopRequested = 0;
+
+void onSignal(int) {
+    gStopRequested = 1;
+}
+
+// "canal:sortie[m],..." -> AdikMixer::routeChannelToOutput
+bool applyRouting(AdikMixer& mixer, const std::string& routing) {
+    std::stringstream entries(routing);
+    std::string entry;
+    while (std::getline(entries, entry, ',')) {
+        int channel = 0, output = 0;
+        char mono = 0;
+        if (std::sscanf(entry.c_str(), "%d:%d%c", &channel, &output, &mono) < 2 ||
+            !mixer.routeChannelToOutput(channel, output - 1, mono == 'm')) {
+            std::cerr << "adikd: Routage invalide: '" << entry << "'." << std::endl;
+            return false;
+        }
+    }
+    return true;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    std::string socketPath = "/tmp/adikd.sock";
+    if (const char* env = std::getenv("ADIKD_SOCKET")) socketPath = env;
+    if (argc > 1) socketPath = argv[1];
+
+    std::signal(SIGINT, onSignal);
+    std::signal(SIGTERM, onSignal);
+
+    AudioInfo globalAudioInfo(44100, 2, 32, 512); // sr=44100, ch=2, bd=32, bs=512
+    if (const char* env = std::getenv("ADIKD_BIT_DEPTH")) {
+        globalAudioInfo.bitDepth = static_cast<unsigned int>(std::atoi(env));
+    }
+    if (const char* env = std::getenv("ADIKD_OUTPUTS")) {
+        const int outputs = std::atoi(env);
+        if (outputs > 0) globalAudioInfo.numChannels = static_cast<unsigned int>(outputs);
+    }
+    std::shared_ptr<AdikPlayer> player = std::make_shared<AdikPlayer>();
+    player->initParams(globalAudioInfo);
+    if (AdikSoundCache* soundCache = AdikSoundCache::getDefault()) {
+        soundCache->printReport();
+    }
+    if (const char* env = std::getenv("ADIKD_ROUTING")) {
+        if (!applyRouting(player->mixer, env)) return 1;
+        player->mixer.displayRouting();
+    }
+    if (const char* env = std::getenv("ADIKD_QUALITY")) {
+        AdikQualitySettings settings;
+        if (std::string(env) == "off") {
+            player->qualityController.setEnabled(false);
+        } else if (std::sscanf(env, "%f,%f,%f", &settings.degradeThresholds[0], &settings.degradeThresholds[1],
+                               &settings.degradeThresholds[2]) == 3) {
+            player->qualityController.configure(settings);
+        } else {
+            std::cerr << "adikd: ADIKD_QUALITY invalide: '" << env << "'." << std::endl;
+            return 1;
+        }
+    }
+    if (const char* env = std::getenv("ADIKD_NONESSENTIAL")) {
+        std::stringstream entries(env);
+        std::string entry;
+        while (std::getline(entries, entry, ',')) {
+            const int channel = std::atoi(entry.c_str());
+            if (channel >= 1 && channel <= AdikMixer::NUM_MIXER_channelList) {
+                player->mixer.channelList[channel - 1].essential = false;
+            }
+        }
+    }
+    if (argc > 2 && !AdikProject::load(*player, argv[2])) {
+        std::cerr << "adikd: Projet '" << argv[2] << "' non chargé, démarrage avec le projet par défaut." << std::endl;
+    }
+
+    AudioEngine audioEngine;
+    if (!audioEngine.init(globalAudioInfo)) {
+        std::cerr << "adikd: Échec de l'initialisation du moteur audio." << std::endl;
+        return 1;
+    }
+    audioEngine.setPlayer(player);
+    if (const char* env = std::getenv("ADIKD_DITHER")) {
+        const std::string mode = env;
+        audioEngine.setDither(mode == "none" ? AdikFormatConverter::DITHER_NONE
+                            : mode == "shaped" ? AdikFormatConverter::DITHER_SHAPED
+                            : AdikFormatConverter::DITHER_TPDF);
+    }
+    if (!audioEngine.start()) {
+        std::cerr << "adikd: Échec du démarrage du flux audio." << std::endl;
+        audioEngine.close();
+        return 1;
+    }
+
+    AdikScheduler scheduler(player, 100.0);
+    scheduler.start();
+
+    AdikControlServer server(player, socketPath);
+    if (!server.start()) {
+        scheduler.stop();
+        audioEngine.stop();
+        audioEngine.close();
+        return 1;
+    }
+
+    std::cout << "adikd: Prêt (Ctrl+C pour quitter)." << std::endl;
+    while (!gStopRequested) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+        player->qualityController.printNewTransitions(player->sampleRate);
+    }
+
+    std::cout << "adikd: Arrêt demandé." << std::endl;
+    audioEngine.printInfo(); // Charge DSP et xruns de la session
+    server.stop();
+    player->stop();
+    scheduler.stop();
+    audioEngine.stop();
+    audioEngine.close();
+    return 0;
+}
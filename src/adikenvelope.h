@@ -0,0 +1,139 @@
+#ifndef ADIKENVELOPE_H
+#define ADIKENVELOPE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <algorithm>
+
+// Paramètres d'enveloppe d'amplitude d'un instrument (durées en secondes)
+struct AdikEnvelopeParams {
+    enum Mode {
+        ONE_SHOT = 0, // Attaque, puis niveau 1 ; relâchement sur les 'release' dernières secondes du sample
+        AHDSR = 1     // Attaque, maintien, déclin vers 'sustain', relâchement après 'gate' secondes
+    };
+
+    int mode;
+    float attack;
+    float hold;
+    float decay;
+    float sustain;  // Niveau (0 à 1) ; 0 : la voix se termine à la fin du déclin
+    float release;
+    float gate;     // AHDSR : durée de la note avant le relâchement (les pas n'ont pas de note-off)
+
+    AdikEnvelopeParams() : mode(ONE_SHOT), attack(0.0f), hold(0.0f), decay(0.0f), sustain(1.0f), release(0.0f), gate(0.0f) {}
+
+    static AdikEnvelopeParams oneShot(float attack, float release) {
+        AdikEnvelopeParams params;
+        params.attack = attack;
+        params.release = release;
+        return params;
+    }
+
+    static AdikEnvelopeParams ahdsr(float attack, float hold, float decay, float sustain, float release, float gate) {
+        AdikEnvelopeParams params;
+        params.mode = AHDSR;
+        params.attack = attack;
+        params.hold = hold;
+        params.decay = decay;
+        params.sustain = sustain;
+        params.release = release;
+        params.gate = gate;
+        return params;
+    }
+
+    // Enveloppe neutre : gain 1 du début à la fin du sample
+    bool isUnity() const {
+        return mode == ONE_SHOT && attack <= 0.0f && release <= 0.0f;
+    }
+};
+
+// --- AdikEnvelope ---
+// État d'enveloppe d'une voix. Le niveau est calculé une fois par bloc (advance) ;
+// AdikChannel interpole linéairement entre le niveau de début et celui de fin de bloc.
+// Le niveau est une fonction du temps écoulé depuis le déclenchement : pas d'accumulation d'erreur.
+class AdikEnvelope {
+public:
+    AdikEnvelope() : attackFrames(0), holdFrames(0), decayFrames(0), releaseFrames(0), releaseStart(0),
+                     elapsed(0), sustain(1.0f), releaseLevel(1.0f), level(1.0f), mode(AdikEnvelopeParams::ONE_SHOT), unity(true) {}
+
+    // Démarre l'enveloppe d'une nouvelle voix ; soundFrames : longueur du sample en frames
+    void start(const AdikEnvelopeParams& params, unsigned int sampleRate, size_t soundFrames) {
+        mode = params.mode;
+        unity = params.isUnity();
+        attackFrames = toFrames(params.attack, sampleRate);
+        holdFrames = toFrames(params.hold, sampleRate);
+        decayFrames = toFrames(params.decay, sampleRate);
+        releaseFrames = toFrames(params.release, sampleRate);
+        sustain = std::max(0.0f, std::min(1.0f, params.sustain));
+        if (mode == AdikEnvelopeParams::AHDSR) {
+            releaseStart = toFrames(params.gate, sampleRate);
+        } else {
+            releaseStart = soundFrames > releaseFrames ? soundFrames - releaseFrames : 0;
+        }
+        elapsed = 0;
+        releaseLevel = levelBeforeRelease(releaseStart);
+        level = levelAt(0);
+    }
+
+    // Avance de numFrames et renvoie le niveau en fin de bloc
+    float advance(unsigned int numFrames) {
+        elapsed += numFrames;
+        level = levelAt(elapsed);
+        return level;
+    }
+
+    // Relâchement immédiat (à partir du niveau courant)
+    void release() {
+        if (elapsed >= releaseStart) return;
+        releaseLevel = level;
+        releaseStart = elapsed;
+        unity = false;
+    }
+
+    float getLevel() const { return level; }
+    bool isUnity() const { return unity; }
+    // Attaque en cours : le niveau monte, la voix ne doit pas être jugée silencieuse
+    bool isRising() const { return elapsed < attackFrames; }
+    bool isFinished() const {
+        if (unity) return false; // La fin du sample termine la voix
+        if (elapsed >= releaseStart + releaseFrames) return true;
+        // Déclin vers un sustain nul : terminée à la fin du déclin
+        return mode == AdikEnvelopeParams::AHDSR && sustain <= 0.0f && elapsed >= attackFrames + holdFrames + decayFrames;
+    }
+
+private:
+    static size_t toFrames(float seconds, unsigned int sampleRate) {
+        return seconds > 0.0f ? static_cast<size_t>(seconds * sampleRate + 0.5f) : 0;
+    }
+
+    float levelBeforeRelease(size_t t) const {
+        if (t < attackFrames) return static_cast<float>(t) / attackFrames;
+        t -= attackFrames;
+        if (mode != AdikEnvelopeParams::AHDSR || t < holdFrames) return 1.0f;
+        t -= holdFrames;
+        if (t < decayFrames) return 1.0f + (sustain - 1.0f) * static_cast<float>(t) / decayFrames;
+        return sustain;
+    }
+
+    float levelAt(size_t t) const {
+        if (unity) return 1.0f;
+        if (t < releaseStart) return levelBeforeRelease(t);
+        const size_t r = t - releaseStart;
+        if (r >= releaseFrames) return 0.0f;
+        return releaseLevel * (1.0f - static_cast<float>(r) / releaseFrames);
+    }
+
+    size_t attackFrames;
+    size_t holdFrames;
+    size_t decayFrames;
+    size_t releaseFrames;
+    size_t releaseStart;  // Frame (depuis le déclenchement) où commence le relâchement
+    size_t elapsed;
+    float sustain;
+    float releaseLevel;   // Niveau au début du relâchement
+    float level;          // Niveau à la fin du dernier bloc
+    int mode;
+    bool unity;
+};
+
+#endif // ADIKENVELOPE_H
@@ -1,27 +1,67 @@
 #ifndef ADIKEVENT_H
 #define ADIKEVENT_H
 
-#include <memory> // Pour std::shared_ptr
-#include <string>   // Pour std::string
-#include <iostream> // Pour std::cout (si utilisé pour le debug)
-
-// IMPORTANT : AdikInstrument.h DOIT être inclus avant AdikEvent.h
-// car AdikEvent contient un std::shared_ptr<AdikInstrument>.
-#include "adikinstrument.h" // Assurez-vous que AdikInstrument.h est défini et inclus avant
-
-class AdikEvent {
-public:
-    std::shared_ptr<AdikInstrument> instrument; // L'instrument à jouer pour cet événement
-    float velocity;                             // Volume de l'événement (0.0f à 1.0f)
-    float pan;                                  // Panoramique (-1.0f gauche à +1.0f droite)
-    float pitch;                                // Pitch shift (par exemple, 0.0f pour original, +/- pour transposer)
-    int step;                                   // Le pas du séquenceur où cet événement se déclenche
+#include <cstdint>     // Pour uint32_t, int16_t...
+#include <cmath>       // Pour std::lround
+#include <type_traits> // Pour std::is_trivially_copyable
+
+// Un événement ne contient plus de std::shared_ptr<AdikInstrument> :
+// il référence l'instrument par un handle 32 bits (index et génération dans le registre
+// d'instruments du Player, voir AdikInstrumentRegistry et AdikPlayer::getInstrumentHandle).
+// AdikEvent est donc un POD compact, copiable par memcpy.
+typedef uint32_t AdikInstrumentHandle;
+const AdikInstrumentHandle INVALID_INSTRUMENT_HANDLE = 0xFFFFFFFFu;
+
+// Quantification des attributs d'un événement
+namespace AdikEventQuant {
+    const float VELOCITY_SCALE = 65535.0f; // Vélocité 0.0f..1.0f -> 0..65535
+    const float PAN_SCALE = 32767.0f;      // Pan -1.0f..+1.0f -> -32767..32767
+    const float PITCH_SCALE = 100.0f;      // Pitch en demi-tons -> centièmes (±327 demi-tons)
+
+    inline int32_t clampToRange(long value, long minValue, long maxValue) {
+        if (value < minValue) return static_cast<int32_t>(minValue);
+        if (value > maxValue) return static_cast<int32_t>(maxValue);
+        return static_cast<int32_t>(value);
+    }
+
+    inline uint16_t encodeVelocity(float vel) {
+        return static_cast<uint16_t>(clampToRange(std::lround(vel * VELOCITY_SCALE), 0, 65535));
+    }
+    inline float decodeVelocity(uint16_t q) { return q / VELOCITY_SCALE; }
+
+    inline int16_t encodePan(float pan) {
+        return static_cast<int16_t>(clampToRange(std::lround(pan * PAN_SCALE), -32767, 32767));
+    }
+    inline float decodePan(int16_t q) { return q / PAN_SCALE; }
+
+    inline int16_t encodePitch(float semitones) {
+        return static_cast<int16_t>(clampToRange(std::lround(semitones * PITCH_SCALE), -32767, 32767));
+    }
+    inline float decodePitch(int16_t q) { return q / PITCH_SCALE; }
+}
+
+struct AdikEvent {
+    AdikInstrumentHandle instrument; // Handle de l'instrument à jouer pour cet événement
+    int32_t step;                    // Le pas du séquenceur où cet événement se déclenche
+    uint16_t velocity;               // Volume quantifié (0.0f à 1.0f)
+    int16_t pan;                     // Panoramique quantifié (-1.0f gauche à +1.0f droite)
+    int16_t pitch;                   // Pitch shift quantifié, en centièmes de demi-ton
+
+    AdikEvent() = default;
 
     // Constructeur
-    AdikEvent(std::shared_ptr<AdikInstrument> instr, int s, float vel = 1.0f, float p = 0.0f, float pt = 0.0f)
-        : instrument(instr), velocity(vel), pan(p), pitch(pt), step(s) {
-        // std::cout << "AdikEvent créé pour instrument " << (instrument ? instrument->name : "N/A") << " au pas " << step << std::endl;
+    AdikEvent(AdikInstrumentHandle instr, int s, float vel = 1.0f, float p = 0.0f, float pt = 0.0f)
+        : instrument(instr), step(s),
+          velocity(AdikEventQuant::encodeVelocity(vel)),
+          pan(AdikEventQuant::encodePan(p)),
+          pitch(AdikEventQuant::encodePitch(pt)) {
     }
+
+    float getVelocity() const { return AdikEventQuant::decodeVelocity(velocity); }
+    float getPan() const { return AdikEventQuant::decodePan(pan); }
+    float getPitch() const { return AdikEventQuant::decodePitch(pitch); }
 };
 
+static_assert(std::is_trivially_copyable<AdikEvent>::value, "AdikEvent doit rester un POD copiable par memcpy");
+
 #endif // ADIKEVENT_H
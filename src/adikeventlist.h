@@ -0,0 +1,180 @@
+#ifndef ADIKEVENTLIST_H
+#define ADIKEVENTLIST_H
+
+#include <vector>
+#include <algorithm> // Pour std::lower_bound, std::upper_bound
+#include <utility>   // Pour std::pair
+#include <cstddef>
+
+#include "adikevent.h"
+
+// --- AdikEventList ---
+// Stockage des événements d'une piste en "structure de tableaux" (SoA) :
+// un tableau par attribut, tous triés par pas croissant.
+// Le parcours des pas ne touche que le tableau 'steps', et les transformations
+// en bloc (transposition, vélocité, copier/coller) travaillent sur des tableaux
+// contigus de POD, vectorisables par le compilateur.
+class AdikEventList {
+public:
+    std::vector<int32_t> steps;
+    std::vector<AdikInstrumentHandle> instruments;
+    std::vector<uint16_t> velocities;
+    std::vector<int16_t> pans;
+    std::vector<int16_t> pitches;
+
+    size_t size() const { return steps.size(); }
+    bool empty() const { return steps.empty(); }
+
+    void clear() {
+        steps.clear();
+        instruments.clear();
+        velocities.clear();
+        pans.clear();
+        pitches.clear();
+    }
+
+    void reserve(size_t count) {
+        steps.reserve(count);
+        instruments.reserve(count);
+        velocities.reserve(count);
+        pans.reserve(count);
+        pitches.reserve(count);
+    }
+
+    // Ajoute un événement en conservant l'ordre des pas.
+    // Les événements d'un même pas gardent leur ordre d'insertion.
+    void add(const AdikEvent& event) {
+        size_t index = steps.size();
+        if (!steps.empty() && steps.back() > event.step) {
+            index = std::upper_bound(steps.begin(), steps.end(), event.step) - steps.begin();
+        }
+        steps.insert(steps.begin() + index, event.step);
+        instruments.insert(instruments.begin() + index, event.instrument);
+        velocities.insert(velocities.begin() + index, event.velocity);
+        pans.insert(pans.begin() + index, event.pan);
+        pitches.insert(pitches.begin() + index, event.pitch);
+    }
+
+    // Reconstitue l'événement à l'index donné
+    AdikEvent get(size_t index) const {
+        AdikEvent event;
+        event.instrument = instruments[index];
+        event.step = steps[index];
+        event.velocity = velocities[index];
+        event.pan = pans[index];
+        event.pitch = pitches[index];
+        return event;
+    }
+
+    void remove(size_t index) {
+        if (index >= steps.size()) return;
+        steps.erase(steps.begin() + index);
+        instruments.erase(instruments.begin() + index);
+        velocities.erase(velocities.begin() + index);
+        pans.erase(pans.begin() + index);
+        pitches.erase(pitches.begin() + index);
+    }
+
+    // Intervalle [first, second) des événements situés dans [firstStep, lastStep)
+    std::pair<size_t, size_t> rangeBetweenSteps(int firstStep, int lastStep) const {
+        size_t first = std::lower_bound(steps.begin(), steps.end(), firstStep) - steps.begin();
+        size_t last = std::lower_bound(steps.begin() + first, steps.end(), lastStep) - steps.begin();
+        return std::make_pair(first, last);
+    }
+
+    // Intervalle [first, second) des événements au pas donné (recherche dichotomique)
+    std::pair<size_t, size_t> rangeAtStep(int step) const {
+        return rangeBetweenSteps(step, step + 1);
+    }
+
+    bool hasEventsAtStep(int step) const {
+        std::pair<size_t, size_t> range = rangeAtStep(step);
+        return range.first != range.second;
+    }
+
+    // --- Transformations en bloc ---
+
+    // Transpose tous les événements de 'semitones' demi-tons (saturation sur int16)
+    void transpose(float semitones) {
+        const int32_t delta = AdikEventQuant::encodePitch(semitones);
+        int16_t* p = pitches.data();
+        const size_t n = pitches.size();
+        for (size_t i = 0; i < n; ++i) {
+            int32_t value = p[i] + delta;
+            value = value < -32767 ? -32767 : (value > 32767 ? 32767 : value);
+            p[i] = static_cast<int16_t>(value);
+        }
+    }
+
+    // Multiplie toutes les vélocités par 'factor' (saturation à 1.0f)
+    void scaleVelocity(float factor) {
+        if (factor < 0.0f) factor = 0.0f;
+        uint16_t* v = velocities.data();
+        const size_t n = velocities.size();
+        for (size_t i = 0; i < n; ++i) {
+            float value = v[i] * factor + 0.5f;
+            v[i] = static_cast<uint16_t>(value > 65535.0f ? 65535.0f : value);
+        }
+    }
+
+    // Copie les événements de [firstStep, lastStep) dans 'clip', pas ramenés à 0
+    void copyRange(int firstStep, int lastStep, AdikEventList& clip) const {
+        std::pair<size_t, size_t> range = rangeBetweenSteps(firstStep, lastStep);
+        clip.steps.assign(steps.begin() + range.first, steps.begin() + range.second);
+        clip.instruments.assign(instruments.begin() + range.first, instruments.begin() + range.second);
+        clip.velocities.assign(velocities.begin() + range.first, velocities.begin() + range.second);
+        clip.pans.assign(pans.begin() + range.first, pans.begin() + range.second);
+        clip.pitches.assign(pitches.begin() + range.first, pitches.begin() + range.second);
+        for (auto& s : clip.steps) {
+            s -= firstStep;
+        }
+    }
+
+    // Supprime les événements de [firstStep, lastStep)
+    void removeRange(int firstStep, int lastStep) {
+        std::pair<size_t, size_t> range = rangeBetweenSteps(firstStep, lastStep);
+        steps.erase(steps.begin() + range.first, steps.begin() + range.second);
+        instruments.erase(instruments.begin() + range.first, instruments.begin() + range.second);
+        velocities.erase(velocities.begin() + range.first, velocities.begin() + range.second);
+        pans.erase(pans.begin() + range.first, pans.begin() + range.second);
+        pitches.erase(pitches.begin() + range.first, pitches.begin() + range.second);
+    }
+
+    // Colle 'clip' (pas relatifs) à partir de 'atStep'.
+    // Le clip étant trié, l'insertion se fait en un seul bloc par tableau.
+    void paste(const AdikEventList& clip, int atStep) {
+        if (clip.empty()) return;
+        const int clipFirst = atStep + clip.steps.front();
+        const int clipLast = atStep + clip.steps.back();
+        // Les événements du clip se placent après ceux déjà présents aux mêmes pas
+        size_t index = std::upper_bound(steps.begin(), steps.end(), clipFirst) - steps.begin();
+        if (index != steps.size() && steps[index] <= clipLast) {
+            // Le clip chevauche des événements existants : insertion individuelle
+            for (size_t i = 0; i < clip.size(); ++i) {
+                AdikEvent event = clip.get(i);
+                event.step += atStep;
+                add(event);
+            }
+            return;
+        }
+        steps.insert(steps.begin() + index, clip.steps.begin(), clip.steps.end());
+        for (size_t i = index; i < index + clip.size(); ++i) {
+            steps[i] += atStep;
+        }
+        instruments.insert(instruments.begin() + index, clip.instruments.begin(), clip.instruments.end());
+        velocities.insert(velocities.begin() + index, clip.velocities.begin(), clip.velocities.end());
+        pans.insert(pans.begin() + index, clip.pans.begin(), clip.pans.end());
+        pitches.insert(pitches.begin() + index, clip.pitches.begin(), clip.pitches.end());
+    }
+
+    // Mémoire utilisée par les tableaux d'événements, en octets
+    size_t memoryBytes() const {
+        return steps.capacity() * sizeof(int32_t)
+             + instruments.capacity() * sizeof(AdikInstrumentHandle)
+             + velocities.capacity() * sizeof(uint16_t)
+             + pans.capacity() * sizeof(int16_t)
+             + pitches.capacity() * sizeof(int16_t);
+    }
+};
+
+#endif // ADIKEVENTLIST_H
@@ -0,0 +1,193 @@
+#include "adikformatconverter.h"
+
+#include <cmath>     // Pour std::lrintf
+#include <cstring>   // Pour std::memcpy
+#include <algorithm> // Pour std::min, std::max
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+namespace {
+
+const uint32_t DITHER_SEEDS[4] = { 0x9E3779B9u, 0x7F4A7C15u, 0x85EBCA6Bu, 0xC2B2AE35u };
+
+// Échelle et bornes en unités de LSB pour un format entier
+struct IntegerRange {
+    float scale;
+    float minValue;
+    float maxValue;
+    int shift; // Décalage vers la gauche dans le conteneur (INT24 dans 32 bits)
+};
+
+IntegerRange integerRange(AdikSampleFormat format) {
+    if (format == AdikSampleFormat::INT16) {
+        return IntegerRange{ 32768.0f, -32768.0f, 32767.0f, 0 };
+    }
+    return IntegerRange{ 8388608.0f, -8388608.0f, 8388607.0f, 8 };
+}
+
+inline uint32_t xorshift32(uint32_t& state) {
+    state ^= state << 13;
+    state ^= state >> 17;
+    state ^= state << 5;
+    return state;
+}
+
+// Uniforme dans [-0.5, 0.5) à partir des 23 bits forts (mantisse d'un float dans [1, 2))
+inline float uniformFromBits(uint32_t bits) {
+    const uint32_t mantissa = (bits >> 9) | 0x3F800000u;
+    float value;
+    std::memcpy(&value, &mantissa, sizeof(value));
+    return value - 1.5f;
+}
+
+} // namespace
+
+AdikFormatConverter::AdikFormatConverter()
+    : format(AdikSampleFormat::FLOAT32), channels(2), dither(DITHER_NONE), rngLane(0) {
+    reset();
+}
+
+void AdikFormatConverter::configure(AdikSampleFormat fmt, unsigned int numChannels, Dither ditherMode) {
+    format = fmt;
+    channels = numChannels > 0 ? numChannels : 1;
+    dither = ditherMode;
+    errors.assign(channels, 0.0f);
+    reset();
+}
+
+void AdikFormatConverter::reset() {
+    for (int i = 0; i < 4; ++i) rngState[i] = DITHER_SEEDS[i];
+    rngLane = 0;
+    std::fill(errors.begin(), errors.end(), 0.0f);
+}
+
+float AdikFormatConverter::nextUniform() {
+    return uniformFromBits(xorshift32(rngState[rngLane]));
+}
+
+// Chemin scalaire : samples [start, start + count) de l'entrée entrelacée.
+// Deux tirages par sample sur la même voie, puis passage à la voie suivante (comme en SSE2).
+void AdikFormatConverter::convertScalar(const float* input, void* output, size_t start, size_t count) {
+    const IntegerRange range = integerRange(format);
+    for (size_t i = start; i < start + count; ++i) {
+        float value = input[i] * range.scale;
+        if (dither != DITHER_NONE) {
+            const float d1 = nextUniform();
+            const float d2 = nextUniform();
+            rngLane = (rngLane + 1) & 3u;
+            if (dither == DITHER_SHAPED) {
+                float& error = errors[i % channels];
+                const float target = value - error;
+                float quantized = static_cast<float>(std::lrintf(std::min(range.maxValue, std::max(range.minValue, target + (d1 + d2)))));
+                error = quantized - target;
+                value = quantized;
+            } else {
+                value = value + (d1 + d2);
+            }
+        }
+        const int32_t sample = static_cast<int32_t>(std::lrintf(std::min(range.maxValue, std::max(range.minValue, value))));
+        if (format == AdikSampleFormat::INT16) {
+            static_cast<int16_t*>(output)[i] = static_cast<int16_t>(sample);
+        } else {
+            static_cast<int32_t*>(output)[i] = static_cast<int32_t>(static_cast<uint32_t>(sample) << range.shift);
+        }
+    }
+}
+
+void AdikFormatConverter::convert(const float* input, void* output, size_t numFrames) {
+    const size_t total = numFrames * channels;
+    if (format == AdikSampleFormat::FLOAT32) {
+        std::memcpy(output, input, total * sizeof(float));
+        return;
+    }
+
+    // La mise en forme du bruit dépend de l'erreur du sample précédent du même canal : pas de SIMD
+    if (dither == DITHER_SHAPED) {
+        convertScalar(input, output, 0, total);
+        return;
+    }
+
+    size_t i = 0;
+#if defined(__SSE2__)
+    // Aligner le début du chemin vectoriel sur la voie 0 du générateur
+    if (dither != DITHER_NONE) {
+        const size_t head = std::min(total, static_cast<size_t>((4u - rngLane) & 3u));
+        convertScalar(input, output, 0, head);
+        i = head;
+    }
+
+    const IntegerRange range = integerRange(format);
+    const __m128 scale = _mm_set1_ps(range.scale);
+    const __m128 minValue = _mm_set1_ps(range.minValue);
+    const __m128 maxValue = _mm_set1_ps(range.maxValue);
+    const __m128i mantissaOne = _mm_set1_epi32(0x3F800000);
+    const __m128 half = _mm_set1_ps(1.5f);
+    __m128i state = _mm_loadu_si128(reinterpret_cast<const __m128i*>(rngState));
+
+    // Un tirage uniforme [-0.5, 0.5) sur chacune des 4 voies
+    auto nextUniform4 = [&]() {
+        state = _mm_xor_si128(state, _mm_slli_epi32(state, 13));
+        state = _mm_xor_si128(state, _mm_srli_epi32(state, 17));
+        state = _mm_xor_si128(state, _mm_slli_epi32(state, 5));
+        const __m128i mantissa = _mm_or_si128(_mm_srli_epi32(state, 9), mantissaOne);
+        return _mm_sub_ps(_mm_castsi128_ps(mantissa), half);
+    };
+
+    // Convertit 4 samples en entiers 32 bits (arrondi au plus proche, saturé)
+    auto quantize4 = [&](const float* source) {
+        __m128 value = _mm_mul_ps(_mm_loadu_ps(source), scale);
+        if (dither == DITHER_TPDF) {
+            const __m128 d1 = nextUniform4();
+            const __m128 d2 = nextUniform4();
+            value = _mm_add_ps(value, _mm_add_ps(d1, d2));
+        }
+        value = _mm_min_ps(maxValue, _mm_max_ps(minValue, value));
+        return _mm_cvtps_epi32(value);
+    };
+
+    if (format == AdikSampleFormat::INT16) {
+        int16_t* out = static_cast<int16_t*>(output);
+        for (; i + 8 <= total; i += 8) {
+            const __m128i low = quantize4(input + i);
+            const __m128i high = quantize4(input + i + 4);
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i), _mm_packs_epi32(low, high));
+        }
+    } else {
+        int32_t* out = static_cast<int32_t*>(output);
+        for (; i + 4 <= total; i += 4) {
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i), _mm_slli_epi32(quantize4(input + i), range.shift));
+        }
+    }
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(rngState), state);
+#endif
+
+    convertScalar(input, output, i, total - i);
+}
+
+size_t AdikFormatConverter::bytesPerSample(AdikSampleFormat fmt) {
+    return fmt == AdikSampleFormat::INT16 ? 2 : 4;
+}
+
+const char* AdikFormatConverter::formatName(AdikSampleFormat fmt) {
+    switch (fmt) {
+        case AdikSampleFormat::INT16: return "int16";
+        case AdikSampleFormat::INT24: return "int24 (32 bits)";
+        default: return "float32";
+    }
+}
+
+const char* AdikFormatConverter::ditherName(Dither ditherMode) {
+    switch (ditherMode) {
+        case DITHER_TPDF: return "TPDF";
+        case DITHER_SHAPED: return "TPDF + mise en forme";
+        default: return "aucun";
+    }
+}
+
+AdikSampleFormat AdikFormatConverter::formatForBitDepth(unsigned int bitDepth) {
+    if (bitDepth == 16) return AdikSampleFormat::INT16;
+    if (bitDepth == 24) return AdikSampleFormat::INT24;
+    return AdikSampleFormat::FLOAT32;
+}
@@ -0,0 +1,61 @@
+#ifndef ADIKFORMATCONVERTER_H
+#define ADIKFORMATCONVERTER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Formats de sortie (carte son ou fichier) produits à partir du bus interne en float
+enum class AdikSampleFormat {
+    FLOAT32, // float 32 bits, [-1, 1]
+    INT16,   // Entier 16 bits
+    INT24    // Entier 24 bits dans un conteneur de 32 bits (cadré à gauche, les 8 bits faibles à zéro)
+};
+
+// --- AdikFormatConverter ---
+// Conversion float entrelacé -> format de sortie, avec dither TPDF et mise en forme du bruit optionnels.
+// Utilisé par le driver audio (dans le callback : aucune allocation après configure())
+// et par l'écriture de fichiers (AdikWavWriter), pour un rendu identique.
+// Le chemin sans mise en forme du bruit est vectorisé (SSE2) ; la mise en forme du bruit
+// (rétroaction de l'erreur, par canal) est séquentielle par nature.
+// Le générateur de dither est déterministe (graine fixe, 4 voies xorshift32) et produit
+// la même suite en SSE2 et en scalaire : un rendu est reproductible d'une machine à l'autre.
+class AdikFormatConverter {
+public:
+    enum Dither {
+        DITHER_NONE,   // Arrondi simple
+        DITHER_TPDF,   // Bruit triangulaire de ±1 LSB, décorrèle l'erreur de quantification
+        DITHER_SHAPED  // TPDF + mise en forme du bruit (1er ordre) : le bruit est repoussé vers l'aigu
+    };
+
+    AdikFormatConverter();
+
+    void configure(AdikSampleFormat fmt, unsigned int numChannels, Dither ditherMode);
+    void reset(); // Remet le générateur et les erreurs à zéro (début d'un rendu)
+
+    // Convertit 'numFrames' frames entrelacées de 'input' vers 'output' (format configuré)
+    void convert(const float* input, void* output, size_t numFrames);
+
+    AdikSampleFormat getFormat() const { return format; }
+    unsigned int getNumChannels() const { return channels; }
+    Dither getDither() const { return dither; }
+
+    static size_t bytesPerSample(AdikSampleFormat fmt);
+    static const char* formatName(AdikSampleFormat fmt);
+    static const char* ditherName(Dither ditherMode);
+    // 16 -> INT16, 24 -> INT24, autre -> FLOAT32
+    static AdikSampleFormat formatForBitDepth(unsigned int bitDepth);
+
+private:
+    AdikSampleFormat format;
+    unsigned int channels;
+    Dither dither;
+    uint32_t rngState[4];        // Une graine par voie
+    unsigned int rngLane;        // Voie du prochain tirage (chemin scalaire)
+    std::vector<float> errors;   // Erreur de quantification précédente, par canal (DITHER_SHAPED)
+
+    float nextUniform();         // Uniforme dans [-0.5, 0.5)
+    void convertScalar(const float* input, void* output, size_t start, size_t count);
+};
+
+#endif // ADIKFORMATCONVERTER_H
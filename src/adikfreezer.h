@@ -0,0 +1,528 @@
+#ifndef ADIKFREEZER_H
+#define ADIKFREEZER_H
+
+#include "adikplayer.h"
+#include "adikfrozen.h"
+#include "adikkit.h"
+#include "adikvoicerenderer.h"
+
+#include <memory>
+#include <string>
+#include <vector>
+#include <utility>
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <chrono>
+#include <algorithm>
+#include <iostream>
+
+// --- AdikFreezer ---
+// Gel de pistes et de séquences : une boucle de la séquence est rendue hors temps réel, sur un thread
+// d'arrière-plan, dans un son stéréo (AdikFrozenAudio) que le thread audio joue par une seule voix
+// à la place des événements des pistes figées (voir AdikPlayer::triggerFrozenVoices).
+// Une boucle est rendue pour chaque séquence qui peut précéder la séquence figée : aucune (départ, saut de
+// position), elle-même (lecture en boucle) et ses prédécesseurs dans le morceau. La voix d'une séquence figée
+// remplace au pas 0 celle de la précédente : si la précédente est figée de la même façon sur le même canal,
+// sa fin est rendue au début de la boucle (rendu des deux séquences enchaînées, la seconde gardée) ; sinon la
+// boucle part du silence. Chaque rendu garde la fin de ses propres sons après le dernier pas.
+// Le rendu somme les pistes avant les bus : toutes les pistes d'une séquence figée doivent aller dans le même
+// bus, avec le même réglage de surcharge (AdikChannel::essential), sinon la séquence n'est pas figée.
+// Le thread relit périodiquement ce dont dépend chaque rendu (événements, volume, mute/solo, routage des canaux,
+// instruments du kit, tempo, morceau) sous AdikPlayer::sequenceEditMutex : à la moindre différence le rendu est
+// retiré, les pistes rejouent leurs événements, puis un nouveau rendu est publié.
+// Pas de gel sous une carte de tempo (durée des pas variable) : les pistes restent jouées normalement.
+class AdikFreezer {
+public:
+    static const int WHOLE_SEQUENCE = AdikFrozenAudio::WHOLE_SEQUENCE;
+
+    explicit AdikFreezer(std::shared_ptr<AdikPlayer> p)
+        : player(p), running(false), requests(0), completedRequests(0) {
+        if (!player) {
+            std::cerr << "AdikFreezer créé avec un AdikPlayer nul !" << std::endl;
+        }
+    }
+
+    ~AdikFreezer() {
+        running.store(false);
+        if (worker.joinable()) worker.join();
+    }
+
+    // Gel demandé : séquence et piste (WHOLE_SEQUENCE : séquence entière)
+    typedef std::pair<std::shared_ptr<AdikSequence>, int> FrozenTrack;
+
+    // Demande le gel d'une piste, ou de toute la séquence (les gels de ses pistes sont alors remplacés).
+    // Le rendu est fait en arrière-plan. Faux si la demande est invalide.
+    bool freeze(std::shared_ptr<AdikSequence> sequence, int trackIndex = WHOLE_SEQUENCE) {
+        if (!player || !sequence) return false;
+        std::lock_guard<std::mutex> editLock(player->sequenceEditMutex);
+        return freezeLocked(sequence, trackIndex);
+    }
+
+    // Dégèle une piste (ou la séquence) : ses événements rejouent dès le pas suivant. Faux si elle n'était pas figée.
+    bool unfreeze(const std::shared_ptr<AdikSequence>& sequence, int trackIndex = WHOLE_SEQUENCE) {
+        if (!player || !sequence) return false;
+        std::lock_guard<std::mutex> editLock(player->sequenceEditMutex);
+        return unfreezeLocked(sequence, trackIndex);
+    }
+
+    // Comme freeze et unfreeze, sequenceEditMutex pris par l'appelant (éditions suivies par AdikHistory)
+    bool freezeLocked(const std::shared_ptr<AdikSequence>& sequence, int trackIndex) {
+        if (!player || !sequence) return false;
+        if (trackIndex != WHOLE_SEQUENCE && (trackIndex < 0 || trackIndex >= static_cast<int>(sequence->tracks.size()) || trackIndex >= 64)) {
+            std::cerr << "AdikFreezer: Piste invalide: " << trackIndex << std::endl;
+            return false;
+        }
+        {
+            std::lock_guard<std::mutex> lock(targetsMutex);
+            for (const auto& target : targets) {
+                if (target.sequence == sequence && (target.trackIndex == trackIndex || target.trackIndex == WHOLE_SEQUENCE)) {
+                    return true; // Déjà figée
+                }
+            }
+            if (trackIndex == WHOLE_SEQUENCE) {
+                for (size_t i = 0; i < targets.size();) {
+                    if (targets[i].sequence == sequence) {
+                        player->unpublishFrozen(sequence.get(), targets[i].trackIndex);
+                        targets.erase(targets.begin() + i);
+                    } else {
+                        ++i;
+                    }
+                }
+            }
+            if (targets.size() >= static_cast<size_t>(MAX_TARGETS)) {
+                std::cerr << "AdikFreezer: Nombre maximal de gels atteint (" << MAX_TARGETS << ")." << std::endl;
+                return false;
+            }
+            targets.push_back(Target{ sequence, trackIndex, 0 });
+        }
+        requests.fetch_add(1);
+        if (!running.exchange(true)) {
+            worker = std::thread(&AdikFreezer::run, this);
+        }
+        return true;
+    }
+
+    bool unfreezeLocked(const std::shared_ptr<AdikSequence>& sequence, int trackIndex) {
+        if (!player || !sequence) return false;
+        std::lock_guard<std::mutex> lock(targetsMutex);
+        for (size_t i = 0; i < targets.size(); ++i) {
+            if (targets[i].sequence == sequence && targets[i].trackIndex == trackIndex) {
+                player->unpublishFrozen(sequence.get(), trackIndex);
+                targets.erase(targets.begin() + i);
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // Gels demandés, dans l'ordre des demandes
+    std::vector<FrozenTrack> getFrozenTracks() {
+        std::lock_guard<std::mutex> lock(targetsMutex);
+        std::vector<FrozenTrack> frozen;
+        for (const auto& target : targets) frozen.emplace_back(target.sequence, target.trackIndex);
+        return frozen;
+    }
+
+    // Ramène les gels à 'wanted' : les autres sont dégelés, ceux qui manquent demandés.
+    // sequenceEditMutex pris par l'appelant (AdikHistory, en annulant ou rétablissant).
+    void setFrozenTracksLocked(const std::vector<FrozenTrack>& wanted) {
+        for (const FrozenTrack& frozen : getFrozenTracks()) {
+            if (std::find(wanted.begin(), wanted.end(), frozen) == wanted.end()) unfreezeLocked(frozen.first, frozen.second);
+        }
+        for (const FrozenTrack& frozen : wanted) freezeLocked(frozen.first, frozen.second);
+    }
+
+    // Attend que les demandes déjà faites soient rendues et publiées (ou refusées)
+    void wait() const {
+        while (running.load() && completedRequests.load() < requests.load()) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+    }
+
+    // Gels demandés (publiés ou en cours de rendu)
+    size_t getFrozenCount() {
+        std::lock_guard<std::mutex> lock(targetsMutex);
+        return targets.size();
+    }
+
+    void displayFrozen() {
+        std::lock_guard<std::mutex> lock(targetsMutex);
+        std::cout << "Gels (" << targets.size() << "):" << std::endl;
+        for (const auto& target : targets) {
+            std::cout << "  '" << target.sequence->name << "' "
+                      << (target.trackIndex == WHOLE_SEQUENCE ? std::string("séquence entière") : "piste " + std::to_string(target.trackIndex + 1))
+                      << (target.published ? "" : " (non publiée)") << std::endl;
+        }
+    }
+
+    // Rendu et publication immédiats, sur le thread appelant et sans surveillance des modifications
+    // (rendu hors ligne, tests de performance). Vrai si tous les rendus du gel ont été publiés.
+    static bool freezeNow(AdikPlayer& player, const std::shared_ptr<AdikSequence>& sequence, int trackIndex = WHOLE_SEQUENCE) {
+        return freezeTargetsNow(player, { Target{ sequence, trackIndex, 0 } }) == 1;
+    }
+
+    // Comme freezeNow, pour des séquences entières figées ensemble : la fin des sons d'une séquence du lot est
+    // rendue au début de celles qui la suivent. Renvoie le nombre de séquences figées.
+    static size_t freezeSequencesNow(AdikPlayer& player, const std::vector<std::shared_ptr<AdikSequence>>& sequences) {
+        std::vector<Target> batch;
+        for (const auto& sequence : sequences) batch.push_back(Target{ sequence, WHOLE_SEQUENCE, 0 });
+        return freezeTargetsNow(player, batch);
+    }
+
+private:
+    // Séquence qui peut précéder la séquence figée : un rendu chacune
+    struct Context {
+        const AdikSequence* predecessor = nullptr; // Identité (nullptr : départ)
+        std::shared_ptr<AdikSequence> seed;        // Copie rendue avant la boucle, ou nullptr : boucle rendue depuis le silence
+    };
+
+    // Ce dont dépend un rendu, copié sous sequenceEditMutex puis rendu sans verrou
+    struct Snapshot {
+        const AdikSequence* key = nullptr;
+        std::shared_ptr<AdikSequence> sequence; // Copie
+        int trackIndex = WHOLE_SEQUENCE;
+        std::shared_ptr<AdikKit> kit;
+        unsigned int sampleRate = 0;
+        double samplesPerStep = 0.0;
+        bool tempoMapped = false;
+        std::vector<int> channelBuses;          // Routage des canaux du mixeur du player (AdikChannel::busIndex)
+        std::vector<uint8_t> channelEssential;  // et leur réglage de surcharge (AdikChannel::essential)
+        std::vector<Context> contexts;
+    };
+
+    struct Target {
+        std::shared_ptr<AdikSequence> sequence;
+        int trackIndex;
+        uint64_t signature; // Empreinte du dernier rendu tenté, 0 : jamais rendu
+        bool published = false;
+    };
+
+    std::shared_ptr<AdikPlayer> player;
+    std::thread worker;
+    std::atomic<bool> running;
+    std::mutex targetsMutex;      // Pris après sequenceEditMutex
+    std::vector<Target> targets;
+    std::atomic<uint64_t> requests;
+    std::atomic<uint64_t> completedRequests;
+
+    static constexpr int POLL_INTERVAL_MS = 50;   // Délai maximal de détection d'une modification
+    static constexpr int MAX_TARGETS = AdikPlayer::MAX_FROZEN / 4; // Un gel occupe un emplacement par séquence précédente
+    static constexpr unsigned int MAX_TAIL_SECONDS = 10; // Fin des sons gardée au plus après le dernier pas
+
+    void run() {
+        while (running.load()) {
+            const uint64_t passRequests = requests.load();
+            refresh();
+            completedRequests.store(passRequests);
+            for (int waited = 0; running.load() && waited < POLL_INTERVAL_MS && requests.load() == passRequests; ++waited) {
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            }
+        }
+    }
+
+    // Une passe : chaque gel dont l'empreinte a changé est retiré, rendu à nouveau puis republié
+    void refresh() {
+        std::vector<Target> current;
+        {
+            std::lock_guard<std::mutex> lock(targetsMutex);
+            current = targets;
+        }
+        for (const auto& target : current) {
+            Snapshot snapshot;
+            uint64_t currentSignature = 0;
+            {
+                std::lock_guard<std::mutex> editLock(player->sequenceEditMutex);
+                if (!isStillTarget(target) || !takeSnapshot(*player, target.sequence, target.trackIndex, current, snapshot)) continue;
+                currentSignature = signature(snapshot);
+                if (currentSignature == target.signature) continue;
+                // Les pistes rejouent leurs événements pendant le rendu
+                player->unpublishFrozen(target.sequence.get(), target.trackIndex);
+            }
+
+            const auto start = std::chrono::steady_clock::now();
+            const std::vector<std::shared_ptr<AdikFrozenAudio>> renders = render(snapshot, currentSignature);
+            const double elapsedMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+            std::lock_guard<std::mutex> editLock(player->sequenceEditMutex);
+            std::lock_guard<std::mutex> lock(targetsMutex);
+            for (auto& stored : targets) {
+                if (stored.sequence != target.sequence || stored.trackIndex != target.trackIndex) continue;
+                stored.signature = currentSignature;
+                stored.published = publishAll(*player, renders);
+                if (stored.published) {
+                    size_t bytes = 0;
+                    for (const auto& frozen : renders) bytes += frozen->voice->sound.getMemoryBytes();
+                    std::cout << "AdikFreezer: '" << target.sequence->name << "' "
+                              << (target.trackIndex == WHOLE_SEQUENCE ? std::string("figée") : "piste " + std::to_string(target.trackIndex + 1) + " figée")
+                              << " : " << renders.size() << " rendus, " << bytes / 1024 << " Kio, rendus en " << elapsedMs << " ms." << std::endl;
+                }
+            }
+        }
+        std::lock_guard<std::mutex> editLock(player->sequenceEditMutex);
+        player->collectRetiredFrozenLocked();
+    }
+
+    // sequenceEditMutex pris. Faux si le gel a été annulé, ou si la séquence n'est plus jouable
+    // (remplacée, ex. projet rechargé) : son rendu est alors retiré et le gel oublié.
+    bool isStillTarget(const Target& target) {
+        std::lock_guard<std::mutex> lock(targetsMutex);
+        auto it = std::find_if(targets.begin(), targets.end(), [&](const Target& stored) {
+            return stored.sequence == target.sequence && stored.trackIndex == target.trackIndex;
+        });
+        if (it == targets.end()) return false;
+        bool playable = std::find(player->sequenceList.begin(), player->sequenceList.end(), target.sequence) != player->sequenceList.end();
+        if (!playable && player->currentSong) {
+            const auto& songSequences = player->currentSong->sequences;
+            playable = std::find(songSequences.begin(), songSequences.end(), target.sequence) != songSequences.end();
+        }
+        if (!playable) {
+            player->unpublishFrozen(target.sequence.get(), target.trackIndex);
+            targets.erase(it);
+            return false;
+        }
+        return true;
+    }
+
+    // Rend puis publie un lot de gels, chacun pouvant être précédé d'un autre du lot. Renvoie le nombre de gels publiés.
+    static size_t freezeTargetsNow(AdikPlayer& player, const std::vector<Target>& batch) {
+        std::vector<Snapshot> snapshots(batch.size());
+        std::vector<uint8_t> taken(batch.size(), 0);
+        {
+            std::lock_guard<std::mutex> editLock(player.sequenceEditMutex);
+            for (size_t i = 0; i < batch.size(); ++i) {
+                taken[i] = takeSnapshot(player, batch[i].sequence, batch[i].trackIndex, batch, snapshots[i]);
+            }
+        }
+        size_t published = 0;
+        for (size_t i = 0; i < batch.size(); ++i) {
+            if (!taken[i]) continue;
+            const std::vector<std::shared_ptr<AdikFrozenAudio>> renders = render(snapshots[i], signature(snapshots[i]));
+            std::lock_guard<std::mutex> editLock(player.sequenceEditMutex);
+            if (publishAll(player, renders)) published++;
+        }
+        return published;
+    }
+
+    // sequenceEditMutex pris. Faux si aucun rendu, ou si l'un d'eux n'a pas pu être publié.
+    static bool publishAll(AdikPlayer& player, const std::vector<std::shared_ptr<AdikFrozenAudio>>& renders) {
+        bool published = !renders.empty();
+        for (const auto& frozen : renders) {
+            published = player.publishFrozen(frozen) && published;
+        }
+        return published;
+    }
+
+    // sequenceEditMutex pris. 'frozenTargets' : gels demandés en même temps, dont la fin des sons peut être rendue
+    // au début de la séquence qu'ils précèdent.
+    static bool takeSnapshot(AdikPlayer& player, const std::shared_ptr<AdikSequence>& sequence, int trackIndex,
+                             const std::vector<Target>& frozenTargets, Snapshot& snapshot) {
+        if (!sequence || sequence->lengthInSteps <= 0 || sequence->tracks.empty()) return false;
+        if (trackIndex != WHOLE_SEQUENCE && (trackIndex < 0 || trackIndex >= static_cast<int>(sequence->tracks.size()))) return false;
+        snapshot.key = sequence.get();
+        snapshot.sequence = std::make_shared<AdikSequence>(*sequence);
+        snapshot.trackIndex = trackIndex;
+        snapshot.kit = player.getPublishedKit();
+        snapshot.sampleRate = player.sampleRate;
+        // Durée d'un pas d'après le tempo demandé (player.samplesPerStep est mis à jour par le thread audio)
+        snapshot.samplesPerStep = AdikClock(player.sampleRate, player.tempoBPM, player.clock.stepsPerBeat).getSamplesPerStep();
+        snapshot.tempoMapped = player.getPublishedTempoMap() != nullptr;
+        snapshot.channelBuses.clear();
+        snapshot.channelEssential.clear();
+        for (const auto& channel : player.mixer.channelList) {
+            snapshot.channelBuses.push_back(channel.busIndex);
+            snapshot.channelEssential.push_back(channel.essential ? 1 : 0);
+        }
+
+        // Séquences qui peuvent précéder : aucune, elle-même, puis ses prédécesseurs dans le morceau (qui boucle)
+        std::vector<const AdikSequence*> predecessors = { nullptr, sequence.get() };
+        if (player.currentSong) {
+            const auto& song = player.currentSong->sequences;
+            for (size_t p = 0; p < song.size(); ++p) {
+                if (song[p] != sequence) continue;
+                const AdikSequence* previous = (p > 0 ? song[p - 1] : song.back()).get();
+                if (std::find(predecessors.begin(), predecessors.end(), previous) == predecessors.end()) {
+                    predecessors.push_back(previous);
+                }
+            }
+        }
+        int channel = 0;
+        const bool routed = voiceChannel(snapshot, *sequence, trackIndex, channel);
+        snapshot.contexts.clear();
+        for (const AdikSequence* previous : predecessors) {
+            Context context;
+            context.predecessor = previous;
+            if (previous == sequence.get()) {
+                context.seed = snapshot.sequence;
+            } else if (previous && routed && previous->lengthInSteps > 0) {
+                // Fin des sons rendue seulement si la précédente est figée de la même façon, sur le même canal :
+                // sinon sa voix (ou ses événements) continue pendant cette boucle
+                const bool frozenAlike = std::any_of(frozenTargets.begin(), frozenTargets.end(), [&](const Target& target) {
+                    return target.sequence.get() == previous && target.trackIndex == trackIndex;
+                });
+                int previousChannel = 0;
+                if (frozenAlike && voiceChannel(snapshot, *previous, trackIndex, previousChannel) && previousChannel == channel) {
+                    context.seed = std::make_shared<AdikSequence>(*previous);
+                }
+            }
+            snapshot.contexts.push_back(context);
+        }
+        return snapshot.kit != nullptr;
+    }
+
+    // Groupe de routage d'un canal (bus, réglage de surcharge), -1 pour un canal invalide
+    static int routeGroup(const Snapshot& snapshot, int channelIndex) {
+        if (channelIndex < 1 || channelIndex > static_cast<int>(snapshot.channelBuses.size())) return -1;
+        return snapshot.channelBuses[channelIndex - 1] * 2 + snapshot.channelEssential[channelIndex - 1];
+    }
+
+    // Canal de la voix d'un rendu de 'sequence' : celui de la première piste rendue qui a des événements.
+    // Faux si les pistes rendues ne vont pas toutes dans le même groupe de routage (voir routeGroup).
+    static bool voiceChannel(const Snapshot& snapshot, const AdikSequence& sequence, int trackIndex, int& channel) {
+        bool hasSoloedTrack = false;
+        for (const auto& track : sequence.tracks) hasSoloedTrack = hasSoloedTrack || track.isSoloed;
+        bool found = false;
+        for (size_t t = 0; t < sequence.tracks.size(); ++t) {
+            if (trackIndex != WHOLE_SEQUENCE && static_cast<int>(t) != trackIndex) continue;
+            const AdikTrack& track = sequence.tracks[t];
+            if (track.isMuted || (hasSoloedTrack && !track.isSoloed) || track.events.size() == 0) continue;
+            if (!found) {
+                channel = track.mixerChannelIndex;
+                found = true;
+            } else if (routeGroup(snapshot, track.mixerChannelIndex) != routeGroup(snapshot, channel)) {
+                return false;
+            }
+        }
+        if (!found) {
+            const size_t first = trackIndex != WHOLE_SEQUENCE ? static_cast<size_t>(trackIndex) : 0;
+            channel = first < sequence.tracks.size() ? sequence.tracks[first].mixerChannelIndex : 1;
+        }
+        return true;
+    }
+
+    // Empreinte FNV-1a 64 de tout ce dont dépend le rendu
+    static uint64_t signature(const Snapshot& snapshot) {
+        uint64_t hash = 1469598103934665603ull;
+        auto mix = [&hash](const void* data, size_t size) {
+            const unsigned char* bytes = static_cast<const unsigned char*>(data);
+            for (size_t i = 0; i < size; ++i) {
+                hash = (hash ^ bytes[i]) * 1099511628211ull;
+            }
+        };
+        // Pistes rendues d'une séquence (la séquence figée, ou une précédente dont la fin est rendue)
+        auto mixTracks = [&](const AdikSequence& sequence) {
+            mix(&sequence.lengthInSteps, sizeof(sequence.lengthInSteps));
+            bool hasSoloedTrack = false;
+            for (const auto& track : sequence.tracks) hasSoloedTrack = hasSoloedTrack || track.isSoloed;
+            for (size_t t = 0; t < sequence.tracks.size(); ++t) {
+                if (snapshot.trackIndex != WHOLE_SEQUENCE && static_cast<int>(t) != snapshot.trackIndex) continue;
+                const AdikTrack& track = sequence.tracks[t];
+                const bool audible = !track.isMuted && (!hasSoloedTrack || track.isSoloed);
+                mix(&audible, sizeof(audible));
+                mix(&track.volume, sizeof(track.volume));
+                mix(&track.mixerChannelIndex, sizeof(track.mixerChannelIndex));
+                for (size_t i = 0; i < track.events.size(); ++i) {
+                    const AdikEvent event = track.events.get(i);
+                    mix(&event.instrument, sizeof(event.instrument));
+                    mix(&event.step, sizeof(event.step));
+                    mix(&event.velocity, sizeof(event.velocity));
+                    mix(&event.pan, sizeof(event.pan));
+                    mix(&event.pitch, sizeof(event.pitch));
+                }
+            }
+        };
+        mix(&snapshot.sampleRate, sizeof(snapshot.sampleRate));
+        mix(&snapshot.samplesPerStep, sizeof(snapshot.samplesPerStep));
+        mix(&snapshot.tempoMapped, sizeof(snapshot.tempoMapped));
+        mixTracks(*snapshot.sequence);
+        // Routage des canaux du player : le rendu est refusé si les pistes vont dans des groupes différents
+        if (!snapshot.channelBuses.empty()) mix(snapshot.channelBuses.data(), snapshot.channelBuses.size() * sizeof(int));
+        if (!snapshot.channelEssential.empty()) mix(snapshot.channelEssential.data(), snapshot.channelEssential.size());
+        // Séquences précédentes (morceau modifié) et, pour celles dont la fin est rendue, leurs pistes
+        for (const Context& context : snapshot.contexts) {
+            const bool seeded = context.seed != nullptr;
+            mix(&context.predecessor, sizeof(context.predecessor));
+            mix(&seeded, sizeof(seeded));
+            if (seeded && context.predecessor != snapshot.key) mixTracks(*context.seed);
+        }
+        // Instruments du kit (tous : un changement de kit refait le rendu) et leurs réglages ; un retrait change la génération
+        const std::vector<uint8_t>& generations = snapshot.kit->generations;
+        if (!generations.empty()) mix(generations.data(), generations.size());
+        for (const auto& instrument : snapshot.kit->instruments) {
+            const AdikInstrument* pointer = instrument.get();
+            mix(&pointer, sizeof(pointer));
+            if (!instrument) continue;
+            const size_t numSamples = instrument->sound.getNumSamples();
+            const int storage = instrument->sound.getStorage();
+            mix(&numSamples, sizeof(numSamples));
+            mix(&storage, sizeof(storage));
+            mix(&instrument->sound.numChannels, sizeof(instrument->sound.numChannels));
+            mix(&instrument->defaultVolume, sizeof(instrument->defaultVolume));
+            const AdikEnvelopeParams& envelope = instrument->envelope;
+            const float envelopeValues[] = { envelope.attack, envelope.hold, envelope.decay, envelope.sustain, envelope.release, envelope.gate };
+            mix(&envelope.mode, sizeof(envelope.mode));
+            mix(envelopeValues, sizeof(envelopeValues));
+        }
+        return hash ? hash : 1; // 0 : jamais rendu
+    }
+
+    // Rend la boucle, une fois par séquence précédente, avec un mixeur privé (AdikVoiceRenderer) qui déclenche
+    // les voix exactement comme le mixeur du player ; la somme des canaux est jouée par une voix dans le groupe
+    // de routage des pistes. Aucun rendu si la séquence ne peut pas être figée.
+    static std::vector<std::shared_ptr<AdikFrozenAudio>> render(const Snapshot& snapshot, uint64_t signature) {
+        std::vector<std::shared_ptr<AdikFrozenAudio>> renders;
+        const AdikSequence& sequence = *snapshot.sequence;
+        if (snapshot.tempoMapped) {
+            std::cerr << "AdikFreezer: '" << sequence.name << "' non figée : carte de tempo active." << std::endl;
+            return renders;
+        }
+        if (snapshot.samplesPerStep < 1.0 || snapshot.sampleRate == 0) return renders;
+        int channel = 1;
+        if (!voiceChannel(snapshot, sequence, snapshot.trackIndex, channel)) {
+            std::cerr << "AdikFreezer: '" << sequence.name << "' non figée : ses pistes vont dans des bus différents"
+                      << " (ou n'ont pas le même réglage de surcharge)." << std::endl;
+            return renders;
+        }
+
+        const int trackIndex = snapshot.trackIndex;
+        AdikVoiceRenderer::TrackFilter filter;
+        if (trackIndex != WHOLE_SEQUENCE) {
+            filter = [trackIndex](size_t t, const AdikTrack&) { return static_cast<int>(t) == trackIndex; };
+        }
+        const int64_t maxTailFrames = static_cast<int64_t>(MAX_TAIL_SECONDS) * snapshot.sampleRate;
+        for (const Context& context : snapshot.contexts) {
+            std::vector<const AdikSequence*> passes;
+            if (context.seed) passes.push_back(context.seed.get());
+            passes.push_back(&sequence);
+            AdikVoiceRenderer renderer(passes, snapshot.kit, snapshot.sampleRate, snapshot.samplesPerStep, nullptr, filter);
+            const int64_t start = context.seed ? renderer.sampleForStep(context.seed->lengthInSteps) : 0;
+            const int64_t end = renderer.getTotalFrames();
+
+            std::vector<float> samples;
+            samples.reserve(static_cast<size_t>(end - start) * 2);
+            auto append = [&samples](const float* block, unsigned int frames) {
+                samples.insert(samples.end(), block, block + static_cast<size_t>(frames) * 2);
+            };
+            renderer.render(start, [](const float*, unsigned int) {}); // Séquence précédente : seule la fin de ses sons est gardée
+            renderer.render(end - start, append);
+            for (int64_t tail = 0; tail < maxTailFrames && renderer.hasActiveVoices(); tail += AdikVoiceRenderer::BLOCK_FRAMES) {
+                renderer.render(AdikVoiceRenderer::BLOCK_FRAMES, append);
+            }
+
+            auto frozen = std::make_shared<AdikFrozenAudio>();
+            frozen->sequence = snapshot.key;
+            frozen->trackIndex = trackIndex;
+            frozen->predecessor = context.predecessor;
+            frozen->mixerChannelIndex = channel;
+            frozen->samplesPerStep = snapshot.samplesPerStep;
+            frozen->signature = signature;
+            frozen->voice = std::make_shared<AdikInstrument>("gel:" + sequence.name, "Gel " + sequence.name,
+                                                             AdikSound(std::move(samples), 2, snapshot.sampleRate));
+            frozen->voice->frozen = true;
+            renders.push_back(frozen);
+        }
+        return renders;
+    }
+};
+
+#endif // ADIKFREEZER_H
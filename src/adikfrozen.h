@@ -0,0 +1,45 @@
+#ifndef ADIKFROZEN_H
+#define ADIKFROZEN_H
+
+#include <memory>
+#include <cstddef>
+#include <cstdint>
+#include <cmath> // Pour std::ceil
+
+#include "adikinstrument.h"
+#include "adiksequence.h"
+
+// --- AdikFrozenAudio ---
+// Rendu figé d'une piste, ou d'une séquence entière : une boucle de la séquence rendue hors temps réel
+// (AdikFreezer) en stéréo, jouée par une seule voix à la place des événements qu'elle remplace.
+// Une boucle est rendue par séquence qui peut la précéder (elle-même en boucle, ses prédécesseurs dans le
+// morceau, aucune au départ) : la fin des sons de la séquence précédente n'est entendue qu'après elle.
+// Publié (AdikPlayer::publishFrozen), il n'est plus jamais modifié : le thread audio le lit sans verrou.
+struct AdikFrozenAudio {
+    static const int WHOLE_SEQUENCE = -1;
+
+    const AdikSequence* sequence = nullptr; // Séquence figée (identité seulement)
+    int trackIndex = WHOLE_SEQUENCE;         // Piste figée, ou WHOLE_SEQUENCE
+    const AdikSequence* predecessor = nullptr; // Séquence jouée juste avant ce rendu (identité), nullptr : départ
+    int mixerChannelIndex = 1;               // Canal de la voix : celui de la première piste rendue qui a des événements
+    double samplesPerStep = 0.0;             // Durée d'un pas au moment du rendu
+    uint64_t signature = 0;                  // Empreinte de tout ce dont dépend le rendu (AdikFreezer::signature)
+    std::shared_ptr<AdikInstrument> voice;   // Son stéréo de la boucle, volume 1, enveloppe neutre
+
+    // Pistes remplacées par ce rendu, un bit par index de piste (toutes pour une séquence entière)
+    uint64_t trackMask() const {
+        return trackIndex == WHOLE_SEQUENCE ? ~0ull : (1ull << trackIndex);
+    }
+
+    static bool coversTrack(uint64_t mask, size_t trackIndex) {
+        return trackIndex < 64 ? ((mask >> trackIndex) & 1u) != 0 : mask == ~0ull;
+    }
+
+    // Position (en samples) de la boucle au début du pas 'step', pour une reprise en cours de boucle
+    size_t positionForStep(int step) const {
+        const size_t frame = static_cast<size_t>(std::ceil(step * samplesPerStep));
+        return frame * (voice ? voice->getNumChannels() : 2);
+    }
+};
+
+#endif // ADIKFROZEN_H
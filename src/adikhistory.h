@@ -0,0 +1,498 @@
+#ifndef ADIKHISTORY_H
+#define ADIKHISTORY_H
+
+#include <memory>
+#include <vector>
+#include <deque>
+#include <map>
+#include <set>
+#include <string>
+#include <algorithm>
+#include <cstring>   // Pour std::memcmp
+#include <climits>   // Pour INT_MAX
+#include <iostream>
+
+#include "adikplayer.h"
+#include "adikfreezer.h"
+
+// --- AdikHistory ---
+// Historique annuler/rétablir des séquences du Player et du morceau courant, à partage de structure :
+// une révision est un arbre immuable (séquences -> pistes -> tranches de CHUNK_STEPS pas d'événements),
+// et une révision ne recopie que les nœuds modifiés depuis la précédente ; les autres sont partagés
+// (shared_ptr). Valider une édition coûte donc la taille des tranches touchées, pas celle du morceau.
+// Les éditions restent faites directement sur les séquences du Player ; l'appelant signale ce qu'il a
+// modifié (markTrack, markSequence, markSong, markFrozen) puis valide (commit). Les gels d'AdikFreezer
+// (pistes et séquences figées) font partie de la révision quand un freezer est attaché.
+// Une modification faite par les méthodes du Player (AdikPlayer::sequenceEdits) échappe aux signalements :
+// à la première qui n'est pas encore dans l'historique, celui-ci est oublié et repart de l'état actuel.
+// undo, redo et publish réécrivent dans les séquences du Player les seuls nœuds qui diffèrent entre la
+// révision courante et la révision visée, puis replanifient la lecture (comme une édition ordinaire).
+// Au-delà de 'memoryCap' octets, les plus anciennes révisions sont oubliées.
+// Toutes les méthodes, constructeur compris, sont à appeler sous AdikPlayer::sequenceEditMutex.
+class AdikHistory {
+public:
+    static const int CHUNK_STEPS = 64;
+    static const size_t DEFAULT_MEMORY_CAP = 64u << 20; // 64 Mio
+
+    // L'état actuel des séquences, du morceau et des gels de 'f' (s'il n'est pas nul) devient la première révision
+    explicit AdikHistory(std::shared_ptr<AdikPlayer> p, AdikFreezer* f = nullptr, size_t cap = DEFAULT_MEMORY_CAP)
+        : player(p), freezer(f), memoryCap(cap), memoryBytes(0), current(0), totalRevisions(0), knownEdits(0) {
+        if (!player) {
+            std::cerr << "AdikHistory créé avec un AdikPlayer nul !" << std::endl;
+            return;
+        }
+        reset("initial");
+    }
+
+    // Oublie tout l'historique et prend l'état actuel comme révision de départ (après un chargement de projet)
+    void reset(const std::string& label) {
+        revisions.clear();
+        memoryBytes = 0;
+        clearMarks();
+        if (!player) return;
+        Revision revision;
+        revision.label = label;
+        revision.id = totalRevisions++;
+        for (size_t s = 0; s < player->sequenceList.size(); ++s) {
+            revision.sequences.push_back(captureSequence(nullptr, static_cast<int>(s), nullptr));
+        }
+        revision.song = captureSong();
+        if (revision.song) memoryBytes += bytesOf(*revision.song);
+        revision.frozen = captureFrozen();
+        if (revision.frozen) memoryBytes += bytesOf(*revision.frozen);
+        revisions.push_back(revision);
+        current = 0;
+        knownEdits = player->sequenceEdits;
+    }
+
+    // --- Signalement des modifications (avant commit) ---
+
+    // Événements de [firstStep, lastStep) de la piste, et ses réglages (nom, volume, mute, solo, canal)
+    void markTrack(int sequenceIndex, int trackIndex, int firstStep = 0, int lastStep = INT_MAX) {
+        if (firstStep >= lastStep) return;
+        std::pair<int, int>& range = markedTracks.emplace(std::make_pair(sequenceIndex, trackIndex),
+                                                          std::make_pair(firstStep, lastStep)).first->second;
+        range.first = std::min(range.first, firstStep);
+        range.second = std::max(range.second, lastStep);
+    }
+
+    // Toute la séquence : longueur, carte de tempo, pistes ajoutées ou supprimées, tous les événements
+    void markSequence(int sequenceIndex) { markedSequences.insert(sequenceIndex); }
+
+    // Le morceau : nom, enchaînement des séquences, carte de tempo
+    void markSong() { songMarked = true; }
+
+    // Les gels du freezer attaché (freeze, unfreeze)
+    void markFrozen() { frozenMarked = true; }
+
+    bool hasPendingChanges() const { return songMarked || frozenMarked || !markedSequences.empty() || !markedTracks.empty(); }
+
+    // Crée une révision avec les modifications signalées. Les révisions annulées (rétablir) sont abandonnées.
+    // Faux s'il n'y avait rien de signalé ou si rien n'a changé.
+    bool commit(const std::string& label) {
+        if (!player || revisions.empty() || !hasPendingChanges()) return false;
+        if (resetOnUnknownEdits()) return false; // Les modifications signalées sont dans la nouvelle révision de départ
+        const Revision& base = revisions[current];
+        Revision revision = base;
+        revision.label = label;
+        bool changed = false;
+
+        std::set<int> touched(markedSequences.begin(), markedSequences.end());
+        for (const auto& entry : markedTracks) touched.insert(entry.first.first);
+        for (int s : touched) {
+            if (s < 0 || s >= static_cast<int>(player->sequenceList.size())) continue;
+            if (revision.sequences.size() <= static_cast<size_t>(s)) revision.sequences.resize(s + 1);
+            const std::shared_ptr<const SequenceState>& before = revision.sequences[s];
+            std::shared_ptr<const SequenceState> after;
+            after = captureSequence(before, s, markedSequences.count(s) ? nullptr : &markedTracks);
+            if (after != before) {
+                revision.sequences[s] = after;
+                changed = true;
+            }
+        }
+        if (songMarked) {
+            std::shared_ptr<const SongState> song = captureSong();
+            if (!sameSong(song, revision.song)) {
+                if (song) memoryBytes += bytesOf(*song);
+                revision.song = song;
+                changed = true;
+            }
+        }
+        if (frozenMarked) {
+            std::shared_ptr<const FrozenState> frozen = captureFrozen();
+            if (!sameFrozen(frozen, revision.frozen)) {
+                if (frozen) memoryBytes += bytesOf(*frozen);
+                revision.frozen = frozen;
+                changed = true;
+            }
+        }
+        clearMarks();
+        if (!changed) return false; // Contenu identique : aucun nœud nouveau
+
+        // Abandonner les révisions annulées, puis ajouter la nouvelle
+        while (revisions.size() > current + 1) {
+            forget(revisions.back());
+            revisions.pop_back();
+        }
+        revision.id = totalRevisions++;
+        revisions.push_back(revision);
+        current = revisions.size() - 1;
+        enforceMemoryCap();
+        return true;
+    }
+
+    // --- Navigation ---
+
+    bool canUndo() const { return current > 0; }
+    bool canRedo() const { return current + 1 < revisions.size(); }
+
+    // Les modifications signalées et pas encore validées le sont d'abord
+    bool undo() {
+        resetOnUnknownEdits();
+        commit("modifications");
+        return canUndo() && publish(current - 1);
+    }
+
+    bool redo() {
+        resetOnUnknownEdits();
+        commit("modifications");
+        return canRedo() && publish(current + 1);
+    }
+
+    // Rend la révision d'index 'index' (0 : la plus ancienne conservée) courante : elle est réécrite dans
+    // les séquences du Player et le morceau, et la lecture replanifiée
+    bool publish(size_t index) {
+        if (!player || resetOnUnknownEdits() || index >= revisions.size()) return false;
+        if (index == current) return true;
+        restore(revisions[index], revisions[current]);
+        current = index;
+        return true;
+    }
+
+    size_t getRevisionCount() const { return revisions.size(); }
+    size_t getCurrentRevision() const { return current; }
+    size_t getMemoryBytes() const { return memoryBytes; }
+    size_t getMemoryCap() const { return memoryCap; }
+    const std::string& getLabel(size_t index) const { return revisions.at(index).label; }
+
+    void setMemoryCap(size_t cap) {
+        memoryCap = cap;
+        enforceMemoryCap();
+    }
+
+    void display() const {
+        std::cout << "Historique : " << revisions.size() << " révision(s), " << memoryBytes / 1024 << " Kio (limite "
+                  << memoryCap / 1024 << " Kio)" << std::endl;
+        for (size_t i = 0; i < revisions.size(); ++i) {
+            std::cout << (i == current ? "  > " : "    ") << revisions[i].id << " " << revisions[i].label << std::endl;
+        }
+    }
+
+private:
+    // Événements de [k * CHUNK_STEPS, (k + 1) * CHUNK_STEPS) d'une piste, pas relatifs au début de la tranche
+    struct Chunk {
+        AdikEventList events;
+    };
+
+    struct TrackState {
+        std::string name;
+        float volume;
+        bool isMuted;
+        bool isSoloed;
+        int mixerChannelIndex;
+        std::vector<std::shared_ptr<const Chunk>> chunks; // nullptr : tranche vide
+    };
+
+    struct SequenceState {
+        std::string name;
+        int numberOfMeasures;
+        int stepsPerMeasure;
+        int lengthInSteps;
+        std::vector<AdikTempoMap::TempoPoint> tempoPoints;
+        std::vector<std::shared_ptr<const TrackState>> tracks;
+    };
+
+    struct SongState {
+        std::string name;
+        std::vector<std::shared_ptr<AdikSequence>> sequences; // Identité des séquences (leur contenu est versionné par index)
+        std::vector<AdikTempoMap::TempoPoint> tempoPoints;
+    };
+
+    struct FrozenState {
+        std::vector<AdikFreezer::FrozenTrack> tracks;
+    };
+
+    struct Revision {
+        std::string label;
+        uint64_t id = 0;
+        std::vector<std::shared_ptr<const SequenceState>> sequences; // Par index dans AdikPlayer::sequenceList
+        std::shared_ptr<const SongState> song;
+        std::shared_ptr<const FrozenState> frozen; // nullptr : aucun freezer attaché
+    };
+
+    typedef std::map<std::pair<int, int>, std::pair<int, int>> TrackMarks; // (séquence, piste) -> [premier, dernier pas)
+
+    std::shared_ptr<AdikPlayer> player;
+    AdikFreezer* freezer;         // Gels versionnés, ou nullptr
+    size_t memoryCap;
+    size_t memoryBytes;           // Octets de tous les nœuds conservés, chacun compté une fois
+    std::deque<Revision> revisions;
+    size_t current;
+    uint64_t totalRevisions;      // Numérotation des révisions, continue après oubli des plus anciennes
+    uint64_t knownEdits;          // AdikPlayer::sequenceEdits contenues dans l'historique
+    TrackMarks markedTracks;
+    std::set<int> markedSequences;
+    bool songMarked = false;
+    bool frozenMarked = false;
+
+    static const size_t NODE_OVERHEAD = 16; // Bloc de contrôle d'un make_shared
+
+    void clearMarks() {
+        markedTracks.clear();
+        markedSequences.clear();
+        songMarked = false;
+        frozenMarked = false;
+    }
+
+    // Une méthode du Player a modifié les séquences ou le morceau : les révisions ne décrivent plus l'état du
+    // Player, l'historique repart de l'état actuel. Vrai s'il a été oublié.
+    bool resetOnUnknownEdits() {
+        if (!player || player->sequenceEdits == knownEdits) return false;
+        std::cerr << "AdikHistory: Séquences modifiées hors de l'historique, les révisions précédentes sont oubliées." << std::endl;
+        reset("modifications du Player");
+        return true;
+    }
+
+    static size_t bytesOf(const Chunk& chunk) { return sizeof(Chunk) + NODE_OVERHEAD + chunk.events.memoryBytes(); }
+    static size_t bytesOf(const TrackState& track) {
+        return sizeof(TrackState) + NODE_OVERHEAD + track.name.capacity() + track.chunks.capacity() * sizeof(track.chunks[0]);
+    }
+    static size_t bytesOf(const SequenceState& sequence) {
+        return sizeof(SequenceState) + NODE_OVERHEAD + sequence.name.capacity()
+             + sequence.tempoPoints.capacity() * sizeof(AdikTempoMap::TempoPoint)
+             + sequence.tracks.capacity() * sizeof(sequence.tracks[0]);
+    }
+    static size_t bytesOf(const SongState& song) {
+        return sizeof(SongState) + NODE_OVERHEAD + song.name.capacity() + song.sequences.capacity() * sizeof(song.sequences[0])
+             + song.tempoPoints.capacity() * sizeof(AdikTempoMap::TempoPoint);
+    }
+    static size_t bytesOf(const FrozenState& frozen) {
+        return sizeof(FrozenState) + NODE_OVERHEAD + frozen.tracks.capacity() * sizeof(frozen.tracks[0]);
+    }
+
+    static int chunkCount(const AdikSequence& sequence, const AdikTrack& track) {
+        int extent = sequence.lengthInSteps;
+        if (!track.events.empty()) extent = std::max(extent, track.events.steps.back() + 1);
+        return (std::max(extent, 0) + CHUNK_STEPS - 1) / CHUNK_STEPS;
+    }
+
+    static bool sameEvents(const AdikEventList& a, const AdikEventList& b) {
+        const size_t n = a.size();
+        return n == b.size()
+            && std::memcmp(a.steps.data(), b.steps.data(), n * sizeof(a.steps[0])) == 0
+            && std::memcmp(a.instruments.data(), b.instruments.data(), n * sizeof(a.instruments[0])) == 0
+            && std::memcmp(a.velocities.data(), b.velocities.data(), n * sizeof(a.velocities[0])) == 0
+            && std::memcmp(a.pans.data(), b.pans.data(), n * sizeof(a.pans[0])) == 0
+            && std::memcmp(a.pitches.data(), b.pitches.data(), n * sizeof(a.pitches[0])) == 0;
+    }
+
+    static bool samePoints(const std::vector<AdikTempoMap::TempoPoint>& a, const std::vector<AdikTempoMap::TempoPoint>& b) {
+        if (a.size() != b.size()) return false;
+        for (size_t i = 0; i < a.size(); ++i) {
+            if (a[i].step != b[i].step || a[i].bpm != b[i].bpm || a[i].curve != b[i].curve) return false;
+        }
+        return true;
+    }
+
+    // Tranche 'k' de la piste ; reprend 'before' si le contenu n'a pas changé
+    std::shared_ptr<const Chunk> captureChunk(const AdikTrack& track, int k, const std::shared_ptr<const Chunk>& before) {
+        std::pair<size_t, size_t> range = track.events.rangeBetweenSteps(k * CHUNK_STEPS, (k + 1) * CHUNK_STEPS);
+        if (range.first == range.second) return nullptr;
+        std::shared_ptr<Chunk> chunk = std::make_shared<Chunk>();
+        track.events.copyRange(k * CHUNK_STEPS, (k + 1) * CHUNK_STEPS, chunk->events);
+        if (before && sameEvents(before->events, chunk->events)) return before;
+        memoryBytes += bytesOf(*chunk);
+        return chunk;
+    }
+
+    // Piste ; seules les tranches de [firstStep, lastStep) sont relues (toutes si 'before' est nul)
+    std::shared_ptr<const TrackState> captureTrack(const std::shared_ptr<const TrackState>& before, const AdikSequence& sequence,
+                                                   const AdikTrack& track, int firstStep, int lastStep) {
+        std::shared_ptr<TrackState> state = std::make_shared<TrackState>();
+        state->name = track.name;
+        state->volume = track.volume;
+        state->isMuted = track.isMuted;
+        state->isSoloed = track.isSoloed;
+        state->mixerChannelIndex = track.mixerChannelIndex;
+        const int count = chunkCount(sequence, track);
+        if (before) state->chunks.assign(before->chunks.begin(), before->chunks.begin() + std::min<size_t>(before->chunks.size(), count));
+        const size_t known = state->chunks.size();
+        state->chunks.resize(count);
+        int firstChunk = before ? std::max(firstStep, 0) / CHUNK_STEPS : 0;
+        int lastChunk = before ? static_cast<int>(std::min<long long>((static_cast<long long>(lastStep) + CHUNK_STEPS - 1) / CHUNK_STEPS, count)) : count;
+        bool changed = !before || count != static_cast<int>(before->chunks.size());
+        for (int k = 0; k < count; ++k) {
+            if ((k < firstChunk || k >= lastChunk) && static_cast<size_t>(k) < known) continue;
+            const std::shared_ptr<const Chunk> previous = static_cast<size_t>(k) < known ? state->chunks[k] : nullptr;
+            state->chunks[k] = captureChunk(track, k, previous);
+            changed = changed || state->chunks[k] != previous;
+        }
+        if (!changed && before->name == state->name && before->volume == state->volume && before->isMuted == state->isMuted
+            && before->isSoloed == state->isSoloed && before->mixerChannelIndex == state->mixerChannelIndex) {
+            return before;
+        }
+        memoryBytes += bytesOf(*state);
+        return state;
+    }
+
+    // Séquence d'index 'sequenceIndex' : toutes ses pistes si 'marks' est nul, sinon les seules pistes signalées
+    std::shared_ptr<const SequenceState> captureSequence(const std::shared_ptr<const SequenceState>& before,
+                                                         int sequenceIndex, const TrackMarks* marks) {
+        const AdikSequence& sequence = *player->sequenceList[sequenceIndex];
+        std::shared_ptr<SequenceState> state = std::make_shared<SequenceState>();
+        state->name = sequence.name;
+        state->numberOfMeasures = sequence.numberOfMeasures;
+        state->stepsPerMeasure = sequence.stepsPerMeasure;
+        state->lengthInSteps = sequence.lengthInSteps;
+        state->tempoPoints = sequence.tempoMap.points;
+        bool changed = !before || before->tracks.size() != sequence.tracks.size() || before->name != state->name
+                    || before->lengthInSteps != state->lengthInSteps || before->numberOfMeasures != state->numberOfMeasures
+                    || before->stepsPerMeasure != state->stepsPerMeasure || !samePoints(before->tempoPoints, state->tempoPoints);
+        state->tracks.resize(sequence.tracks.size());
+        for (size_t t = 0; t < sequence.tracks.size(); ++t) {
+            const std::shared_ptr<const TrackState> previous = before && t < before->tracks.size() ? before->tracks[t] : nullptr;
+            int firstStep = 0, lastStep = INT_MAX;
+            if (marks && previous) {
+                auto mark = marks->find(std::make_pair(sequenceIndex, static_cast<int>(t)));
+                if (mark == marks->end()) {
+                    state->tracks[t] = previous;
+                    continue;
+                }
+                firstStep = mark->second.first;
+                lastStep = mark->second.second;
+            }
+            state->tracks[t] = captureTrack(previous, sequence, sequence.tracks[t], firstStep, lastStep);
+            changed = changed || state->tracks[t] != previous;
+        }
+        if (!changed) return before;
+        memoryBytes += bytesOf(*state);
+        return state;
+    }
+
+    std::shared_ptr<const SongState> captureSong() {
+        if (!player->currentSong) return nullptr;
+        std::shared_ptr<SongState> state = std::make_shared<SongState>();
+        state->name = player->currentSong->name;
+        state->sequences = player->currentSong->sequences;
+        state->tempoPoints = player->currentSong->tempoMap.points;
+        return state;
+    }
+
+    std::shared_ptr<const FrozenState> captureFrozen() {
+        if (!freezer) return nullptr;
+        std::shared_ptr<FrozenState> state = std::make_shared<FrozenState>();
+        state->tracks = freezer->getFrozenTracks();
+        return state;
+    }
+
+    static bool sameFrozen(const std::shared_ptr<const FrozenState>& a, const std::shared_ptr<const FrozenState>& b) {
+        if (!a || !b) return a == b;
+        return a->tracks == b->tracks;
+    }
+
+    static bool sameSong(const std::shared_ptr<const SongState>& a, const std::shared_ptr<const SongState>& b) {
+        if (!a || !b) return a == b;
+        return a->name == b->name && a->sequences == b->sequences && samePoints(a->tempoPoints, b->tempoPoints);
+    }
+
+    // Retire du compte les nœuds que seule 'revision' référence (ils seront libérés avec elle)
+    void forget(const Revision& revision) {
+        for (const auto& sequence : revision.sequences) {
+            if (!sequence || sequence.use_count() > 1) continue;
+            for (const auto& track : sequence->tracks) {
+                if (!track || track.use_count() > 1) continue;
+                for (const auto& chunk : track->chunks) {
+                    if (chunk && chunk.use_count() == 1) memoryBytes -= bytesOf(*chunk);
+                }
+                memoryBytes -= bytesOf(*track);
+            }
+            memoryBytes -= bytesOf(*sequence);
+        }
+        if (revision.song && revision.song.use_count() == 1) memoryBytes -= bytesOf(*revision.song);
+        if (revision.frozen && revision.frozen.use_count() == 1) memoryBytes -= bytesOf(*revision.frozen);
+    }
+
+    void enforceMemoryCap() {
+        // La révision courante est toujours conservée
+        while (memoryBytes > memoryCap && current > 0) {
+            forget(revisions.front());
+            revisions.pop_front();
+            current--;
+        }
+    }
+
+    // Réécrit dans le Player ce qui diffère entre 'from' (état actuel) et 'target'
+    void restore(const Revision& target, const Revision& from) {
+        bool structureChanged = false;
+        for (size_t s = 0; s < target.sequences.size() && s < player->sequenceList.size(); ++s) {
+            const std::shared_ptr<const SequenceState>& wanted = target.sequences[s];
+            const std::shared_ptr<const SequenceState> actual = s < from.sequences.size() ? from.sequences[s] : nullptr;
+            if (!wanted || wanted == actual) continue;
+            AdikSequence& sequence = *player->sequenceList[s];
+            structureChanged = structureChanged || sequence.lengthInSteps != wanted->lengthInSteps
+                            || !samePoints(sequence.tempoMap.points, wanted->tempoPoints);
+            sequence.name = wanted->name;
+            sequence.numberOfMeasures = wanted->numberOfMeasures;
+            sequence.stepsPerMeasure = wanted->stepsPerMeasure;
+            sequence.lengthInSteps = wanted->lengthInSteps;
+            sequence.tempoMap.points = wanted->tempoPoints;
+            while (sequence.tracks.size() > wanted->tracks.size()) sequence.tracks.pop_back();
+            while (sequence.tracks.size() < wanted->tracks.size()) sequence.tracks.emplace_back("", 1);
+            for (size_t t = 0; t < wanted->tracks.size(); ++t) {
+                const std::shared_ptr<const TrackState> previous = actual && t < actual->tracks.size() ? actual->tracks[t] : nullptr;
+                if (wanted->tracks[t] != previous) restoreTrack(*wanted->tracks[t], previous.get(), sequence.tracks[t]);
+            }
+        }
+        if (target.song && target.song != from.song && player->currentSong) {
+            AdikSong& song = *player->currentSong;
+            song.name = target.song->name;
+            song.sequences = target.song->sequences;
+            song.tempoMap.points = target.song->tempoPoints;
+            structureChanged = true;
+        }
+        if (structureChanged) {
+            if (player->currentSong) player->currentSong->rebuildTimeline();
+            player->refreshTempoMap();
+        }
+        // Après les séquences : un gel rétabli est rendu depuis leur contenu rétabli
+        if (freezer && target.frozen && target.frozen != from.frozen) freezer->setFrozenTracksLocked(target.frozen->tracks);
+        player->invalidateSchedule(); // Replanifier les pas déjà résolus
+    }
+
+    static void restoreTrack(const TrackState& wanted, const TrackState* actual, AdikTrack& track) {
+        track.name = wanted.name;
+        track.volume = wanted.volume;
+        track.isMuted = wanted.isMuted;
+        track.isSoloed = wanted.isSoloed;
+        track.mixerChannelIndex = wanted.mixerChannelIndex;
+        if (!actual) {
+            track.events.clear();
+            for (size_t k = 0; k < wanted.chunks.size(); ++k) {
+                if (wanted.chunks[k]) track.events.paste(wanted.chunks[k]->events, static_cast<int>(k) * CHUNK_STEPS);
+            }
+            return;
+        }
+        // Tranches différentes seulement (les événements au-delà des tranches connues ne bougent pas)
+        const size_t count = std::max(wanted.chunks.size(), actual->chunks.size());
+        for (size_t k = 0; k < count; ++k) {
+            const Chunk* want = k < wanted.chunks.size() ? wanted.chunks[k].get() : nullptr;
+            const Chunk* have = k < actual->chunks.size() ? actual->chunks[k].get() : nullptr;
+            if (want == have) continue;
+            const int first = static_cast<int>(k) * CHUNK_STEPS;
+            track.events.removeRange(first, first + CHUNK_STEPS);
+            if (want) track.events.paste(want->events, first);
+        }
+    }
+};
+
+#endif // ADIKHISTORY_H
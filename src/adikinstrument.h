@@ -9,6 +9,8 @@
 // Important : AdikSound.h DOIT être inclus avant AdikInstrument.h
 // car AdikInstrument contient un membre 'AdikSound sound;'.
 #include "adiksound.h" // Assurez-vous que AdikSound.h contient la définition complète de AdikSound
+#include "adikenvelope.h"
+#include "adiksampleanalyzer.h"
 
 class AdikInstrument {
 public:
@@ -30,6 +32,9 @@ public:
     float defaultVolume;
     float defaultPan;
     float defaultPitch; // Changement de hauteur (pitch shift)
+    AdikEnvelopeParams envelope; // Enveloppe d'amplitude appliquée à chaque voix (par défaut : neutre)
+    AdikSampleAnalysis analysis; // Remplie au chargement (AdikSampleAnalyzer) : longueur utile, crête, cache de crêtes
+    bool frozen = false;         // Rendu figé d'une piste ou d'une séquence (AdikFreezer) : voix jamais libérée sur silence
 
 
     AdikSound sound; // L'objet AdikSound qui contient les données audio
@@ -44,6 +49,13 @@ public:
         std::cout << "Instrument '" << name << "' (" << id << ") créé, canaux: " << numChannels << std::endl;
     }
 
+    // Instrument d'un son déjà rendu (voir AdikSound(samples, ...)) : aucun son généré, rien écrit dans le cache
+    AdikInstrument(const std::string& id_val, const std::string& name_val, AdikSound&& rendered)
+        : id(id_val), name(name_val),
+          defaultVolume(1.0f), defaultPan(0.0f), defaultPitch(0.0f),
+          sound(std::move(rendered)) {
+    }
+
     // Nouvelle méthode pour obtenir le nombre de canaux de l'instrument
     unsigned int getNumChannels() const {
         return sound.numChannels;
@@ -52,10 +64,11 @@ public:
     // <--- MODIFIÉ : Signature de render.
     // Le buffer passé ici est un buffer temporaire pour l'instrument,
     // sa taille sera `numSamples * instrument->getNumChannels()`.
-    void render(std::vector<float>& buffer, unsigned int numSamples, float finalVelocity, float finalPan, float finalPitch) {
+    // 'position' est la position de lecture de la voix (AdikChannel), avancée de numSamples frames.
+    void render(std::vector<float>& buffer, unsigned int numSamples, size_t& position, float finalVelocity, float finalPan, float finalPitch) const {
         // Remarque: La logique de pan/pitch/velocity sera appliquée par le mixer ou la couche supérieure.
         // Ici, AdikSound::readData lit les samples bruts.
-        sound.readData(buffer, numSamples); // Lire les samples directement
+        sound.readData(position, buffer, numSamples); // Lire les samples directement
 
         // Appliquer la vélocité (volume) et le pitch (simplifié) ici, avant le pan au niveau du mixeur.
         for (unsigned int i = 0; i < numSamples * sound.numChannels; ++i) {
@@ -65,11 +78,6 @@ public:
         }
     }
 
-    // Réinitialise la position de lecture du son de l'instrument
-    void resetPlayback() {
-        sound.resetPlayback();
-    }
-
     void genTone(WaveType soundType = SINE_WAVE, float freq = 440.0f, unsigned int numFrames = 44100, float amplitude = 1.0f) {
         // Le paramètre 'amplitude' est maintenant aussi dans genTone pour passer à squareWave, sineWave, whiteNoiseWave
         // Pour COMBINED_SINE_NOISE_WAVE, nous utiliserons des ratios internes ou ajouterons d'autres paramètres si nécessaire.
@@ -0,0 +1,158 @@
+#ifndef ADIKINSTRUMENTREGISTRY_H
+#define ADIKINSTRUMENTREGISTRY_H
+
+#include <string>
+#include <vector>
+#include <memory>
+#include <unordered_map>
+#include <algorithm> // Pour std::copy, std::min
+#include <cstdint>
+#include <cstddef>
+#include <iostream>
+
+#include "adikevent.h"      // Pour AdikInstrumentHandle
+#include "adikinstrument.h"
+
+// --- AdikInstrumentRegistry ---
+// Registre des instruments du Player : chaque id est interné une fois dans un emplacement (slot) dense,
+// désigné par un handle 32 bits = index de l'emplacement (24 bits faibles) | génération (8 bits forts).
+// Lecture par handle en O(1), recherche par id par table de hachage.
+// Un handle reste valide tant que son instrument n'est pas retiré : remplacer un instrument garde le handle,
+// retirer un instrument incrémente la génération de son emplacement, et les anciens handles (événements
+// des séquences, commandes en file) ne désignent plus rien, même si l'emplacement est réutilisé.
+// Tant qu'aucun instrument n'a été retiré, le handle est l'index dans la liste : les handles déjà écrits
+// (projets, numéros de pads) restent valides.
+// Le thread audio ne lit pas le registre : il lit le kit publié (AdikKit::fromRegistry), qui en copie
+// les emplacements et les générations. Non synchronisé : AdikPlayer ne l'utilise que sous registryMutex.
+class AdikInstrumentRegistry {
+public:
+    static const uint32_t INDEX_BITS = 24;
+    static const uint32_t INDEX_MASK = (1u << INDEX_BITS) - 1;
+    // L'index INDEX_MASK est exclu : avec la génération 255, ce serait INVALID_INSTRUMENT_HANDLE
+    static const uint32_t MAX_SLOTS = INDEX_MASK;
+
+    static uint32_t indexOf(AdikInstrumentHandle handle) { return handle & INDEX_MASK; }
+    static uint8_t generationOf(AdikInstrumentHandle handle) { return static_cast<uint8_t>(handle >> INDEX_BITS); }
+    static AdikInstrumentHandle makeHandle(uint32_t index, uint8_t generation) {
+        return (static_cast<uint32_t>(generation) << INDEX_BITS) | (index & INDEX_MASK);
+    }
+
+    // Interne l'instrument : un id déjà présent est remplacé (même handle), sinon un emplacement libre
+    // est réutilisé (nouvelle génération) ou ajouté. INVALID_INSTRUMENT_HANDLE si nul ou registre plein.
+    AdikInstrumentHandle add(std::shared_ptr<AdikInstrument> instrument) {
+        if (!instrument) return INVALID_INSTRUMENT_HANDLE;
+        auto found = indexById.find(instrument->id);
+        if (found != indexById.end()) {
+            slots[found->second] = instrument;
+            return makeHandle(found->second, generations[found->second]);
+        }
+        uint32_t index;
+        if (!freeSlots.empty()) {
+            index = freeSlots.back();
+            freeSlots.pop_back();
+        } else {
+            if (slots.size() >= MAX_SLOTS) {
+                std::cerr << "AdikInstrumentRegistry: Registre plein, '" << instrument->id << "' non ajouté." << std::endl;
+                return INVALID_INSTRUMENT_HANDLE;
+            }
+            index = static_cast<uint32_t>(slots.size());
+            slots.emplace_back();
+            generations.push_back(0);
+        }
+        slots[index] = instrument;
+        indexById.emplace(instrument->id, index);
+        return makeHandle(index, generations[index]);
+    }
+
+    // Met 'instrument' à la place de celui du handle (le handle reste valide, l'id peut changer)
+    bool replace(AdikInstrumentHandle handle, std::shared_ptr<AdikInstrument> instrument) {
+        if (!instrument || !isValid(handle)) return false;
+        const uint32_t index = indexOf(handle);
+        if (slots[index]->id != instrument->id) {
+            auto other = indexById.find(instrument->id);
+            if (other != indexById.end() && other->second != index) return false; // Id déjà pris par un autre handle
+            unindex(index);
+            indexById.emplace(instrument->id, index);
+        }
+        slots[index] = instrument;
+        return true;
+    }
+
+    // Retire l'instrument : ses handles deviennent périmés, l'emplacement sera réutilisé
+    bool remove(AdikInstrumentHandle handle) {
+        if (!isValid(handle)) return false;
+        const uint32_t index = indexOf(handle);
+        unindex(index);
+        slots[index].reset();
+        generations[index]++;
+        freeSlots.push_back(index);
+        return true;
+    }
+
+    // Handle de l'id, ou INVALID_INSTRUMENT_HANDLE (sans message : à l'appelant de décider)
+    AdikInstrumentHandle find(const std::string& id) const {
+        auto found = indexById.find(id);
+        return found == indexById.end() ? INVALID_INSTRUMENT_HANDLE : makeHandle(found->second, generations[found->second]);
+    }
+
+    bool isValid(AdikInstrumentHandle handle) const {
+        const uint32_t index = indexOf(handle);
+        return index < slots.size() && slots[index] && generations[index] == generationOf(handle);
+    }
+
+    // Instrument du handle, ou nullptr si le handle est invalide ou périmé
+    std::shared_ptr<AdikInstrument> get(AdikInstrumentHandle handle) const {
+        return isValid(handle) ? slots[indexOf(handle)] : nullptr;
+    }
+
+    // Handle actuel de l'emplacement 'index' (numéro de pad), ou INVALID_INSTRUMENT_HANDLE s'il est vide
+    AdikInstrumentHandle handleAt(size_t index) const {
+        return index < slots.size() && slots[index] ? makeHandle(static_cast<uint32_t>(index), generations[index])
+                                                    : INVALID_INSTRUMENT_HANDLE;
+    }
+
+    size_t getNumSlots() const { return slots.size(); }
+    size_t count() const { return indexById.size(); } // Ids distincts
+
+    // Emplacements (nullptr pour un emplacement libre) et leurs générations, indexés par indexOf(handle)
+    const std::vector<std::shared_ptr<AdikInstrument>>& getSlots() const { return slots; }
+    const std::vector<uint8_t>& getGenerations() const { return generations; }
+
+    // Reprend les emplacements d'un kit ('generations' plus court : 0 au-delà). Pour un même id, le premier handle gagne.
+    void assign(const std::vector<std::shared_ptr<AdikInstrument>>& kitSlots, const std::vector<uint8_t>& kitGenerations) {
+        slots = kitSlots;
+        if (slots.size() > MAX_SLOTS) slots.resize(MAX_SLOTS);
+        generations.assign(slots.size(), 0);
+        std::copy(kitGenerations.begin(), kitGenerations.begin() + std::min(kitGenerations.size(), slots.size()), generations.begin());
+        freeSlots.clear();
+        indexById.clear();
+        indexById.reserve(slots.size());
+        for (size_t i = slots.size(); i-- > 0;) {
+            if (!slots[i]) freeSlots.push_back(static_cast<uint32_t>(i)); // Le plus petit index sera réutilisé d'abord
+        }
+        for (size_t i = 0; i < slots.size(); ++i) {
+            if (slots[i]) indexById.emplace(slots[i]->id, static_cast<uint32_t>(i)); // emplace ne remplace pas
+        }
+    }
+
+    void clear() {
+        slots.clear();
+        generations.clear();
+        freeSlots.clear();
+        indexById.clear();
+    }
+
+private:
+    std::vector<std::shared_ptr<AdikInstrument>> slots;
+    std::vector<uint8_t> generations;
+    std::vector<uint32_t> freeSlots;                      // Emplacements libres, le dernier libéré d'abord
+    std::unordered_map<std::string, uint32_t> indexById;  // Id -> emplacement
+
+    // Retire l'id de l'emplacement de la table (un doublon venu d'un kit n'y figure pas)
+    void unindex(uint32_t index) {
+        auto found = indexById.find(slots[index]->id);
+        if (found != indexById.end() && found->second == index) indexById.erase(found);
+    }
+};
+
+#endif // ADIKINSTRUMENTREGISTRY_H
@@ -0,0 +1,132 @@
+#ifndef ADIKKIT_H
+#define ADIKKIT_H
+
+#include <string>
+#include <vector>
+#include <memory>
+#include <cstddef>
+#include <algorithm> // Pour std::find
+#include <unordered_map>
+
+#include "adikevent.h"     // Pour AdikInstrumentHandle
+#include "adikinstrument.h"
+#include "adikinstrumentregistry.h"
+#include "adiksequence.h"
+
+// --- AdikKit ---
+// Jeu d'instruments lu par le thread audio : instruments[index du handle] est l'instrument joué par les
+// événements de ce handle, si la génération du handle est celle de l'emplacement (voir AdikInstrumentRegistry). Un kit publié (AdikPlayer::publishKit) n'est plus jamais modifié, le thread audio le lit sans verrou.
+// Changer de kit ne touche pas aux séquences : le nouveau kit est composé pour que chaque handle existant
+// désigne l'instrument qui remplace l'ancien (voir compose).
+struct AdikKit {
+    // Frontière musicale à laquelle le thread audio active le kit
+    enum Boundary {
+        IMMEDIATE = 0,     // Bloc audio suivant
+        NEXT_BEAT = 1,
+        NEXT_MEASURE = 2,
+        NEXT_SEQUENCE = 3  // Début de la séquence suivante (ou reprise de la boucle)
+    };
+
+    std::string name;
+    std::vector<std::shared_ptr<AdikInstrument>> instruments; // Indexé par AdikInstrumentRegistry::indexOf(handle)
+    std::vector<uint8_t> generations;                         // Génération de chaque emplacement (0 au-delà de la fin)
+    Boundary boundary = IMMEDIATE;
+
+    // Kit dont les handles sont directement les index de 'instruments' (ex. projet chargé)
+    static std::shared_ptr<AdikKit> fromInstruments(const std::string& name,
+                                                    const std::vector<std::shared_ptr<AdikInstrument>>& instruments,
+                                                    Boundary boundary = IMMEDIATE) {
+        auto kit = std::make_shared<AdikKit>();
+        kit->name = name;
+        kit->instruments = instruments;
+        kit->boundary = boundary;
+        return kit;
+    }
+
+    // Kit des instruments du registre, handles et générations compris
+    static std::shared_ptr<AdikKit> fromRegistry(const std::string& name, const AdikInstrumentRegistry& registry,
+                                                 Boundary boundary = IMMEDIATE) {
+        auto kit = fromInstruments(name, registry.getSlots(), boundary);
+        kit->generations = registry.getGenerations();
+        return kit;
+    }
+
+    // Kit remplaçant 'current' par 'replacements'. Chaque handle de 'current' reçoit l'instrument de même id ;
+    // si aucun id ne correspond (kit nommé autrement), les handles sont remplacés dans l'ordre.
+    // Les remplaçants restants reçoivent de nouveaux handles. Un handle sans remplaçant garde son instrument :
+    // les pistes qui l'utilisent continuent de jouer.
+    static std::shared_ptr<AdikKit> compose(const std::string& name, const AdikKit* current,
+                                            const std::vector<std::shared_ptr<AdikInstrument>>& replacements,
+                                            Boundary boundary) {
+        auto kit = std::make_shared<AdikKit>();
+        kit->name = name;
+        kit->boundary = boundary;
+        if (current) {
+            kit->instruments = current->instruments;
+            kit->generations = current->generations; // Les handles existants restent valides
+        }
+        const size_t numHandles = kit->instruments.size();
+        std::vector<bool> used(replacements.size(), false);
+        // Handles de chaque id, le plus petit en dernier : chaque remplaçant prend le premier handle libre de son id
+        std::unordered_map<std::string, std::vector<size_t>> handlesById;
+        handlesById.reserve(numHandles);
+        for (size_t h = numHandles; h-- > 0;) {
+            if (kit->instruments[h]) handlesById[kit->instruments[h]->id].push_back(h);
+        }
+        for (size_t r = 0; r < replacements.size(); ++r) {
+            auto found = handlesById.find(replacements[r]->id);
+            if (found == handlesById.end() || found->second.empty()) continue;
+            kit->instruments[found->second.back()] = replacements[r];
+            found->second.pop_back();
+            used[r] = true;
+        }
+        const bool anyMatch = std::find(used.begin(), used.end(), true) != used.end();
+        for (size_t h = 0; !anyMatch && h < numHandles && h < replacements.size(); ++h) {
+            kit->instruments[h] = replacements[h];
+            used[h] = true;
+        }
+        for (size_t r = 0; r < replacements.size(); ++r) {
+            if (!used[r]) kit->instruments.push_back(replacements[r]);
+        }
+        return kit;
+    }
+
+    // Instrument du handle, ou nullptr si le handle est invalide ou périmé (appelé par le thread audio)
+    std::shared_ptr<AdikInstrument> get(AdikInstrumentHandle handle) const {
+        const uint32_t index = AdikInstrumentRegistry::indexOf(handle);
+        if (index >= instruments.size()) return nullptr;
+        const uint8_t generation = index < generations.size() ? generations[index] : 0;
+        return AdikInstrumentRegistry::generationOf(handle) == generation ? instruments[index] : nullptr;
+    }
+
+    // Vrai si le pas 'step' de 'sequence' est sur la frontière du kit (appelé par le thread audio)
+    bool isBoundary(int step, const AdikSequence& sequence, int stepsPerBeat) const {
+        switch (boundary) {
+            case NEXT_BEAT: return stepsPerBeat <= 0 || step % stepsPerBeat == 0;
+            case NEXT_MEASURE: return sequence.stepsPerMeasure <= 0 || step % sequence.stepsPerMeasure == 0;
+            case NEXT_SEQUENCE: return step == 0;
+            default: return true;
+        }
+    }
+
+    static const char* boundaryName(Boundary boundary) {
+        switch (boundary) {
+            case NEXT_BEAT: return "beat";
+            case NEXT_MEASURE: return "measure";
+            case NEXT_SEQUENCE: return "sequence";
+            default: return "now";
+        }
+    }
+
+    // "now", "beat", "measure", "sequence" ; faux si inconnu
+    static bool parseBoundary(const std::string& text, Boundary& boundary) {
+        if (text == "now") boundary = IMMEDIATE;
+        else if (text == "beat") boundary = NEXT_BEAT;
+        else if (text == "measure") boundary = NEXT_MEASURE;
+        else if (text == "sequence") boundary = NEXT_SEQUENCE;
+        else return false;
+        return true;
+    }
+};
+
+#endif // ADIKKIT_H
@@ -0,0 +1,109 @@
+#ifndef ADIKKITLOADER_H
+#define ADIKKITLOADER_H
+
+#include "adikplayer.h"
+#include "adikproject.h"
+#include "adikkit.h"
+
+#include <memory>
+#include <string>
+#include <vector>
+#include <thread>
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <iostream>
+
+// --- AdikKitLoader ---
+// Changement de kit sans interruption : le nouveau jeu d'instruments est créé et analysé (AdikSampleAnalyzer,
+// stockage des samples compris) sur un thread d'arrière-plan, composé avec le kit courant (AdikKit::compose)
+// puis publié. Le thread audio bascule à la frontière demandée par une simple écriture de pointeur.
+// Les voix en cours gardent leur instrument et finissent sur les anciennes données ; l'ancien kit est
+// ensuite libéré par ce thread, jamais par le thread audio. Une seule préparation à la fois.
+class AdikKitLoader {
+public:
+    // Remplit la liste des nouveaux instruments ; faux en cas d'échec (le kit courant est conservé)
+    typedef std::function<bool(std::vector<std::shared_ptr<AdikInstrument>>&)> Builder;
+
+    explicit AdikKitLoader(std::shared_ptr<AdikPlayer> p)
+        : player(p), preparing(false), cancelled(false), succeeded(false) {
+        if (!player) {
+            std::cerr << "AdikKitLoader créé avec un AdikPlayer nul !" << std::endl;
+        }
+    }
+
+    ~AdikKitLoader() {
+        cancelled.store(true);
+        if (worker.joinable()) worker.join();
+    }
+
+    // Lance la préparation d'un kit. Faux si une préparation est déjà en cours.
+    bool load(const std::string& name, Builder build, AdikKit::Boundary boundary) {
+        if (!player || preparing.load()) return false;
+        // Le thread précédent peut encore attendre la libération de l'ancien kit : il s'arrête ici
+        cancelled.store(true);
+        if (worker.joinable()) worker.join();
+        cancelled.store(false);
+        preparing.store(true);
+        worker = std::thread(&AdikKitLoader::run, this, name, build, boundary);
+        return true;
+    }
+
+    // Instruments d'un projet (.adkp), voir AdikProject::loadInstruments
+    bool loadProject(const std::string& path, AdikKit::Boundary boundary) {
+        return load(path, [path](std::vector<std::shared_ptr<AdikInstrument>>& instruments) {
+            return AdikProject::loadInstruments(path, instruments);
+        }, boundary);
+    }
+
+    bool isPreparing() const { return preparing.load(); }
+    bool lastSucceeded() const { return succeeded.load(); }
+
+    // Attend la fin de la préparation (le kit est alors publié ; la bascule a lieu à sa frontière)
+    void wait() const {
+        while (preparing.load()) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+    }
+
+private:
+    std::shared_ptr<AdikPlayer> player;
+    std::thread worker;
+    std::atomic<bool> preparing;
+    std::atomic<bool> cancelled;
+    std::atomic<bool> succeeded;
+
+    // Délai maximal d'attente de la fin des voix de l'ancien kit (au-delà, il sera libéré à la publication suivante)
+    static constexpr int COLLECT_TIMEOUT_MS = 30000;
+    static constexpr int COLLECT_INTERVAL_MS = 50;
+
+    void run(std::string name, Builder build, AdikKit::Boundary boundary) {
+        const auto start = std::chrono::steady_clock::now();
+        std::vector<std::shared_ptr<AdikInstrument>> instruments;
+        if (!build(instruments) || instruments.empty()) {
+            std::cerr << "AdikKitLoader: Préparation du kit '" << name << "' impossible, kit courant conservé." << std::endl;
+            succeeded.store(false);
+            preparing.store(false);
+            return;
+        }
+        AdikSampleAnalyzer::analyzeAll(instruments, player->sampleAnalysisOptions);
+
+        std::shared_ptr<AdikKit> current = player->getPublishedKit();
+        std::shared_ptr<AdikKit> kit = AdikKit::compose(name, current.get(), instruments, boundary);
+        player->publishKit(kit);
+        const double elapsedMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        std::cout << "AdikKitLoader: Kit '" << name << "' prêt en " << elapsedMs << " ms (" << instruments.size()
+                  << " instrument(s), " << kit->instruments.size() << " handle(s)), bascule : "
+                  << AdikKit::boundaryName(boundary) << "." << std::endl;
+        succeeded.store(true);
+        preparing.store(false);
+
+        // Libérer l'ancien kit dès que le thread audio l'a quitté et que ses dernières voix sont terminées
+        for (int waited = 0; !cancelled.load() && waited < COLLECT_TIMEOUT_MS; waited += COLLECT_INTERVAL_MS) {
+            if (player->collectRetiredKits() == 0) break;
+            std::this_thread::sleep_for(std::chrono::milliseconds(COLLECT_INTERVAL_MS));
+        }
+    }
+};
+
+#endif // ADIKKITLOADER_H
@@ -0,0 +1,178 @@
+#ifndef ADIKMETER_H
+#define ADIKMETER_H
+
+#include <cstdint>
+#include <cstddef>
+#include <cmath>
+#include <algorithm>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+// Mesure d'un bloc : crête, somme des carrés et nombre d'échantillons saturés (|x| >= 1)
+struct AdikMeterMeasure {
+    float peak;
+    float sumSquares;
+    uint32_t clips;
+    uint32_t samples;
+};
+
+// Mesure 'count' échantillons contigus, multipliés par 'gain' (gain constant sur le bloc).
+// SSE2 : 4 échantillons par itération (max et somme des carrés vectoriels, saturations par masque).
+// Les données sont celles que le mixeur vient d'écrire : elles sont encore dans le cache L1.
+inline AdikMeterMeasure adikMeasure(const float* data, size_t count, float gain = 1.0f) {
+    AdikMeterMeasure measure = { 0.0f, 0.0f, 0, static_cast<uint32_t>(count) };
+    size_t i = 0;
+#if defined(__SSE2__)
+    const __m128 absMask = _mm_castsi128_ps(_mm_set1_epi32(0x7FFFFFFF));
+    const __m128 one = _mm_set1_ps(1.0f);
+    const __m128 gains = _mm_set1_ps(gain);
+    __m128 peaks = _mm_setzero_ps();
+    __m128 sums = _mm_setzero_ps();
+    uint32_t clips = 0;
+    for (; i + 4 <= count; i += 4) {
+        const __m128 v = _mm_mul_ps(_mm_loadu_ps(data + i), gains);
+        const __m128 a = _mm_and_ps(v, absMask);
+        peaks = _mm_max_ps(peaks, a);
+        sums = _mm_add_ps(sums, _mm_mul_ps(v, v));
+        clips += static_cast<uint32_t>(__builtin_popcount(_mm_movemask_ps(_mm_cmpge_ps(a, one))));
+    }
+    float lanes[4];
+    _mm_storeu_ps(lanes, peaks);
+    measure.peak = std::max(std::max(lanes[0], lanes[1]), std::max(lanes[2], lanes[3]));
+    _mm_storeu_ps(lanes, sums);
+    measure.sumSquares = (lanes[0] + lanes[1]) + (lanes[2] + lanes[3]);
+    measure.clips = clips;
+#endif
+    for (; i < count; ++i) {
+        const float v = data[i] * gain;
+        const float a = std::fabs(v);
+        measure.peak = std::max(measure.peak, a);
+        measure.sumSquares += v * v;
+        if (a >= 1.0f) measure.clips++;
+    }
+    return measure;
+}
+
+// Niveau publié pour un point de mesure (canal, sortie ou maître)
+struct AdikMeterLevel {
+    float peak;          // Crête du dernier bloc
+    float windowPeak;    // Crête sur la fenêtre de capture (voir AdikMeterSnapshot::WINDOW_MS)
+    float rms;           // RMS du dernier bloc
+    double sumSquares;   // Cumuls depuis le démarrage : le lecteur calcule le RMS exact de son intervalle
+    uint64_t samples;
+    uint64_t clips;      // Échantillons saturés depuis le démarrage
+};
+
+// Mesures de tous les points, publiées par le mixeur à chaque bloc (AdikMixer::meterSnapshot)
+struct AdikMeterSnapshot {
+    static constexpr int MAX_CHANNELS = 8;
+    static constexpr int MAX_OUTPUTS = 16;
+    // Un lecteur qui relit au moins toutes les WINDOW_MS ms ne manque aucune crête
+    static constexpr unsigned int WINDOW_MS = 50;
+
+    uint64_t block;
+    int numChannels;
+    int numOutputs;
+    AdikMeterLevel channels[MAX_CHANNELS];
+    AdikMeterLevel outputs[MAX_OUTPUTS];
+    AdikMeterLevel master;  // Toutes les sorties réunies
+};
+
+// --- AdikMeterAccumulator ---
+// Côté thread audio : cumuls d'un point de mesure et crête de fenêtre.
+// La crête de fenêtre est le maximum de la fenêtre en cours et de la précédente :
+// chaque crête reste donc visible au moins une fenêtre entière.
+class AdikMeterAccumulator {
+public:
+    AdikMeterAccumulator() : level(), currentWindowPeak(0.0f), previousWindowPeak(0.0f) {}
+
+    void add(const AdikMeterMeasure& measure) {
+        level.peak = measure.peak;
+        level.rms = measure.samples ? std::sqrt(measure.sumSquares / measure.samples) : 0.0f;
+        level.sumSquares += measure.sumSquares;
+        level.samples += measure.samples;
+        level.clips += measure.clips;
+        currentWindowPeak = std::max(currentWindowPeak, measure.peak);
+        level.windowPeak = std::max(currentWindowPeak, previousWindowPeak);
+    }
+
+    void nextWindow() {
+        previousWindowPeak = currentWindowPeak;
+        currentWindowPeak = 0.0f;
+    }
+
+    const AdikMeterLevel& getLevel() const { return level; }
+
+private:
+    AdikMeterLevel level;
+    float currentWindowPeak;
+    float previousWindowPeak;
+};
+
+// --- AdikMeterBallistics ---
+// Côté lecteur (interface, serveur de contrôle) : maintien de crête et retombée,
+// appliqués à chaque lecture d'un AdikMeterLevel. Un objet par point de mesure et par lecteur.
+class AdikMeterBallistics {
+public:
+    AdikMeterBallistics(float holdSeconds = 1.5f, float decayDbPerSecond = 24.0f, float clipHoldSeconds = 2.0f)
+        : holdSeconds(holdSeconds), decayDbPerSecond(decayDbPerSecond), clipHoldSeconds(clipHoldSeconds),
+          peak(0.0f), heldPeak(0.0f), holdRemaining(0.0f), clipRemaining(0.0f), rms(0.0f),
+          lastSumSquares(0.0), lastSamples(0), lastClips(0), primed(false) {}
+
+    // 'elapsedSeconds' : temps écoulé depuis la lecture précédente
+    void update(const AdikMeterLevel& level, float elapsedSeconds) {
+        const float decay = std::pow(10.0f, -decayDbPerSecond * elapsedSeconds / 20.0f);
+        peak = std::max(level.windowPeak, peak * decay);
+        if (level.windowPeak >= heldPeak) {
+            heldPeak = level.windowPeak;
+            holdRemaining = holdSeconds;
+        } else if (holdRemaining > 0.0f) {
+            holdRemaining -= elapsedSeconds;
+        } else {
+            heldPeak = std::max(peak, heldPeak * decay);
+        }
+        // RMS exact sur l'intervalle depuis la lecture précédente
+        if (primed && level.samples > lastSamples) {
+            rms = static_cast<float>(std::sqrt((level.sumSquares - lastSumSquares) / (level.samples - lastSamples)));
+        } else if (!primed) {
+            rms = level.rms;
+        } else {
+            rms *= decay; // Aucun bloc depuis la lecture précédente (flux arrêté)
+        }
+        if (primed && level.clips > lastClips) {
+            clipRemaining = clipHoldSeconds;
+        } else if (clipRemaining > 0.0f) {
+            clipRemaining -= elapsedSeconds;
+        }
+        lastSumSquares = level.sumSquares;
+        lastSamples = level.samples;
+        lastClips = level.clips;
+        primed = true;
+    }
+
+    float getPeak() const { return peak; }
+    float getHeldPeak() const { return heldPeak; }
+    float getRms() const { return rms; }
+    bool isClipping() const { return clipRemaining > 0.0f; }
+    uint64_t getClipCount() const { return lastClips; }
+
+    static float toDb(float linear) { return linear > 0.0f ? 20.0f * std::log10(linear) : -144.0f; }
+
+private:
+    float holdSeconds;
+    float decayDbPerSecond;
+    float clipHoldSeconds;
+    float peak;
+    float heldPeak;
+    float holdRemaining;
+    float clipRemaining;
+    float rms;
+    double lastSumSquares;
+    uint64_t lastSamples;
+    uint64_t lastClips;
+    bool primed;
+};
+
+#endif // ADIKMETER_H
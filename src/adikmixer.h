@@ -3,43 +3,162 @@
 
 #include <vector>
 #include <string> // Pour std::string dans displayMixerStatus
+#include <cstdio> // Pour std::snprintf (printMeters)
 #include <iostream>
 #include <memory> // Pour std::shared_ptr
+#include <algorithm> // Pour std::max
+#include <cmath> // Pour std::fabs
+#include <cstdint>
+#include <atomic>
 
 // Important : AdikChannel.h DOIT être inclus avant AdikMixer.h
 // car AdikMixer contient un std::vector<AdikChannel>,
 // ce qui signifie qu'il a besoin de la définition complète de AdikChannel.
 // De même, AdikChannel a besoin de AdikInstrument, donc AdikInstrument.h doit être inclus avant AdikChannel.h
 #include "adikchannel.h"
+#include "adikrealtime.h" // Pour AdikRealtime::prefault
+#include "adikmeter.h"
+#include "adikseqlock.h"
 
 
+// Bus de sortie : somme stéréo d'un groupe de canaux du mixeur (plans gauche/droite séparés),
+// envoyée vers une paire de sorties du périphérique, ou vers une seule sortie en mono.
+struct AdikOutputBus {
+    std::string name;
+    int firstOutput;           // Première sortie du périphérique (0-based)
+    bool mono;                 // true : une seule sortie, (G + D) / 2
+    float gain;
+    std::vector<float> left;   // Plans du bloc en cours
+    std::vector<float> right;
+
+    AdikOutputBus(const std::string& n, int first, bool isMono, float g = 1.0f)
+        : name(n), firstOutput(first), mono(isMono), gain(g) {}
+};
+
 class AdikMixer {
 public:
     std::vector<AdikChannel> channelList;
     static const int NUM_MIXER_channelList = 8;
+    static const int MAX_BUSES = NUM_MIXER_channelList + 1; // Bus principal + un bus dédié par canal
+    static const unsigned int SILENCE_WINDOW_MS = 30;       // Voir silenceWindowFrames (seuil par défaut : -80 dBFS)
     unsigned int numOutputChannels; // Le nombre de canaux de sortie du mixeur (ex: 2 pour stéréo)
     float masterVolume; // Pour un contrôle de volume global
+    std::vector<AdikOutputBus> busList;            // busList[0] : bus principal (sorties 0-1)
+    std::vector<std::vector<float>> outputPlanes;  // Un plan par sortie du périphérique
     std::vector<float> instruBuffer;  
+    // Mesures (crête, RMS, saturations) faites pendant le mixage, publiées à chaque bloc.
+    // Les lecteurs appliquent maintien et retombée eux-mêmes (AdikMeterBallistics).
+    AdikSeqLock<AdikMeterSnapshot> meterSnapshot;
+    // Dégradation sous surcharge (réglée par AdikQualityController, sur le thread audio)
+    int voiceLimit;                 // Polyphonie maximale, 0 : pas de limite
+    bool bypassNonEssential;        // Canaux non essentiels coupés
+    std::atomic<uint64_t> stolenVoices; // Voix coupées par la limite de polyphonie ou le contournement
+    // Libération anticipée des voix devenues inaudibles (AdikChannel::trackSilence)
+    float silenceThreshold;             // Crête linéaire sous laquelle une voix est silencieuse (0 : désactivé)
+    unsigned int silenceWindowFrames;   // Durée de silence avant libération
+    std::atomic<uint64_t> retiredVoices; // Voix libérées avant la fin de leur son
+
+private:
+    // Accumulateurs des mesures (thread audio)
+    AdikMeterAccumulator channelMeters[AdikMeterSnapshot::MAX_CHANNELS];
+    std::vector<AdikMeterAccumulator> outputMeters;
+    AdikMeterAccumulator masterMeter;
+    unsigned int meterWindowFrames;   // Durée d'une fenêtre de capture des crêtes
+    unsigned int meterWindowElapsed;
+    uint64_t meterBlocks;
+
+public:
 
     // Constructeur - maintenant prend le nombre de canaux de sortie de l'AudioEngine
-    AdikMixer() : numOutputChannels(2) { // Par défaut, sortie stéréo
+    AdikMixer() : numOutputChannels(2), masterVolume(1.0f), voiceLimit(0), bypassNonEssential(false), stolenVoices(0),
+                  silenceThreshold(1.0e-4f), silenceWindowFrames(44100 * SILENCE_WINDOW_MS / 1000), retiredVoices(0),
+                  meterWindowFrames(44100 * AdikMeterSnapshot::WINDOW_MS / 1000), meterWindowElapsed(0), meterBlocks(0) { // Par défaut, sortie stéréo
         // Initialiser 8 canaux par défaut
         for (int i = 0; i < 8; ++i) {
             channelList.emplace_back(i + 1);
         }
+        // Réservé une fois pour toutes : le thread audio parcourt busList, qui ne doit pas être réalloué
+        busList.reserve(MAX_BUSES);
+        busList.emplace_back("Main", 0, false);
+        allocateBuffers(512);
         std::cout << "AdikMixer: Constructeur appelé avec " << channelList.size() << " canaux." << std::endl;
     }
 
-    // Acheminer le son vers un canal spécifique du mixeur
-    void routeSound(int channelIndex, std::shared_ptr<AdikInstrument> instrument, float finalVelocity, float finalPan, float finalPitch) {
+    // Acheminer le son vers un canal spécifique du mixeur.
+    // startOffsetFrames : décalage du début du son dans le prochain bloc rendu (déclenchement précis au sample).
+    // startPosition : position de départ dans le son, en samples (voir AdikChannel::receiveSound).
+    void routeSound(int channelIndex, std::shared_ptr<AdikInstrument> instrument, float finalVelocity, float finalPan, float finalPitch,
+                    unsigned int startOffsetFrames = 0, size_t startPosition = 0) {
         if (channelIndex > 0 && channelIndex <= NUM_MIXER_channelList) {
-            channelList[channelIndex - 1].receiveSound(instrument, finalVelocity, finalPan, finalPitch);
+            if (bypassNonEssential && !channelList[channelIndex - 1].essential) return; // Surcharge : canal coupé
+            channelList[channelIndex - 1].receiveSound(instrument, finalVelocity, finalPan, finalPitch, startOffsetFrames, startPosition);
             // std::cout << "routeSound: Après receiveSound\n";
         } else {
             std::cerr << "Erreur: Canal mixeur invalide: " << channelIndex << std::endl;
         }
     }
 
+    // --- Routage vers les sorties du périphérique ---
+    // À configurer avant le démarrage du flux audio (ou transport arrêté) : le thread audio lit ces réglages sans verrou.
+
+    // Ajoute un bus vers la sortie 'firstOutput' (0-based) et la suivante, ou cette seule sortie en mono.
+    // Renvoie l'index du bus, ou -1.
+    int addBus(const std::string& name, int firstOutput, bool mono = false, float gain = 1.0f) {
+        if (busList.size() >= static_cast<size_t>(MAX_BUSES)) {
+            std::cerr << "AdikMixer: Nombre maximal de bus atteint (" << MAX_BUSES << ")." << std::endl;
+            return -1;
+        }
+        if (!isValidOutput(firstOutput, mono)) return -1;
+        busList.emplace_back(name, firstOutput, mono, gain);
+        const size_t frames = busList[0].left.size();
+        busList.back().left.assign(frames, 0.0f);
+        busList.back().right.assign(frames, 0.0f);
+        return static_cast<int>(busList.size()) - 1;
+    }
+
+    bool setBusOutput(int busIndex, int firstOutput, bool mono) {
+        if (busIndex < 0 || busIndex >= static_cast<int>(busList.size()) || !isValidOutput(firstOutput, mono)) return false;
+        busList[busIndex].firstOutput = firstOutput;
+        busList[busIndex].mono = mono;
+        return true;
+    }
+
+    // channelIndex : 1-based, comme routeSound
+    bool setChannelBus(int channelIndex, int busIndex) {
+        if (channelIndex < 1 || channelIndex > NUM_MIXER_channelList ||
+            busIndex < 0 || busIndex >= static_cast<int>(busList.size())) {
+            std::cerr << "AdikMixer: Routage invalide (canal " << channelIndex << ", bus " << busIndex << ")." << std::endl;
+            return false;
+        }
+        channelList[channelIndex - 1].busIndex = busIndex;
+        return true;
+    }
+
+    // Raccourci : un canal vers sa propre sortie (mono) ou sa propre paire de sorties, par un bus dédié
+    bool routeChannelToOutput(int channelIndex, int firstOutput, bool mono = true) {
+        if (channelIndex < 1 || channelIndex > NUM_MIXER_channelList) return false;
+        const int current = channelList[channelIndex - 1].busIndex;
+        if (current > 0 && busList[current].name == "Canal " + std::to_string(channelIndex)) {
+            return setBusOutput(current, firstOutput, mono);
+        }
+        const int bus = addBus("Canal " + std::to_string(channelIndex), firstOutput, mono);
+        return bus >= 0 && setChannelBus(channelIndex, bus);
+    }
+
+    void displayRouting() const {
+        std::cout << "Routage du mixeur (" << numOutputChannels << " sorties):" << std::endl;
+        for (size_t b = 0; b < busList.size(); ++b) {
+            const AdikOutputBus& bus = busList[b];
+            std::cout << "  Bus " << b << " '" << bus.name << "' -> sortie " << bus.firstOutput + 1;
+            if (!bus.mono) std::cout << "-" << bus.firstOutput + 2;
+            std::cout << " ; canaux:";
+            for (const auto& channel : channelList) {
+                if (channel.busIndex == static_cast<int>(b)) std::cout << " " << channel.id;
+            }
+            std::cout << std::endl;
+        }
+    }
+
     // Afficher l'état actuel du mixeur (quels canaux sont actifs)
     void displayMixerStatus() const {
         std::cout << "Mixer Status (Master Vol: " << masterVolume << "): [";
@@ -49,6 +168,51 @@ public:
         std::cout << "]" << std::endl;
     }
 
+    // Nombre de canaux en cours de lecture
+    int getActiveChannelCount() const {
+        int count = 0;
+        for (const auto& channel : channelList) {
+            if (channel.isActive) count++;
+        }
+        return count;
+    }
+
+    // Applique un niveau de dégradation (thread audio). Les voix en trop sont coupées au prochain mixage.
+    void setQualityLimits(int maxVoices, bool bypass) {
+        voiceLimit = maxVoices;
+        bypassNonEssential = bypass;
+    }
+
+    // Coupe les canaux non essentiels (si contournés) puis, au-delà de voiceLimit, les voix les plus faibles.
+    // Faiblesse d'une voix : sa crête au bloc précédent, ou sa vélocité si elle vient de démarrer.
+    void enforceQualityLimits() {
+        int active = 0;
+        for (auto& channel : channelList) {
+            if (!channel.isActive) continue;
+            if (bypassNonEssential && !channel.essential) {
+                channel.isActive = false;
+                stolenVoices.fetch_add(1, std::memory_order_relaxed);
+                continue;
+            }
+            active++;
+        }
+        while (voiceLimit > 0 && active > voiceLimit) {
+            AdikChannel* quietest = nullptr;
+            float quietestLevel = 0.0f;
+            for (auto& channel : channelList) {
+                if (!channel.isActive) continue;
+                const float level = channel.peakLevel > 0.0f ? channel.peakLevel : channel.currentVelocity;
+                if (!quietest || level < quietestLevel) {
+                    quietest = &channel;
+                    quietestLevel = level;
+                }
+            }
+            quietest->isActive = false;
+            stolenVoices.fetch_add(1, std::memory_order_relaxed);
+            active--;
+        }
+    }
+
     // Réinitialiser l'état de lecture de tous les canaux
     void clearAllchannelListPlaybackState() {
         for (auto& channel : channelList) {
@@ -57,31 +221,53 @@ public:
         std::cout << "État de lecture de tous les canaux du mixeur réinitialisé." << std::endl;
     }
     
-    // Méthode pour mixer tous les canaux actifs dans un buffer de sortie stéréo final.
-    // Le outputBuffer est un buffer entrelacé (LRLR...) de la carte son.
-    void mixChannels(std::vector<float>& outputBuffer, unsigned int numFrames) {
-        // std::cout << "\a";  
+    // Méthode pour mixer tous les canaux actifs vers le buffer entrelacé du périphérique.
+    // Les canaux sont sommés dans leur bus (plans G/D), les bus dans les plans de sortie,
+    // puis une seule passe entrelace les plans dans 'outputBuffer' (numChannels samples par frame)
+    // et mesure la crête de chaque sortie.
+    void mixChannels(float* outputBuffer, unsigned int numFrames, unsigned int numChannels) {
         // std::cout << "MixChannelList: avant tout.\n";
-        // Initialiser le buffer de sortie avec des zéros
-        // La taille est numFrames * numOutputChannels (ex: 512 frames * 2 canaux = 1024 floats)
-        outputBuffer.assign(numFrames * numOutputChannels, 0.0f);
-        // std::cout << "MixchannelList: après l'initialisation du monoBuffer.\n";
+        if (numFrames > busList[0].left.size()) {
+            allocateBuffers(numFrames); // Bloc plus grand que prévu à l'initialisation (alloue, cas exceptionnel)
+        }
+        enforceQualityLimits();
+        for (auto& bus : busList) {
+            std::fill(bus.left.begin(), bus.left.begin() + numFrames, 0.0f);
+            std::fill(bus.right.begin(), bus.right.begin() + numFrames, 0.0f);
+        }
 
         // Parcourir chaque canal du mixeur
         for (auto i =0; i < channelList.size(); i++) {
             auto& channel = channelList[i];  
+            channel.peakLevel = 0.0f;
             // std::cout << "mixChannels: boucle sur les channelList: " << i << ", active: " << channel.isActive << "\n";
             if (channel.isActive && channel.currentInstrument) {
                 unsigned int numInstruChannels = channel.currentInstrument->getNumChannels();
-                // instruBuffer.assign(numFrames * numInstruChannels, 0.0f);  
                 // Demander au canal de rendre son son dans son buffer interne
-                // std::cout << "mixChannels: Avant channel.render:\n ";
                 // instruBuffer sera réinitialisé par la fonction readData
                 channel.render(instruBuffer, numFrames);
-                // std::cout << "mixchannelList: Après channel.render:\n ";
+                AdikOutputBus& bus = busList[channel.busIndex < static_cast<int>(busList.size()) ? channel.busIndex : 0];
+                float* busLeft = bus.left.data();
+                float* busRight = bus.right.data();
 
+                // Application du panoramique (loi de puissance -3dB plus naturelle), constante sur le bloc.
+                // Pan de -1 (gauche) à +1 (droite)
+                float panAngle = (channel.currentPan + 1.0f) * (PI / 4.0f); // De 0 à PI/2
+                float gainLeft = std::cos(panAngle);
+                float gainRight = std::sin(panAngle);
+                gainLeft = 0.3;
+                gainRight = 0.3;
 
-                // Appliquer le panoramique et mixer dans le buffer de sortie final (stéréo)
+                // Mesure du canal (après gain), sur le buffer que l'instrument vient d'écrire
+                const AdikMeterMeasure measure = adikMeasure(instruBuffer.data(), static_cast<size_t>(numFrames) * numInstruChannels,
+                                                             numInstruChannels == 1 ? std::max(gainLeft, gainRight) : 1.0f);
+                channel.peakLevel = measure.peak;
+                if (i < AdikMeterSnapshot::MAX_CHANNELS) channelMeters[i].add(measure);
+                if (channel.trackSilence(measure.peak, numFrames, silenceThreshold, silenceWindowFrames)) {
+                    retiredVoices.fetch_add(1, std::memory_order_relaxed);
+                }
+
+                // Mixer dans le bus du canal (stéréo)
                 for (unsigned int j =0; j < numFrames; ++j) {
                     float leftSample = 0.0f;
                     float rightSample = 0.0f;
@@ -89,14 +275,6 @@ public:
                     if (numInstruChannels == 1) { // Son mono
                         float monoSample = instruBuffer[j];
 
-                        // Application du panoramique (loi de puissance -3dB plus naturelle)
-                        // Pan de -1 (gauche) à +1 (droite)
-                        float panAngle = (channel.currentPan + 1.0f) * (PI / 4.0f); // De 0 à PI/2
-                        float gainLeft = std::cos(panAngle);
-                        float gainRight = std::sin(panAngle);
-                        gainLeft = 0.3;
-                        gainRight = 0.3;
-
                         leftSample = monoSample * gainLeft;
                         rightSample = monoSample * gainRight;
 
@@ -112,26 +290,158 @@ public:
                         // Pour l'instant, pas de pan sur stéréo.
                     }
 
-                    // Ajouter les samples mixés au buffer de sortie principal (stéréo entrelacé)
-                    outputBuffer[j * numOutputChannels] += leftSample;       // Canal gauche
-                    outputBuffer[j * numOutputChannels + 1] += rightSample; // Canal droit
+                    busLeft[j] += leftSample;
+                    busRight[j] += rightSample;
                 } // End for j loop
+            } else if (i < AdikMeterSnapshot::MAX_CHANNELS) {
+                channelMeters[i].add(AdikMeterMeasure{ 0.0f, 0.0f, 0, numFrames }); // Silence : compte dans le RMS
             } // End if condition
         
         } // End for i loop
-    
+
+        // Bus -> plans de sortie
+        for (auto& plane : outputPlanes) {
+            std::fill(plane.begin(), plane.begin() + numFrames, 0.0f);
+        }
+        for (const auto& bus : busList) {
+            const int first = bus.firstOutput;
+            if (bus.mono) {
+                if (first >= static_cast<int>(outputPlanes.size())) continue;
+                float* out = outputPlanes[first].data();
+                const float gain = bus.gain * 0.5f;
+                for (unsigned int j = 0; j < numFrames; ++j) out[j] += gain * (bus.left[j] + bus.right[j]);
+            } else {
+                if (first + 1 >= static_cast<int>(outputPlanes.size())) continue;
+                float* outLeft = outputPlanes[first].data();
+                float* outRight = outputPlanes[first + 1].data();
+                for (unsigned int j = 0; j < numFrames; ++j) {
+                    outLeft[j] += bus.gain * bus.left[j];
+                    outRight[j] += bus.gain * bus.right[j];
+                }
+            }
+        }
+
+        // Mesure des sorties, plan par plan (contigu, encore en cache), puis du maître (toutes les sorties)
+        const unsigned int planes = std::min(numChannels, static_cast<unsigned int>(outputPlanes.size()));
+        AdikMeterMeasure master = { 0.0f, 0.0f, 0, 0 };
+        for (unsigned int o = 0; o < planes; ++o) {
+            const AdikMeterMeasure measure = adikMeasure(outputPlanes[o].data(), numFrames);
+            outputMeters[o].add(measure);
+            master.peak = std::max(master.peak, measure.peak);
+            master.sumSquares += measure.sumSquares;
+            master.clips += measure.clips;
+            master.samples += measure.samples;
+        }
+        masterMeter.add(master);
+
+        // Passe unique d'entrelacement vers le périphérique
+        for (unsigned int j = 0; j < numFrames; ++j) {
+            float* frame = outputBuffer + static_cast<size_t>(j) * numChannels;
+            for (unsigned int o = 0; o < planes; ++o) {
+                frame[o] = outputPlanes[o][j];
+            }
+            for (unsigned int o = planes; o < numChannels; ++o) frame[o] = 0.0f;
+        }
+        publishMeters(numFrames);
+    }
+
+    // Durée de la fenêtre de capture des crêtes, d'après le taux d'échantillonnage
+    void setMeterSampleRate(unsigned int sampleRate) {
+        meterWindowFrames = std::max(1u, sampleRate * AdikMeterSnapshot::WINDOW_MS / 1000);
+    }
+
+    // Affiche crête, RMS (dBFS) et saturations du dernier bloc publié. Tout thread.
+    void printMeters() const {
+        AdikMeterSnapshot snapshot;
+        if (!meterSnapshot.read(snapshot)) {
+            std::cout << "Niveaux: aucun bloc mixé." << std::endl;
+            return;
+        }
+        auto line = [](const std::string& name, const AdikMeterLevel& level) {
+            char text[128];
+            std::snprintf(text, sizeof(text), "  %-8s crête %6.1f dB  RMS %6.1f dB  saturations %llu", name.c_str(),
+                          AdikMeterBallistics::toDb(level.windowPeak), AdikMeterBallistics::toDb(level.rms),
+                          static_cast<unsigned long long>(level.clips));
+            std::cout << text << std::endl;
+        };
+        std::cout << "Niveaux (bloc " << snapshot.block << "):" << std::endl;
+        for (int i = 0; i < snapshot.numChannels; ++i) line("Canal " + std::to_string(i + 1), snapshot.channels[i]);
+        for (int o = 0; o < snapshot.numOutputs; ++o) line("Sortie " + std::to_string(o + 1), snapshot.outputs[o]);
+        line("Maître", snapshot.master);
     }
 
-    // Une méthode pour initialiser les paramètres si le mixeur en avait besoin.
-    // Pour l'instant, numOutputChannels est défini dans le constructeur.
+    // Nombre de sorties et taille de bloc : alloue les plans des bus et des sorties (hors du thread audio).
     void initParams(const AudioInfo& info) {
-        this->numOutputChannels = info.numChannels;
-        // Vous pouvez passer ces infos aux canaux si besoin
-        // for (auto& ch : channelList) { ch.initParams(info); }
+        this->numOutputChannels = info.numChannels > 0 ? info.numChannels : 2;
+        if (numOutputChannels == 1) busList[0].mono = true;
+        allocateBuffers(info.bufferSize);
+        setMeterSampleRate(info.sampleRate);
+        silenceWindowFrames = info.sampleRate * SILENCE_WINDOW_MS / 1000;
         std::cout << "AdikMixer: Initialisé avec " << numOutputChannels << " canaux de sortie." << std::endl;
     }
 
 
+    // Touche chaque page des plans et du buffer d'instrument (voir AdikRealtime::prefault). Hors du thread audio.
+    size_t prefaultBuffers() {
+        size_t bytes = 0;
+        for (auto& bus : busList) {
+            bytes += AdikRealtime::prefault(bus.left.data(), bus.left.size() * sizeof(float));
+            bytes += AdikRealtime::prefault(bus.right.data(), bus.right.size() * sizeof(float));
+        }
+        for (auto& plane : outputPlanes) {
+            bytes += AdikRealtime::prefault(plane.data(), plane.size() * sizeof(float));
+        }
+        bytes += AdikRealtime::prefault(outputMeters.data(), outputMeters.size() * sizeof(AdikMeterAccumulator));
+        bytes += AdikRealtime::prefault(instruBuffer.data(), instruBuffer.capacity() * sizeof(float));
+        bytes += AdikRealtime::prefault(channelList.data(), channelList.size() * sizeof(AdikChannel));
+        return bytes;
+    }
+
+private:
+    bool isValidOutput(int firstOutput, bool mono) const {
+        const int last = firstOutput + (mono ? 0 : 1);
+        if (firstOutput < 0 || last >= static_cast<int>(numOutputChannels)) {
+            std::cerr << "AdikMixer: Sortie invalide " << firstOutput + 1 << (mono ? "" : " (paire)")
+                      << " pour " << numOutputChannels << " sorties." << std::endl;
+            return false;
+        }
+        return true;
+    }
+
+    // Publie les mesures du bloc (thread audio) et fait avancer la fenêtre de capture des crêtes
+    void publishMeters(unsigned int numFrames) {
+        AdikMeterSnapshot snapshot;
+        snapshot.block = meterBlocks++;
+        snapshot.numChannels = std::min(static_cast<int>(channelList.size()), AdikMeterSnapshot::MAX_CHANNELS);
+        snapshot.numOutputs = std::min(static_cast<int>(outputMeters.size()), AdikMeterSnapshot::MAX_OUTPUTS);
+        for (int i = 0; i < AdikMeterSnapshot::MAX_CHANNELS; ++i) {
+            snapshot.channels[i] = i < snapshot.numChannels ? channelMeters[i].getLevel() : AdikMeterLevel();
+        }
+        for (int o = 0; o < AdikMeterSnapshot::MAX_OUTPUTS; ++o) {
+            snapshot.outputs[o] = o < snapshot.numOutputs ? outputMeters[o].getLevel() : AdikMeterLevel();
+        }
+        snapshot.master = masterMeter.getLevel();
+        meterSnapshot.write(snapshot);
+
+        meterWindowElapsed += numFrames;
+        if (meterWindowElapsed >= meterWindowFrames) {
+            meterWindowElapsed = 0;
+            for (auto& meter : channelMeters) meter.nextWindow();
+            for (auto& meter : outputMeters) meter.nextWindow();
+            masterMeter.nextWindow();
+        }
+    }
+
+    void allocateBuffers(unsigned int maxFrames) {
+        for (auto& bus : busList) {
+            bus.left.assign(maxFrames, 0.0f);
+            bus.right.assign(maxFrames, 0.0f);
+        }
+        outputPlanes.assign(numOutputChannels, std::vector<float>(maxFrames, 0.0f));
+        outputMeters.resize(numOutputChannels);
+        // Taille maximale (stéréo) dès maintenant : readData ne fait plus que réduire la taille, sans allouer
+        instruBuffer.assign(static_cast<size_t>(maxFrames) * 2, 0.0f);
+    }
 };
 
 #endif // ADIKMIXER_H
@@ -0,0 +1,72 @@
+#ifndef ADIKOFFLINERENDERER_H
+#define ADIKOFFLINERENDERER_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <iostream>
+
+#include "audioinfo.h"
+#include "audioengine.h"   // Pour processAudioCallback
+#include "adikplayer.h"
+#include "adikrealtime.h"
+#include "adikwavwriter.h"
+
+// --- AdikOfflineRenderer ---
+// Rendu hors temps réel : appelle processAudioCallback bloc par bloc, sans périphérique,
+// exactement comme le ferait le driver (même mixage, même horloge, mêmes déclenchements).
+// Le résultat est déterministe : le contrôleur de qualité est désactivé (la charge mesurée
+// dépend de la machine) et le thread de rendu active FTZ/DAZ comme le thread audio.
+// Le player ne doit pas être branché sur un flux en même temps.
+class AdikOfflineRenderer {
+public:
+    AdikOfflineRenderer(AdikPlayer& player, const AudioInfo& info)
+        : player(player), info(info), block(static_cast<size_t>(info.bufferSize) * info.numChannels, 0.0f) {}
+
+    // Configure le player pour ce rendu (taille de bloc, sorties) et coupe la dégradation sous charge
+    void prepare() {
+        player.initParams(info);
+        player.qualityController.setEnabled(false);
+        player.schedulerEnabled.store(false); // Les événements sont parcourus par le callback, sans thread d'anticipation
+    }
+
+    // Rend numFrames frames ; sink(const float* interleaved, unsigned int frames) reçoit chaque bloc.
+    // Renvoie le nombre de frames rendues.
+    template <typename Sink>
+    int64_t render(int64_t numFrames, Sink sink) {
+        AdikRealtime::flushDenormals();
+        int64_t done = 0;
+        while (done < numFrames) {
+            const unsigned int frames = static_cast<unsigned int>(
+                std::min<int64_t>(info.bufferSize, numFrames - done));
+            processAudioCallback(block.data(), frames, info.numChannels, 0, &player);
+            sink(static_cast<const float*>(block.data()), frames);
+            done += frames;
+        }
+        return done;
+    }
+
+    // Rend numFrames frames dans un fichier WAV
+    bool renderToWav(const std::string& path, int64_t numFrames, AdikSampleFormat format,
+                     AdikFormatConverter::Dither dither = AdikFormatConverter::DITHER_TPDF) {
+        AdikWavWriter writer;
+        if (!writer.open(path, info.sampleRate, info.numChannels, format, dither)) return false;
+        bool ok = true;
+        render(numFrames, [&](const float* samples, unsigned int frames) {
+            ok = writer.write(samples, frames) && ok;
+        });
+        return writer.close() && ok;
+    }
+
+    // Durée en frames de 'steps' pas au tempo courant (sans carte de tempo)
+    int64_t framesForSteps(int64_t steps) const {
+        return static_cast<int64_t>(steps * player.samplesPerStep + 0.5);
+    }
+
+private:
+    AdikPlayer& player;
+    AudioInfo info;
+    std::vector<float> block;
+};
+
+#endif // ADIKOFFLINERENDERER_H
@@ -0,0 +1,541 @@
+/***
+ * File: adikperftest.cpp
+ * Suite de non-régression : rend hors temps réel (AdikOfflineRenderer) un jeu fixe de projets
+ * de référence, vérifie que l'audio produit n'a pas changé (empreinte FNV-1a des samples float,
+ * ou tolérance sur RMS et crête) et compare le temps de rendu, la mémoire résidente maximale
+ * et le nombre d'allocations pendant le rendu aux références enregistrées.
+ * Chaque rendu a lieu dans un processus fils (fork) : la mémoire et les allocations mesurées
+ * sont celles du seul projet, et deux rendus du même projet doivent donner la même empreinte.
+ *
+ * Usage: adikperftest [--baselines fichier] [--update] [--runs n] [--time-threshold r]
+ *                     [--rss-threshold r] [--alloc-threshold r] [--tolerance t] [--wav-dir rép] [projet...]
+ *   --update          réécrit les références avec les mesures de cette exécution
+ *   --runs            rendus par projet (3) : le temps retenu est le meilleur
+ *   --time-threshold  régression de temps tolérée (0.25 = +25 %, et au moins 1 ms)
+ *   --rss-threshold   régression de mémoire tolérée (0.10, et au moins 512 Kio)
+ *   --alloc-threshold régression d'allocations tolérée (0 : aucune allocation de plus)
+ *   --tolerance       écart relatif accepté sur RMS et crête quand l'empreinte diffère (0 : empreinte exacte)
+ *   --wav-dir         écrit aussi le rendu de chaque projet en WAV float (pour écouter une différence)
+ * Voir aussi les cibles 'perftest' et 'perftest-update' du Makefile.
+ *
+ * ***/
+#include "audioinfo.h"
+#include "adikplayer.h"
+#include "adikofflinerenderer.h"
+#include "adikfreezer.h"
+
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <map>
+#include <memory>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include <algorithm>
+
+#include <unistd.h>       // Pour fork, pipe
+#include <sys/wait.h>     // Pour waitpid
+#include <sys/resource.h> // Pour getrusage
+
+// ============================================================================
+// Comptage des allocations : tous les operator new du processus passent par ici
+
+static std::atomic<uint64_t> gAllocations(0);
+
+void* operator new(std::size_t size) {
+    gAllocations.fetch_add(1, std::memory_order_relaxed);
+    if (void* p = std::malloc(size ? size : 1)) return p;
+    throw std::bad_alloc();
+}
+void* operator new[](std::size_t size) { return operator new(size); }
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete[](void* p) noexcept { std::free(p); }
+void operator delete(void* p, std::size_t) noexcept { std::free(p); }
+void operator delete[](void* p, std::size_t) noexcept { std::free(p); }
+
+// ============================================================================
+// Projets de référence
+
+struct PerfProject {
+    const char* name;
+    const char* description;
+    // Prépare le player (séquences, morceau, tempo, mode) et renvoie le nombre de pas à rendre
+    int64_t (*setup)(AdikPlayer& player);
+    // Projet dont l'audio doit être le même, seconde par seconde (voir checkSameAudio), ou nullptr
+    const char* sameAudioAs;
+};
+
+// Séquence de 'numTracks' pistes réparties sur les 8 canaux du mixeur, un événement tous les 'stride' pas
+static std::shared_ptr<AdikSequence> makeStressSequence(AdikPlayer& player, const std::string& name,
+                                                        int numMeasures, int spm, int numTracks, int stride) {
+    static const char* ids[] = { "kick_1", "snare_1", "hihat_closed_1", "hihat_open_1", "clap_1",
+                                 "synth_sine", "synth_square", "synth_noise", "synth_sineNoise" };
+    const int numIds = static_cast<int>(sizeof(ids) / sizeof(ids[0]));
+    auto sequence = std::make_shared<AdikSequence>(name, numMeasures, spm);
+    sequence->tracks.clear();
+    for (int t = 0; t < numTracks; ++t) {
+        sequence->tracks.emplace_back("Piste " + std::to_string(t + 1), t % AdikMixer::NUM_MIXER_channelList + 1);
+        AdikTrack& track = sequence->tracks.back();
+        const AdikInstrumentHandle handle = player.getInstrumentHandle(ids[t % numIds]);
+        for (int step = t % stride; step < sequence->lengthInSteps; step += stride) {
+            // Vélocité et pan variables mais fixes : le rendu reste reproductible
+            const float velocity = 0.4f + 0.6f * static_cast<float>((step * 7 + t * 3) % 11) / 10.0f;
+            const float pan = static_cast<float>((t * 5 + step) % 9 - 4) / 4.0f;
+            track.addEvent(handle, step, velocity, pan);
+        }
+    }
+    return sequence;
+}
+
+static void playSequence(AdikPlayer& player, int index) {
+    player.setPlaybackMode(AdikPlayer::SEQUENCE_MODE);
+    player.selectSequenceInPlayer(index);
+    player.resetPosition();
+    player.start();
+}
+
+static void playSong(AdikPlayer& player) {
+    player.setPlaybackMode(AdikPlayer::SONG_MODE);
+    player.resetPosition();
+    player.start();
+}
+
+static int64_t setupDemoSequence(AdikPlayer& player) {
+    playSequence(player, 0); // "Intro Groove (2 Mesures)"
+    return 8 * player.sequenceList[0]->lengthInSteps;
+}
+
+static int64_t setupDemoSong(AdikPlayer& player) {
+    player.clearCurrentSong();
+    player.addSequenceFromPlayerToSong(0, 2);
+    player.addSequenceFromPlayerToSong(1, 2);
+    playSong(player);
+    return player.currentSong->getTotalSteps();
+}
+
+static int64_t setupManyTracks(AdikPlayer& player) {
+    player.sequenceList[2] = makeStressSequence(player, "Stress pistes", 4, 16, 32, 4);
+    playSequence(player, 2);
+    return 4 * player.sequenceList[2]->lengthInSteps;
+}
+
+static int64_t setupHighDensity(AdikPlayer& player) {
+    player.tempoBPM = 180.0;
+    player.calculateTimingParameters();
+    player.sequenceList[3] = makeStressSequence(player, "Stress densité", 2, 64, 8, 1);
+    playSequence(player, 3);
+    return 4 * player.sequenceList[3]->lengthInSteps;
+}
+
+static int64_t setupLongSong(AdikPlayer& player) {
+    player.sequenceList[4] = makeStressSequence(player, "Couplet", 4, 16, 8, 2);
+    player.sequenceList[5] = makeStressSequence(player, "Refrain", 2, 32, 12, 3);
+    player.clearCurrentSong();
+    for (int i = 0; i < 8; ++i) {
+        player.addSequenceFromPlayerToSong(0, 2);
+        player.addSequenceFromPlayerToSong(4, 2);
+        player.addSequenceFromPlayerToSong(5, 2);
+        player.addSequenceFromPlayerToSong(1, 1);
+    }
+    playSong(player);
+    return player.currentSong->getTotalSteps();
+}
+
+// Stress pistes, avec les samples en stockage compact : mesure le coût du décodage (voir AdikSampleStore)
+static void setSampleStorage(AdikPlayer& player, AdikSampleStore::Format format) {
+    for (const auto& instrument : player.getPublishedKit()->instruments) {
+        if (instrument) instrument->sound.setStorage(format);
+    }
+}
+
+static int64_t setupManyTracksInt16(AdikPlayer& player) {
+    setSampleStorage(player, AdikSampleStore::INT16);
+    return setupManyTracks(player);
+}
+
+static int64_t setupManyTracksInt24(AdikPlayer& player) {
+    setSampleStorage(player, AdikSampleStore::INT24);
+    return setupManyTracks(player);
+}
+
+// Morceau long, chaque séquence figée (AdikFreezer) : une voix par séquence au lieu d'une par piste
+static int64_t setupFrozenLongSong(AdikPlayer& player) {
+    const int64_t steps = setupLongSong(player);
+    // Figées ensemble : chaque séquence reçoit la fin des sons de celle qui la précède dans le morceau
+    AdikFreezer::freezeSequencesNow(player, { player.sequenceList[0], player.sequenceList[1],
+                                              player.sequenceList[4], player.sequenceList[5] });
+    return steps;
+}
+
+static const PerfProject projects[] = {
+    { "demo-sequence", "séquence de démonstration 0, 8 boucles", setupDemoSequence, nullptr },
+    { "demo-song", "morceau des deux séquences de démonstration", setupDemoSong, nullptr },
+    { "stress-tracks", "32 pistes sur 8 canaux", setupManyTracks, nullptr },
+    { "stress-density", "8 pistes, un événement par pas, 64 pas/mesure à 180 BPM", setupHighDensity, nullptr },
+    { "stress-long-song", "morceau de 56 séquences (~5 min 30)", setupLongSong, nullptr },
+    { "storage-int16", "stress-tracks, samples stockés en int16", setupManyTracksInt16, nullptr },
+    { "storage-int24", "stress-tracks, samples stockés en int24", setupManyTracksInt24, nullptr },
+    { "frozen-long-song", "stress-long-song, séquences figées", setupFrozenLongSong, "stress-long-song" },
+};
+
+// ============================================================================
+// Mesures
+
+static const unsigned int BLOCK_FRAMES = 512;
+static const int MAX_WINDOWS = 600;                 // RMS par seconde, sur les 10 premières minutes
+static const double TRANSPARENCY_TOLERANCE = 0.01;  // Écart relatif maximal d'une seconde avec le projet de sameAudioAs
+static const unsigned int SAME_AUDIO_BLOCK_FRAMES = 8; // Blocs des rendus comparés (voir checkSameAudio)
+
+struct PerfResult {
+    uint64_t hash;        // FNV-1a 64 des samples float rendus
+    double rms;
+    float windowRms[MAX_WINDOWS]; // RMS de chaque seconde rendue (voir PerfProject::sameAudioAs)
+    int windows;
+    float peak;
+    double wallMs;        // Durée du rendu seul (préparation exclue)
+    long rssKb;           // Mémoire résidente maximale du processus fils
+    uint64_t allocations; // operator new pendant le rendu
+    double activeVoices;  // Voix actives en moyenne, par bloc (information, sans référence)
+    size_t sampleBytes;   // Mémoire des samples des instruments (information, sans référence)
+    int64_t frames;
+    int ok;
+};
+
+struct PerfBaseline {
+    uint64_t hash = 0;
+    double rms = 0.0;
+    double peak = 0.0;
+    double wallMs = 0.0;
+    long rssKb = 0;
+    uint64_t allocations = 0;
+};
+
+struct PerfOptions {
+    std::string baselinesPath = "perf/baselines.txt";
+    bool update = false;
+    int runs = 3;
+    double timeThreshold = 0.25;
+    double rssThreshold = 0.10;
+    double allocThreshold = 0.0;
+    double tolerance = 0.0;
+    std::string wavDir;
+};
+
+// Processus fils : prépare et rend le projet par blocs de 'blockFrames', mesures comprises
+static PerfResult renderProject(const PerfProject& project, const PerfOptions& options, unsigned int blockFrames) {
+    PerfResult result = {};
+    const AudioInfo info(44100, 2, 32, blockFrames);
+    auto player = std::make_shared<AdikPlayer>();
+    AdikOfflineRenderer renderer(*player, info);
+    renderer.prepare();
+    const int64_t frames = renderer.framesForSteps(project.setup(*player));
+    for (const auto& instrument : player->getPublishedKit()->instruments) {
+        if (instrument) result.sampleBytes += instrument->sound.getMemoryBytes();
+    }
+
+    AdikWavWriter writer;
+    if (!options.wavDir.empty() && blockFrames == BLOCK_FRAMES) {
+        writer.open(options.wavDir + "/" + project.name + ".wav", info.sampleRate, info.numChannels, AdikSampleFormat::FLOAT32);
+    }
+
+    uint64_t hash = 1469598103934665603ull;
+    double sumSquares = 0.0;
+    float peak = 0.0f;
+    uint64_t voiceBlocks = 0;
+    uint64_t blocks = 0;
+    double windowSquares = 0.0;
+    int64_t windowFrames = 0;
+    const uint64_t allocationsBefore = gAllocations.load();
+    const auto start = std::chrono::steady_clock::now();
+    result.frames = renderer.render(frames, [&](const float* samples, unsigned int numFrames) {
+        const size_t count = static_cast<size_t>(numFrames) * info.numChannels;
+        const unsigned char* bytes = reinterpret_cast<const unsigned char*>(samples);
+        for (size_t i = 0; i < count * sizeof(float); ++i) {
+            hash = (hash ^ bytes[i]) * 1099511628211ull;
+        }
+        for (unsigned int frame = 0; frame < numFrames; ++frame) {
+            for (unsigned int c = 0; c < info.numChannels; ++c) {
+                const float sample = samples[frame * info.numChannels + c];
+                const double square = static_cast<double>(sample) * sample;
+                sumSquares += square;
+                windowSquares += square;
+                peak = std::max(peak, std::fabs(sample));
+            }
+            if (++windowFrames == info.sampleRate) {
+                if (result.windows < MAX_WINDOWS) {
+                    result.windowRms[result.windows++] = static_cast<float>(std::sqrt(windowSquares / (static_cast<double>(windowFrames) * info.numChannels)));
+                }
+                windowSquares = 0.0;
+                windowFrames = 0;
+            }
+        }
+        voiceBlocks += player->mixer.getActiveChannelCount();
+        blocks++;
+        if (writer.isOpen()) writer.write(samples, numFrames);
+    });
+    result.wallMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    result.allocations = gAllocations.load() - allocationsBefore;
+    writer.close();
+
+    result.hash = hash;
+    result.rms = result.frames > 0 ? std::sqrt(sumSquares / (static_cast<double>(result.frames) * info.numChannels)) : 0.0;
+    result.peak = peak;
+    result.activeVoices = blocks ? static_cast<double>(voiceBlocks) / blocks : 0.0;
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    result.rssKb = usage.ru_maxrss;
+    result.ok = 1;
+    return result;
+}
+
+// Lance le rendu dans un processus fils et récupère ses mesures par un tube
+static bool runInChild(const PerfProject& project, const PerfOptions& options, PerfResult& result,
+                       unsigned int blockFrames = BLOCK_FRAMES) {
+    int fds[2];
+    if (pipe(fds) != 0) return false;
+    std::cout.flush();
+    const pid_t pid = fork();
+    if (pid < 0) {
+        close(fds[0]);
+        close(fds[1]);
+        return false;
+    }
+    if (pid == 0) {
+        close(fds[0]);
+        std::cout.rdbuf(nullptr); // Messages du player (pas, mixeur) : ignorés, ils fausseraient le temps de rendu
+        PerfResult childResult = renderProject(project, options, blockFrames);
+        const ssize_t written = write(fds[1], &childResult, sizeof(childResult));
+        close(fds[1]);
+        _exit(written == static_cast<ssize_t>(sizeof(childResult)) ? 0 : 1);
+    }
+    close(fds[1]);
+    size_t received = 0;
+    unsigned char* out = reinterpret_cast<unsigned char*>(&result);
+    while (received < sizeof(result)) {
+        const ssize_t n = read(fds[0], out + received, sizeof(result) - received);
+        if (n <= 0) break;
+        received += static_cast<size_t>(n);
+    }
+    close(fds[0]);
+    int status = 0;
+    waitpid(pid, &status, 0);
+    return received == sizeof(result) && WIFEXITED(status) && WEXITSTATUS(status) == 0 && result.ok;
+}
+
+// ============================================================================
+// Références : une ligne par projet, "nom empreinte rms crête temps_ms rss_kio allocations"
+
+static std::map<std::string, PerfBaseline> loadBaselines(const std::string& path) {
+    std::map<std::string, PerfBaseline> baselines;
+    std::ifstream file(path);
+    std::string line;
+    while (std::getline(file, line)) {
+        if (line.empty() || line[0] == '#') continue;
+        std::istringstream fields(line);
+        std::string name, hashText;
+        PerfBaseline baseline;
+        if (fields >> name >> hashText >> baseline.rms >> baseline.peak >> baseline.wallMs >> baseline.rssKb >> baseline.allocations) {
+            baseline.hash = std::strtoull(hashText.c_str(), nullptr, 16);
+            baselines[name] = baseline;
+        }
+    }
+    return baselines;
+}
+
+static bool saveBaselines(const std::string& path, const std::map<std::string, PerfBaseline>& baselines) {
+    std::ofstream file(path);
+    if (!file) return false;
+    file << "# Références de adikperftest (make perftest-update)\n";
+    file << "# Temps et mémoire dépendent de la machine et des options de compilation : à régénérer en cas de changement\n";
+    file << "# projet empreinte_fnv1a64 rms crête temps_ms rss_kio allocations\n";
+    for (const auto& entry : baselines) {
+        const PerfBaseline& b = entry.second;
+        char line[256];
+        std::snprintf(line, sizeof(line), "%s %016llx %.9g %.9g %.2f %ld %llu\n", entry.first.c_str(),
+                      static_cast<unsigned long long>(b.hash), b.rms, b.peak, b.wallMs, b.rssKb,
+                      static_cast<unsigned long long>(b.allocations));
+        file << line;
+    }
+    return static_cast<bool>(file);
+}
+
+// Compare l'audio du projet à celui de project.sameAudioAs, seconde par seconde (RMS). Les deux sont rendus par
+// petits blocs : par blocs de 512, les pas sont déclenchés au début de leur bloc (callback sans AdikScheduler),
+// alors qu'un rendu figé place ses événements au sample près ; le décalage suffit à changer le mixage des voix.
+static bool checkSameAudio(const PerfProject& project, const PerfOptions& options) {
+    const PerfProject* reference = nullptr;
+    for (const PerfProject& candidate : projects) {
+        if (std::strcmp(candidate.name, project.sameAudioAs) == 0) reference = &candidate;
+    }
+    PerfResult result;
+    PerfResult expected;
+    if (!reference || !runInChild(project, options, result, SAME_AUDIO_BLOCK_FRAMES) ||
+        !runInChild(*reference, options, expected, SAME_AUDIO_BLOCK_FRAMES)) {
+        std::cout << "  ÉCHEC : rendu impossible pour la comparaison avec '" << project.sameAudioAs << "'." << std::endl;
+        return false;
+    }
+    if (expected.frames != result.frames || expected.windows != result.windows) {
+        std::cout << "  ÉCHEC : durée différente de '" << project.sameAudioAs << "'." << std::endl;
+        return false;
+    }
+    double worst = 0.0;
+    int worstWindow = 0;
+    for (int w = 0; w < result.windows; ++w) {
+        const double deviation = std::fabs(result.windowRms[w] - expected.windowRms[w]) / std::max<double>(expected.windowRms[w], 1e-3);
+        if (deviation > worst) {
+            worst = deviation;
+            worstWindow = w;
+        }
+    }
+    char line[256];
+    std::snprintf(line, sizeof(line), "  %s : écart RMS max avec '%s' %.3f %% (seconde %d, tolérance %.1f %%)",
+                  worst <= TRANSPARENCY_TOLERANCE ? "Même audio" : "ÉCHEC", project.sameAudioAs, worst * 100.0, worstWindow,
+                  TRANSPARENCY_TOLERANCE * 100.0);
+    std::cout << line << std::endl;
+    return worst <= TRANSPARENCY_TOLERANCE;
+}
+
+static bool parseOptions(int argc, char* argv[], PerfOptions& options, std::vector<std::string>& selected) {
+    for (int i = 1; i < argc; ++i) {
+        const std::string arg = argv[i];
+        const bool hasValue = i + 1 < argc;
+        if (arg == "--update") options.update = true;
+        else if (arg == "--baselines" && hasValue) options.baselinesPath = argv[++i];
+        else if (arg == "--runs" && hasValue) options.runs = std::max(1, std::atoi(argv[++i]));
+        else if (arg == "--time-threshold" && hasValue) options.timeThreshold = std::atof(argv[++i]);
+        else if (arg == "--rss-threshold" && hasValue) options.rssThreshold = std::atof(argv[++i]);
+        else if (arg == "--alloc-threshold" && hasValue) options.allocThreshold = std::atof(argv[++i]);
+        else if (arg == "--tolerance" && hasValue) options.tolerance = std::atof(argv[++i]);
+        else if (arg == "--wav-dir" && hasValue) options.wavDir = argv[++i];
+        else if (!arg.empty() && arg[0] != '-') selected.push_back(arg);
+        else {
+            std::cerr << "adikperftest: option inconnue ou incomplète: " << arg << std::endl;
+            return false;
+        }
+    }
+    return true;
+}
+
+int main(int argc, char* argv[]) {
+    PerfOptions options;
+    std::vector<std::string> selected;
+    if (!parseOptions(argc, argv, options, selected)) return 2;
+
+    // Sons générés à chaque fois : le cache disque ferait dépendre le rendu de l'historique de la machine
+    setenv("ADIK_SOUND_CACHE_DIR", "none", 1);
+
+    std::map<std::string, PerfBaseline> baselines = loadBaselines(options.baselinesPath);
+    if (baselines.empty() && !options.update) {
+        std::cout << "adikperftest: aucune référence dans '" << options.baselinesPath
+                  << "' (make perftest-update pour les créer)." << std::endl;
+    }
+
+    int failures = 0;
+    for (const PerfProject& project : projects) {
+        if (!selected.empty() && std::find(selected.begin(), selected.end(), project.name) == selected.end()) continue;
+        std::cout << "\n[" << project.name << "] " << project.description << std::endl;
+
+        PerfResult best = {};
+        bool deterministic = true;
+        bool ok = true;
+        for (int run = 0; run < options.runs && ok; ++run) {
+            PerfResult result;
+            if (!runInChild(project, options, result)) {
+                ok = false;
+                break;
+            }
+            if (run == 0) {
+                best = result;
+            } else {
+                deterministic = deterministic && result.hash == best.hash;
+                best.wallMs = std::min(best.wallMs, result.wallMs);
+                best.rssKb = std::min(best.rssKb, result.rssKb);
+                best.allocations = std::min(best.allocations, result.allocations);
+            }
+        }
+        if (!ok) {
+            std::cout << "  ÉCHEC : le rendu n'a pas abouti." << std::endl;
+            ++failures;
+            continue;
+        }
+
+        const double audioSeconds = static_cast<double>(best.frames) / 44100.0;
+        char line[256];
+        std::snprintf(line, sizeof(line), "  %.1f s audio, empreinte %016llx, RMS %.6f, crête %.6f, samples %zu Kio",
+                      audioSeconds, static_cast<unsigned long long>(best.hash), best.rms, best.peak, best.sampleBytes / 1024);
+        std::cout << line << std::endl;
+        std::snprintf(line, sizeof(line), "  rendu %.2f ms (x%.0f temps réel), RSS max %ld Kio, %llu allocation(s) pendant le rendu, %.2f voix actives en moyenne",
+                      best.wallMs, best.wallMs > 0.0 ? audioSeconds * 1000.0 / best.wallMs : 0.0, best.rssKb,
+                      static_cast<unsigned long long>(best.allocations), best.activeVoices);
+        std::cout << line << std::endl;
+
+        bool projectFailed = false;
+        if (!deterministic) {
+            std::cout << "  ÉCHEC : deux rendus du même projet diffèrent (rendu non déterministe)." << std::endl;
+            projectFailed = true;
+        }
+
+        PerfBaseline measured;
+        measured.hash = best.hash;
+        measured.rms = best.rms;
+        measured.peak = best.peak;
+        measured.wallMs = best.wallMs;
+        measured.rssKb = best.rssKb;
+        measured.allocations = best.allocations;
+
+        auto found = baselines.find(project.name);
+        if (options.update) {
+            baselines[project.name] = measured;
+        } else if (found == baselines.end()) {
+            std::cout << "  Pas de référence pour ce projet." << std::endl;
+        } else {
+            const PerfBaseline& b = found->second;
+            if (b.hash != best.hash) {
+                const bool withinTolerance = options.tolerance > 0.0
+                    && std::fabs(best.rms - b.rms) <= options.tolerance * std::max(b.rms, 1e-9)
+                    && std::fabs(best.peak - b.peak) <= options.tolerance * std::max(b.peak, 1e-9);
+                std::snprintf(line, sizeof(line), "  %s : audio modifié (référence %016llx, RMS %.6f, crête %.6f)",
+                              withinTolerance ? "Toléré" : "ÉCHEC", static_cast<unsigned long long>(b.hash), b.rms, b.peak);
+                std::cout << line << std::endl;
+                projectFailed = projectFailed || !withinTolerance;
+            }
+            if (best.wallMs > b.wallMs * (1.0 + options.timeThreshold) && best.wallMs - b.wallMs > 1.0) {
+                std::snprintf(line, sizeof(line), "  ÉCHEC : temps de rendu %.2f ms > référence %.2f ms (+%.0f %%)",
+                              best.wallMs, b.wallMs, (best.wallMs / b.wallMs - 1.0) * 100.0);
+                std::cout << line << std::endl;
+                projectFailed = true;
+            }
+            if (best.rssKb > b.rssKb * (1.0 + options.rssThreshold) && best.rssKb - b.rssKb > 512) {
+                std::cout << "  ÉCHEC : RSS max " << best.rssKb << " Kio > référence " << b.rssKb << " Kio" << std::endl;
+                projectFailed = true;
+            }
+            if (best.allocations > b.allocations * (1.0 + options.allocThreshold)) {
+                std::cout << "  ÉCHEC : " << best.allocations << " allocation(s) pendant le rendu > référence "
+                          << b.allocations << std::endl;
+                projectFailed = true;
+            }
+            if (!projectFailed) std::cout << "  OK" << std::endl;
+        }
+        if (project.sameAudioAs) {
+            projectFailed = !checkSameAudio(project, options) || projectFailed;
+        }
+        if (projectFailed) ++failures;
+    }
+
+    if (options.update) {
+        if (!saveBaselines(options.baselinesPath, baselines)) {
+            std::cerr << "adikperftest: impossible d'écrire '" << options.baselinesPath << "'." << std::endl;
+            return 2;
+        }
+        std::cout << "\nRéférences enregistrées dans '" << options.baselinesPath << "'." << std::endl;
+    }
+    std::cout << "\n" << (failures ? std::to_string(failures) + " projet(s) en régression." : std::string("Aucune régression.")) << std::endl;
+    return failures ? 1 : 0;
+}
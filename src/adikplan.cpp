@@ -11,6 +11,8 @@
 #include "audioengine.h"
 #include "adikplayer.h"
 #include "adiktransport.h" // Inclure la nouvelle classe AdikTransport
+#include "adikscheduler.h"
+#include "adikproject.h"
 #include "utils.h"
 
 #include <iostream>
@@ -154,6 +156,9 @@ void demo2() {
 
 }
 
+// Fichier de projet utilisé par les touches 'w' et 'o'
+const char* PROJECT_FILE_NAME = "adikplan.adkp";
+
 // Fonction displayStatus simplifiée pour utiliser std::cout
 void displayStatus(const std::string& msg) {
     std::cout << "Status: " << msg << std::endl;
@@ -170,6 +175,8 @@ void keyHandler() {
     std::cout << "d: Afficher status du mixeur" << std::endl;
     std::cout << "s: Toggle Séquenceur Play/Stop" << std::endl;
     std::cout << "p: Avancer dans la Séquence (si en mode STEP)" << std::endl;
+    std::cout << "w: Enregistrer le projet (" << PROJECT_FILE_NAME << ")" << std::endl;
+    std::cout << "o: Ouvrir le projet (" << PROJECT_FILE_NAME << ")" << std::endl;
     std::cout << "\n--- Appuyez sur une touche et ENTER ---" << std::endl;
 
     if (gPlayer) {
@@ -204,6 +211,27 @@ void keyHandler() {
                 _msgText = "Démonstration 2 lancée.";
                 displayStatus(_msgText);
                 break;
+            case 'w':
+                if (gPlayer && AdikProject::save(*gPlayer, PROJECT_FILE_NAME)) {
+                    _msgText = std::string("Projet enregistré dans ") + PROJECT_FILE_NAME + ".";
+                } else {
+                    _msgText = "Erreur: Enregistrement du projet impossible.";
+                }
+                displayStatus(_msgText);
+                break;
+            case 'o':
+                if (gPlayer) {
+                    gPlayer->stop(); // Le chargement remplace les séquences : transport arrêté
+                    if (AdikProject::load(*gPlayer, PROJECT_FILE_NAME)) {
+                        _msgText = std::string("Projet ") + PROJECT_FILE_NAME + " chargé.";
+                    } else {
+                        _msgText = "Erreur: Chargement du projet impossible.";
+                    }
+                } else {
+                    _msgText = "Erreur: Player non initialisé.";
+                }
+                displayStatus(_msgText);
+                break;
             case 'v':
                 gPlayer->stop();
                 _msgText = "Séquenceur mis en pause.";
@@ -230,7 +258,8 @@ void keyHandler() {
                 // Gérer les touches de '0' à '9'
                 if (key >= '0' && key <= '9') {
                     int instruIndex = key - '0';
-                    if (gPlayer && instruIndex < gPlayer->instrumentList.size()) {
+                    const std::shared_ptr<AdikKit> kit = gPlayer ? gPlayer->getPublishedKit() : nullptr;
+                    if (kit && instruIndex < static_cast<int>(kit->instruments.size()) && kit->instruments[instruIndex]) {
                         gPlayer->playInstrument(instruIndex);
                         _msgText = "Jouer l'instrument " + std::to_string(instruIndex) + ".";
                     } else {
@@ -259,6 +288,10 @@ int main() {
 
     // 2. Créer une instance de AdikPlayer
     gPlayer->initParams(globalAudioInfo); // Initialiser AdikPlayer avec AudioInfo
+    // Sons par défaut : combien ont été relus depuis le cache disque
+    if (AdikSoundCache* soundCache = AdikSoundCache::getDefault()) {
+        soundCache->printReport();
+    }
 
     // 3. Créer une instance du moteur audio
     AudioEngine audioEngine;
@@ -274,15 +307,23 @@ int main() {
     // 4. Démarrer le flux audio physique via l'AudioEngine
     if (audioEngine.start()) {
         std::cout << "Lecture en cours..." << std::endl;
-        for (size_t i = 0; i < gPlayer->instrumentList.size(); i++) {
-            const auto& instru = gPlayer->instrumentList[i];
+        const std::shared_ptr<AdikKit> kit = gPlayer->getPublishedKit();
+        for (size_t i = 0; kit && i < kit->instruments.size(); i++) {
+            const auto& instru = kit->instruments[i];
+            if (!instru) continue; // Instrument retiré
             std::cout << "Index " << i << ": " << instru->id << " (" << instru->name << ")" << std::endl;
         }
 
-        // 5. Lancer l'interface Console et la gestion des touches
+        // 5. Planifier les événements à l'avance, hors du thread audio
+        AdikScheduler scheduler(gPlayer, 100.0);
+        scheduler.start();
+
+        // 6. Lancer l'interface Console et la gestion des touches
         keyHandler();
 
         gPlayer->stop();
+        scheduler.stop();
+        audioEngine.printInfo(); // Charge DSP et xruns de la session
         audioEngine.stop();
         audioEngine.close();
     } else {
@@ -8,6 +8,7 @@
 #include "AdikSound.h"
 #include "AdikInstrument.h"
 #include "AdikEvent.h"
+#include "AdikEventList.h"
 #include "AdikChannel.h"
 #include "AdikMixer.h"
 #include "AdikTrack.h"
@@ -24,6 +25,7 @@
 - AdikSound
 - AdikInstrument
 - AdikEvent
+- AdikEventList
 - AdikChannel
 - AdikMixer
 - AdikTrack
@@ -32,6 +34,29 @@
 - AudioEngine
 - AdikPlayer
 - adiktransport
+- AdikProject
+- AdikSoundCache
+- AdikControlServer
+- AdikFormatConverter
+- AdikWavWriter
+- AdikXrunMonitor
+- AdikQualityController
+- AdikRealtime
+- AdikOfflineRenderer
+- AdikMeter
+- AdikEnvelope
+- AdikSampleAnalyzer
+- AdikSampleStore
+- AdikKit
+- AdikKitLoader
+- AdikFrozenAudio
+- AdikFreezer
+- AdikVoiceRenderer
+- AdikStemExporter
+- AdikStepGrid
+- AdikHistory
+- AdikInstrumentRegistry
+- AdikProjectState
 */
 
 #endif // ADIKPLAN_H
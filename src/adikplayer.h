@@ -4,12 +4,23 @@
 #include "adikplan.h"
 #include "adiksound.h"
 #include "adikinstrument.h"
+#include "adikkit.h"
+#include "adikinstrumentregistry.h"
+#include "adikprojectstate.h"
+#include "adikfrozen.h"
 #include "adikevent.h"
 #include "adiktrack.h"
 #include "adikchannel.h"
 #include "adikmixer.h"
 #include "adiksequence.h"
 #include "adiksong.h"
+#include "adikclock.h"
+#include "adikxrunmonitor.h"
+#include "adikqualitycontroller.h"
+#include "adikringbuffer.h"
+#include "adikseqlock.h"
+#include "adikvoicetrigger.h"
+#include "adikcontrol.h"
 #include "audioengine.h"
 
 #include <string>
@@ -19,6 +30,40 @@
 #include <iostream>
 #include <chrono>
 #include <thread>
+#include <atomic>
+#include <mutex>
+#include <algorithm> // Pour std::min, std::max
+
+// Instantané de l'état du transport, publié par le thread audio à la fin de chaque bloc.
+// Lu sans verrou par AdikScheduler (et tout autre thread non temps réel).
+struct AdikTimingSnapshot {
+    uint32_t generation;              // Génération de planification au moment de la publication
+    int mode;                         // AdikPlayer::PlaybackMode
+    int selectedSequenceInPlayerIndex;
+    int currentSequenceIndexInSong;
+    int currentStepInSequence;        // Pas qui sera joué à la prochaine frontière (clock.nextStep)
+    bool playing;
+    AdikClock clock;                  // Copie de l'horloge (position, tempo, carte de tempo)
+};
+
+// Instantané pour l'affichage (AdikTUI), publié par le thread audio à la fin de chaque bloc.
+// Taille fixe et copiable par memcpy : lu via AdikSeqLock sans jamais bloquer le thread audio.
+struct AdikDisplaySnapshot {
+    static constexpr int MAX_CHANNELS = AdikMixer::NUM_MIXER_channelList;
+
+    uint64_t block;                   // Numéro du bloc audio
+    int64_t samplePosition;           // Position du transport, en samples
+    double tempoBPM;                  // Tempo effectif
+    float dspLoad;
+    uint64_t xrunCount;               // Incidents de flux depuis le démarrage
+    int qualityLevel;                 // Niveau de AdikQualityController (0 : normal)
+    int mode;                         // AdikPlayer::PlaybackMode
+    int sequenceIndex;                // Séquence de la tête de lecture : dans sequenceList (SEQUENCE) ou dans le morceau (SONG)
+    int playheadStep;                 // Dernier pas joué dans cette séquence (-1 si aucun)
+    bool playing;
+    int numChannels;
+    bool channelActive[MAX_CHANNELS]; // Les niveaux sont dans AdikMixer::meterSnapshot
+};
 
 // --- AdikPlayer.h ---
 // Le moteur principal de la drum machine.
@@ -32,33 +77,122 @@ public:
     };
 
     static const int NUM_SEQS = 16; // Nombre fixe de séquences disponibles pour le Player
-    std::vector<std::shared_ptr<AdikInstrument>> instrumentList; // Tous les instruments disponibles
     std::vector<std::shared_ptr<AdikSequence>> sequenceList;                   // La liste fixe de 16 séquences disponibles pour le Player
     std::shared_ptr<AdikSong> currentSong;                                   // Le morceau actuellement chargé
 
     AdikMixer mixer; // L'instance du mixeur gérée par le Player
 
-    int tempoBPM;                       // Tempo global en BPM
+    double tempoBPM;                    // Tempo global en BPM (fractionnaire)
     unsigned int sampleRate;                     // Taux d'échantillonnage (samples/seconde)
     unsigned int bufferSizeSamples;              // Taille du buffer audio en samples
-    unsigned int samplesPerBeat;              // Nombre de samples par battement (quart de note)
-    unsigned int samplesPerStep;              // Nombre de samples par pas du séquenceur
+    double samplesPerBeat;              // Nombre de samples par battement (quart de note), non tronqué
+    double samplesPerStep;              // Nombre de samples par pas du séquenceur, non tronqué
+
+    AdikClock clock;                    // Horloge musicale sans dérive (lue et avancée par le thread audio)
+    std::atomic<double> pendingTempoBPM; // Tempo demandé par setTempo(), appliqué au prochain bloc audio (0 = aucun)
+
+    // Carte de tempo compilée en cours d'utilisation (morceau en mode SONG, séquence en mode SEQUENCE).
+    // Publiée par refreshTempoMap() via pendingTempoMap, prise en compte par le thread audio au bloc suivant.
+    std::shared_ptr<AdikTempoMap> publishedTempoMap; // tempoMapMutex (voir getPublishedTempoMap)
+    // Anciennes cartes, avec le nombre de blocs traités à leur retrait : libérées hors du thread audio quand
+    // ni l'horloge ni l'instantané de position (AdikTimingSnapshot) ne peuvent plus les désigner (collectRetiredTempoMapsLocked)
+    std::vector<std::pair<std::shared_ptr<AdikTempoMap>, uint64_t>> retiredTempoMaps;
+    std::atomic<const AdikTempoMap*> pendingTempoMap;
+    std::atomic<bool> tempoMapChanged;
+    mutable std::mutex tempoMapMutex;   // Entre les threads qui publient ou lisent la carte publiée
+
+    // Planification anticipée (voir AdikScheduler) :
+    // quand schedulerEnabled est vrai, le thread audio ne parcourt plus les événements,
+    // il dépile les déclenchements horodatés de triggerQueue dont l'instant tombe dans le bloc.
+    AdikRingBuffer<AdikVoiceTrigger> triggerQueue;
+    std::atomic<uint32_t> scheduleGeneration; // Incrémentée à chaque saut de position ou de tempo
+    std::atomic<bool> schedulerEnabled;
+    AdikSeqLock<AdikTimingSnapshot> timingSnapshot;
+    AdikSeqLock<AdikDisplaySnapshot> displaySnapshot;
+
+    // Commandes de contrôle temps réel (voir AdikControlCommand) : un seul producteur (ex. AdikControlServer),
+    // consommées par le thread audio au début de chaque bloc.
+    AdikRingBuffer<AdikControlCommand> controlQueue;
+    std::vector<AdikControlCommand> deferredCommands; // Commandes reçues dont l'instant n'est pas encore atteint
+    static const size_t MAX_DEFERRED_COMMANDS = 256;
+    std::atomic<int64_t> streamSamplePosition;         // Samples produits depuis le démarrage du flux (avance toujours)
+
+    // Statistiques DSP, publiées par le thread audio
+    std::atomic<uint64_t> processedBlocks;
+    std::atomic<float> dspLoad;                        // Durée du dernier bloc / durée audio du bloc
+    std::atomic<float> dspLoadPeak;
+    AdikXrunMonitor xrunMonitor;          // Xruns signalés par le driver (compteurs et derniers incidents)
+    AdikQualityController qualityController; // Dégradation progressive sous surcharge
+    // Analyse des sons au chargement (découpe, crêtes, normalisation), voir AdikSampleAnalyzer
+    AdikSampleAnalysisOptions sampleAnalysisOptions = AdikSampleAnalysisOptions::fromEnvironment();
+
+    // Protège les séquences contre les éditions concurrentes des threads non temps réel
+    // (AdikScheduler qui les lit ; AdikControlServer, populateDemoSequence et les méthodes du morceau qui les modifient).
+    // Jamais pris par le thread audio.
+    std::mutex sequenceEditMutex;
+    // Éditions faites par les méthodes du Player (populateDemoSequence, morceau, publishProject), sous sequenceEditMutex :
+    // AdikHistory repart de l'état actuel quand il en voit une qu'aucune révision ne contient
+    uint64_t sequenceEdits = 0;
+
+    // Kit d'instruments (voir AdikKit) : publié par publishKit() via pendingKit, activé par le thread audio
+    // à la frontière musicale du kit. Le thread audio ne résout les handles que par activeKit.
+    std::shared_ptr<AdikKit> publishedKit;
+    // Anciens kits, avec le nombre de blocs traités à leur retrait : libérés hors du thread audio
+    // quand celui-ci ne peut plus les lire et qu'aucune voix ne joue plus leurs sons (collectRetiredKits)
+    std::vector<std::pair<std::shared_ptr<AdikKit>, uint64_t>> retiredKits;
+    std::atomic<const AdikKit*> pendingKit;
+    std::atomic<const AdikKit*> activeKit;  // Écrit par le thread audio seulement
+    std::atomic<uint64_t> kitSwitches;      // Changements de kit effectués par le thread audio
+    std::mutex kitMutex;                    // Entre les threads qui publient des kits
+
+    // Projet chargé (voir publishProject) : déposé dans pendingProject, adopté par le thread audio au début d'un bloc
+    std::atomic<AdikProjectState*> pendingProject;
+    std::atomic<uint64_t> projectSwaps;     // Projets adoptés par le thread audio
+    std::atomic<bool> streamActive;         // Flux démarré (AudioEngine) : processAudioCallback est appelé par le thread audio
+
+    // Rendus figés (voir AdikFreezer) : publiés dans frozenSlots sous sequenceEditMutex, lus sans verrou par le
+    // thread audio (forEachStepVoice, triggerFrozenVoices). Les pistes d'un rendu publié ne déclenchent plus leurs
+    // événements : une seule voix lit la boucle rendue. Un gel publie un rendu par séquence précédente possible.
+    static constexpr int MAX_FROZEN = 64;
+    std::shared_ptr<AdikFrozenAudio> frozenOwners[MAX_FROZEN];  // Propriétaires des rendus publiés (sequenceEditMutex)
+    std::atomic<const AdikFrozenAudio*> frozenSlots[MAX_FROZEN];
+    // Rendus retirés, avec le nombre de blocs traités à leur retrait : libérés comme les kits (collectRetiredFrozen)
+    std::vector<std::pair<std::shared_ptr<AdikFrozenAudio>, uint64_t>> retiredFrozen;
+    std::atomic<uint32_t> frozenRetirements;   // Incrémenté à chaque retrait : le thread audio coupe les voix périmées
+    std::atomic<uint32_t> locateCount;         // Sauts de position (locateClock) : un rendu figé reprend en cours de boucle
 
     int currentStepInSequence;          // Le pas actuel en cours de lecture dans la séquence
+    int playheadStep;                   // Dernier pas joué (tête de lecture affichée), -1 si aucun
+    int playheadSequenceIndexInSong;    // Index dans le morceau de la séquence de ce pas (mode SONG)
     long long currentSampleInStep;      // Le sample actuel dans le pas courant
     bool _playing;                     // Indique si le séquenceur est en lecture
 
     // Variables de contrôle des modes
-    PlaybackMode currentMode;                   // Mode de lecture actuel
-    int selectedSequenceInPlayerIndex;          // Index de la séquence sélectionnée dans sequenceList (pour SEQUENCE_MODE)
+    // Réglages écrits par les threads non temps réel (setPlaybackMode, selectSequenceInPlayer), lus par le thread audio
+    std::atomic<PlaybackMode> currentMode;      // Mode de lecture actuel
+    std::atomic<int> selectedSequenceInPlayerIndex; // Index de la séquence sélectionnée dans sequenceList (pour SEQUENCE_MODE)
     int currentSequenceIndexInSong;             // Index de la séquence actuellement jouée dans le morceau (pour SONG_MODE)
 
 
-    AdikPlayer() : tempoBPM(120), sampleRate(44100), bufferSizeSamples(512), // Taille de buffer typique
-                     currentStepInSequence(0), currentSampleInStep(0), _playing(false),
+    AdikPlayer() : tempoBPM(120.0), sampleRate(44100), bufferSizeSamples(512), // Taille de buffer typique
+                     pendingTempoBPM(0.0), pendingTempoMap(nullptr), tempoMapChanged(false),
+                     triggerQueue(4096), scheduleGeneration(0), schedulerEnabled(false),
+                     controlQueue(1024), streamSamplePosition(0), processedBlocks(0), dspLoad(0.0f), dspLoadPeak(0.0f),
+                     pendingKit(nullptr), activeKit(nullptr), kitSwitches(0),
+                     pendingProject(nullptr), projectSwaps(0), streamActive(false), frozenRetirements(0), locateCount(0),
+                     currentStepInSequence(0), playheadStep(-1), playheadSequenceIndexInSong(0),
+                     currentSampleInStep(0), _playing(false),
                      currentMode(SEQUENCE_MODE), selectedSequenceInPlayerIndex(0), currentSequenceIndexInSong(0) {
 
         calculateTimingParameters(); // Calculer samplesPerBeat et samplesPerStep
+        for (int i = 0; i < MAX_FROZEN; ++i) {
+            frozenSlots[i].store(nullptr);
+            frozenStarted[i] = nullptr;
+            frozenStartLocate[i] = 0;
+        }
+        frozenRetirementsSeen = 0;
+        precedingSequence = nullptr;
+        deferredCommands.reserve(MAX_DEFERRED_COMMANDS); // Aucune allocation ensuite sur le thread audio
 
         // Initialiser quelques instruments par défaut
         loadDefaultInstruments();
@@ -80,8 +214,7 @@ public:
     void initParams(const AudioInfo& audioInfo) {
         this->sampleRate = audioInfo.sampleRate;
         this->bufferSizeSamples = audioInfo.bufferSize;
-        // Si AdikMixer avait des paramètres audio, ils seraient passés ici
-        // mixer.initParams(audioInfo); // Exemple si AdikMixer avait aussi une telle méthode
+        mixer.initParams(audioInfo); // Nombre de sorties et taille des plans du mixeur
         calculateTimingParameters();
         std::cout << "AdikPlayer: Paramètres audio initialisés." << std::endl;
         audioInfo.display(); // Pour confirmation
@@ -92,26 +225,36 @@ public:
       auto sineSynth = std::make_shared<AdikInstrument>("synth_sine", "Synth Sine 440Hz", "none", 1);
         sineSynth->genTone(AdikInstrument::SINE_WAVE, 440.0f, 44100, 0.5f); // Ajout du paramètre amplitude
         sineSynth->defaultVolume = 0.5f;
+        // Les synthés durent 1 s : l'enveloppe les ramène à une note courte (la voix est libérée à la fin du déclin)
+        sineSynth->envelope = AdikEnvelopeParams::ahdsr(0.002f, 0.05f, 0.3f, 0.0f, 0.05f, 0.5f);
         addInstrument(sineSynth);
 
 
         // /* (vos instruments basés sur fichiers) */
-        addInstrument(std::make_shared<AdikInstrument>("kick_1", "Grosse Caisse", "path/to/kick.wav", 1));
-        addInstrument(std::make_shared<AdikInstrument>("snare_1", "Caisse Claire", "path/to/snare.wav", 1));
-        addInstrument(std::make_shared<AdikInstrument>("hihat_closed_1", "Charley Fermé", "path/to/hihat_closed.wav", 1));
-        addInstrument(std::make_shared<AdikInstrument>("hihat_open_1", "Charley Ouvert", "path/to/hihat_open.wav", 1));
-        addInstrument(std::make_shared<AdikInstrument>("clap_1", "Clap", "path/to/clap.wav", 1));
+        // One-shot : le sample est joué en entier, avec un court relâchement pour éviter un clic en fin de son
+        auto addDrum = [this](const std::string& id, const std::string& name, const std::string& path) {
+            auto drum = std::make_shared<AdikInstrument>(id, name, path, 1);
+            drum->envelope = AdikEnvelopeParams::oneShot(0.0f, 0.005f);
+            addInstrument(drum);
+        };
+        addDrum("kick_1", "Grosse Caisse", "path/to/kick.wav");
+        addDrum("snare_1", "Caisse Claire", "path/to/snare.wav");
+        addDrum("hihat_closed_1", "Charley Fermé", "path/to/hihat_closed.wav");
+        addDrum("hihat_open_1", "Charley Ouvert", "path/to/hihat_open.wav");
+        addDrum("clap_1", "Clap", "path/to/clap.wav");
         // */
         
         // /*
         auto squareSynth = std::make_shared<AdikInstrument>("synth_square", "Synth Square 220Hz", "none", 1);
         squareSynth->genTone(AdikInstrument::SQUARE_WAVE, 220.0f, 44100, 0.5f); // Ajout du paramètre amplitude
         squareSynth->defaultVolume = 0.1f;
+        squareSynth->envelope = AdikEnvelopeParams::ahdsr(0.002f, 0.03f, 0.2f, 0.0f, 0.05f, 0.5f);
         addInstrument(squareSynth);
 
         auto noiseSynth = std::make_shared<AdikInstrument>("synth_noise", "Synth White Noise", "none", 1);
         noiseSynth->genTone(AdikInstrument::WHITE_NOISE_WAVE, 0.0f, 44100, 0.8f); // Amplitude à 0.8 pour le bruit
         noiseSynth->defaultVolume = 0.5f;
+        noiseSynth->envelope = AdikEnvelopeParams::ahdsr(0.001f, 0.0f, 0.15f, 0.0f, 0.05f, 0.5f);
         addInstrument(noiseSynth);
 
         auto sineNoiseSynth = std::make_shared<AdikInstrument>("synth_sineNoise", "Synth Sine Noise", "none", 1);
@@ -119,22 +262,579 @@ public:
         // Les ratios de mélange sont définis DANS combinedSineNoise pour l'instant.
         sineNoiseSynth->genTone(AdikInstrument::COMBINED_SINE_NOISE_WAVE, 440.0f, 44100);
         sineNoiseSynth->defaultVolume = 0.5f;
+        sineNoiseSynth->envelope = AdikEnvelopeParams::ahdsr(0.002f, 0.05f, 0.25f, 0.0f, 0.05f, 0.5f);
         addInstrument(sineNoiseSynth);
         // */
 
+        // Découpe des silences et cache de crêtes, en parallèle sur tous les sons
+        std::vector<std::shared_ptr<AdikInstrument>> instruments = getInstrumentRegistry().getSlots();
+        AdikSampleAnalyzer::analyzeAll(instruments, sampleAnalysisOptions);
+        publishInstruments("défaut");
 
         std::cout << "AdikPlayer: Instruments par défaut chargés." << std::endl;
     }
     //
     // Calculer les paramètres de timing basés sur le tempo et le sample rate
+    // Ne pas appeler pendant la lecture : utiliser setTempo() qui est sûr vis-à-vis du thread audio.
     void calculateTimingParameters() {
-        // 60 secondes/minute * sampleRate (samples/seconde) / tempoBPM (battements/minute) = samples/battement
-        samplesPerBeat = (double)sampleRate * 60.0 / tempoBPM;
         // Un pas est un 16ème de note dans notre cas (16 pas par mesure = 4 battements, donc 1 pas = 1/4 de battement)
-        samplesPerStep = samplesPerBeat / 4.0; // Si stepsPerMeasure est 16, et 4 battements/mesure
+        clock.setSampleRate(sampleRate);
+        clock.setTempo(tempoBPM);
+        // 60 secondes/minute * sampleRate (samples/seconde) / tempoBPM (battements/minute) = samples/battement
+        samplesPerBeat = clock.getSamplesPerBeat();
+        samplesPerStep = clock.getSamplesPerStep();
+        refreshTempoMap(); // La table dépend du taux d'échantillonnage
         std::cout << "Timing: Samples par battement = " << samplesPerBeat << ", Samples par pas = " << samplesPerStep << std::endl;
     }
 
+    // Change le tempo pendant la lecture.
+    // Le changement est publié atomiquement et appliqué par le thread audio au début du prochain bloc.
+    void setTempo(double bpm) {
+        if (bpm <= 0.0) {
+            std::cerr << "Erreur: Tempo invalide: " << bpm << std::endl;
+            return;
+        }
+        tempoBPM = bpm;
+        pendingTempoBPM.store(bpm);
+    }
+
+    // Appelé par le thread audio au début de chaque bloc
+    void applyPendingTempo() {
+        double bpm = pendingTempoBPM.exchange(0.0);
+        if (bpm > 0.0) applyClockTempo(bpm);
+        if (tempoMapChanged.exchange(false)) {
+            clock.setTempoMap(pendingTempoMap.load());
+            invalidateSchedule();
+        }
+    }
+
+    // Thread audio uniquement : change le tempo de l'horloge et les durées qui en dérivent, sans E/S.
+    // Le tempo global (tempoBPM), écrit par les threads non temps réel, n'est pas modifié.
+    void applyClockTempo(double bpm) {
+        clock.setTempo(bpm);
+        samplesPerBeat = clock.getSamplesPerBeat();
+        samplesPerStep = clock.getSamplesPerStep();
+        invalidateSchedule();
+    }
+
+    // Publie un kit : le thread audio l'active à sa frontière (AdikKit::boundary), les voix en cours
+    // finissent sur l'ancien. Le registre reprend les emplacements du kit. Threads non temps réel.
+    void publishKit(std::shared_ptr<AdikKit> kit) {
+        if (!kit) return;
+        std::lock_guard<std::mutex> lock(kitMutex);
+        adoptKitLocked(kit);
+        pendingKit.store(kit.get(), std::memory_order_release);
+        collectRetiredKitsLocked();
+    }
+
+    // Fait adopter un projet lu par AdikProject::read : kit, séquences, morceau, mode et tempo, transport arrêté au début.
+    // Flux démarré, le projet est déposé pour le thread audio, qui l'adopte au début de son prochain bloc
+    // (applyPendingProject) ; sinon il est adopté ici. Après adoption, 'state' contient l'ancien projet, libéré par
+    // l'appelant. Faux si le thread audio ne l'a pas pris avant 'timeout' : le Player est inchangé.
+    // Threads non temps réel ; prend sequenceEditMutex puis kitMutex (aucun kit n'est publié pendant l'échange).
+    bool publishProject(const std::shared_ptr<AdikProjectState>& state,
+                        std::chrono::milliseconds timeout = std::chrono::milliseconds(500)) {
+        if (!state || !state->kit) return false;
+        std::lock_guard<std::mutex> editLock(sequenceEditMutex);
+        std::lock_guard<std::mutex> kitLock(kitMutex);
+        sequenceEdits++;
+        const bool direct = !streamActive.load();
+        if (direct) {
+            applyProject(*state);
+        } else {
+            const uint64_t swaps = projectSwaps.load(std::memory_order_acquire);
+            pendingProject.store(state.get(), std::memory_order_release);
+            const auto deadline = std::chrono::steady_clock::now() + timeout;
+            while (projectSwaps.load(std::memory_order_acquire) == swaps) {
+                if (std::chrono::steady_clock::now() >= deadline) {
+                    AdikProjectState* expected = state.get();
+                    if (pendingProject.compare_exchange_strong(expected, nullptr)) {
+                        std::cerr << "AdikPlayer: Projet '" << state->name << "' non adopté, le thread audio ne répond pas." << std::endl;
+                        return false;
+                    }
+                    // Pris entre-temps par le thread audio : adopté dans son bloc en cours
+                }
+                std::this_thread::sleep_for(std::chrono::microseconds(200));
+            }
+        }
+        // Le kit du projet est déjà actif (applyProject) : il devient le kit publié sans nouvelle activation
+        adoptKitLocked(state->kit);
+        collectRetiredKitsLocked();
+        if (state->tempoBPM > 0.0) setTempo(state->tempoBPM);
+        if (direct) {
+            calculateTimingParameters(); // Recompile aussi la carte de tempo
+        } else {
+            refreshTempoMap();
+        }
+        return true;
+    }
+
+    // Appelé par le thread audio au début de chaque bloc : adopte le projet déposé par publishProject
+    void applyPendingProject() {
+        AdikProjectState* state = pendingProject.exchange(nullptr, std::memory_order_acq_rel);
+        if (!state) return;
+        applyProject(*state);
+        projectSwaps.fetch_add(1, std::memory_order_release);
+    }
+
+    // Kit publié : instantané immuable des instruments, indexés par handle (nullptr : emplacement libre).
+    // C'est lui que lisent les interfaces pour lister ou jouer les instruments.
+    std::shared_ptr<AdikKit> getPublishedKit() {
+        std::lock_guard<std::mutex> lock(kitMutex);
+        return publishedKit;
+    }
+
+    // Libère les kits retirés devenus inutiles ; renvoie le nombre de kits encore gardés. Threads non temps réel.
+    size_t collectRetiredKits() {
+        std::lock_guard<std::mutex> lock(kitMutex);
+        return collectRetiredKitsLocked();
+    }
+
+    // Appelé par le thread audio : kit en attente à activer maintenant, ou nullptr.
+    // Hors d'un pas (sequence nul), seul un kit IMMEDIATE ou un transport arrêté n'attend pas sa frontière.
+    const AdikKit* dueKit(const AdikSequence* sequence) const {
+        const AdikKit* kit = pendingKit.load(std::memory_order_acquire);
+        if (!kit || kit == activeKit.load(std::memory_order_relaxed)) return nullptr;
+        if (kit->boundary == AdikKit::IMMEDIATE || !_playing) return kit;
+        return (sequence && kit->isBoundary(currentStepInSequence, *sequence, clock.stepsPerBeat)) ? kit : nullptr;
+    }
+
+    // Adopte un projet : thread audio (applyPendingProject), ou publishProject flux arrêté. Ni verrou, ni allocation,
+    // ni libération : les séquences et le morceau sont échangés avec ceux de 'state', le kit du projet est activé.
+    // kitMutex est tenu par publishProject : pendingKit n'a pas d'autre écrivain pendant l'échange.
+    void applyProject(AdikProjectState& state) {
+        sequenceList.swap(state.sequenceList);
+        currentSong.swap(state.song);
+        currentMode = state.playbackMode == SONG_MODE ? SONG_MODE : SEQUENCE_MODE;
+        selectedSequenceInPlayerIndex = state.selectedSequenceInPlayerIndex;
+        currentSequenceIndexInSong = 0;
+        _playing = false;
+        resetPosition();
+        pendingKit.store(state.kit.get(), std::memory_order_release);
+        activateKit(state.kit.get());
+    }
+
+    // Appelé par le thread audio : une seule écriture de pointeur, ni chargement ni allocation
+    void activateKit(const AdikKit* kit) {
+        activeKit.store(kit, std::memory_order_release);
+        kitSwitches.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    // Publie un rendu figé, à la place de celui de même piste (ou séquence) et de même séquence précédente s'il existe.
+    // sequenceEditMutex pris par l'appelant : AdikScheduler lit les emplacements sous ce verrou.
+    // Faux si tous les emplacements sont occupés.
+    bool publishFrozen(std::shared_ptr<AdikFrozenAudio> frozen) {
+        if (!frozen || !frozen->voice) return false;
+        int slot = -1;
+        for (int i = 0; i < MAX_FROZEN && slot < 0; ++i) {
+            if (frozenOwners[i] && frozenOwners[i]->sequence == frozen->sequence && frozenOwners[i]->trackIndex == frozen->trackIndex &&
+                frozenOwners[i]->predecessor == frozen->predecessor) {
+                slot = i;
+            }
+        }
+        for (int i = 0; i < MAX_FROZEN && slot < 0; ++i) {
+            if (!frozenOwners[i]) slot = i;
+        }
+        if (slot < 0) {
+            std::cerr << "AdikPlayer: Nombre maximal de rendus figés atteint (" << MAX_FROZEN << ")." << std::endl;
+            return false;
+        }
+        retireFrozenSlot(slot);
+        frozenOwners[slot] = frozen;
+        frozenSlots[slot].store(frozen.get(), std::memory_order_release);
+        invalidateSchedule(); // Les déclenchements déjà planifiés de ces pistes ne doivent plus jouer
+        collectRetiredFrozenLocked();
+        return true;
+    }
+
+    // Retire les rendus figés d'une piste (ou de la séquence entière), pour toutes les séquences précédentes :
+    // ses événements rejouent dès le pas suivant. sequenceEditMutex pris par l'appelant.
+    bool unpublishFrozen(const AdikSequence* sequence, int trackIndex) {
+        bool found = false;
+        for (int i = 0; i < MAX_FROZEN; ++i) {
+            if (frozenOwners[i] && frozenOwners[i]->sequence == sequence && frozenOwners[i]->trackIndex == trackIndex) {
+                retireFrozenSlot(i);
+                found = true;
+            }
+        }
+        if (found) {
+            invalidateSchedule();
+            collectRetiredFrozenLocked();
+        }
+        return found;
+    }
+
+    // Libère les rendus retirés devenus inutiles ; renvoie le nombre de rendus encore gardés.
+    // sequenceEditMutex pris par l'appelant.
+    size_t collectRetiredFrozenLocked() {
+        const uint64_t blocks = processedBlocks.load();
+        size_t kept = 0;
+        for (size_t i = 0; i < retiredFrozen.size(); ++i) {
+            // Lisible par le thread audio pendant deux blocs, puis tenu par une voix tant qu'elle le joue
+            const bool keep = blocks < retiredFrozen[i].second + 2 || retiredFrozen[i].first->voice.use_count() > 1;
+            if (keep) {
+                if (kept != i) retiredFrozen[kept] = std::move(retiredFrozen[i]);
+                kept++;
+            }
+        }
+        retiredFrozen.resize(kept);
+        return kept;
+    }
+
+    // Vrai si 'frozen' est publié (comparaison de pointeurs seulement). Tout thread.
+    bool isFrozenPublished(const AdikFrozenAudio* frozen) const {
+        for (int i = 0; i < MAX_FROZEN; ++i) {
+            if (frozen && frozenSlots[i].load(std::memory_order_acquire) == frozen) return true;
+        }
+        return false;
+    }
+
+    // Pistes de 'sequence' remplacées par un rendu figé publié (voir AdikFrozenAudio::trackMask)
+    uint64_t frozenTrackMask(const AdikSequence* sequence) const {
+        uint64_t mask = 0;
+        for (int i = 0; i < MAX_FROZEN; ++i) {
+            const AdikFrozenAudio* frozen = frozenSlots[i].load(std::memory_order_acquire);
+            if (frozen && frozen->sequence == sequence) mask |= frozen->trackMask();
+        }
+        return mask;
+    }
+
+    // Appelé par le thread audio à chaque pas de 'sequence', avant ses déclenchements : lance la voix de ses rendus
+    // figés, celui rendu après la séquence qui a réellement précédé (precedingSequence) ou, à défaut, celui rendu
+    // depuis le silence. Au pas 0 la boucle repart du début ; ailleurs, un rendu qui n'a pas encore joué depuis sa
+    // publication ou le dernier saut de position reprend au pas courant. Une voix coupée ensuite (autre piste sur le
+    // même canal, polyphonie limitée) reste coupée jusqu'à la boucle suivante, comme le serait un événement.
+    void triggerFrozenVoices(const AdikSequence* sequence, unsigned int startOffsetFrames) {
+        const uint32_t locates = locateCount.load(std::memory_order_relaxed);
+        const AdikFrozenAudio* candidates[MAX_FROZEN];
+        for (int i = 0; i < MAX_FROZEN; ++i) {
+            const AdikFrozenAudio* frozen = frozenSlots[i].load(std::memory_order_acquire);
+            candidates[i] = (frozen && frozen->sequence == sequence) ? frozen : nullptr;
+        }
+        auto rank = [this](const AdikFrozenAudio* frozen) {
+            return frozen->predecessor == precedingSequence ? 0 : (frozen->predecessor == nullptr ? 1 : 2);
+        };
+        for (int i = 0; i < MAX_FROZEN; ++i) {
+            const AdikFrozenAudio* frozen = candidates[i];
+            if (!frozen) continue;
+            bool chosen = true;
+            for (int j = 0; j < MAX_FROZEN && chosen; ++j) {
+                const AdikFrozenAudio* other = candidates[j];
+                if (j == i || !other || other->trackIndex != frozen->trackIndex) continue;
+                chosen = rank(frozen) < rank(other) || (rank(frozen) == rank(other) && i < j);
+            }
+            if (!chosen) continue;
+            const bool started = frozenStarted[i] == frozen && frozenStartLocate[i] == locates;
+            if (started && currentStepInSequence != 0) continue;
+            const size_t position = frozen->positionForStep(currentStepInSequence);
+            if (position >= frozen->voice->sound.getNumSamples()) continue;
+            frozenStarted[i] = frozen;
+            frozenStartLocate[i] = locates;
+            mixer.routeSound(frozen->mixerChannelIndex, frozen->voice, 1.0f, 0.0f, 0.0f, startOffsetFrames, position);
+        }
+    }
+
+    // Appelé par le thread audio au début de chaque bloc : après un retrait, coupe les voix qui lisent un rendu
+    // figé qui n'est plus publié (événements modifiés) ; les événements de ces pistes ont repris.
+    void stopStaleFrozenVoices() {
+        const uint32_t retirements = frozenRetirements.load(std::memory_order_acquire);
+        if (retirements == frozenRetirementsSeen) return;
+        frozenRetirementsSeen = retirements;
+        for (auto& channel : mixer.channelList) {
+            if (!channel.isActive || !channel.currentInstrument || !channel.currentInstrument->frozen) continue;
+            bool published = false;
+            for (int i = 0; i < MAX_FROZEN && !published; ++i) {
+                const AdikFrozenAudio* frozen = frozenSlots[i].load(std::memory_order_acquire);
+                published = frozen && frozen->voice.get() == channel.currentInstrument.get();
+            }
+            if (!published) channel.isActive = false; // L'instrument reste tenu : il sera libéré hors du thread audio
+        }
+    }
+
+    // Invalide les déclenchements déjà planifiés (saut de position, changement de tempo...)
+    void invalidateSchedule() {
+        scheduleGeneration.fetch_add(1);
+    }
+
+    // Publie l'état du transport pour les threads non temps réel (appelé par le thread audio)
+    void publishTimingSnapshot() {
+        AdikTimingSnapshot snapshot;
+        snapshot.generation = scheduleGeneration.load();
+        snapshot.mode = currentMode;
+        snapshot.selectedSequenceInPlayerIndex = selectedSequenceInPlayerIndex;
+        snapshot.currentSequenceIndexInSong = currentSequenceIndexInSong;
+        snapshot.currentStepInSequence = currentStepInSequence;
+        snapshot.playing = _playing;
+        snapshot.clock = clock;
+        timingSnapshot.write(snapshot);
+    }
+
+    // Publie l'état affiché par les interfaces (appelé par le thread audio, après le mixage)
+    void publishDisplaySnapshot() {
+        AdikDisplaySnapshot snapshot;
+        snapshot.block = processedBlocks.load(std::memory_order_relaxed);
+        snapshot.samplePosition = clock.samplePosition;
+        snapshot.tempoBPM = clock.tempoBPM;
+        if (clock.tempoMap) {
+            const double stepPosition = std::fmod(clock.tempoMap->stepPositionAtSample(clock.samplePosition),
+                                                  static_cast<double>(clock.tempoMap->compiledTotalSteps));
+            snapshot.tempoBPM = clock.tempoMap->tempoAtStep(stepPosition);
+        }
+        snapshot.dspLoad = dspLoad.load(std::memory_order_relaxed);
+        snapshot.xrunCount = xrunMonitor.getIncidentCount();
+        snapshot.qualityLevel = qualityController.getLevel();
+        snapshot.mode = currentMode;
+        snapshot.sequenceIndex = currentMode == SONG_MODE ? playheadSequenceIndexInSong : selectedSequenceInPlayerIndex.load();
+        snapshot.playheadStep = playheadStep;
+        snapshot.playing = _playing;
+        snapshot.numChannels = std::min(static_cast<int>(mixer.channelList.size()), AdikDisplaySnapshot::MAX_CHANNELS);
+        for (int i = 0; i < AdikDisplaySnapshot::MAX_CHANNELS; ++i) {
+            const bool exists = i < snapshot.numChannels;
+            snapshot.channelActive[i] = exists && mixer.channelList[i].isActive;
+        }
+        displaySnapshot.write(snapshot);
+    }
+
+    // Déclenche les voix planifiées dont l'instant tombe dans [blockStart, blockStart + numFrames).
+    // Les déclenchements en retard sont joués au début du bloc, ceux d'une ancienne génération sont ignorés.
+    void dispatchScheduledTriggers(int64_t blockStart, unsigned int numFrames) {
+        const uint32_t generation = scheduleGeneration.load();
+        const int64_t blockEnd = blockStart + numFrames;
+        AdikVoiceTrigger trigger;
+        while (triggerQueue.peek(trigger)) {
+            if (trigger.generation != generation) {
+                triggerQueue.discard();
+                continue;
+            }
+            if (trigger.sampleTime >= blockEnd) {
+                break;
+            }
+            triggerQueue.discard();
+            std::shared_ptr<AdikInstrument> instrument = getInstrumentByHandle(trigger.instrument);
+            if (instrument) {
+                unsigned int offset = trigger.sampleTime > blockStart ? static_cast<unsigned int>(trigger.sampleTime - blockStart) : 0;
+                mixer.routeSound(trigger.mixerChannelIndex, instrument, trigger.velocity, trigger.pan, trigger.pitch, offset);
+            }
+        }
+    }
+
+    // Exécute les commandes de contrôle dont l'instant tombe avant la fin du bloc [blockStart, blockStart + numFrames)
+    // (instants en samples du flux). Les commandes futures sont mises de côté jusqu'à leur bloc.
+    // Appelé par le thread audio au début de chaque bloc.
+    void applyControlCommands(int64_t blockStart, unsigned int numFrames) {
+        const int64_t blockEnd = blockStart + numFrames;
+        AdikControlCommand command;
+        while (deferredCommands.size() < MAX_DEFERRED_COMMANDS && controlQueue.pop(command)) {
+            deferredCommands.push_back(command);
+        }
+        size_t kept = 0;
+        for (size_t i = 0; i < deferredCommands.size(); ++i) {
+            const AdikControlCommand& pending = deferredCommands[i];
+            if (pending.sampleTime >= blockEnd) {
+                deferredCommands[kept++] = pending;
+                continue;
+            }
+            const unsigned int offset = pending.sampleTime > blockStart ? static_cast<unsigned int>(pending.sampleTime - blockStart) : 0;
+            executeControlCommand(pending, offset);
+        }
+        deferredCommands.resize(kept);
+    }
+
+    void executeControlCommand(const AdikControlCommand& command, unsigned int offset) {
+        switch (command.type) {
+            case AdikControlCommand::TRIGGER: {
+                std::shared_ptr<AdikInstrument> instrument = getInstrumentByHandle(command.instrument);
+                if (instrument) {
+                    mixer.routeSound(command.mixerChannelIndex, instrument, command.velocity, command.pan, command.pitch, offset);
+                }
+                break;
+            }
+            case AdikControlCommand::PLAY:
+                if (currentMode == SEQUENCE_MODE || (currentSong && !currentSong->sequences.empty())) {
+                    _playing = true;
+                }
+                break;
+            case AdikControlCommand::PAUSE:
+                _playing = false;
+                break;
+            case AdikControlCommand::STOP:
+                _playing = false;
+                resetPosition();
+                break;
+            case AdikControlCommand::LOCATE:
+                locateStep(static_cast<int>(command.step));
+                break;
+            case AdikControlCommand::TEMPO: // Validé par l'émetteur (> 0, fini)
+                applyClockTempo(command.bpm);
+                break;
+            case AdikControlCommand::RESET:
+                resetPosition();
+                break;
+            default:
+                break;
+        }
+    }
+
+    // Publie une commande vers le thread audio (producteur unique). Renvoie false si la file est pleine.
+    bool postControlCommand(const AdikControlCommand& command) {
+        return controlQueue.push(command);
+    }
+
+    // Commande de transport d'un thread non temps réel (AdikTransport, changement de mode ou de séquence).
+    // La position (horloge, pas et séquence courants) n'est écrite que par le thread audio : flux démarré, la
+    // commande lui est transmise pour le début de son prochain bloc ; sinon elle est exécutée ici.
+    // Faux si la file est pleine.
+    bool postTransportCommand(uint32_t type, int64_t step = 0) {
+        AdikControlCommand command{};
+        command.type = type;
+        command.sampleTime = AdikControlCommand::IMMEDIATE;
+        command.step = step;
+        if (!streamActive.load()) {
+            executeControlCommand(command, 0);
+            return true;
+        }
+        return postControlCommand(command);
+    }
+
+    // Recompile la carte de tempo applicable au mode courant et la publie au thread audio.
+    // À appeler après toute modification d'une carte de tempo ou de la structure du morceau. Threads non temps réel.
+    void refreshTempoMap() {
+        publishTempoMap(compileTempoMap(currentMode, currentSong.get(),
+                                        (selectedSequenceInPlayerIndex >= 0 && selectedSequenceInPlayerIndex < static_cast<int>(sequenceList.size()))
+                                        ? sequenceList[selectedSequenceInPlayerIndex].get() : nullptr));
+    }
+
+    // Carte de tempo compilée du morceau (mode SONG) ou de la séquence (mode SEQUENCE), nullptr si vide : tempo global
+    std::shared_ptr<AdikTempoMap> compileTempoMap(PlaybackMode mode, const AdikSong* song, const AdikSequence* sequence) const {
+        std::shared_ptr<AdikTempoMap> map;
+        if (mode == SONG_MODE) {
+            if (song) {
+                map = std::make_shared<AdikTempoMap>(song->buildTempoMap());
+                map->compile(song->getTotalSteps(), sampleRate, clock.stepsPerBeat);
+            }
+        } else if (sequence) {
+            map = std::make_shared<AdikTempoMap>(sequence->tempoMap);
+            map->compile(sequence->lengthInSteps, sampleRate, clock.stepsPerBeat);
+        }
+        return map && map->isCompiled() ? map : nullptr;
+    }
+
+    // Publie une carte compilée (ou nullptr) au thread audio ; l'ancienne est retirée. Threads non temps réel.
+    void publishTempoMap(std::shared_ptr<AdikTempoMap> map) {
+        std::lock_guard<std::mutex> lock(tempoMapMutex);
+        if (!map && !publishedTempoMap) {
+            collectRetiredTempoMapsLocked();
+            return;
+        }
+        if (publishedTempoMap) {
+            retiredTempoMaps.emplace_back(publishedTempoMap, processedBlocks.load());
+        }
+        publishedTempoMap = map;
+        pendingTempoMap.store(map.get());
+        tempoMapChanged.store(true);
+        collectRetiredTempoMapsLocked();
+    }
+
+    std::shared_ptr<AdikTempoMap> getPublishedTempoMap() const {
+        std::lock_guard<std::mutex> lock(tempoMapMutex);
+        return publishedTempoMap;
+    }
+
+    // Lit l'instantané de position et retient la carte de tempo de son horloge : 'map' la garde en vie tant que
+    // l'appelant le tient (snapshot.clock.tempoMap == map.get()). Lus ensemble sous tempoMapMutex, aucune carte ne
+    // peut être libérée entre les deux. Faux si aucun bloc n'a été traité, ou si la carte n'est plus connue.
+    bool readTimingSnapshot(AdikTimingSnapshot& snapshot, std::shared_ptr<const AdikTempoMap>& map) const {
+        std::lock_guard<std::mutex> lock(tempoMapMutex);
+        map.reset();
+        if (!timingSnapshot.read(snapshot)) return false;
+        if (!snapshot.clock.tempoMap) return true;
+        if (publishedTempoMap.get() == snapshot.clock.tempoMap) {
+            map = publishedTempoMap;
+            return true;
+        }
+        for (const auto& retired : retiredTempoMaps) {
+            if (retired.first.get() == snapshot.clock.tempoMap) {
+                map = retired.first;
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // Tempo effectif à la position courante (carte de tempo si présente, sinon tempo global).
+    // La position vient de l'instantané publié par le thread audio (début du morceau avant le premier bloc).
+    double getCurrentTempo() const {
+        AdikTimingSnapshot snapshot;
+        std::shared_ptr<const AdikTempoMap> map;
+        int64_t position = 0;
+        if (readTimingSnapshot(snapshot, map)) {
+            position = snapshot.clock.samplePosition;
+        } else {
+            map = getPublishedTempoMap();
+        }
+        if (map && map->isCompiled()) {
+            double stepPosition = map->stepPositionAtSample(position);
+            stepPosition = std::fmod(stepPosition, static_cast<double>(map->compiledTotalSteps));
+            return map->tempoAtStep(stepPosition);
+        }
+        return tempoBPM;
+    }
+
+    // Sauts de position : thread audio (executeControlCommand), ou flux arrêté. Les autres threads passent
+    // par postTransportCommand (LOCATE, RESET, STOP).
+
+    // Replace l'horloge au début du pas absolu donné (pas dans la séquence, ou dans le morceau en mode SONG)
+    void locateClock(long long absoluteStep) {
+        clock.locateStep(absoluteStep);
+        precedingSequence = nullptr;
+        currentSampleInStep = 0;
+        locateCount.fetch_add(1, std::memory_order_relaxed);
+        invalidateSchedule();
+    }
+
+    // Revient au début de la séquence (ou du morceau)
+    void resetPosition() {
+        currentStepInSequence = 0;
+        playheadStep = -1;
+        currentSampleInStep = 0;
+        if (currentMode == SONG_MODE) {
+            currentSequenceIndexInSong = 0;
+        }
+        locateClock(0);
+    }
+
+    // Place la lecture au pas absolu donné (dans la séquence, ou dans le morceau en mode SONG),
+    // borné à la longueur courante. Renvoie le pas retenu, ou -1 s'il n'y a rien à jouer.
+    int locateStep(int step) {
+        std::shared_ptr<AdikSequence> currentSeq = getCurrentPlayingSequence();
+        if (!currentSeq) return -1;
+        const int maxSteps = (currentMode == SEQUENCE_MODE) ? currentSeq->lengthInSteps : currentSong->getTotalSteps();
+        const int targetStep = std::max(0, std::min(step, maxSteps - 1));
+        if (currentMode == SONG_MODE) {
+            int seqIndex = 0;
+            int stepInSeq = 0;
+            currentSong->getSequenceAndStepFromAbsoluteStep(targetStep, seqIndex, stepInSeq);
+            currentSequenceIndexInSong = seqIndex;
+            currentStepInSequence = stepInSeq;
+        } else {
+            currentStepInSequence = targetStep;
+        }
+        locateClock(targetStep); // Réinitialise aussi le sample dans le pas
+        return targetStep;
+    }
+
+    // Renvoie la séquence en cours de lecture selon le mode, ou nullptr
+    std::shared_ptr<AdikSequence> getCurrentPlayingSequence() const {
+        if (currentMode == SEQUENCE_MODE) {
+            if (selectedSequenceInPlayerIndex >= 0 && selectedSequenceInPlayerIndex < static_cast<int>(sequenceList.size())) {
+                return sequenceList[selectedSequenceInPlayerIndex];
+            }
+        } else if (currentSong && currentSequenceIndexInSong >= 0 && currentSequenceIndexInSong < static_cast<int>(currentSong->sequences.size())) {
+            return currentSong->sequences[currentSequenceIndexInSong];
+        }
+        return nullptr;
+    }
+
     // Fonction utilitaire pour peupler une séquence de démonstration
     // Prend en compte le nombre de mesures et de pas par mesure.
     void populateDemoSequence(std::shared_ptr<AdikSequence> seq_ptr, const std::string& name,
@@ -142,84 +842,174 @@ public:
                                   const std::string& hihatClosedId, const std::string& additionalId,
                                   int numMeasures, int spm) {
         if (!seq_ptr) return; // Sécurité
+        std::lock_guard<std::mutex> lock(sequenceEditMutex); // AdikScheduler peut lire la séquence
+        sequenceEdits++;
 
         seq_ptr->name = name;
         seq_ptr->stepsPerMeasure = spm;
         seq_ptr->numberOfMeasures = numMeasures;
         seq_ptr->lengthInSteps = seq_ptr->numberOfMeasures * seq_ptr->stepsPerMeasure;
 
+        // Résoudre une seule fois les handles des instruments utilisés
+        const AdikInstrumentHandle kickHandle = getInstrumentHandle(kickId);
+        const AdikInstrumentHandle snareHandle = getInstrumentHandle(snareId);
+        const AdikInstrumentHandle hihatClosedHandle = getInstrumentHandle(hihatClosedId);
+        const AdikInstrumentHandle additionalHandle = getInstrumentHandle(additionalId);
+
         // Vider les événements de toutes les pistes de la séquence avant de les remplir
         for(auto& track : seq_ptr->tracks) {
             track.events.clear();
         }
 
+        // Chaque piste est écrite sous forme de grille de pas (une mesure, recopiée sur les suivantes)
+        const int length = seq_ptr->lengthInSteps;
+
         // Piste 1: Grosse Caisse (assignée au canal 1 du mixeur par défaut)
         AdikTrack& kickTrack = seq_ptr->getTrack(0);
         kickTrack.name = "Kick";
         kickTrack.mixerChannelIndex = 1; // Explicitly assign to channel 1
-        for (int m = 0; m < numMeasures; ++m) {
-            kickTrack.addEvent(getInstrument(kickId), m * spm + 0);  // Début de chaque mesure
-            kickTrack.addEvent(getInstrument(kickId), m * spm + 8);  // Milieu de chaque mesure
-        }
+        AdikStepGrid kickGrid(kickHandle, length, spm);
+        kickGrid.set(0);  // Début de chaque mesure
+        kickGrid.set(8);  // Milieu de chaque mesure
+        kickGrid.repeatMeasure(0);
+        kickTrack.applyStepGrid(kickGrid);
 
         // Piste 2: Caisse Claire (assignée au canal 2 du mixeur par défaut)
         AdikTrack& snareTrack = seq_ptr->getTrack(1);
         snareTrack.name = "Snare";
         snareTrack.mixerChannelIndex = 2; // Explicitly assign to channel 2
-        for (int m = 0; m < numMeasures; ++m) {
-            snareTrack.addEvent(getInstrument(snareId), m * spm + 4);  // 5ème pas de chaque mesure
-            snareTrack.addEvent(getInstrument(snareId), m * spm + 12); // 13ème pas de chaque mesure
-        }
+        AdikStepGrid snareGrid(snareHandle, length, spm);
+        snareGrid.set(4);  // 5ème pas de chaque mesure
+        snareGrid.set(12); // 13ème pas de chaque mesure
+        snareGrid.repeatMeasure(0);
+        snareTrack.applyStepGrid(snareGrid);
 
         // Piste 3: Charley Fermé (assignée au canal 3 du mixeur par défaut)
         AdikTrack& hihatClosedTrack = seq_ptr->getTrack(2);
         hihatClosedTrack.name = "Hi-Hat Fermé";
         hihatClosedTrack.mixerChannelIndex = 3; // Explicitly assign to channel 3
-        for (int m = 0; m < numMeasures; ++m) {
-            for (int i = 0; i < spm; ++i) {
-                hihatClosedTrack.addEvent(getInstrument(hihatClosedId), m * spm + i, 0.7f);
-            }
-        }
+        AdikStepGrid hihatClosedGrid(hihatClosedHandle, length, spm);
+        hihatClosedGrid.fillEuclidean(spm, spm, 0, 0.7f); // Tous les pas
+        hihatClosedTrack.applyStepGrid(hihatClosedGrid);
         hihatClosedTrack.volume = 0.8f;
 
         // Piste 4: Son additionnel (assignée au canal 4 du mixeur par défaut)
         AdikTrack& additionalTrack = seq_ptr->getTrack(3);
         additionalTrack.name = "Additional Sound";
         additionalTrack.mixerChannelIndex = 4; // Explicitly assign to channel 4
-        for (int m = 0; m < numMeasures; ++m) {
-            additionalTrack.addEvent(getInstrument(additionalId), m * spm + (spm - 1), 0.9f);
+        AdikStepGrid additionalGrid(additionalHandle, length, spm);
+        additionalGrid.set(spm - 1, 0.9f); // Dernier pas de chaque mesure
+        additionalGrid.repeatMeasure(0);
+        additionalTrack.applyStepGrid(additionalGrid);
+
+        // La longueur de la séquence a pu changer : resynchroniser la ligne de temps du morceau
+        if (currentSong) {
+            currentSong->rebuildTimeline();
+        }
+        refreshTempoMap();
+    }
+
+
+    // Touche chaque page des samples des instruments et des buffers du mixeur, pour que le thread audio
+    // n'y prenne aucun défaut de page (voir AudioEngine::start). Renvoie le nombre d'octets parcourus.
+    size_t prefaultMemory() {
+        size_t bytes = mixer.prefaultBuffers();
+        const std::shared_ptr<AdikKit> kit = getPublishedKit();
+        if (!kit) return bytes;
+        for (const auto& instru : kit->instruments) {
+            if (!instru) continue;
+            AdikSound& sound = instru->sound;
+            bytes += AdikRealtime::prefault(sound.audioData.data(), sound.audioData.size() * sizeof(float));
+            bytes += AdikRealtime::prefault(sound.compactData.rawData(), sound.compactData.getMemoryBytes());
+        }
+        return bytes;
+    }
+
+    // Ajoute un instrument à la collection globale et renvoie son handle (un id déjà présent est remplacé, même handle).
+    // Ajout, retrait et remplacement sont pris en compte par le thread audio au prochain publishKit / publishInstruments.
+    AdikInstrumentHandle addInstrument(std::shared_ptr<AdikInstrument> instrument) {
+        std::lock_guard<std::mutex> lock(registryMutex);
+        return instrumentRegistry.add(instrument);
+    }
+
+    // Retire un instrument : les événements qui utilisent son handle ne jouent plus rien, même si l'emplacement est réutilisé
+    bool removeInstrument(AdikInstrumentHandle handle) {
+        std::lock_guard<std::mutex> lock(registryMutex);
+        return instrumentRegistry.remove(handle);
+    }
+
+    // Remplace l'instrument d'un handle : les événements qui l'utilisent jouent le nouvel instrument
+    bool replaceInstrument(AdikInstrumentHandle handle, std::shared_ptr<AdikInstrument> instrument) {
+        std::lock_guard<std::mutex> lock(registryMutex);
+        return instrumentRegistry.replace(handle, instrument);
+    }
+
+    // Publie les instruments du registre (ajouts, retraits, remplacements) comme nouveau kit
+    void publishInstruments(const std::string& name, AdikKit::Boundary boundary = AdikKit::IMMEDIATE) {
+        std::shared_ptr<AdikKit> kit;
+        {
+            std::lock_guard<std::mutex> lock(registryMutex);
+            kit = AdikKit::fromRegistry(name, instrumentRegistry, boundary);
         }
+        publishKit(kit);
     }
 
+    // Copie du registre (ex. pour enregistrer le projet) : cohérente même si un kit est publié pendant la lecture
+    AdikInstrumentRegistry getInstrumentRegistry() const {
+        std::lock_guard<std::mutex> lock(registryMutex);
+        return instrumentRegistry;
+    }
 
-    // Ajoute un instrument à la collection globale
-    void addInstrument(std::shared_ptr<AdikInstrument> instrument) {
-        instrumentList.push_back(instrument);
+    // Handle actuel de l'emplacement 'index' (numéro de pad), ou INVALID_INSTRUMENT_HANDLE s'il est vide
+    AdikInstrumentHandle getInstrumentHandleAt(size_t index) const {
+        std::lock_guard<std::mutex> lock(registryMutex);
+        return instrumentRegistry.handleAt(index);
     }
 
     // Récupère un instrument par son ID
     std::shared_ptr<AdikInstrument> getInstrument(const std::string& id) {
-      for (const auto& instru: instrumentList) {
-            if (instru->id == id) { 
-              std::cout << "voici l'instru trouvé: " << instru->id << "\n";
-              return instru;
-            }
+        std::shared_ptr<AdikInstrument> instru;
+        {
+            std::lock_guard<std::mutex> lock(registryMutex);
+            instru = instrumentRegistry.get(instrumentRegistry.find(id));
+        }
+        if (!instru) {
+            throw std::runtime_error("Instrument avec l'ID '" + id + "' non trouvé.");
+        }
+        // std::cout << "voici l'instru trouvé: " << instru->id << "\n";
+        return instru;
+    }
+
+    // Récupère le handle d'un instrument par son ID (index de l'emplacement et génération, voir AdikInstrumentRegistry)
+    AdikInstrumentHandle getInstrumentHandle(const std::string& id) const {
+        AdikInstrumentHandle handle;
+        {
+            std::lock_guard<std::mutex> lock(registryMutex);
+            handle = instrumentRegistry.find(id);
         }
-        throw std::runtime_error("Instrument avec l'ID '" + id + "' non trouvé.");
-        return nullptr; // Ne devrait pas être atteint grâce à throw
+        if (handle == INVALID_INSTRUMENT_HANDLE) {
+            throw std::runtime_error("Instrument avec l'ID '" + id + "' non trouvé.");
+        }
+        return handle;
+    }
+
+    // Résout un handle d'événement en instrument du kit actif (nullptr si le handle est invalide).
+    // Appelé par le thread audio.
+    std::shared_ptr<AdikInstrument> getInstrumentByHandle(AdikInstrumentHandle handle) const {
+        const AdikKit* kit = activeKit.load(std::memory_order_acquire);
+        return kit ? kit->get(handle) : nullptr;
     }
 
     void playInstrument(int instruIndex) {
-        if (instruIndex < 0 || instruIndex >= instrumentList.size()) {
+        const std::shared_ptr<AdikKit> kit = getPublishedKit();
+        if (!kit || instruIndex < 0 || instruIndex >= static_cast<int>(kit->instruments.size())) {
             std::cerr << "Erreur: Index d'instrument invalide: " << instruIndex << std::endl;
             return;
         }
 
-        auto instrumentToPlay = instrumentList[instruIndex];
+        auto instrumentToPlay = kit->instruments[instruIndex];
         if (instrumentToPlay) {
-            // Optionnel: Réinitialiser l'instrument pour qu'il joue du début
-            instrumentToPlay->resetPlayback();
-
+            // La voix repart du début du son (position de lecture propre au canal)
             // Router l'instrument vers un canal spécifique du mixeur.
             // Pour un test simple, on peut utiliser le canal 1 (index 0).
             // Le pan, la vélocité et le pitch peuvent être par défaut pour le test.
@@ -238,18 +1028,19 @@ public:
     void setPlaybackMode(PlaybackMode mode) {
         currentMode = mode;
         std::cout << "\nMode de lecture défini sur: " << (mode == SEQUENCE_MODE ? "SEQUENCE_MODE" : "SONG_MODE") << std::endl;
-        // Réinitialiser le pas et le sample au début du mode
-        currentStepInSequence = 0;
-        currentSampleInStep = 0;
-        currentSequenceIndexInSong = 0; // Pour s'assurer de commencer le song depuis le début
+        refreshTempoMap();
+        // Le pas, le sample et la séquence du morceau repartent du début du mode
+        postTransportCommand(AdikControlCommand::RESET);
     }
 
     // Sélectionne une séquence spécifique parmi les 16 séquences du Player (mode SEQUENCE_MODE)
     void selectSequenceInPlayer(int index) {
         if (index >= 0 && index < sequenceList.size()) {
             selectedSequenceInPlayerIndex = index;
-            currentStepInSequence = 0; // Réinitialiser le pas
-            currentSampleInStep = 0;   // Réinitialiser le sample
+            if (currentMode == SEQUENCE_MODE) {
+                refreshTempoMap();
+                postTransportCommand(AdikControlCommand::RESET); // Début de la séquence
+            }
             std::cout << "Séquence sélectionnée dans le Player: " << sequenceList[selectedSequenceInPlayerIndex]->name
                       << " (Longueur: " << sequenceList[selectedSequenceInPlayerIndex]->numberOfMeasures << " mesures, "
                       << sequenceList[selectedSequenceInPlayerIndex]->lengthInSteps << " pas)" << std::endl;
@@ -261,20 +1052,25 @@ public:
     // Sélectionne une séquence spécifique dans le morceau courant (mode SONG_MODE)
     void selectSequenceInSong(int index) {
         if (currentSong && index >= 0 && index < currentSong->sequences.size()) {
-            currentSequenceIndexInSong = index;
-            currentStepInSequence = 0; // Réinitialiser le pas
-            currentSampleInStep = 0;   // Réinitialiser le sample
-            std::cout << "Séquence sélectionnée dans le Morceau: " << currentSong->sequences[currentSequenceIndexInSong]->name << std::endl;
+            // Hors mode SONG, le passage au mode SONG repart de toute façon du début du morceau
+            if (currentMode == SONG_MODE) {
+                postTransportCommand(AdikControlCommand::LOCATE, currentSong->getSequenceStartStep(index));
+            }
+            std::cout << "Séquence sélectionnée dans le Morceau: " << currentSong->sequences[index]->name << std::endl;
         } else {
             std::cerr << "Erreur: Indice de séquence invalide dans le Morceau (" << index << ")." << std::endl;
         }
     }
 
-    // Ajoute une copie (référence partagée) d'une séquence des 16 séquences du Player au morceau courant
+    // Ajoute une copie (référence partagée) d'une séquence des 16 séquences du Player au morceau courant.
+    // Comme les autres modifications du morceau, sous sequenceEditMutex : AdikScheduler le parcourt pendant la lecture.
     void addSequenceFromPlayerToSong(int playerSequenceIndex, int numTimes = 1) {
+        std::lock_guard<std::mutex> lock(sequenceEditMutex);
+        sequenceEdits++;
         if (playerSequenceIndex >= 0 && playerSequenceIndex < sequenceList.size()) {
             if (currentSong) {
                 currentSong->addSequence(sequenceList[playerSequenceIndex], numTimes);
+                refreshTempoMap();
             } else {
                 std::cerr << "Erreur: Aucun morceau courant pour ajouter la séquence." << std::endl;
             }
@@ -285,8 +1081,11 @@ public:
 
     // Supprime une séquence du morceau courant par son index
     void deleteSequenceFromCurrentSong(int indexToDelete) {
+        std::lock_guard<std::mutex> lock(sequenceEditMutex);
+        sequenceEdits++;
         if (currentSong) {
             currentSong->deleteSequence(indexToDelete);
+            refreshTempoMap();
         } else {
             std::cerr << "Erreur: Aucun morceau courant pour supprimer la séquence." << std::endl;
         }
@@ -294,8 +1093,11 @@ public:
 
     // Réinitialise le morceau courant
     void clearCurrentSong() {
+        std::lock_guard<std::mutex> lock(sequenceEditMutex);
+        sequenceEdits++;
         if (currentSong) {
             currentSong->clear();
+            refreshTempoMap();
         }
     }
 
@@ -337,42 +1139,69 @@ public:
                   << " | Événements: ";
 
         bool hasPlayedSound = false;
+        forEachStepVoice(*currentPlayingSequence, currentStepInSequence,
+                         [&](const AdikTrack& track, const AdikEvent& event, float finalVelocity) {
+            std::shared_ptr<AdikInstrument> instrument = getInstrumentByHandle(event.instrument);
+            if (instrument) {
+                // Route le son vers le mixeur; le mixeur gère maintenant l'instrument pendant sa durée de son
+                std::cout << "in advanceStep: channelIndex: " << track.mixerChannelIndex << "\n";
+                mixer.routeSound(track.mixerChannelIndex, instrument, finalVelocity, event.getPan(), event.getPitch());
+                hasPlayedSound = true;
+            }
+        });
+        if (!hasPlayedSound) {
+            std::cout << "Rien.";
+        }
+        std::cout << std::endl;
+        mixer.displayMixerStatus(); // Affiche l'état du mixeur à chaque nouveau pas
+        std::cout << std::endl;
+
+        moveToNextStep(currentPlayingSequence);
+    }
+
+    // Parcourt les événements audibles d'un pas (solo/mute appliqués) et appelle
+    // func(track, event, vélocité finale) pour chacun. Utilisé par advanceStep et AdikScheduler.
+    // Les pistes remplacées par un rendu figé sont sautées (voir triggerFrozenVoices).
+    template <typename Func>
+    void forEachStepVoice(const AdikSequence& sequence, int step, Func func) const {
+        forEachAudibleEvent(sequence, step, frozenTrackMask(&sequence), func);
+    }
+
+    // Comme forEachStepVoice, en sautant les pistes de 'skippedTracks' (voir AdikFrozenAudio::trackMask).
+    // Sans état : utilisé aussi par AdikFreezer pour rendre les pistes à figer.
+    template <typename Func>
+    static void forEachAudibleEvent(const AdikSequence& sequence, int step, uint64_t skippedTracks, Func func) {
         bool hasSoloedTrack = false;
-        for (const auto& track : currentPlayingSequence->tracks) {
+        for (const auto& track : sequence.tracks) {
             if (track.isSoloed) {
                 hasSoloedTrack = true;
                 break;
             }
         }
 
-        // Déclencher les événements pour ce nouveau pas
-        for (auto& track : currentPlayingSequence->tracks) {
-            if (track.isMuted || (hasSoloedTrack && !track.isSoloed)) {
+        for (size_t t = 0; t < sequence.tracks.size(); ++t) {
+            const AdikTrack& track = sequence.tracks[t];
+            if (track.isMuted || (hasSoloedTrack && !track.isSoloed) || AdikFrozenAudio::coversTrack(skippedTracks, t)) {
                 continue;
             }
-
-            std::vector<AdikEvent*> trackEvents = track.getEventsAtStep(currentStepInSequence);
-            for (AdikEvent* event : trackEvents) {
-                if (event->instrument) {
-                    float finalVelocity = event->velocity * track.volume;
-                    // Route le son vers le mixeur; le mixeur gère maintenant l'instrument pendant sa durée de son
-                    std::cout << "in advanceStep: channelIndex: " << track.mixerChannelIndex << "\n";
-                    mixer.routeSound(track.mixerChannelIndex, event->instrument, finalVelocity, event->pan, event->pitch);
-                    hasPlayedSound = true;
-                }
+            std::pair<size_t, size_t> range = track.events.rangeAtStep(step);
+            for (size_t i = range.first; i < range.second; ++i) {
+                const AdikEvent event = track.events.get(i);
+                func(track, event, event.getVelocity() * track.volume);
             }
         }
-        if (!hasPlayedSound) {
-            std::cout << "Rien.";
-        }
-        std::cout << std::endl;
-        mixer.displayMixerStatus(); // Affiche l'état du mixeur à chaque nouveau pas
-        std::cout << std::endl;
+    }
 
-        // Passer au pas suivant
+    // Fait avancer la position de lecture d'un pas, avec bouclage de la séquence et du morceau,
+    // sans déclencher d'événements (mode planifié).
+    void moveToNextStep(std::shared_ptr<AdikSequence> currentPlayingSequence) {
+        if (!currentPlayingSequence) return;
+        playheadStep = currentStepInSequence;
+        playheadSequenceIndexInSong = currentSequenceIndexInSong;
         currentStepInSequence++;
         if (currentStepInSequence >= currentPlayingSequence->lengthInSteps) {
             currentStepInSequence = 0; // Reboucler le pas dans la séquence actuelle
+            precedingSequence = currentPlayingSequence.get();
 
             if (currentMode == SONG_MODE) {
                 currentSequenceIndexInSong++; // Passer à la séquence suivante du morceau
@@ -389,12 +1218,12 @@ public:
         // Deprecated function, used when there is no Realtime Audio Library  
         start();
         int totalSamplesToSimulate = numSecondsToSimulate * sampleRate;
-        std::vector<float> audioOutputBuffer(bufferSizeSamples); // Buffer pour la sortie audio
+        std::vector<float> audioOutputBuffer(bufferSizeSamples * mixer.numOutputChannels); // Buffer pour la sortie audio
 
         long long samplesProcessed = 0;
         while (samplesProcessed < totalSamplesToSimulate) {
             // Appeler la fonction processAudioCallback globale, en lui passant 'this' comme userData
-            ::processAudioCallback(audioOutputBuffer.data(), bufferSizeSamples, this);
+            ::processAudioCallback(audioOutputBuffer.data(), bufferSizeSamples, mixer.numOutputChannels, 0, this);
             samplesProcessed += bufferSizeSamples;
 
             // Ici, dans une vraie application, le buffer audioOutputBuffer serait envoyé à la carte son.
@@ -403,6 +1232,100 @@ public:
         }
         stop();
     }
+
+private:
+    // Ids internés -> handles (voir AdikInstrumentRegistry). Écrit par les threads qui ajoutent des instruments
+    // ou publient des kits (chargeur de kits compris), lu par les interfaces : toujours sous registryMutex,
+    // pris en dernier (après kitMutex). Le thread audio ne le lit pas.
+    AdikInstrumentRegistry instrumentRegistry;
+    mutable std::mutex registryMutex;
+
+    // État du thread audio pour triggerFrozenVoices / stopStaleFrozenVoices
+    const AdikFrozenAudio* frozenStarted[MAX_FROZEN]; // Dernier rendu lancé par emplacement
+    uint32_t frozenStartLocate[MAX_FROZEN];           // Valeur de locateCount à ce lancement
+    uint32_t frozenRetirementsSeen;
+    const AdikSequence* precedingSequence; // Séquence jouée juste avant la séquence courante, nullptr après un saut
+
+    // sequenceEditMutex pris. Le rendu reste lisible par le thread audio jusqu'à la fin de son bloc :
+    // il est gardé dans retiredFrozen, et le thread audio coupe sa voix au bloc suivant.
+    void retireFrozenSlot(int slot) {
+        if (!frozenOwners[slot]) return;
+        frozenSlots[slot].store(nullptr, std::memory_order_release);
+        retiredFrozen.emplace_back(frozenOwners[slot], processedBlocks.load());
+        frozenOwners[slot].reset();
+        frozenRetirements.fetch_add(1, std::memory_order_release);
+    }
+
+    // tempoMapMutex pris. Une carte retirée reste attachée à l'horloge jusqu'au bloc où le thread audio prend la
+    // suivante (applyPendingTempo), puis figure encore dans l'instantané de position publié à la fin de ce bloc :
+    // elle est gardée deux blocs après son retrait, comme un kit.
+    size_t collectRetiredTempoMapsLocked() {
+        const uint64_t blocks = processedBlocks.load();
+        size_t kept = 0;
+        for (size_t i = 0; i < retiredTempoMaps.size(); ++i) {
+            const bool keep = blocks < retiredTempoMaps[i].second + 2;
+            if (keep) {
+                if (kept != i) retiredTempoMaps[kept] = std::move(retiredTempoMaps[i]);
+                kept++;
+            }
+        }
+        retiredTempoMaps.resize(kept);
+        return kept;
+    }
+
+    // kitMutex pris. 'kit' devient le kit publié (l'ancien est retiré) ; le registre reprend ses emplacements
+    void adoptKitLocked(const std::shared_ptr<AdikKit>& kit) {
+        if (publishedKit) {
+            retiredKits.emplace_back(publishedKit, processedBlocks.load());
+        }
+        publishedKit = kit;
+        std::lock_guard<std::mutex> lock(registryMutex);
+        instrumentRegistry.assign(kit->instruments, kit->generations);
+    }
+
+    // kitMutex pris. Un kit retiré est gardé tant que le thread audio peut encore l'activer (moins de deux blocs
+    // depuis son retrait) ou l'utiliser, et tant qu'un de ses instruments absents du kit publié a plus de références
+    // que n'en tiennent les kits retirés : une voix le tient encore, et c'est ici, pas sur le thread audio,
+    // que l'instrument doit être libéré.
+    size_t collectRetiredKitsLocked() {
+        const uint64_t blocks = processedBlocks.load();
+        const AdikKit* active = activeKit.load(std::memory_order_acquire);
+        std::map<const AdikInstrument*, long> owners;
+        for (const auto& retired : retiredKits) {
+            for (const auto& instrument : retired.first->instruments) {
+                if (instrument) owners[instrument.get()]++;
+            }
+        }
+        // Gardés en vie par le kit publié ou le registre : leur dernière référence ne peut pas être celle d'une voix
+        if (publishedKit) {
+            for (const auto& instrument : publishedKit->instruments) {
+                if (instrument) owners[instrument.get()] = -1;
+            }
+        }
+        {
+            std::lock_guard<std::mutex> lock(registryMutex);
+            for (const auto& instrument : instrumentRegistry.getSlots()) {
+                if (instrument) owners[instrument.get()] = -1;
+            }
+        }
+
+        size_t kept = 0;
+        for (size_t i = 0; i < retiredKits.size(); ++i) {
+            const AdikKit* kit = retiredKits[i].first.get();
+            bool keep = kit == active || blocks < retiredKits[i].second + 2;
+            for (size_t j = 0; !keep && j < kit->instruments.size(); ++j) {
+                const auto& instrument = kit->instruments[j];
+                const long owned = instrument ? owners[instrument.get()] : -1;
+                keep = owned >= 0 && instrument.use_count() > owned;
+            }
+            if (keep) {
+                if (kept != i) retiredKits[kept] = std::move(retiredKits[i]);
+                kept++;
+            }
+        }
+        retiredKits.resize(kept);
+        return kept;
+    }
 };
 
 #endif // ADIKPLAYER_H
@@ -0,0 +1,626 @@
+#include "adikproject.h"
+#include "adikplayer.h"
+#include "adikprojectstate.h"
+#include "adikchecksum.h"
+
+#include <cstring>     // Pour std::memcpy, std::memcmp, strnlen
+#include <cstddef>     // Pour offsetof
+#include <cstdio>      // Pour std::rename, std::remove
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <algorithm>   // Pour std::is_sorted
+
+#include <fcntl.h>     // Pour open
+#include <sys/mman.h>  // Pour mmap, munmap
+#include <sys/stat.h>  // Pour fstat
+#include <unistd.h>    // Pour close
+
+namespace {
+
+const char PROJECT_MAGIC[8] = {'A', 'D', 'I', 'K', 'P', 'R', 'J', '\0'};
+const uint64_t SECTION_ALIGNMENT = 16;
+
+// Section en cours de construction (écriture)
+struct SectionBuffer {
+    char id[4];
+    uint32_t recordSize;
+    std::vector<uint8_t> data;
+
+    SectionBuffer(const char* sectionId, uint32_t recSize) : recordSize(recSize) {
+        std::memcpy(id, sectionId, 4);
+    }
+
+    template <typename T>
+    void append(const T& record) {
+        const uint8_t* bytes = reinterpret_cast<const uint8_t*>(&record);
+        data.insert(data.end(), bytes, bytes + sizeof(T));
+    }
+
+    template <typename T>
+    void appendArray(const std::vector<T>& values) {
+        if (values.empty()) return;
+        const uint8_t* bytes = reinterpret_cast<const uint8_t*>(values.data());
+        data.insert(data.end(), bytes, bytes + values.size() * sizeof(T));
+    }
+};
+
+// Table de chaînes dédoublonnée (section STRS)
+class StringTable {
+public:
+    uint32_t add(const std::string& value) {
+        auto it = offsets.find(value);
+        if (it != offsets.end()) return it->second;
+        const uint32_t offset = static_cast<uint32_t>(data.size());
+        data.insert(data.end(), value.begin(), value.end());
+        data.push_back('\0');
+        offsets[value] = offset;
+        return offset;
+    }
+
+    std::vector<uint8_t> data;
+
+private:
+    std::map<std::string, uint32_t> offsets;
+};
+
+uint64_t alignUp(uint64_t value) {
+    return (value + SECTION_ALIGNMENT - 1) & ~(SECTION_ALIGNMENT - 1);
+}
+
+void appendTempoPoints(SectionBuffer& section, const AdikTempoMap& map, uint32_t& first, uint32_t& count) {
+    first = static_cast<uint32_t>(section.data.size() / sizeof(AdikProjectTempoPointRecord));
+    count = static_cast<uint32_t>(map.points.size());
+    for (const auto& point : map.points) {
+        AdikProjectTempoPointRecord record;
+        record.step = point.step;
+        record.curve = static_cast<uint32_t>(point.curve);
+        record.bpm = point.bpm;
+        section.append(record);
+    }
+}
+
+// Fichier projeté en mémoire, en lecture seule
+class MappedFile {
+public:
+    explicit MappedFile(const std::string& path) : data(nullptr), size(0) {
+        int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0) return;
+        struct stat st;
+        if (::fstat(fd, &st) == 0 && st.st_size > 0) {
+            void* mapped = ::mmap(nullptr, static_cast<size_t>(st.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+            if (mapped != MAP_FAILED) {
+                data = static_cast<const uint8_t*>(mapped);
+                size = static_cast<size_t>(st.st_size);
+            }
+        }
+        ::close(fd);
+    }
+
+    ~MappedFile() {
+        if (data) ::munmap(const_cast<uint8_t*>(data), size);
+    }
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    const uint8_t* data;
+    size_t size;
+};
+
+// Vue sur une section validée du fichier chargé
+struct SectionView {
+    const uint8_t* data = nullptr;
+    uint64_t size = 0;
+    uint32_t recordSize = 0;
+
+    bool present() const { return data != nullptr; }
+
+    size_t count(size_t minRecordSize) const {
+        if (!data || recordSize < minRecordSize) return 0;
+        return static_cast<size_t>(size / recordSize);
+    }
+
+    // Lit l'enregistrement i ; les champs absents (version mineure plus ancienne) restent à zéro
+    template <typename T>
+    T record(size_t i) const {
+        T value;
+        std::memset(&value, 0, sizeof(T));
+        std::memcpy(&value, data + i * recordSize, recordSize < sizeof(T) ? recordSize : sizeof(T));
+        return value;
+    }
+};
+
+std::string stringAt(const SectionView& strings, uint32_t offset) {
+    if (offset == ADIK_PROJECT_NO_STRING || offset >= strings.size) return std::string();
+    const char* begin = reinterpret_cast<const char*>(strings.data + offset);
+    size_t length = strnlen(begin, static_cast<size_t>(strings.size - offset));
+    return std::string(begin, length);
+}
+
+// Copie 'count' éléments d'un tableau d'événements à partir de 'first' (bornes comparées en éléments : sans débordement)
+template <typename T>
+bool copyEventArray(const SectionView& section, uint64_t first, uint64_t count, std::vector<T>& out) {
+    const uint64_t total = section.size / sizeof(T);
+    if (!section.present() || first > total || count > total - first) return false;
+    out.resize(static_cast<size_t>(count));
+    if (count > 0) {
+        std::memcpy(out.data(), section.data + first * sizeof(T), static_cast<size_t>(count * sizeof(T)));
+    }
+    return true;
+}
+
+void loadTempoPoints(const SectionView& tempo, uint32_t first, uint32_t count, AdikTempoMap& map) {
+    map.clear();
+    const size_t total = tempo.count(sizeof(AdikProjectTempoPointRecord));
+    for (uint32_t i = 0; i < count && static_cast<size_t>(first) + i < total; ++i) {
+        AdikProjectTempoPointRecord record = tempo.record<AdikProjectTempoPointRecord>(first + i);
+        AdikTempoMap::CurveType curve = record.curve <= AdikTempoMap::TEMPO_EXPONENTIAL
+                                      ? static_cast<AdikTempoMap::CurveType>(record.curve)
+                                      : AdikTempoMap::TEMPO_STEP;
+        map.addPoint(record.step, record.bpm, curve);
+    }
+}
+
+// Valide l'en-tête et la table des sections du fichier, puis les sections connues
+bool readSections(const MappedFile& file, const std::string& path, bool verifyChecksums,
+                  AdikProjectHeader& header, std::map<std::string, SectionView>& views) {
+    // En-tête
+    if (file.size < sizeof(header)) {
+        std::cerr << "AdikProject: Fichier trop court." << std::endl;
+        return false;
+    }
+    std::memcpy(&header, file.data, sizeof(header));
+    if (std::memcmp(header.magic, PROJECT_MAGIC, sizeof(PROJECT_MAGIC)) != 0) {
+        std::cerr << "AdikProject: '" << path << "' n'est pas un projet AdikPlan." << std::endl;
+        return false;
+    }
+    if (header.headerCrc != adikCrc32(&header, offsetof(AdikProjectHeader, headerCrc))) {
+        std::cerr << "AdikProject: En-tête corrompu." << std::endl;
+        return false;
+    }
+    if (header.versionMajor != ADIK_PROJECT_VERSION_MAJOR) {
+        std::cerr << "AdikProject: Version " << header.versionMajor << "." << header.versionMinor
+                  << " non supportée (attendu " << ADIK_PROJECT_VERSION_MAJOR << ".x)." << std::endl;
+        return false;
+    }
+    const uint64_t tableBytes = static_cast<uint64_t>(header.sectionCount) * sizeof(AdikProjectSection);
+    if (header.fileSize > file.size || sizeof(header) + tableBytes > file.size) {
+        std::cerr << "AdikProject: Fichier tronqué." << std::endl;
+        return false;
+    }
+    const uint8_t* tableData = file.data + sizeof(header);
+    if (header.tableCrc != adikCrc32(tableData, static_cast<size_t>(tableBytes))) {
+        std::cerr << "AdikProject: Table des sections corrompue." << std::endl;
+        return false;
+    }
+
+    // Sections : les inconnues sont ignorées, les connues sont bornées et vérifiées
+    for (uint32_t i = 0; i < header.sectionCount; ++i) {
+        AdikProjectSection section;
+        std::memcpy(&section, tableData + i * sizeof(AdikProjectSection), sizeof(section));
+        const std::string id(section.id, 4);
+        if (section.offset > file.size || section.size > file.size - section.offset) {
+            std::cerr << "AdikProject: Section '" << id << "' hors du fichier." << std::endl;
+            return false;
+        }
+        const uint8_t* data = file.data + section.offset;
+        if (verifyChecksums && section.crc != adikCrc32(data, static_cast<size_t>(section.size))) {
+            std::cerr << "AdikProject: Somme de contrôle invalide pour la section '" << id << "'." << std::endl;
+            return false;
+        }
+        SectionView view;
+        view.data = data;
+        view.size = section.size;
+        view.recordSize = section.recordSize;
+        views[id] = view;
+    }
+
+    const char* required[] = {"STRS", "PLYR", "INST", "SEQS", "TRKS", "EVST", "EVIN", "EVVL", "EVPN", "EVPT", "SONG"};
+    for (const char* id : required) {
+        if (!views[id].present()) {
+            std::cerr << "AdikProject: Section obligatoire '" << id << "' absente." << std::endl;
+            return false;
+        }
+    }
+    return true;
+}
+
+// Instruments (section INST), avec leurs samples embarqués (SMPL)
+bool readInstruments(std::map<std::string, SectionView>& views, std::vector<std::shared_ptr<AdikInstrument>>& instruments) {
+    const SectionView& inst = views["INST"];
+    const SectionView& strs = views["STRS"];
+    const SectionView& smpl = views["SMPL"];
+    for (size_t i = 0; i < inst.count(ADIK_PROJECT_INSTRUMENT_RECORD_V10_SIZE); ++i) {
+        const AdikProjectInstrumentRecord record = inst.record<AdikProjectInstrumentRecord>(i);
+        auto instrument = std::make_shared<AdikInstrument>(stringAt(strs, record.idString), stringAt(strs, record.nameString),
+                                                           stringAt(strs, record.pathString),
+                                                           record.numChannels > 0 ? record.numChannels : 1);
+        instrument->defaultVolume = record.defaultVolume;
+        instrument->defaultPan = record.defaultPan;
+        instrument->defaultPitch = record.defaultPitch;
+        if (record.sampleRate > 0) instrument->sound.sampleRate = record.sampleRate;
+        if (record.envelopeMode == AdikEnvelopeParams::AHDSR) {
+            instrument->envelope = AdikEnvelopeParams::ahdsr(record.envelopeAttack, record.envelopeHold, record.envelopeDecay,
+                                                             record.envelopeSustain, record.envelopeRelease, record.envelopeGate);
+        } else {
+            instrument->envelope = AdikEnvelopeParams::oneShot(record.envelopeAttack, record.envelopeRelease);
+        }
+        if (record.sampleOffset != ADIK_PROJECT_NO_SAMPLES) {
+            if (!smpl.present() || record.sampleOffset > smpl.size
+                || record.sampleCount > (smpl.size - record.sampleOffset) / sizeof(float)) {
+                std::cerr << "AdikProject: Données audio de '" << instrument->id << "' hors de la section 'SMPL'." << std::endl;
+                return false;
+            }
+            instrument->sound.cacheKey.clear(); // Les samples viennent du projet, pas du générateur
+            instrument->sound.compactData.clear();
+            instrument->sound.audioData.resize(static_cast<size_t>(record.sampleCount));
+            std::memcpy(instrument->sound.audioData.data(), smpl.data + record.sampleOffset,
+                        static_cast<size_t>(record.sampleCount * sizeof(float)));
+        }
+        // Sinon le son est régénéré par le constructeur à partir de l'id
+        instruments.push_back(instrument);
+    }
+    return true;
+}
+
+} // namespace
+
+bool AdikProject::save(const AdikPlayer& player, const std::string& path, bool embedSamples) {
+    StringTable strings;
+    SectionBuffer plyr("PLYR", sizeof(AdikProjectPlayerRecord));
+    SectionBuffer inst("INST", sizeof(AdikProjectInstrumentRecord));
+    SectionBuffer smpl("SMPL", 0);
+    SectionBuffer seqs("SEQS", sizeof(AdikProjectSequenceRecord));
+    SectionBuffer trks("TRKS", sizeof(AdikProjectTrackRecord));
+    SectionBuffer evst("EVST", sizeof(int32_t));
+    SectionBuffer evin("EVIN", sizeof(AdikInstrumentHandle));
+    SectionBuffer evvl("EVVL", sizeof(uint16_t));
+    SectionBuffer evpn("EVPN", sizeof(int16_t));
+    SectionBuffer evpt("EVPT", sizeof(int16_t));
+    SectionBuffer song("SONG", 0);
+    SectionBuffer tmpo("TMPO", sizeof(AdikProjectTempoPointRecord));
+
+    // Instruments, dans l'ordre du registre. Les emplacements libres ne sont pas écrits : un handle d'événement
+    // est enregistré comme l'index de son instrument dans le fichier (INVALID_INSTRUMENT_HANDLE s'il est périmé).
+    const AdikInstrumentRegistry registry = player.getInstrumentRegistry();
+    const std::vector<uint8_t>& generations = registry.getGenerations();
+    std::vector<AdikInstrumentHandle> savedIndex(registry.getNumSlots(), INVALID_INSTRUMENT_HANDLE);
+    bool handlesAreIndices = true; // Registre sans retrait : les handles sont déjà les index du fichier
+    uint32_t instrumentCount = 0;
+    for (size_t i = 0; i < registry.getNumSlots(); ++i) {
+        const std::shared_ptr<AdikInstrument>& instrument = registry.getSlots()[i];
+        handlesAreIndices = handlesAreIndices && instrument && generations[i] == 0;
+        if (!instrument) continue;
+        savedIndex[i] = instrumentCount++;
+        AdikProjectInstrumentRecord record;
+        std::memset(&record, 0, sizeof(record));
+        record.idString = strings.add(instrument->id);
+        record.nameString = strings.add(instrument->name);
+        record.pathString = strings.add(instrument->audioFilePath);
+        record.numChannels = instrument->sound.numChannels;
+        record.defaultVolume = instrument->defaultVolume;
+        record.defaultPan = instrument->defaultPan;
+        record.defaultPitch = instrument->defaultPitch;
+        record.sampleRate = instrument->sound.sampleRate;
+        record.envelopeMode = static_cast<uint32_t>(instrument->envelope.mode);
+        record.envelopeAttack = instrument->envelope.attack;
+        record.envelopeHold = instrument->envelope.hold;
+        record.envelopeDecay = instrument->envelope.decay;
+        record.envelopeSustain = instrument->envelope.sustain;
+        record.envelopeRelease = instrument->envelope.release;
+        record.envelopeGate = instrument->envelope.gate;
+        record.sampleOffset = ADIK_PROJECT_NO_SAMPLES;
+        record.sampleCount = 0;
+        if (embedSamples && instrument->sound.getNumSamples() > 0) {
+            // Toujours en float dans le fichier : le stockage compact est un réglage de chargement
+            const std::vector<float> samples = instrument->sound.toFloat();
+            smpl.data.resize(alignUp(smpl.data.size()), 0);
+            record.sampleOffset = smpl.data.size();
+            record.sampleCount = samples.size();
+            smpl.appendArray(samples);
+        }
+        inst.append(record);
+    }
+
+    // Séquences : d'abord celles du Player, puis celles du morceau qui n'y figurent pas
+    std::vector<std::shared_ptr<AdikSequence>> sequences(player.sequenceList.begin(), player.sequenceList.end());
+    std::map<const AdikSequence*, uint32_t> sequenceIndex;
+    for (size_t i = 0; i < sequences.size(); ++i) {
+        sequenceIndex[sequences[i].get()] = static_cast<uint32_t>(i);
+    }
+    if (player.currentSong) {
+        for (const auto& seq : player.currentSong->sequences) {
+            if (sequenceIndex.find(seq.get()) == sequenceIndex.end()) {
+                sequenceIndex[seq.get()] = static_cast<uint32_t>(sequences.size());
+                sequences.push_back(seq);
+            }
+        }
+    }
+
+    uint64_t eventCount = 0;
+    uint32_t trackCount = 0;
+    for (const auto& seq : sequences) {
+        AdikProjectSequenceRecord seqRecord;
+        std::memset(&seqRecord, 0, sizeof(seqRecord));
+        seqRecord.nameString = strings.add(seq->name);
+        seqRecord.numberOfMeasures = seq->numberOfMeasures;
+        seqRecord.stepsPerMeasure = seq->stepsPerMeasure;
+        seqRecord.lengthInSteps = seq->lengthInSteps;
+        seqRecord.firstTrack = trackCount;
+        seqRecord.trackCount = static_cast<uint32_t>(seq->tracks.size());
+        appendTempoPoints(tmpo, seq->tempoMap, seqRecord.firstTempoPoint, seqRecord.tempoPointCount);
+        seqs.append(seqRecord);
+
+        for (const auto& track : seq->tracks) {
+            AdikProjectTrackRecord trackRecord;
+            std::memset(&trackRecord, 0, sizeof(trackRecord));
+            trackRecord.nameString = strings.add(track.name);
+            trackRecord.volume = track.volume;
+            trackRecord.isMuted = track.isMuted ? 1 : 0;
+            trackRecord.isSoloed = track.isSoloed ? 1 : 0;
+            trackRecord.mixerChannelIndex = track.mixerChannelIndex;
+            trackRecord.firstEvent = eventCount;
+            trackRecord.eventCount = track.events.size();
+            trks.append(trackRecord);
+
+            // Les tableaux SoA sont écrits tels quels
+            evst.appendArray(track.events.steps);
+            if (handlesAreIndices) {
+                evin.appendArray(track.events.instruments);
+            } else {
+                std::vector<AdikInstrumentHandle> handles = track.events.instruments;
+                for (auto& handle : handles) {
+                    const uint32_t index = AdikInstrumentRegistry::indexOf(handle);
+                    const bool live = index < savedIndex.size() && AdikInstrumentRegistry::generationOf(handle) == generations[index];
+                    handle = live ? savedIndex[index] : INVALID_INSTRUMENT_HANDLE;
+                }
+                evin.appendArray(handles);
+            }
+            evvl.appendArray(track.events.velocities);
+            evpn.appendArray(track.events.pans);
+            evpt.appendArray(track.events.pitches);
+            eventCount += track.events.size();
+            trackCount++;
+        }
+    }
+
+    // Morceau
+    AdikProjectSongRecord songRecord;
+    std::memset(&songRecord, 0, sizeof(songRecord));
+    songRecord.nameString = player.currentSong ? strings.add(player.currentSong->name) : ADIK_PROJECT_NO_STRING;
+    if (player.currentSong) {
+        songRecord.slotCount = static_cast<uint32_t>(player.currentSong->sequences.size());
+        appendTempoPoints(tmpo, player.currentSong->tempoMap, songRecord.firstTempoPoint, songRecord.tempoPointCount);
+    }
+    song.append(songRecord);
+    if (player.currentSong) {
+        for (const auto& seq : player.currentSong->sequences) {
+            song.append(sequenceIndex[seq.get()]);
+        }
+    }
+
+    // Réglages du Player
+    AdikProjectPlayerRecord playerRecord;
+    std::memset(&playerRecord, 0, sizeof(playerRecord));
+    playerRecord.tempoBPM = player.tempoBPM;
+    playerRecord.sampleRate = player.sampleRate;
+    playerRecord.playbackMode = player.currentMode;
+    playerRecord.selectedSequenceInPlayerIndex = player.selectedSequenceInPlayerIndex;
+    playerRecord.playerSequenceCount = static_cast<uint32_t>(player.sequenceList.size());
+    plyr.append(playerRecord);
+
+    SectionBuffer strs("STRS", 0);
+    strs.data = strings.data;
+
+    std::vector<SectionBuffer*> sections = {&strs, &plyr, &inst, &smpl, &seqs, &trks,
+                                            &evst, &evin, &evvl, &evpn, &evpt, &song, &tmpo};
+
+    // Disposition : en-tête, table des sections, puis sections alignées
+    std::vector<AdikProjectSection> table(sections.size());
+    uint64_t offset = alignUp(sizeof(AdikProjectHeader) + sections.size() * sizeof(AdikProjectSection));
+    for (size_t i = 0; i < sections.size(); ++i) {
+        std::memset(&table[i], 0, sizeof(AdikProjectSection));
+        std::memcpy(table[i].id, sections[i]->id, 4);
+        table[i].recordSize = sections[i]->recordSize;
+        table[i].offset = offset;
+        table[i].size = sections[i]->data.size();
+        table[i].crc = adikCrc32(sections[i]->data.data(), sections[i]->data.size());
+        offset = alignUp(offset + table[i].size);
+    }
+
+    AdikProjectHeader header;
+    std::memset(&header, 0, sizeof(header));
+    std::memcpy(header.magic, PROJECT_MAGIC, sizeof(PROJECT_MAGIC));
+    header.versionMajor = ADIK_PROJECT_VERSION_MAJOR;
+    header.versionMinor = ADIK_PROJECT_VERSION_MINOR;
+    header.sectionCount = static_cast<uint32_t>(sections.size());
+    header.fileSize = offset;
+    header.tableCrc = adikCrc32(table.data(), table.size() * sizeof(AdikProjectSection));
+    header.headerCrc = adikCrc32(&header, offsetof(AdikProjectHeader, headerCrc));
+
+    // Écriture dans un fichier temporaire, renommé à la fin : un projet existant n'est jamais laissé à moitié écrit
+    const std::string tmpPath = path + ".tmp";
+    {
+        std::ofstream out(tmpPath, std::ios::binary | std::ios::trunc);
+        if (!out) {
+            std::cerr << "AdikProject: Impossible de créer '" << tmpPath << "'." << std::endl;
+            return false;
+        }
+        const char padding[SECTION_ALIGNMENT] = {0};
+        out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        out.write(reinterpret_cast<const char*>(table.data()), table.size() * sizeof(AdikProjectSection));
+        uint64_t written = sizeof(header) + table.size() * sizeof(AdikProjectSection);
+        for (size_t i = 0; i < sections.size(); ++i) {
+            out.write(padding, static_cast<std::streamsize>(table[i].offset - written));
+            out.write(reinterpret_cast<const char*>(sections[i]->data.data()), static_cast<std::streamsize>(table[i].size));
+            written = table[i].offset + table[i].size;
+        }
+        out.write(padding, static_cast<std::streamsize>(header.fileSize - written));
+        if (!out) {
+            std::cerr << "AdikProject: Erreur d'écriture dans '" << tmpPath << "'." << std::endl;
+            std::remove(tmpPath.c_str());
+            return false;
+        }
+    }
+    if (std::rename(tmpPath.c_str(), path.c_str()) != 0) {
+        std::cerr << "AdikProject: Impossible de renommer '" << tmpPath << "' en '" << path << "'." << std::endl;
+        std::remove(tmpPath.c_str());
+        return false;
+    }
+
+    std::cout << "AdikProject: Projet enregistré dans '" << path << "' (" << header.fileSize << " octets, "
+              << instrumentCount << " instruments, " << sequences.size() << " séquences, "
+              << eventCount << " événements)." << std::endl;
+    return true;
+}
+
+bool AdikProject::read(const std::string& path, AdikProjectState& state, const AdikSampleAnalysisOptions& analysis,
+                       bool verifyChecksums) {
+    MappedFile file(path);
+    if (!file.data) {
+        std::cerr << "AdikProject: Impossible d'ouvrir '" << path << "'." << std::endl;
+        return false;
+    }
+
+    AdikProjectHeader header;
+    std::map<std::string, SectionView> views;
+    if (!readSections(file, path, verifyChecksums, header, views)) {
+        return false;
+    }
+    const SectionView& strs = views["STRS"];
+    const SectionView& tmpo = views["TMPO"];
+
+    if (views["PLYR"].count(sizeof(AdikProjectPlayerRecord)) < 1) {
+        std::cerr << "AdikProject: Section 'PLYR' invalide." << std::endl;
+        return false;
+    }
+    const AdikProjectPlayerRecord playerRecord = views["PLYR"].record<AdikProjectPlayerRecord>(0);
+
+    // Instruments
+    std::vector<std::shared_ptr<AdikInstrument>> instruments;
+    if (!readInstruments(views, instruments)) {
+        return false;
+    }
+
+    // Séquences et pistes
+    std::vector<std::shared_ptr<AdikSequence>> sequences;
+    const SectionView& seqs = views["SEQS"];
+    const SectionView& trks = views["TRKS"];
+    const size_t trackTotal = trks.count(sizeof(AdikProjectTrackRecord));
+    for (size_t i = 0; i < seqs.count(sizeof(AdikProjectSequenceRecord)); ++i) {
+        const AdikProjectSequenceRecord record = seqs.record<AdikProjectSequenceRecord>(i);
+        auto seq = std::make_shared<AdikSequence>(stringAt(strs, record.nameString), record.numberOfMeasures, record.stepsPerMeasure);
+        seq->lengthInSteps = record.lengthInSteps;
+        if (seq->lengthInSteps <= 0) {
+            std::cerr << "AdikProject: Longueur invalide pour la séquence '" << seq->name << "' (" << record.lengthInSteps << " pas)." << std::endl;
+            return false;
+        }
+        loadTempoPoints(tmpo, record.firstTempoPoint, record.tempoPointCount, seq->tempoMap);
+        if (static_cast<size_t>(record.firstTrack) + record.trackCount > trackTotal) {
+            std::cerr << "AdikProject: Pistes de la séquence '" << seq->name << "' hors de la section 'TRKS'." << std::endl;
+            return false;
+        }
+        seq->tracks.clear();
+        for (uint32_t t = 0; t < record.trackCount; ++t) {
+            const AdikProjectTrackRecord trackRecord = trks.record<AdikProjectTrackRecord>(record.firstTrack + t);
+            AdikTrack track(stringAt(strs, trackRecord.nameString), trackRecord.mixerChannelIndex);
+            track.volume = trackRecord.volume;
+            track.isMuted = trackRecord.isMuted != 0;
+            track.isSoloed = trackRecord.isSoloed != 0;
+            AdikEventList& events = track.events;
+            if (!copyEventArray(views["EVST"], trackRecord.firstEvent, trackRecord.eventCount, events.steps)
+                || !copyEventArray(views["EVIN"], trackRecord.firstEvent, trackRecord.eventCount, events.instruments)
+                || !copyEventArray(views["EVVL"], trackRecord.firstEvent, trackRecord.eventCount, events.velocities)
+                || !copyEventArray(views["EVPN"], trackRecord.firstEvent, trackRecord.eventCount, events.pans)
+                || !copyEventArray(views["EVPT"], trackRecord.firstEvent, trackRecord.eventCount, events.pitches)) {
+                std::cerr << "AdikProject: Événements de la piste '" << track.name << "' hors des tableaux d'événements." << std::endl;
+                return false;
+            }
+            // Recherches par pas (AdikEventList), tranches de l'historique et grilles de pas supposent des pas triés
+            if (!std::is_sorted(events.steps.begin(), events.steps.end())) {
+                std::cerr << "AdikProject: Événements de la piste '" << track.name << "' non triés par pas." << std::endl;
+                return false;
+            }
+            seq->tracks.push_back(std::move(track));
+        }
+        sequences.push_back(seq);
+    }
+    if (playerRecord.playerSequenceCount > sequences.size()) {
+        std::cerr << "AdikProject: Nombre de séquences du Player invalide." << std::endl;
+        return false;
+    }
+
+    // Morceau
+    const SectionView& songView = views["SONG"];
+    if (songView.size < sizeof(AdikProjectSongRecord)) {
+        std::cerr << "AdikProject: Section 'SONG' invalide." << std::endl;
+        return false;
+    }
+    AdikProjectSongRecord songRecord;
+    std::memcpy(&songRecord, songView.data, sizeof(songRecord));
+    if (sizeof(songRecord) + static_cast<uint64_t>(songRecord.slotCount) * sizeof(uint32_t) > songView.size) {
+        std::cerr << "AdikProject: Section 'SONG' tronquée." << std::endl;
+        return false;
+    }
+    auto song = std::make_shared<AdikSong>(stringAt(strs, songRecord.nameString));
+    loadTempoPoints(tmpo, songRecord.firstTempoPoint, songRecord.tempoPointCount, song->tempoMap);
+    for (uint32_t i = 0; i < songRecord.slotCount; ++i) {
+        uint32_t index;
+        std::memcpy(&index, songView.data + sizeof(songRecord) + i * sizeof(uint32_t), sizeof(index));
+        if (index >= sequences.size()) {
+            std::cerr << "AdikProject: Séquence " << index << " du morceau inexistante." << std::endl;
+            return false;
+        }
+        song->sequences.push_back(sequences[index]);
+    }
+    song->rebuildTimeline();
+
+    // Tout est valide : analyser les sons (découpe, crêtes) avant de les confier au Player
+    AdikSampleAnalyzer::analyzeAll(instruments, analysis);
+
+    // Les handles des événements sont des index dans 'instruments' : le kit les reprend tels quels
+    state.name = path;
+    state.kit = AdikKit::fromInstruments(path, instruments);
+    state.sequenceList.assign(sequences.begin(), sequences.begin() + playerRecord.playerSequenceCount);
+    state.song = song;
+    state.tempoBPM = playerRecord.tempoBPM > 0.0 ? playerRecord.tempoBPM : 0.0;
+    state.playbackMode = playerRecord.playbackMode == AdikPlayer::SONG_MODE ? AdikPlayer::SONG_MODE : AdikPlayer::SEQUENCE_MODE;
+    state.selectedSequenceInPlayerIndex =
+        (playerRecord.selectedSequenceInPlayerIndex >= 0 && playerRecord.selectedSequenceInPlayerIndex < static_cast<int>(state.sequenceList.size()))
+        ? playerRecord.selectedSequenceInPlayerIndex : 0;
+
+    std::cout << "AdikProject: Projet '" << path << "' lu (version " << header.versionMajor << "." << header.versionMinor
+              << ", " << instruments.size() << " instruments, " << sequences.size() << " séquences, "
+              << song->sequences.size() << " séquences dans le morceau)." << std::endl;
+    return true;
+}
+
+bool AdikProject::load(AdikPlayer& player, const std::string& path, bool verifyChecksums) {
+    auto state = std::make_shared<AdikProjectState>();
+    if (!read(path, *state, player.sampleAnalysisOptions, verifyChecksums)) {
+        return false;
+    }
+    if (!player.publishProject(state)) {
+        return false;
+    }
+    std::cout << "AdikProject: Projet '" << path << "' chargé." << std::endl;
+    return true; // L'ancien projet est libéré ici, avec 'state'
+}
+
+bool AdikProject::loadInstruments(const std::string& path, std::vector<std::shared_ptr<AdikInstrument>>& instruments,
+                                  bool verifyChecksums) {
+    MappedFile file(path);
+    if (!file.data) {
+        std::cerr << "AdikProject: Impossible d'ouvrir '" << path << "'." << std::endl;
+        return false;
+    }
+    AdikProjectHeader header;
+    std::map<std::string, SectionView> views;
+    std::vector<std::shared_ptr<AdikInstrument>> loaded;
+    if (!readSections(file, path, verifyChecksums, header, views) || !readInstruments(views, loaded)) {
+        return false;
+    }
+    instruments.swap(loaded);
+    return true;
+}
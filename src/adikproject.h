@@ -0,0 +1,157 @@
+#ifndef ADIKPROJECT_H
+#define ADIKPROJECT_H
+
+#include <cstddef> // Pour offsetof
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <memory>
+
+class AdikPlayer; // Déclaration anticipée
+class AdikInstrument;
+struct AdikProjectState;
+struct AdikSampleAnalysisOptions;
+
+/*
+ * Format de projet binaire AdikPlan (.adkp), version 1.
+ *
+ * Le fichier est conçu pour être projeté en mémoire (mmap) et utilisé presque sans analyse :
+ * toutes les structures sont de taille fixe, alignées, en petit-boutiste, et les événements
+ * sont stockés en tableaux par attribut (comme AdikEventList), copiés tels quels au chargement.
+ *
+ *   AdikProjectHeader
+ *   AdikProjectSection[sectionCount]   (table des sections)
+ *   sections, chacune alignée sur 16 octets et protégée par un CRC-32
+ *
+ * Sections connues :
+ *   STRS  table de chaînes (terminées par '\0'), référencées par leur offset
+ *   PLYR  AdikProjectPlayerRecord : tempo, mode, nombre de séquences du Player
+ *   INST  AdikProjectInstrumentRecord[]
+ *   SMPL  blocs de samples float32 embarqués (référencés par INST)
+ *   SEQS  AdikProjectSequenceRecord[] (les playerSequenceCount premières forment AdikPlayer::sequenceList)
+ *   TRKS  AdikProjectTrackRecord[]
+ *   EVST, EVIN, EVVL, EVPN, EVPT  tableaux d'événements : pas, instrument, vélocité, pan, pitch
+ *   SONG  AdikProjectSongRecord suivi de slotCount index de séquences (uint32)
+ *   TMPO  AdikProjectTempoPointRecord[] (cartes de tempo du morceau et des séquences)
+ *
+ * Compatibilité ascendante : un lecteur ignore les sections qu'il ne connaît pas, et n'accepte
+ * que les fichiers de même version majeure. Une version mineure supérieure peut ajouter des
+ * sections ou des champs en fin d'enregistrement (recordSize donne la taille réelle).
+ */
+
+const uint16_t ADIK_PROJECT_VERSION_MAJOR = 1;
+const uint16_t ADIK_PROJECT_VERSION_MINOR = 1; // 1.1 : enveloppe des instruments (INST)
+const uint32_t ADIK_PROJECT_NO_STRING = 0xFFFFFFFFu;
+const uint64_t ADIK_PROJECT_NO_SAMPLES = 0xFFFFFFFFFFFFFFFFull;
+
+struct AdikProjectHeader {
+    char magic[8];            // "ADIKPRJ\0"
+    uint16_t versionMajor;
+    uint16_t versionMinor;
+    uint32_t sectionCount;
+    uint64_t fileSize;
+    uint32_t tableCrc;        // CRC-32 de la table des sections
+    uint32_t headerCrc;       // CRC-32 des champs précédents
+};
+
+struct AdikProjectSection {
+    char id[4];
+    uint32_t recordSize;      // Taille d'un enregistrement (0 pour les blocs bruts)
+    uint64_t offset;          // Depuis le début du fichier
+    uint64_t size;            // En octets
+    uint32_t crc;             // CRC-32 du contenu
+    uint32_t reserved;
+};
+
+struct AdikProjectPlayerRecord {
+    double tempoBPM;
+    uint32_t sampleRate;
+    int32_t playbackMode;
+    int32_t selectedSequenceInPlayerIndex;
+    uint32_t playerSequenceCount;
+};
+
+struct AdikProjectInstrumentRecord {
+    uint32_t idString;
+    uint32_t nameString;
+    uint32_t pathString;
+    uint32_t numChannels;
+    float defaultVolume;
+    float defaultPan;
+    float defaultPitch;
+    uint32_t sampleRate;
+    uint64_t sampleOffset;    // Offset dans SMPL, en octets (ADIK_PROJECT_NO_SAMPLES si non embarqué)
+    uint64_t sampleCount;     // Nombre de floats
+    // Version 1.1 : enveloppe (AdikEnvelopeParams) ; à zéro dans un fichier 1.0, soit l'enveloppe neutre
+    uint32_t envelopeMode;
+    float envelopeAttack;
+    float envelopeHold;
+    float envelopeDecay;
+    float envelopeSustain;
+    float envelopeRelease;
+    float envelopeGate;
+    uint32_t reserved;
+};
+
+// Taille d'un enregistrement d'instrument en version 1.0
+const size_t ADIK_PROJECT_INSTRUMENT_RECORD_V10_SIZE = offsetof(AdikProjectInstrumentRecord, envelopeMode);
+
+struct AdikProjectSequenceRecord {
+    uint32_t nameString;
+    int32_t numberOfMeasures;
+    int32_t stepsPerMeasure;
+    int32_t lengthInSteps;
+    uint32_t firstTrack;
+    uint32_t trackCount;
+    uint32_t firstTempoPoint;
+    uint32_t tempoPointCount;
+};
+
+struct AdikProjectTrackRecord {
+    uint32_t nameString;
+    float volume;
+    uint8_t isMuted;
+    uint8_t isSoloed;
+    uint8_t reserved[2];
+    int32_t mixerChannelIndex;
+    uint64_t firstEvent;
+    uint64_t eventCount;
+};
+
+struct AdikProjectSongRecord {
+    uint32_t nameString;
+    uint32_t slotCount;
+    uint32_t firstTempoPoint;
+    uint32_t tempoPointCount;
+};
+
+struct AdikProjectTempoPointRecord {
+    int32_t step;
+    uint32_t curve;
+    double bpm;
+};
+
+// --- AdikProject ---
+// Sauvegarde et chargement d'un projet complet du Player (instruments, séquences, morceau, tempo).
+class AdikProject {
+public:
+    // Enregistre le projet. Si embedSamples est vrai, les données audio des instruments sont incluses.
+    static bool save(const AdikPlayer& player, const std::string& path, bool embedSamples = true);
+
+    // Lit un projet sans toucher au Player (tout thread non temps réel) : instruments analysés selon 'analysis',
+    // kit, séquences, morceau et réglages. Le résultat est adopté par AdikPlayer::publishProject.
+    // verifyChecksums : vérifie le CRC de chaque section avant utilisation.
+    static bool read(const std::string& path, AdikProjectState& state, const AdikSampleAnalysisOptions& analysis,
+                     bool verifyChecksums = true);
+
+    // Charge un projet dans le Player : read() sur le thread appelant, puis AdikPlayer::publishProject (adopté au début
+    // d'un bloc du thread audio si le flux est démarré, transport arrêté). Faux si le projet est invalide ou si le
+    // thread audio ne l'a pas pris à temps : le Player est alors inchangé. Thread non temps réel.
+    static bool load(AdikPlayer& player, const std::string& path, bool verifyChecksums = true);
+
+    // Lit seulement les instruments d'un projet (ex. pour en faire un kit, voir AdikKitLoader), sans toucher au Player
+    static bool loadInstruments(const std::string& path, std::vector<std::shared_ptr<AdikInstrument>>& instruments,
+                                bool verifyChecksums = true);
+};
+
+#endif // ADIKPROJECT_H
@@ -0,0 +1,26 @@
+#ifndef ADIKPROJECTSTATE_H
+#define ADIKPROJECTSTATE_H
+
+#include <string>
+#include <vector>
+#include <memory>
+
+#include "adikkit.h"
+#include "adiksequence.h"
+#include "adiksong.h"
+
+// --- AdikProjectState ---
+// Contenu d'un projet lu hors du Player (voir AdikProject::read) : kit, séquences du Player, morceau et réglages.
+// AdikPlayer::publishProject le fait adopter d'un coup, au début d'un bloc du thread audio : les séquences et le
+// morceau y sont échangés avec ceux du Player. L'état contient alors l'ancien projet, libéré hors du thread audio.
+struct AdikProjectState {
+    std::string name;
+    std::shared_ptr<AdikKit> kit;                            // Handles des événements = index dans ce kit
+    std::vector<std::shared_ptr<AdikSequence>> sequenceList; // Séquences du Player
+    std::shared_ptr<AdikSong> song;
+    double tempoBPM = 0.0;                  // 0 : tempo du Player inchangé
+    int playbackMode = 0;                   // AdikPlayer::PlaybackMode
+    int selectedSequenceInPlayerIndex = 0;  // Valide dans sequenceList (ou 0)
+};
+
+#endif // ADIKPROJECTSTATE_H
@@ -0,0 +1,146 @@
+#ifndef ADIKQUALITYCONTROLLER_H
+#define ADIKQUALITYCONTROLLER_H
+
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <iostream>
+
+#include "adikseqlock.h"
+
+// Changement de niveau de qualité, conservé pour le journal
+struct AdikQualityTransition {
+    uint64_t block;       // Bloc audio où la décision a été prise
+    int64_t streamFrame;  // Position du flux (frames)
+    int fromLevel;
+    int toLevel;
+    float load;           // Charge lissée au moment de la décision
+    int activeVoices;
+};
+
+// Réglages du contrôleur. Niveaux :
+//   0 : qualité normale
+//   1 : canaux non essentiels (AdikChannel::essential == false) coupés
+//   2 : + polyphonie limitée à voiceLimits[2]
+//   3 : + polyphonie limitée à voiceLimits[3]
+struct AdikQualitySettings {
+    static const int NUM_LEVELS = 4;
+
+    float degradeThresholds[NUM_LEVELS - 1]; // Charge lissée au-delà de laquelle on passe du niveau i à i + 1
+    float restoreMargin;                     // Hystérésis : retour au niveau i si la charge < seuil[i] - marge
+    int restoreHoldBlocks;                   // ... pendant ce nombre de blocs consécutifs
+    int voiceLimits[NUM_LEVELS];             // Polyphonie maximale par niveau (0 : pas de limite)
+    float smoothing;                         // Coefficient du lissage exponentiel de la charge (0..1)
+
+    AdikQualitySettings()
+        : degradeThresholds{ 0.70f, 0.80f, 0.90f }, restoreMargin(0.15f), restoreHoldBlocks(86), // ~1 s à 44.1 kHz / 512
+          voiceLimits{ 0, 0, 4, 2 }, smoothing(0.3f) {}
+};
+
+// --- AdikQualityController ---
+// Dégradation progressive sous surcharge, pilotée par la charge mesurée de chaque callback.
+// update() est appelé par le thread audio à la fin de chaque bloc : il fait monter la qualité d'un cran
+// dès que la charge lissée dépasse le seuil du niveau courant, et ne la rétablit qu'après
+// restoreHoldBlocks blocs sous (seuil - marge), pour éviter les oscillations.
+// Les décisions s'appliquent au mixeur (voir AdikMixer::setQualityLimits) au bloc suivant.
+// Chaque changement est conservé (anneau de HISTORY_SIZE cases, comme AdikXrunMonitor)
+// et imprimé hors du thread audio par printNewTransitions().
+class AdikQualityController {
+public:
+    static const size_t HISTORY_SIZE = 32;
+
+    AdikQualityController()
+        : enabled(true), level(0), smoothedLoad(0.0f), blocksBelow(0), transitions(0), printedTransitions(0) {}
+
+    // Réglages et activation : à faire transport arrêté, avant le démarrage du flux de préférence
+    void configure(const AdikQualitySettings& newSettings) { settings = newSettings; }
+    const AdikQualitySettings& getSettings() const { return settings; }
+    void setEnabled(bool on) { enabled.store(on); }
+    bool isEnabled() const { return enabled.load(); }
+
+    int getLevel() const { return level.load(std::memory_order_relaxed); }
+    float getSmoothedLoad() const { return smoothedLoad; }
+    uint64_t getTransitionCount() const { return transitions.load(std::memory_order_acquire); }
+
+    // Thread audio. Renvoie le niveau à appliquer.
+    int update(float load, uint64_t block, int64_t streamFrame, int activeVoices) {
+        int current = level.load(std::memory_order_relaxed);
+        if (!enabled.load(std::memory_order_relaxed)) {
+            if (current != 0) setLevel(0, block, streamFrame, activeVoices);
+            return 0;
+        }
+
+        smoothedLoad += settings.smoothing * (load - smoothedLoad);
+        // Un bloc en retard (charge >= 1) ne doit pas attendre le lissage
+        const float decisionLoad = load >= 1.0f ? load : smoothedLoad;
+
+        if (current < AdikQualitySettings::NUM_LEVELS - 1 && decisionLoad > settings.degradeThresholds[current]) {
+            blocksBelow = 0;
+            setLevel(current + 1, block, streamFrame, activeVoices);
+        } else if (current > 0 && smoothedLoad < settings.degradeThresholds[current - 1] - settings.restoreMargin) {
+            if (++blocksBelow >= settings.restoreHoldBlocks) {
+                blocksBelow = 0;
+                setLevel(current - 1, block, streamFrame, activeVoices);
+            }
+        } else {
+            blocksBelow = 0;
+        }
+        return level.load(std::memory_order_relaxed);
+    }
+
+    int getVoiceLimit(int forLevel) const {
+        return (forLevel >= 0 && forLevel < AdikQualitySettings::NUM_LEVELS) ? settings.voiceLimits[forLevel] : 0;
+    }
+
+    static const char* levelName(int forLevel) {
+        static const char* names[AdikQualitySettings::NUM_LEVELS] = {
+            "normal", "canaux non essentiels coupés", "polyphonie réduite", "polyphonie minimale"
+        };
+        return (forLevel >= 0 && forLevel < AdikQualitySettings::NUM_LEVELS) ? names[forLevel] : "?";
+    }
+
+    // Hors du thread audio (un seul appelant) : imprime les changements pas encore affichés
+    void printNewTransitions(unsigned int sampleRate) {
+        const uint64_t count = getTransitionCount();
+        uint64_t first = printedTransitions;
+        if (count - first > HISTORY_SIZE) first = count - HISTORY_SIZE; // Les plus anciens ont été écrasés
+        for (uint64_t i = first; i < count; ++i) {
+            AdikQualityTransition transition;
+            if (!history[i % HISTORY_SIZE].read(transition)) continue;
+            char line[200];
+            std::snprintf(line, sizeof(line), "Qualité: %d -> %d (%s) au bloc %llu (%.3f s), charge %.0f%%, %d voix",
+                          transition.fromLevel, transition.toLevel, levelName(transition.toLevel),
+                          static_cast<unsigned long long>(transition.block),
+                          sampleRate ? static_cast<double>(transition.streamFrame) / sampleRate : 0.0,
+                          transition.load * 100.0f, transition.activeVoices);
+            std::cout << line << std::endl;
+        }
+        printedTransitions = count;
+    }
+
+private:
+    AdikQualitySettings settings;
+    std::atomic<bool> enabled;
+    std::atomic<int> level;
+    float smoothedLoad;        // Thread audio
+    int blocksBelow;           // Thread audio
+    std::atomic<uint64_t> transitions;
+    uint64_t printedTransitions;
+    AdikSeqLock<AdikQualityTransition> history[HISTORY_SIZE];
+
+    void setLevel(int newLevel, uint64_t block, int64_t streamFrame, int activeVoices) {
+        AdikQualityTransition transition;
+        transition.block = block;
+        transition.streamFrame = streamFrame;
+        transition.fromLevel = level.load(std::memory_order_relaxed);
+        transition.toLevel = newLevel;
+        transition.load = smoothedLoad;
+        transition.activeVoices = activeVoices;
+        const uint64_t index = transitions.load(std::memory_order_relaxed);
+        history[index % HISTORY_SIZE].write(transition);
+        transitions.store(index + 1, std::memory_order_release);
+        level.store(newLevel, std::memory_order_relaxed);
+    }
+};
+
+#endif // ADIKQUALITYCONTROLLER_H
@@ -0,0 +1,200 @@
+#include "adikrealtime.h"
+
+#include <iostream>
+#include <cstdlib>
+#include <cstdint>
+#include <cstring>   // Pour std::strerror, std::memset
+#include <cerrno>
+#include <string>
+
+#include <alloca.h>
+#include <pthread.h>
+#include <sched.h>
+#include <unistd.h>       // Pour sysconf
+#include <sys/mman.h>     // Pour mlockall
+#include <sys/resource.h> // Pour getrlimit
+
+#if defined(__SSE__) || defined(__x86_64__)
+#include <xmmintrin.h>    // Pour _mm_getcsr, _mm_setcsr
+#endif
+
+#if defined(__linux__)
+static const long CPU_LIMIT = CPU_SETSIZE; // Cœurs adressables par setAffinity
+#else
+static const long CPU_LIMIT = 1024;
+#endif
+
+// Entier décimal complet (sans caractère en trop), faux sinon
+static bool parseInteger(const char* text, long& value) {
+    char* end = nullptr;
+    errno = 0;
+    value = std::strtol(text, &end, 10);
+    return end != text && *end == '\0' && errno == 0;
+}
+
+AdikRealtimeOptions AdikRealtimeOptions::fromEnvironment() {
+    AdikRealtimeOptions options;
+    if (const char* env = std::getenv("ADIK_RT")) {
+        options.enabled = std::string(env) != "off";
+    }
+    if (const char* env = std::getenv("ADIK_RT_PRIORITY")) {
+        long priority = 0;
+        if (parseInteger(env, priority) && priority >= 1 && priority <= 99) options.priority = static_cast<int>(priority);
+    }
+    if (const char* env = std::getenv("ADIK_RT_CPU")) {
+        long cpu = -1;
+        if (parseInteger(env, cpu) && cpu >= 0 && cpu < CPU_LIMIT) {
+            options.cpu = static_cast<int>(cpu);
+        } else {
+            std::cerr << "Avertissement: ADIK_RT_CPU invalide (" << env << ", attendu 0 à " << CPU_LIMIT - 1
+                      << ") : pas d'affinité." << std::endl;
+        }
+    }
+    if (const char* env = std::getenv("ADIK_RT_MLOCK")) {
+        options.lockMemory = std::string(env) != "off";
+    }
+    return options;
+}
+
+// " - message (indice)" pour un code errno, vide sinon
+static std::string errorText(int error, const char* eprmHint) {
+    if (error == 0) return "";
+    std::string text = std::string(" - ") + std::strerror(error);
+    if (error == EPERM && eprmHint) text += std::string(" (") + eprmHint + ")";
+    return text;
+}
+
+void AdikRealtimeReport::print(const AdikRealtimeOptions& options) const {
+    std::cout << "Temps réel :" << std::endl;
+    if (options.lockMemory) {
+        std::cout << "  Mémoire verrouillée (mlockall) : "
+                  << (memoryLocked ? (memoryLockFuture ? "oui (actuelle et future)" : "oui (actuelle)") : "non")
+                  << (memoryLockError.empty() ? "" : " - " + memoryLockError) << std::endl;
+        std::cout << "  Pré-chargement : " << prefaultedBytes / 1024 << " Kio de buffers et de samples" << std::endl;
+    } else {
+        std::cout << "  Verrouillage mémoire : désactivé" << std::endl;
+    }
+    if (!threadSetupDone) {
+        std::cout << "  Thread audio : pas encore démarré" << std::endl;
+        return;
+    }
+    if (options.enabled) {
+        std::cout << "  Ordonnancement SCHED_FIFO : " << (realtimeScheduling ? "oui, priorité " + std::to_string(threadPriority) : "non")
+                  << errorText(schedulingError, "RLIMIT_RTPRIO / CAP_SYS_NICE") << std::endl;
+    } else {
+        std::cout << "  Ordonnancement temps réel : désactivé" << std::endl;
+    }
+    if (options.cpu >= 0) {
+        std::cout << "  Affinité (cœur " << options.cpu << ") : " << (affinitySet ? "oui" : "non")
+                  << errorText(affinityError, nullptr) << std::endl;
+    }
+    std::cout << "  Dénormalisés mis à zéro (FTZ/DAZ) : " << (denormalsFlushed ? "oui" : "non") << std::endl;
+    if (options.lockMemory) {
+        std::cout << "  Pile du thread audio pré-chargée : " << stackPrefaultedBytes / 1024 << " Kio" << std::endl;
+    }
+}
+
+namespace AdikRealtime {
+
+bool lockMemory(AdikRealtimeReport& report) {
+    struct rlimit limit;
+    const bool unlimited = getrlimit(RLIMIT_MEMLOCK, &limit) == 0 && limit.rlim_cur == RLIM_INFINITY;
+    const int flags = MCL_CURRENT | (unlimited ? MCL_FUTURE : 0);
+    if (mlockall(flags) != 0) {
+        const int error = errno;
+        report.memoryLocked = false;
+        report.memoryLockError = std::strerror(error);
+        if (error == ENOMEM || error == EPERM) {
+            report.memoryLockError += " (RLIMIT_MEMLOCK / CAP_IPC_LOCK)";
+        }
+        return false;
+    }
+    report.memoryLocked = true;
+    report.memoryLockFuture = unlimited;
+    return true;
+}
+
+size_t prefault(void* data, size_t bytes) {
+    if (!data || bytes == 0) return 0;
+    static const long pageSize = sysconf(_SC_PAGESIZE);
+    const size_t step = pageSize > 0 ? static_cast<size_t>(pageSize) : 4096;
+    volatile unsigned char* bytesPtr = static_cast<volatile unsigned char*>(data);
+    for (size_t offset = 0; offset < bytes; offset += step) {
+        bytesPtr[offset] = bytesPtr[offset]; // Lecture puis écriture : page présente et privée
+    }
+    bytesPtr[bytes - 1] = bytesPtr[bytes - 1];
+    return bytes;
+}
+
+size_t prefaultStack(size_t bytes) {
+    // Zone locale de la taille demandée, écrite page par page : les pages de pile sont alors présentes
+    // (et verrouillées si mlockall a réussi). L'accès volatile empêche le compilateur de supprimer les écritures.
+    if (bytes == 0) return 0;
+    volatile unsigned char* stack = static_cast<volatile unsigned char*>(alloca(bytes));
+    static const long pageSize = sysconf(_SC_PAGESIZE);
+    const size_t step = pageSize > 0 ? static_cast<size_t>(pageSize) : 4096;
+    for (size_t offset = 0; offset < bytes; offset += step) {
+        stack[offset] = 0;
+    }
+    stack[bytes - 1] = 0;
+    return bytes;
+}
+
+bool flushDenormals() {
+#if defined(__SSE__) || defined(__x86_64__)
+    // FTZ (bit 15) : résultats dénormalisés mis à zéro ; DAZ (bit 6) : entrées dénormalisées lues comme zéro
+    _mm_setcsr(_mm_getcsr() | 0x8040);
+    return (_mm_getcsr() & 0x8040) == 0x8040;
+#elif defined(__aarch64__)
+    uint64_t fpcr;
+    __asm__ __volatile__("mrs %0, fpcr" : "=r"(fpcr));
+    fpcr |= (1ull << 24); // FZ
+    __asm__ __volatile__("msr fpcr, %0" : : "r"(fpcr));
+    __asm__ __volatile__("mrs %0, fpcr" : "=r"(fpcr));
+    return (fpcr & (1ull << 24)) != 0;
+#else
+    return false;
+#endif
+}
+
+bool ensureRealtimeScheduling(int priority, int& actualPriority, int& error) {
+    int policy = 0;
+    struct sched_param param;
+    if (pthread_getschedparam(pthread_self(), &policy, &param) == 0 && (policy == SCHED_FIFO || policy == SCHED_RR)) {
+        actualPriority = param.sched_priority; // Déjà fait par le driver (RTAUDIO_SCHEDULE_REALTIME)
+        return true;
+    }
+    std::memset(&param, 0, sizeof(param));
+    param.sched_priority = priority;
+    const int result = pthread_setschedparam(pthread_self(), SCHED_FIFO, &param);
+    if (result != 0) {
+        error = result;
+        return false;
+    }
+    actualPriority = priority;
+    return true;
+}
+
+bool setAffinity(int cpu, int& error) {
+#if defined(__linux__)
+    if (cpu < 0 || cpu >= CPU_SETSIZE) { // CPU_SET n'est pas borné
+        error = EINVAL;
+        return false;
+    }
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cpu, &set);
+    const int result = pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+    if (result != 0) {
+        error = result;
+        return false;
+    }
+    return true;
+#else
+    (void)cpu;
+    error = ENOSYS;
+    return false;
+#endif
+}
+
+} // namespace AdikRealtime
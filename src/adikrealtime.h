@@ -0,0 +1,74 @@
+#ifndef ADIKREALTIME_H
+#define ADIKREALTIME_H
+
+#include <cstddef>
+#include <string>
+
+// Réglages de la mise en condition temps réel (voir AudioEngine::start).
+// fromEnvironment() lit ADIK_RT (off), ADIK_RT_PRIORITY (1-99), ADIK_RT_CPU (cœur du thread audio), ADIK_RT_MLOCK (off).
+struct AdikRealtimeOptions {
+    bool enabled;             // Ordonnancement temps réel demandé au driver (SCHED_FIFO)
+    int priority;             // Priorité SCHED_FIFO du thread audio
+    int cpu;                  // Cœur du thread audio, -1 : pas d'affinité
+    bool lockMemory;          // mlockall + pré-chargement des buffers et des samples
+    size_t stackPrefaultBytes;
+
+    AdikRealtimeOptions() : enabled(true), priority(80), cpu(-1), lockMemory(true), stackPrefaultBytes(256 * 1024) {}
+
+    static AdikRealtimeOptions fromEnvironment();
+};
+
+// Bilan des étapes : les champs "thread audio" sont remplis au premier callback
+struct AdikRealtimeReport {
+    // Thread principal, avant l'ouverture du flux
+    bool memoryLocked;
+    bool memoryLockFuture;    // MCL_FUTURE en plus (seulement si RLIMIT_MEMLOCK est illimitée)
+    std::string memoryLockError;
+    size_t prefaultedBytes;   // Buffers et samples touchés page par page
+
+    // Thread audio
+    bool threadSetupDone;
+    bool realtimeScheduling;  // Le thread audio tourne en SCHED_FIFO (ou SCHED_RR)
+    int threadPriority;
+    int schedulingError;      // Codes errno : pas de std::string écrite depuis le thread audio
+    bool affinitySet;
+    int affinityError;
+    bool denormalsFlushed;    // FTZ/DAZ (x86) ou FZ (ARM) actifs
+    size_t stackPrefaultedBytes;
+
+    AdikRealtimeReport()
+        : memoryLocked(false), memoryLockFuture(false), prefaultedBytes(0), threadSetupDone(false),
+          realtimeScheduling(false), threadPriority(0), schedulingError(0), affinitySet(false), affinityError(0), denormalsFlushed(false), stackPrefaultedBytes(0) {}
+
+    void print(const AdikRealtimeOptions& options) const;
+};
+
+// --- AdikRealtime ---
+// Outils de mise en condition du thread audio et de la mémoire (POSIX / Linux).
+// Les pics de latence viennent surtout des défauts de page (première écriture, pages évincées)
+// et des nombres dénormalisés (queues de décroissance, filtres) : ces fonctions les éliminent au démarrage.
+namespace AdikRealtime {
+
+// mlockall(MCL_CURRENT [| MCL_FUTURE]). MCL_FUTURE n'est demandé que si la limite RLIMIT_MEMLOCK est illimitée,
+// pour ne pas faire échouer les allocations suivantes.
+bool lockMemory(AdikRealtimeReport& report);
+
+// Touche chaque page de [data, data + bytes) (lecture puis réécriture). Renvoie le nombre d'octets parcourus.
+size_t prefault(void* data, size_t bytes);
+
+// Touche 'bytes' octets de pile du thread courant
+size_t prefaultStack(size_t bytes);
+
+// Active flush-to-zero / denormals-are-zero sur le thread courant
+bool flushDenormals();
+
+// Place le thread courant en SCHED_FIFO s'il ne l'est pas déjà (le driver peut l'avoir fait).
+// error reçoit le code errno en cas d'échec.
+bool ensureRealtimeScheduling(int priority, int& actualPriority, int& error);
+
+// Fixe le thread courant sur un cœur ; EINVAL hors de [0, CPU_SETSIZE)
+bool setAffinity(int cpu, int& error);
+
+} // namespace AdikRealtime
+
+#endif // ADIKREALTIME_H
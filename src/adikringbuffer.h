@@ -0,0 +1,74 @@
+#ifndef ADIKRINGBUFFER_H
+#define ADIKRINGBUFFER_H
+
+#include <vector>
+#include <atomic>
+#include <cstddef>
+
+// --- AdikRingBuffer ---
+// File circulaire sans verrou, un seul producteur et un seul consommateur (SPSC).
+// Aucune allocation après construction : utilisable depuis le thread audio.
+// La capacité est arrondie à la puissance de deux supérieure.
+template <typename T>
+class AdikRingBuffer {
+public:
+    explicit AdikRingBuffer(size_t minCapacity = 1024) : head(0), tail(0) {
+        size_t capacity = 2;
+        while (capacity < minCapacity) capacity <<= 1;
+        buffer.resize(capacity);
+        mask = capacity - 1;
+    }
+
+    size_t capacity() const { return buffer.size(); }
+
+    // Producteur : ajoute un élément, renvoie false si la file est pleine
+    bool push(const T& item) {
+        const size_t t = tail.load(std::memory_order_relaxed);
+        if (t - head.load(std::memory_order_acquire) >= buffer.size()) {
+            return false;
+        }
+        buffer[t & mask] = item;
+        tail.store(t + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Consommateur : lit l'élément en tête sans le retirer
+    bool peek(T& item) const {
+        const size_t h = head.load(std::memory_order_relaxed);
+        if (h == tail.load(std::memory_order_acquire)) {
+            return false;
+        }
+        item = buffer[h & mask];
+        return true;
+    }
+
+    // Consommateur : retire l'élément en tête
+    bool pop(T& item) {
+        if (!peek(item)) return false;
+        head.store(head.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Consommateur : retire l'élément en tête (déjà lu par peek)
+    void discard() {
+        const size_t h = head.load(std::memory_order_relaxed);
+        if (h != tail.load(std::memory_order_acquire)) {
+            head.store(h + 1, std::memory_order_release);
+        }
+    }
+
+    // Nombre approximatif d'éléments (exact depuis le producteur ou le consommateur)
+    size_t size() const {
+        return tail.load(std::memory_order_acquire) - head.load(std::memory_order_acquire);
+    }
+
+    bool empty() const { return size() == 0; }
+
+private:
+    std::vector<T> buffer;
+    size_t mask;
+    alignas(64) std::atomic<size_t> head; // Index de lecture (consommateur)
+    alignas(64) std::atomic<size_t> tail; // Index d'écriture (producteur)
+};
+
+#endif // ADIKRINGBUFFER_H
@@ -0,0 +1,414 @@
+#include "adiksampleanalyzer.h"
+#include "adikinstrument.h"
+#include "adiksoundcache.h"
+#include "adikchecksum.h"
+
+#include <cmath>
+#include <cstring>     // Pour std::memcpy, std::memcmp
+#include <cstddef>     // Pour offsetof
+#include <cstdio>      // Pour std::rename, std::remove, std::snprintf
+#include <cstdlib>     // Pour std::getenv, std::strtof
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <iterator>    // Pour std::istreambuf_iterator
+#include <thread>
+#include <functional>  // Pour std::hash
+
+#include <sys/stat.h>  // Pour stat
+#include <unistd.h>    // Pour getpid
+
+// ============================================================================
+// AdikPeakCache
+
+void AdikPeakCache::build(const float* data, size_t frames, unsigned int numChannels) {
+    levels.clear();
+    numFrames = frames;
+    if (frames == 0 || numChannels == 0) return;
+
+    Level base;
+    base.framesPerBin = BASE_FRAMES_PER_BIN;
+    const size_t bins = (frames + BASE_FRAMES_PER_BIN - 1) / BASE_FRAMES_PER_BIN;
+    base.minima.resize(bins);
+    base.maxima.resize(bins);
+    for (size_t b = 0; b < bins; ++b) {
+        const size_t first = b * BASE_FRAMES_PER_BIN * numChannels;
+        const size_t last = std::min(frames, (b + 1) * BASE_FRAMES_PER_BIN) * numChannels;
+        float low = data[first];
+        float high = data[first];
+        for (size_t i = first + 1; i < last; ++i) {
+            low = std::min(low, data[i]);
+            high = std::max(high, data[i]);
+        }
+        base.minima[b] = low;
+        base.maxima[b] = high;
+    }
+    levels.push_back(std::move(base));
+
+    // Niveaux plus grossiers : regroupement des cases du niveau précédent
+    while (levels.back().minima.size() > 1) {
+        const Level& finer = levels.back();
+        Level coarser;
+        coarser.framesPerBin = finer.framesPerBin * LEVEL_FACTOR;
+        const size_t count = (finer.minima.size() + LEVEL_FACTOR - 1) / LEVEL_FACTOR;
+        coarser.minima.resize(count);
+        coarser.maxima.resize(count);
+        for (size_t b = 0; b < count; ++b) {
+            const size_t first = b * LEVEL_FACTOR;
+            const size_t last = std::min(finer.minima.size(), first + LEVEL_FACTOR);
+            coarser.minima[b] = *std::min_element(finer.minima.begin() + first, finer.minima.begin() + last);
+            coarser.maxima[b] = *std::max_element(finer.maxima.begin() + first, finer.maxima.begin() + last);
+        }
+        levels.push_back(std::move(coarser));
+    }
+}
+
+const AdikPeakCache::Level* AdikPeakCache::levelFor(double framesPerColumn) const {
+    if (levels.empty()) return nullptr;
+    for (size_t i = levels.size(); i-- > 0;) {
+        if (levels[i].framesPerBin <= framesPerColumn) return &levels[i];
+    }
+    return &levels.front();
+}
+
+void AdikPeakCache::query(size_t startFrame, size_t endFrame, int columns, float* minima, float* maxima) const {
+    if (columns <= 0) return;
+    endFrame = std::min(endFrame, numFrames);
+    const Level* level = endFrame > startFrame ? levelFor(static_cast<double>(endFrame - startFrame) / columns) : nullptr;
+    for (int c = 0; c < columns; ++c) {
+        minima[c] = 0.0f;
+        maxima[c] = 0.0f;
+        if (!level) continue;
+        const size_t from = startFrame + (endFrame - startFrame) * c / columns;
+        const size_t to = startFrame + (endFrame - startFrame) * (c + 1) / columns;
+        const size_t firstBin = from / level->framesPerBin;
+        const size_t lastBin = std::min(level->minima.size(), std::max(firstBin + 1, (to + level->framesPerBin - 1) / level->framesPerBin));
+        if (firstBin >= lastBin) continue;
+        minima[c] = *std::min_element(level->minima.begin() + firstBin, level->minima.begin() + lastBin);
+        maxima[c] = *std::max_element(level->maxima.begin() + firstBin, level->maxima.begin() + lastBin);
+    }
+}
+
+// ============================================================================
+// AdikSampleAnalysisOptions
+
+AdikSampleAnalysisOptions AdikSampleAnalysisOptions::fromEnvironment() {
+    AdikSampleAnalysisOptions options;
+    if (const char* env = std::getenv("ADIK_SAMPLE_TRIM")) {
+        options.trim = std::string(env) != "off";
+    }
+    if (const char* env = std::getenv("ADIK_SAMPLE_TRIM_DB")) {
+        const float db = std::strtof(env, nullptr);
+        if (db < 0.0f) options.leadingThresholdDb = options.trailingThresholdDb = db;
+    }
+    if (const char* env = std::getenv("ADIK_SAMPLE_NORMALIZE")) {
+        if (std::string(env) != "off") {
+            options.normalize = true;
+            const float db = std::strtof(env, nullptr);
+            if (db <= 0.0f) options.normalizePeakDb = db;
+        }
+    }
+    if (const char* env = std::getenv("ADIK_SAMPLE_STORAGE")) {
+        if (!AdikSampleStore::parseFormat(env, options.storage)) {
+            std::cerr << "AdikSampleAnalyzer: ADIK_SAMPLE_STORAGE='" << env << "' inconnu (float, int16 ou int24)." << std::endl;
+        }
+    }
+    return options;
+}
+
+// ============================================================================
+// Fichier d'analyse (".adka")
+
+namespace {
+
+const char ANALYSIS_MAGIC[8] = {'A', 'D', 'I', 'K', 'A', 'N', 'A', '\0'};
+const uint32_t ANALYSIS_VERSION = 1;
+const char* ANALYSIS_SUFFIX = ".adka";
+
+// En-tête, suivi de l'identité (source et réglages) puis des niveaux du cache de crêtes :
+// pour chaque niveau, framesPerBin (uint32), nombre de cases (uint32), minima puis maxima (float32)
+struct AnalysisHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t identityLength;
+    uint32_t numChannels;
+    uint32_t sampleRate;
+    uint64_t originalFrames;
+    uint64_t leadingFrames;
+    uint64_t frames;
+    float peak;
+    float rms;
+    float gain;
+    uint32_t levelCount;
+    uint32_t dataCrc;     // CRC-32 de tout ce qui suit l'en-tête
+    uint32_t headerCrc;   // CRC-32 des champs précédents
+};
+
+float fromDb(float db) {
+    return std::pow(10.0f, db / 20.0f);
+}
+
+// Identité de la source et des réglages : le fichier d'analyse n'est réutilisé que si elle est identique
+std::string identityOf(const AdikInstrument& instrument, const AdikSampleAnalysisOptions& options) {
+    std::string identity;
+    if (!instrument.sound.cacheKey.empty()) {
+        identity = "key:" + instrument.sound.cacheKey;
+    } else {
+        struct stat st;
+        if (::stat(instrument.audioFilePath.c_str(), &st) != 0) return "";
+        identity = "file:" + instrument.audioFilePath + ":size=" + std::to_string(st.st_size)
+                 + ":mtime=" + std::to_string(static_cast<long long>(st.st_mtim.tv_sec) * 1000000000LL + st.st_mtim.tv_nsec);
+    }
+    char settings[128];
+    std::snprintf(settings, sizeof(settings), "|trim=%d:%a:%a|norm=%d:%a", options.trim ? 1 : 0, options.leadingThresholdDb,
+                  options.trailingThresholdDb, options.normalize ? 1 : 0, options.normalizePeakDb);
+    return identity + settings;
+}
+
+bool writeSidecar(const std::string& path, const std::string& identity, const AdikSampleAnalysis& analysis, unsigned int numChannels) {
+    std::string body = identity;
+    auto append = [&body](const void* data, size_t size) {
+        body.append(static_cast<const char*>(data), size);
+    };
+    for (const auto& level : analysis.peakCache.getLevels()) {
+        const uint32_t count = static_cast<uint32_t>(level.minima.size());
+        append(&level.framesPerBin, sizeof(uint32_t));
+        append(&count, sizeof(uint32_t));
+        append(level.minima.data(), count * sizeof(float));
+        append(level.maxima.data(), count * sizeof(float));
+    }
+
+    AnalysisHeader header;
+    std::memset(&header, 0, sizeof(header));
+    std::memcpy(header.magic, ANALYSIS_MAGIC, sizeof(ANALYSIS_MAGIC));
+    header.version = ANALYSIS_VERSION;
+    header.identityLength = static_cast<uint32_t>(identity.size());
+    header.numChannels = numChannels;
+    header.sampleRate = analysis.sampleRate;
+    header.originalFrames = analysis.originalFrames;
+    header.leadingFrames = analysis.leadingFrames;
+    header.frames = analysis.frames;
+    header.peak = analysis.peak;
+    header.rms = analysis.rms;
+    header.gain = analysis.gain;
+    header.levelCount = static_cast<uint32_t>(analysis.peakCache.getLevels().size());
+    header.dataCrc = adikCrc32(body.data(), body.size());
+    header.headerCrc = adikCrc32(&header, offsetof(AnalysisHeader, headerCrc));
+
+    // Écriture atomique par renommage, comme les entrées du cache de sons.
+    // Fichier temporaire propre au processus et au thread : deux instruments peuvent partager un son.
+    const std::string tmpPath = path + ".tmp" + std::to_string(::getpid()) + "-"
+                              + std::to_string(std::hash<std::thread::id>()(std::this_thread::get_id()));
+    {
+        std::ofstream out(tmpPath, std::ios::binary | std::ios::trunc);
+        if (!out) return false;
+        out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        out.write(body.data(), static_cast<std::streamsize>(body.size()));
+        if (!out) {
+            std::remove(tmpPath.c_str());
+            return false;
+        }
+    }
+    if (std::rename(tmpPath.c_str(), path.c_str()) != 0) {
+        std::remove(tmpPath.c_str());
+        return false;
+    }
+    return true;
+}
+
+// Relit un fichier d'analyse ; faux s'il est absent, corrompu, ou d'une autre source / d'autres réglages
+bool readSidecar(const std::string& path, const std::string& identity, const AdikSound& sound, AdikSampleAnalysis& analysis) {
+    std::ifstream in(path, std::ios::binary);
+    if (!in) return false;
+    AnalysisHeader header;
+    if (!in.read(reinterpret_cast<char*>(&header), sizeof(header))) return false;
+    if (std::memcmp(header.magic, ANALYSIS_MAGIC, sizeof(ANALYSIS_MAGIC)) != 0
+        || header.version != ANALYSIS_VERSION
+        || header.headerCrc != adikCrc32(&header, offsetof(AnalysisHeader, headerCrc))
+        || header.identityLength != identity.size()
+        || header.numChannels != sound.numChannels
+        || header.sampleRate != sound.sampleRate
+        || header.originalFrames != sound.getNumFrames()
+        || header.leadingFrames + header.frames > header.originalFrames) {
+        return false;
+    }
+    const std::string body((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+    if (adikCrc32(body.data(), body.size()) != header.dataCrc || body.compare(0, identity.size(), identity) != 0) return false;
+
+    AdikPeakCache cache;
+    size_t offset = identity.size();
+    for (uint32_t l = 0; l < header.levelCount; ++l) {
+        uint32_t framesPerBin = 0;
+        uint32_t count = 0;
+        if (offset + 2 * sizeof(uint32_t) > body.size()) return false;
+        std::memcpy(&framesPerBin, body.data() + offset, sizeof(uint32_t));
+        std::memcpy(&count, body.data() + offset + sizeof(uint32_t), sizeof(uint32_t));
+        offset += 2 * sizeof(uint32_t);
+        if (count > (body.size() - offset) / (2 * sizeof(float))) return false;
+        AdikPeakCache::Level level;
+        level.framesPerBin = framesPerBin;
+        level.minima.resize(count);
+        level.maxima.resize(count);
+        std::memcpy(level.minima.data(), body.data() + offset, count * sizeof(float));
+        std::memcpy(level.maxima.data(), body.data() + offset + count * sizeof(float), count * sizeof(float));
+        offset += 2 * count * sizeof(float);
+        cache.getLevels().push_back(std::move(level));
+    }
+    cache.setNumFrames(static_cast<size_t>(header.frames));
+
+    analysis.originalFrames = static_cast<size_t>(header.originalFrames);
+    analysis.leadingFrames = static_cast<size_t>(header.leadingFrames);
+    analysis.frames = static_cast<size_t>(header.frames);
+    analysis.trailingFrames = analysis.originalFrames - analysis.leadingFrames - analysis.frames;
+    analysis.sampleRate = header.sampleRate;
+    analysis.peak = header.peak;
+    analysis.rms = header.rms;
+    analysis.gain = header.gain;
+    analysis.peakCache = std::move(cache);
+    return true;
+}
+
+// Niveau d'une frame : maximum des valeurs absolues de ses canaux
+inline float frameLevel(const float* frame, unsigned int numChannels) {
+    float level = 0.0f;
+    for (unsigned int c = 0; c < numChannels; ++c) level = std::max(level, std::fabs(frame[c]));
+    return level;
+}
+
+// Découpe [leading, leading + frames) et applique le gain ; la mémoire libérée est rendue
+void applyTrimAndGain(AdikSound& sound, size_t leading, size_t frames, float gain) {
+    const unsigned int ch = sound.numChannels;
+    std::vector<float>& data = sound.audioData;
+    if (leading > 0 || frames * ch < data.size()) {
+        data.erase(data.begin() + (leading + frames) * ch, data.end());
+        data.erase(data.begin(), data.begin() + leading * ch);
+        data.shrink_to_fit();
+    }
+    if (gain != 1.0f) {
+        for (float& sample : data) sample *= gain;
+    }
+}
+
+} // namespace
+
+// ============================================================================
+// AdikSampleAnalyzer
+
+namespace AdikSampleAnalyzer {
+
+std::string sidecarPath(const AdikInstrument& instrument) {
+    if (!instrument.sound.cacheKey.empty()) {
+        AdikSoundCache* cache = AdikSoundCache::getDefault();
+        return cache ? cache->sidecarPath(instrument.sound.cacheKey, ANALYSIS_SUFFIX) : "";
+    }
+    struct stat st;
+    if (!instrument.audioFilePath.empty() && ::stat(instrument.audioFilePath.c_str(), &st) == 0 && S_ISREG(st.st_mode)) {
+        return instrument.audioFilePath + ANALYSIS_SUFFIX;
+    }
+    return "";
+}
+
+void analyze(AdikInstrument& instrument, const AdikSampleAnalysisOptions& options) {
+    AdikSound& sound = instrument.sound;
+    const unsigned int ch = sound.numChannels ? sound.numChannels : 1;
+    sound.setStorage(AdikSampleStore::FLOAT32); // Découpe et analyse travaillent sur les samples float
+    AdikSampleAnalysis analysis;
+    analysis.sampleRate = sound.sampleRate;
+
+    const std::string path = options.persist ? sidecarPath(instrument) : "";
+    const std::string identity = path.empty() ? "" : identityOf(instrument, options);
+    if (!path.empty() && !identity.empty() && readSidecar(path, identity, sound, analysis)) {
+        applyTrimAndGain(sound, analysis.leadingFrames, analysis.frames, analysis.gain);
+        analysis.analyzed = true;
+        analysis.fromSidecar = true;
+        instrument.analysis = std::move(analysis);
+        sound.setStorage(options.storage);
+        return;
+    }
+
+    const size_t total = sound.getNumFrames();
+    const float* data = sound.audioData.data();
+    analysis.originalFrames = total;
+    size_t first = 0;
+    size_t end = total;
+    if (options.trim) {
+        const float leadingThreshold = fromDb(options.leadingThresholdDb);
+        const float trailingThreshold = fromDb(options.trailingThresholdDb);
+        while (first < total && frameLevel(data + first * ch, ch) < leadingThreshold) ++first;
+        while (end > first && frameLevel(data + (end - 1) * ch, ch) < trailingThreshold) --end;
+    }
+    analysis.leadingFrames = first;
+    analysis.trailingFrames = total - end;
+    analysis.frames = end - first;
+
+    double sumSquares = 0.0;
+    float peak = 0.0f;
+    for (size_t i = first * ch; i < end * ch; ++i) {
+        peak = std::max(peak, std::fabs(data[i]));
+        sumSquares += static_cast<double>(data[i]) * data[i];
+    }
+    analysis.gain = (options.normalize && peak > 0.0f) ? fromDb(options.normalizePeakDb) / peak : 1.0f;
+    applyTrimAndGain(sound, first, analysis.frames, analysis.gain);
+    analysis.peak = peak * analysis.gain;
+    analysis.rms = analysis.frames ? static_cast<float>(std::sqrt(sumSquares / (analysis.frames * ch))) * analysis.gain : 0.0f;
+    analysis.peakCache.build(sound.audioData.data(), analysis.frames, ch);
+    analysis.analyzed = true;
+
+    if (!path.empty() && !identity.empty()) {
+        writeSidecar(path, identity, analysis, ch);
+    }
+    instrument.analysis = std::move(analysis);
+    sound.setStorage(options.storage);
+}
+
+void analyzeAll(const std::vector<std::shared_ptr<AdikInstrument>>& instruments,
+                const AdikSampleAnalysisOptions& options, unsigned int numThreads) {
+    if (instruments.empty()) return;
+    const auto start = std::chrono::steady_clock::now();
+    size_t bytesBefore = 0;
+    for (const auto& instrument : instruments) {
+        if (instrument) bytesBefore += instrument->sound.getMemoryBytes();
+    }
+
+    // Un instrument par tâche : chaque thread prend le suivant jusqu'à épuisement
+    if (numThreads == 0) numThreads = std::max(1u, std::thread::hardware_concurrency());
+    numThreads = static_cast<unsigned int>(std::min<size_t>(numThreads, instruments.size()));
+    std::atomic<size_t> next(0);
+    auto work = [&]() {
+        for (size_t i = next.fetch_add(1); i < instruments.size(); i = next.fetch_add(1)) {
+            if (instruments[i]) analyze(*instruments[i], options);
+        }
+    };
+    std::vector<std::thread> workers;
+    for (unsigned int t = 1; t < numThreads; ++t) workers.emplace_back(work);
+    work();
+    for (auto& worker : workers) worker.join();
+
+    const double elapsedMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    size_t bytesAfter = 0;
+    size_t reused = 0;
+    for (const auto& instrument : instruments) {
+        if (!instrument) continue;
+        bytesAfter += instrument->sound.getMemoryBytes();
+        if (instrument->analysis.fromSidecar) reused++;
+    }
+    std::cout << "AdikSampleAnalyzer: " << instruments.size() << " son(s) analysé(s) en " << elapsedMs << " ms sur "
+              << numThreads << " thread(s), " << reused << " relu(s), "
+              << "samples : " << bytesBefore / 1024 << " Kio -> " << bytesAfter / 1024 << " Kio (découpe, stockage "
+              << AdikSampleStore::formatName(options.storage) << ")." << std::endl;
+    for (const auto& instrument : instruments) {
+        if (!instrument) continue;
+        const AdikSampleAnalysis& a = instrument->analysis;
+        char line[192];
+        std::snprintf(line, sizeof(line), "  %-16s %7.3f s, crête %6.1f dB, RMS %6.1f dB, découpe %.1f ms / %.1f ms%s",
+                      instrument->id.c_str(), a.getSeconds(),
+                      a.peak > 0.0f ? 20.0f * std::log10(a.peak) : -144.0f, a.rms > 0.0f ? 20.0f * std::log10(a.rms) : -144.0f,
+                      a.sampleRate ? 1000.0 * a.leadingFrames / a.sampleRate : 0.0,
+                      a.sampleRate ? 1000.0 * a.trailingFrames / a.sampleRate : 0.0,
+                      a.gain != 1.0f ? " (normalisé)" : "");
+        std::cout << line << std::endl;
+    }
+}
+
+} // namespace AdikSampleAnalyzer
@@ -0,0 +1,107 @@
+#ifndef ADIKSAMPLEANALYZER_H
+#define ADIKSAMPLEANALYZER_H
+
+#include <cstdint>
+#include <cstddef>
+#include <string>
+#include <vector>
+#include <memory>
+#include <algorithm>
+
+#include "adiksamplestore.h"
+
+class AdikInstrument;
+
+// --- AdikPeakCache ---
+// Minima / maxima du sample à plusieurs résolutions, pour dessiner une forme d'onde
+// sans relire les samples : le niveau 0 résume BASE_FRAMES_PER_BIN frames par case,
+// chaque niveau suivant LEVEL_FACTOR fois plus.
+class AdikPeakCache {
+public:
+    static const uint32_t BASE_FRAMES_PER_BIN = 64;
+    static const uint32_t LEVEL_FACTOR = 4;
+
+    struct Level {
+        uint32_t framesPerBin;
+        std::vector<float> minima;   // Tous canaux confondus
+        std::vector<float> maxima;
+    };
+
+    // Construit les niveaux à partir de samples entrelacés
+    void build(const float* data, size_t numFrames, unsigned int numChannels);
+
+    // Niveau le plus fin dont une case couvre au moins 'framesPerColumn' frames (le plus grossier sinon)
+    const Level* levelFor(double framesPerColumn) const;
+
+    // Minimum et maximum de chacune des 'columns' colonnes couvrant [startFrame, endFrame)
+    void query(size_t startFrame, size_t endFrame, int columns, float* minima, float* maxima) const;
+
+    const std::vector<Level>& getLevels() const { return levels; }
+    std::vector<Level>& getLevels() { return levels; }
+    size_t getNumFrames() const { return numFrames; }
+    void setNumFrames(size_t frames) { numFrames = frames; }
+    bool empty() const { return levels.empty(); }
+
+private:
+    std::vector<Level> levels;
+    size_t numFrames = 0;
+};
+
+// Réglages de l'analyse au chargement. fromEnvironment() lit ADIK_SAMPLE_TRIM (off),
+// ADIK_SAMPLE_TRIM_DB (seuil des deux extrémités), ADIK_SAMPLE_NORMALIZE (crête visée en dBFS, ou off)
+// et ADIK_SAMPLE_STORAGE (float, int16 ou int24).
+struct AdikSampleAnalysisOptions {
+    bool trim;
+    float leadingThresholdDb;   // Silence de début : frames sous ce niveau supprimées
+    float trailingThresholdDb;  // Silence de fin
+    bool normalize;
+    float normalizePeakDb;      // Crête après normalisation
+    bool persist;               // Résultats enregistrés à côté du sample (et relus au chargement suivant)
+    AdikSampleStore::Format storage; // Stockage des samples après l'analyse (voir AdikSampleStore)
+
+    AdikSampleAnalysisOptions()
+        : trim(true), leadingThresholdDb(-60.0f), trailingThresholdDb(-60.0f), normalize(false), normalizePeakDb(-1.0f), persist(true),
+          storage(AdikSampleStore::FLOAT32) {}
+
+    static AdikSampleAnalysisOptions fromEnvironment();
+};
+
+// Résultat de l'analyse d'un sample (après découpe et normalisation)
+struct AdikSampleAnalysis {
+    bool analyzed = false;
+    bool fromSidecar = false;      // Relu depuis le fichier d'analyse, sans parcourir les samples
+    size_t originalFrames = 0;     // Longueur avant découpe
+    size_t leadingFrames = 0;      // Frames supprimées au début
+    size_t trailingFrames = 0;     // Frames supprimées à la fin
+    size_t frames = 0;             // Longueur utile
+    unsigned int sampleRate = 0;
+    float peak = 0.0f;             // Crête (linéaire)
+    float rms = 0.0f;
+    float gain = 1.0f;             // Gain de normalisation appliqué
+    AdikPeakCache peakCache;
+
+    double getSeconds() const { return sampleRate ? static_cast<double>(frames) / sampleRate : 0.0; }
+};
+
+// --- AdikSampleAnalyzer ---
+// Analyse au chargement : découpe des silences de début et de fin, crête, RMS, longueur utile,
+// cache de crêtes multi-résolution et normalisation optionnelle. Les résultats sont enregistrés
+// dans un fichier ".adka" à côté du sample : à côté de l'entrée du cache de sons pour un son généré,
+// à côté du fichier audio sinon. Au chargement suivant, la découpe et le gain sont réappliqués
+// directement et le cache de crêtes est relu.
+namespace AdikSampleAnalyzer {
+
+// Analyse le son d'un instrument (et le modifie : découpe, gain). Hors du thread audio.
+void analyze(AdikInstrument& instrument, const AdikSampleAnalysisOptions& options);
+
+// Analyse tous les instruments, en parallèle (un instrument par tâche).
+// numThreads = 0 : nombre de cœurs. Affiche un bilan.
+void analyzeAll(const std::vector<std::shared_ptr<AdikInstrument>>& instruments,
+                const AdikSampleAnalysisOptions& options, unsigned int numThreads = 0);
+
+// Fichier d'analyse d'un son ("" si le son n'a ni entrée de cache ni fichier)
+std::string sidecarPath(const AdikInstrument& instrument);
+
+} // namespace AdikSampleAnalyzer
+
+#endif // ADIKSAMPLEANALYZER_H
@@ -0,0 +1,139 @@
+#include "adiksamplestore.h"
+
+#include <cmath>
+#include <cstring>     // Pour std::memcpy
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+#if defined(__SSSE3__)
+#include <tmmintrin.h> // Pour _mm_shuffle_epi8
+#endif
+
+namespace {
+
+const float INT16_SCALE = 32768.0f;
+const float INT24_SCALE = 8388608.0f;
+
+inline int32_t quantize(float sample, float scale, int32_t maxValue) {
+    const long value = std::lrint(static_cast<double>(sample) * scale);
+    if (value > maxValue) return maxValue;
+    if (value < -maxValue - 1) return -maxValue - 1;
+    return static_cast<int32_t>(value);
+}
+
+// 3 octets petit-boutiste -> entier signé (extension de signe par décalage arithmétique)
+inline int32_t readInt24(const uint8_t* p) {
+    const uint32_t packed = (static_cast<uint32_t>(p[0]) << 8) | (static_cast<uint32_t>(p[1]) << 16) | (static_cast<uint32_t>(p[2]) << 24);
+    return static_cast<int32_t>(packed) >> 8;
+}
+
+void decodeInt16(const int16_t* input, size_t numSamples, float* output) {
+    const float scale = 1.0f / INT16_SCALE;
+    size_t i = 0;
+#if defined(__SSE2__)
+    const __m128 scales = _mm_set1_ps(scale);
+    for (; i + 8 <= numSamples; i += 8) {
+        const __m128i packed = _mm_loadu_si128(reinterpret_cast<const __m128i*>(input + i));
+        // Extension de signe 16 -> 32 bits : chaque valeur dans la moitié haute, puis décalage arithmétique
+        const __m128i low = _mm_srai_epi32(_mm_unpacklo_epi16(packed, packed), 16);
+        const __m128i high = _mm_srai_epi32(_mm_unpackhi_epi16(packed, packed), 16);
+        _mm_storeu_ps(output + i, _mm_mul_ps(_mm_cvtepi32_ps(low), scales));
+        _mm_storeu_ps(output + i + 4, _mm_mul_ps(_mm_cvtepi32_ps(high), scales));
+    }
+#endif
+    for (; i < numSamples; ++i) {
+        output[i] = static_cast<float>(input[i]) * scale;
+    }
+}
+
+void decodeInt24(const uint8_t* input, size_t numSamples, float* output) {
+    const float scale = 1.0f / INT24_SCALE;
+    size_t i = 0;
+#if defined(__SSSE3__)
+    // 4 samples (12 octets) par itération : chaque sample est placé dans les 3 octets hauts d'un entier 32 bits
+    const __m128i shuffle = _mm_setr_epi8(-1, 0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, 9, 10, 11);
+    const __m128 scales = _mm_set1_ps(scale);
+    for (; i + 4 <= numSamples; i += 4) {
+        const __m128i packed = _mm_loadu_si128(reinterpret_cast<const __m128i*>(input + i * 3)); // Lit 4 octets de trop (marge)
+        const __m128i values = _mm_srai_epi32(_mm_shuffle_epi8(packed, shuffle), 8);
+        _mm_storeu_ps(output + i, _mm_mul_ps(_mm_cvtepi32_ps(values), scales));
+    }
+#elif defined(__SSE2__)
+    // Sans pshufb : assemblage scalaire des entiers, conversion et mise à l'échelle vectorielles
+    const __m128 scales = _mm_set1_ps(scale);
+    for (; i + 4 <= numSamples; i += 4) {
+        const uint8_t* p = input + i * 3;
+        const __m128i values = _mm_setr_epi32(readInt24(p), readInt24(p + 3), readInt24(p + 6), readInt24(p + 9));
+        _mm_storeu_ps(output + i, _mm_mul_ps(_mm_cvtepi32_ps(values), scales));
+    }
+#endif
+    for (; i < numSamples; ++i) {
+        output[i] = static_cast<float>(readInt24(input + i * 3)) * scale;
+    }
+}
+
+} // namespace
+
+void AdikSampleStore::encode(const float* samples, size_t numSamples, Format fmt) {
+    clear();
+    if (fmt == FLOAT32) return;
+    format = fmt;
+    count = numSamples;
+    bytes.assign(numSamples * bytesPerSample(fmt) + PADDING, 0);
+    if (fmt == INT16) {
+        for (size_t i = 0; i < numSamples; ++i) {
+            const int16_t value = static_cast<int16_t>(quantize(samples[i], INT16_SCALE, 32767));
+            std::memcpy(bytes.data() + i * 2, &value, sizeof(value));
+        }
+    } else {
+        for (size_t i = 0; i < numSamples; ++i) {
+            const uint32_t value = static_cast<uint32_t>(quantize(samples[i], INT24_SCALE, 8388607));
+            uint8_t* p = bytes.data() + i * 3;
+            p[0] = static_cast<uint8_t>(value);
+            p[1] = static_cast<uint8_t>(value >> 8);
+            p[2] = static_cast<uint8_t>(value >> 16);
+        }
+    }
+}
+
+void AdikSampleStore::decode(size_t start, size_t numSamples, float* output) const {
+    if (start >= count) return;
+    if (numSamples > count - start) numSamples = count - start;
+    if (format == INT16) {
+        // Le tableau d'octets de std::vector est aligné pour tout type fondamental
+        decodeInt16(reinterpret_cast<const int16_t*>(bytes.data()) + start, numSamples, output);
+    } else if (format == INT24) {
+        decodeInt24(bytes.data() + start * 3, numSamples, output);
+    }
+}
+
+void AdikSampleStore::clear() {
+    format = FLOAT32;
+    count = 0;
+    std::vector<uint8_t>().swap(bytes);
+}
+
+size_t AdikSampleStore::bytesPerSample(Format fmt) {
+    switch (fmt) {
+        case INT16: return 2;
+        case INT24: return 3;
+        default: return sizeof(float);
+    }
+}
+
+const char* AdikSampleStore::formatName(Format fmt) {
+    switch (fmt) {
+        case INT16: return "int16";
+        case INT24: return "int24";
+        default: return "float";
+    }
+}
+
+bool AdikSampleStore::parseFormat(const std::string& name, Format& fmt) {
+    if (name == "float" || name == "float32") fmt = FLOAT32;
+    else if (name == "int16") fmt = INT16;
+    else if (name == "int24") fmt = INT24;
+    else return false;
+    return true;
+}
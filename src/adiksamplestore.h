@@ -0,0 +1,51 @@
+#ifndef ADIKSAMPLESTORE_H
+#define ADIKSAMPLESTORE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// --- AdikSampleStore ---
+// Stockage compact des samples d'un son : entiers 16 bits, ou 24 bits empaquetés (3 octets).
+// Les samples sont décodés en float à la lecture, bloc par bloc, directement dans le buffer
+// de la voix (AdikSound::readData) : aucune copie float du son entier n'est gardée.
+// Décodage vectorisé : SSE2 pour INT16, SSSE3 (pshufb) pour INT24 quand il est disponible.
+// Quantification par arrondi (sans dither) : les sources sont en général déjà en 16 ou 24 bits.
+class AdikSampleStore {
+public:
+    enum Format {
+        FLOAT32 = 0, // Pas de stockage compact : AdikSound::audioData
+        INT16 = 1,
+        INT24 = 2
+    };
+
+    AdikSampleStore() : format(FLOAT32), count(0) {}
+
+    // Encode 'numSamples' samples float (entrelacés)
+    void encode(const float* samples, size_t numSamples, Format fmt);
+
+    // Décode 'numSamples' samples à partir de 'start' dans 'output'
+    void decode(size_t start, size_t numSamples, float* output) const;
+
+    void clear();
+
+    Format getFormat() const { return format; }
+    size_t size() const { return count; }           // Nombre de samples
+    size_t getMemoryBytes() const { return bytes.capacity(); }
+    uint8_t* rawData() { return bytes.data(); }     // Pour AdikRealtime::prefault
+
+    static size_t bytesPerSample(Format fmt);
+    static const char* formatName(Format fmt);
+    // "float", "int16", "int24" ; faux si inconnu
+    static bool parseFormat(const std::string& name, Format& fmt);
+
+private:
+    Format format;
+    size_t count;
+    std::vector<uint8_t> bytes; // Complété de PADDING octets : le décodage vectoriel peut lire 16 octets d'un coup
+
+    static const size_t PADDING = 16;
+};
+
+#endif // ADIKSAMPLESTORE_H
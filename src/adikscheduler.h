@@ -0,0 +1,172 @@
+#ifndef ADIKSCHEDULER_H
+#define ADIKSCHEDULER_H
+
+#include "adikplayer.h"
+#include "adikvoicetrigger.h"
+
+#include <memory>
+#include <thread>
+#include <atomic>
+#include <chrono>
+#include <vector>
+#include <mutex>
+#include <iostream>
+
+// --- AdikScheduler ---
+// Planificateur d'événements à l'avance, sur un thread non temps réel.
+// Il parcourt les pas à venir (séquence ou morceau) sur une fenêtre de 'lookaheadMs'
+// en avance sur la tête de lecture, résout solo/mute, vélocité * volume de piste et routage,
+// et pousse des AdikVoiceTrigger horodatés dans AdikPlayer::triggerQueue.
+// Le thread audio n'a plus qu'à dépiler les déclenchements tombant dans son bloc.
+// Les modifications de motifs sont donc prises en compte avec au plus 'lookaheadMs' de retard.
+class AdikScheduler {
+public:
+    AdikScheduler(std::shared_ptr<AdikPlayer> p, double lookahead = 100.0)
+        : player(p), running(false), lookaheadMs(lookahead),
+          cursorValid(false), cursorGeneration(0), cursorStep(0),
+          cursorSequenceIndexInSong(0), cursorStepInSequence(0) {
+        if (!player) {
+            std::cerr << "AdikScheduler créé avec un AdikPlayer nul !" << std::endl;
+        }
+    }
+
+    ~AdikScheduler() {
+        stop();
+    }
+
+    // Démarre le thread de planification et bascule le Player en mode planifié
+    bool start() {
+        if (!player || running.load()) return false;
+        running.store(true);
+        cursorValid = false;
+        worker = std::thread(&AdikScheduler::run, this);
+        player->schedulerEnabled.store(true);
+        player->invalidateSchedule();
+        std::cout << "AdikScheduler: démarré (anticipation " << lookaheadMs.load() << " ms)." << std::endl;
+        return true;
+    }
+
+    // Arrête le thread ; le thread audio reprend le parcours des événements lui-même
+    void stop() {
+        if (!running.load()) return;
+        player->schedulerEnabled.store(false);
+        player->invalidateSchedule();
+        running.store(false);
+        if (worker.joinable()) {
+            worker.join();
+        }
+        std::cout << "AdikScheduler: arrêté." << std::endl;
+    }
+
+    bool isRunning() const { return running.load(); }
+
+    // Fenêtre d'anticipation, en millisecondes (typiquement 50 à 200 ms)
+    void setLookahead(double ms) {
+        if (ms > 0.0) lookaheadMs.store(ms);
+    }
+
+    double getLookahead() const { return lookaheadMs.load(); }
+
+private:
+    std::shared_ptr<AdikPlayer> player;
+    std::thread worker;
+    std::atomic<bool> running;
+    std::atomic<double> lookaheadMs;
+
+    // Curseur de planification : prochain pas à résoudre
+    bool cursorValid;
+    uint32_t cursorGeneration;
+    int64_t cursorStep;              // Pas absolu (même repère que AdikClock::nextStep)
+    int cursorSequenceIndexInSong;
+    int cursorStepInSequence;
+    std::vector<AdikVoiceTrigger> stepTriggers; // Déclenchements du pas en cours de résolution
+
+    void run() {
+        while (running.load()) {
+            scheduleAhead();
+            // Réveil plusieurs fois par fenêtre d'anticipation
+            double sleepMs = lookaheadMs.load() / 4.0;
+            if (sleepMs > 10.0) sleepMs = 10.0;
+            if (sleepMs < 1.0) sleepMs = 1.0;
+            std::this_thread::sleep_for(std::chrono::duration<double, std::milli>(sleepMs));
+        }
+    }
+
+    std::shared_ptr<AdikSequence> sequenceAt(const AdikTimingSnapshot& snapshot, int indexInSong) const {
+        if (snapshot.mode == AdikPlayer::SEQUENCE_MODE) {
+            if (snapshot.selectedSequenceInPlayerIndex >= 0 && snapshot.selectedSequenceInPlayerIndex < static_cast<int>(player->sequenceList.size())) {
+                return player->sequenceList[snapshot.selectedSequenceInPlayerIndex];
+            }
+        } else if (player->currentSong && indexInSong >= 0 && indexInSong < static_cast<int>(player->currentSong->sequences.size())) {
+            return player->currentSong->sequences[indexInSong];
+        }
+        return nullptr;
+    }
+
+    void scheduleAhead() {
+        // Les séquences peuvent être éditées par un autre thread non temps réel (AdikControlServer)
+        std::lock_guard<std::mutex> lock(player->sequenceEditMutex);
+        // La carte de tempo de l'horloge de l'instantané est retenue pour toute la passe : elle peut être retirée
+        // et libérée pendant que ce thread est préempté
+        AdikTimingSnapshot snapshot;
+        std::shared_ptr<const AdikTempoMap> tempoMap;
+        if (!player->readTimingSnapshot(snapshot, tempoMap)) return;
+
+        // Nouvelle génération (saut, changement de tempo, arrêt), ou planificateur en retard
+        // sur la tête de lecture : repartir de la position courante
+        if (!cursorValid || snapshot.generation != cursorGeneration || cursorStep < snapshot.clock.nextStep) {
+            cursorGeneration = snapshot.generation;
+            cursorStep = snapshot.clock.nextStep;
+            cursorSequenceIndexInSong = snapshot.currentSequenceIndexInSong;
+            cursorStepInSequence = snapshot.currentStepInSequence;
+            cursorValid = true;
+        }
+
+        const AdikClock& clock = snapshot.clock;
+        const int64_t horizon = clock.samplePosition
+                              + static_cast<int64_t>(lookaheadMs.load() * clock.sampleRate / 1000.0);
+
+        while (running.load()) {
+            const int64_t stepSample = clock.sampleForStep(cursorStep);
+            if (stepSample >= horizon) break;
+
+            std::shared_ptr<AdikSequence> sequence = sequenceAt(snapshot, cursorSequenceIndexInSong);
+            if (!sequence || sequence->lengthInSteps <= 0) break;
+
+            stepTriggers.clear();
+            player->forEachStepVoice(*sequence, cursorStepInSequence,
+                                     [&](const AdikTrack& track, const AdikEvent& event, float finalVelocity) {
+                AdikVoiceTrigger trigger;
+                trigger.sampleTime = stepSample;
+                trigger.generation = cursorGeneration;
+                trigger.instrument = event.instrument;
+                trigger.mixerChannelIndex = track.mixerChannelIndex;
+                trigger.velocity = finalVelocity;
+                trigger.pan = event.getPan();
+                trigger.pitch = event.getPitch();
+                stepTriggers.push_back(trigger);
+            });
+
+            // Un pas est publié en entier ou pas du tout : réessayer plus tard si la file est pleine
+            if (player->triggerQueue.capacity() - player->triggerQueue.size() < stepTriggers.size()) break;
+            for (const auto& trigger : stepTriggers) {
+                player->triggerQueue.push(trigger);
+            }
+
+            // Avancer le curseur comme AdikPlayer::moveToNextStep
+            cursorStep++;
+            cursorStepInSequence++;
+            if (cursorStepInSequence >= sequence->lengthInSteps) {
+                cursorStepInSequence = 0;
+                if (snapshot.mode == AdikPlayer::SONG_MODE) {
+                    cursorSequenceIndexInSong++;
+                    if (!player->currentSong || cursorSequenceIndexInSong >= static_cast<int>(player->currentSong->sequences.size())) {
+                        cursorSequenceIndexInSong = 0;
+                    }
+                }
+            }
+        }
+    }
+};
+
+#endif // ADIKSCHEDULER_H
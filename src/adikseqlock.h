@@ -0,0 +1,54 @@
+#ifndef ADIKSEQLOCK_H
+#define ADIKSEQLOCK_H
+
+#include <atomic>
+#include <cstring>     // Pour std::memcpy
+#include <type_traits> // Pour std::is_trivially_copyable
+
+// --- AdikSeqLock ---
+// Publication d'un instantané (snapshot) par un seul écrivain, lu par n'importe quel thread,
+// sans verrou ni attente pour l'écrivain (le thread audio) : le lecteur recommence
+// simplement sa lecture si une écriture a eu lieu pendant sa copie.
+template <typename T>
+class AdikSeqLock {
+    static_assert(std::is_trivially_copyable<T>::value, "AdikSeqLock nécessite un type copiable par memcpy");
+
+public:
+    AdikSeqLock() : sequence(0) {
+        std::memset(static_cast<void*>(&data), 0, sizeof(T));
+    }
+
+    // Écrivain unique
+    void write(const T& value) {
+        const unsigned int s = sequence.load(std::memory_order_relaxed);
+        sequence.store(s + 1, std::memory_order_relaxed); // Impair : écriture en cours
+        std::atomic_thread_fence(std::memory_order_release);
+        std::memcpy(static_cast<void*>(&data), &value, sizeof(T));
+        std::atomic_thread_fence(std::memory_order_release);
+        sequence.store(s + 2, std::memory_order_release);
+    }
+
+    // Lecteurs : renvoie false si rien n'a encore été publié
+    bool read(T& out) const {
+        unsigned int before, after;
+        do {
+            before = sequence.load(std::memory_order_acquire);
+            while (before & 1u) {
+                before = sequence.load(std::memory_order_acquire);
+            }
+            std::memcpy(static_cast<void*>(&out), &data, sizeof(T));
+            std::atomic_thread_fence(std::memory_order_acquire);
+            after = sequence.load(std::memory_order_relaxed);
+        } while (before != after);
+        return before != 0;
+    }
+
+    // Nombre de publications (change à chaque write)
+    unsigned int version() const { return sequence.load(std::memory_order_acquire) / 2; }
+
+private:
+    std::atomic<unsigned int> sequence;
+    T data;
+};
+
+#endif // ADIKSEQLOCK_H
@@ -9,6 +9,7 @@
 // IMPORTANT : AdikTrack.h DOIT être inclus avant AdikSequence.h
 // car AdikSequence contient un std::vector<AdikTrack>.
 #include "adiktrack.h" // Assurez-vous que AdikTrack.h est défini et inclus avant
+#include "adiktempomap.h"
 
 class AdikSequence {
 public:
@@ -17,6 +18,7 @@ public:
     int numberOfMeasures;          // Nombre de mesures dans la séquence
     int stepsPerMeasure;           // Nombre de pas par mesure (ex: 16 pour 16ème de notes)
     int lengthInSteps;             // Longueur totale de la séquence en pas (numberOfMeasures * stepsPerMeasure)
+    AdikTempoMap tempoMap;         // Carte de tempo optionnelle (pas relatifs à la séquence), vide par défaut
 
     // Constructeur
     AdikSequence(const std::string& seqName, int numMeasures, int spm)
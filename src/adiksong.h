@@ -5,6 +5,8 @@
 #include <string>
 #include <memory> // Pour std::shared_ptr
 #include <numeric> // Pour std::accumulate si besoin (non utilisé ici directement)
+#include <algorithm> // Pour std::upper_bound
+#include <cmath> // Pour std::llround
 #include <stdexcept> // Pour std::out_of_range
 #include <iostream>
 
@@ -17,13 +19,39 @@ public:
     std::string name;
     // Les séquences sont des shared_ptr car elles peuvent être partagées
     // avec AdikPlayer::sequenceList et utilisées dans plusieurs endroits.
+    // Si ce vecteur est modifié directement (ou si la longueur d'une séquence change),
+    // appeler rebuildTimeline() pour resynchroniser la ligne de temps.
     std::vector<std::shared_ptr<AdikSequence>> sequences;
 
+    // Ligne de temps précompilée (sommes préfixes) :
+    // sequenceStartSteps[i] est le pas absolu où commence la séquence i,
+    // et sequenceStartSteps[sequences.size()] le nombre total de pas du morceau.
+    // Idem pour sequenceStartMeasures. Ces tableaux ont toujours sequences.size() + 1 entrées.
+    std::vector<int> sequenceStartSteps;
+    std::vector<int> sequenceStartMeasures;
+
+    AdikTempoMap tempoMap; // Carte de tempo du morceau (pas absolus dans le morceau), vide par défaut
+
     // Constructeur
     AdikSong(const std::string& songName) : name(songName) {
+        sequenceStartSteps.push_back(0);
+        sequenceStartMeasures.push_back(0);
         std::cout << "Morceau '" << name << "' créé." << std::endl;
     }
 
+    // Recalcule la ligne de temps à partir de la séquence 'fromIndex'
+    void rebuildTimeline(size_t fromIndex = 0) {
+        if (fromIndex > sequences.size()) fromIndex = sequences.size();
+        sequenceStartSteps.resize(sequences.size() + 1);
+        sequenceStartMeasures.resize(sequences.size() + 1);
+        sequenceStartSteps[0] = 0;
+        sequenceStartMeasures[0] = 0;
+        for (size_t i = fromIndex; i < sequences.size(); ++i) {
+            sequenceStartSteps[i + 1] = sequenceStartSteps[i] + sequences[i]->lengthInSteps;
+            sequenceStartMeasures[i + 1] = sequenceStartMeasures[i] + sequences[i]->numberOfMeasures;
+        }
+    }
+
     // Ajoute une séquence au morceau
     void addSequence(std::shared_ptr<AdikSequence> sequenceToAdd, int numTimes = 1) {
         if (!sequenceToAdd) {
@@ -32,6 +60,8 @@ public:
         }
         for (int i = 0; i < numTimes; ++i) {
             sequences.push_back(sequenceToAdd);
+            sequenceStartSteps.push_back(sequenceStartSteps.back() + sequenceToAdd->lengthInSteps);
+            sequenceStartMeasures.push_back(sequenceStartMeasures.back() + sequenceToAdd->numberOfMeasures);
             std::cout << "Séquence '" << sequenceToAdd->name << "' ajoutée au morceau '" << name << "'." << std::endl;
         }
     }
@@ -41,6 +71,7 @@ public:
         if (index >= 0 && index < sequences.size()) {
             std::cout << "Séquence '" << sequences[index]->name << "' supprimée du morceau '" << name << "'." << std::endl;
             sequences.erase(sequences.begin() + index);
+            rebuildTimeline(index); // Seules les séquences suivantes sont décalées
         } else {
             std::cerr << "Erreur: Indice de séquence invalide pour la suppression." << std::endl;
         }
@@ -49,53 +80,64 @@ public:
     // Vide le morceau de toutes ses séquences
     void clear() {
         sequences.clear();
+        rebuildTimeline();
         std::cout << "Morceau '" << name << "' vidé de ses séquences." << std::endl;
     }
 
-    // Obtenir le nombre total de pas dans le morceau
-    int getTotalSteps() const {
-        int total = 0;
-        for (const auto& seq : sequences) {
-            total += seq->lengthInSteps;
+    // Construit la carte de tempo effective du morceau :
+    // les points du morceau, plus ceux des cartes de chaque séquence décalés à leur position.
+    AdikTempoMap buildTempoMap() const {
+        AdikTempoMap merged = tempoMap;
+        for (size_t i = 0; i < sequences.size(); ++i) {
+            for (const auto& point : sequences[i]->tempoMap.points) {
+                if (point.step < sequences[i]->lengthInSteps) {
+                    merged.addPoint(sequenceStartSteps[i] + point.step, point.bpm, point.curve);
+                }
+            }
         }
-        return total;
+        return merged;
+    }
+
+    // Obtenir le nombre total de pas dans le morceau (O(1))
+    int getTotalSteps() const {
+        return sequenceStartSteps.back();
     }
 
-    // Obtenir le nombre total de mesures dans le morceau (approximatif si les SPM varient)
+    // Obtenir le nombre total de mesures dans le morceau (O(1), approximatif si les SPM varient)
     int getTotalMeasures() const {
-        int total = 0;
-        for (const auto& seq : sequences) {
-            total += seq->numberOfMeasures;
+        return sequenceStartMeasures.back();
+    }
+
+    // Pas absolu où commence la séquence d'index donné (O(1))
+    int getSequenceStartStep(int sequenceIndex) const {
+        if (sequenceIndex < 0 || sequenceIndex >= static_cast<int>(sequences.size())) {
+            return 0;
         }
-        return total;
+        return sequenceStartSteps[sequenceIndex];
     }
 
-    // Convertit un index de séquence et un pas relatif dans cette séquence en un pas absolu dans le morceau.
+    // Position en samples du début de la séquence d'index donné, à tempo constant (O(1))
+    long long getSequenceStartSample(int sequenceIndex, double samplesPerStep) const {
+        return std::llround(getSequenceStartStep(sequenceIndex) * samplesPerStep);
+    }
+
+    // Convertit un index de séquence et un pas relatif dans cette séquence en un pas absolu dans le morceau (O(1)).
     int getAbsoluteStep(int sequenceIndex, int stepInSequence) const {
-        int absoluteStep = 0;
-        if (sequenceIndex < 0 || sequenceIndex >= sequences.size()) {
+        if (sequenceIndex < 0 || sequenceIndex >= static_cast<int>(sequences.size())) {
             // Gérer l'erreur ou retourner une valeur par défaut, ex: 0
             std::cerr << "Erreur: Indice de séquence invalide dans getAbsoluteStep. (" << sequenceIndex << ")" << std::endl;
             return 0;
         }
-
-        for (int i = 0; i < sequenceIndex; ++i) {
-            absoluteStep += sequences[i]->lengthInSteps;
-        }
-        absoluteStep += stepInSequence;
-        return absoluteStep;
+        return sequenceStartSteps[sequenceIndex] + stepInSequence;
     }
 
-    // Mapper un pas absolu du morceau à un index de séquence et un pas relatif
+    // Mapper un pas absolu du morceau à un index de séquence et un pas relatif (O(log n))
     void getSequenceAndStepFromAbsoluteStep(int absoluteStep, int& outSequenceIndex, int& outStepInSequence) const {
-        int currentAbsolutePos = 0;
         outSequenceIndex = 0;
         outStepInSequence = 0;
 
         int totalSongSteps = getTotalSteps();
         if (totalSongSteps == 0) { // Gérer le cas d'un morceau vide
-            outSequenceIndex = 0;
-            outStepInSequence = 0;
             return;
         }
 
@@ -106,21 +148,12 @@ public:
             absoluteStep = totalSongSteps - 1;
         }
 
-        for (size_t i = 0; i < sequences.size(); ++i) {
-            if (absoluteStep >= currentAbsolutePos && absoluteStep < currentAbsolutePos + sequences[i]->lengthInSteps) {
-                outSequenceIndex = static_cast<int>(i);
-                outStepInSequence = absoluteStep - currentAbsolutePos;
-                return;
-            }
-            currentAbsolutePos += sequences[i]->lengthInSteps;
-        }
-        
-        // Si, pour une raison quelconque, on arrive ici (ce qui ne devrait pas si les bornes sont bien gérées),
-        // on retourne la dernière position valide.
-        if (!sequences.empty()) {
-             outSequenceIndex = static_cast<int>(sequences.size() - 1);
-             outStepInSequence = sequences.back()->lengthInSteps - 1;
-        }
+        // Première séquence dont le début est strictement après absoluteStep, moins un.
+        // upper_bound saute aussi les séquences de longueur nulle.
+        auto it = std::upper_bound(sequenceStartSteps.begin(), sequenceStartSteps.end(), absoluteStep);
+        int index = static_cast<int>(it - sequenceStartSteps.begin()) - 1;
+        outSequenceIndex = index;
+        outStepInSequence = absoluteStep - sequenceStartSteps[index];
     }
 };
 
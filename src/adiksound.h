@@ -7,31 +7,171 @@
 #include <numeric> // Pour std::iota
 #include <cmath>
 #include <algorithm> // Pour std::fill
-#include <random>
+#include <cstdint>
+#include <cstdio> // Pour std::snprintf
+#include <utility> // Pour std::move
+
+#include "adiksoundcache.h"
+#include "adiksamplestore.h"
 
 // Constantes pour la simulation
 const float PI = 3.14159265358979323846f;
 const float MAX_AMPLITUDE = 0.8f;
 
+// Bruit blanc reproductible (xorshift32) : même graine, mêmes samples sur toutes les plateformes.
+// Remplace rand() / std::random_device, pour que deux rendus d'un même projet soient identiques.
+class AdikNoise {
+public:
+    explicit AdikNoise(uint32_t seed) : state(seed ? seed : 0x9E3779B9u) {}
+
+    // Valeur uniforme dans [-1, 1)
+    float next() {
+        state ^= state << 13;
+        state ^= state >> 17;
+        state ^= state << 5;
+        return static_cast<float>(state >> 8) * (2.0f / 16777216.0f) - 1.0f;
+    }
+
+    // Graine dérivée d'un texte (FNV-1a 32 bits), ex. la clé de cache du son
+    static uint32_t seedFor(const std::string& text) {
+        uint32_t hash = 2166136261u;
+        for (unsigned char c : text) {
+            hash = (hash ^ c) * 16777619u;
+        }
+        return hash;
+    }
+
+private:
+    uint32_t state;
+};
+
 class AdikSound {
 public:
-    std::vector<float> audioData;
-    size_t currentSamplePosition; // Utiliser size_t pour la taille/position
+    std::vector<float> audioData;  // Samples float (vide quand le son est en stockage compact, voir setStorage)
+    AdikSampleStore compactData;  // Samples int16 / int24, décodés à la lecture
     unsigned int numChannels;     // <--- NOUVEAU : Nombre de canaux du son (1 pour mono, 2 pour stéréo)
     unsigned int sampleRate;
+    uint32_t noiseSeed = 0;       // Graine du bruit du générateur en cours (voir generateCached)
+    std::string cacheKey;         // Clé du son dans AdikSoundCache ("" : son chargé d'ailleurs, ex. d'un projet)
 
     AdikSound() 
-        : currentSamplePosition(0), 
-        sampleRate(44100), numChannels(1) {
+        : sampleRate(44100), numChannels(1) {
+    }
+
+    // Son déjà rendu (ex. rendu figé, AdikFreezer) : samples entrelacés repris tels quels, ni préréglage ni cache
+    AdikSound(std::vector<float>&& samples, unsigned int channels, unsigned int rate)
+        : audioData(std::move(samples)), numChannels(channels), sampleRate(rate) {
     }
 
     AdikSound(const std::string& soundType, unsigned int channels = 1) // <--- MODIFIÉ : Ajout du paramètre channels
-        : currentSamplePosition(0), numChannels(channels),
+        : numChannels(channels),
         sampleRate(44100) {
         // Simple simulation : générer une petite onde sinusoïdale ou une impulsion.
         // La génération de données est simplifiée pour ne pas dupliquer des samples stéréo ici.
         // On suppose que les données générées sont mono pour cet exemple.
-        if (soundType.find("kick") != std::string::npos) {
+        const std::string preset = presetName(soundType);
+        generateCached("preset:" + preset + formatKey() + noiseKey(preset != "kick" && preset != "tone"), [&]() { renderPreset(preset); });
+        this->numChannels = channels; // Fixe le nombre de canaux
+    }
+
+
+
+    // Lit numFrames frames à partir de 'position' (en samples) dans le buffer de sortie, complété de zéros
+    // après la fin du son, et avance 'position'. La position appartient à la voix (AdikChannel) :
+    // plusieurs voix peuvent lire le même son en même temps.
+    // En stockage compact, le bloc est décodé directement dans le buffer de la voix.
+    // La fonction retourne le nombre de frames (pas de samples) qui ont été lues.
+    unsigned int readData(size_t& position, std::vector<float>& outputBuffer, unsigned int numFrames) const {
+        const size_t samplesToRead = static_cast<size_t>(numFrames) * numChannels; // Nombre total de samples (gauche + droite)
+        // redimensionne le buffer de sortie pour correspondre au nombre de canaux
+        outputBuffer.resize(samplesToRead);
+        const size_t totalSamples = getNumSamples();
+        const size_t available = position < totalSamples ? totalSamples - position : 0;
+        const size_t actualSamplesRead = std::min(samplesToRead, available);
+        if (compactData.size()) {
+            compactData.decode(position, actualSamplesRead, outputBuffer.data());
+        } else {
+            std::copy(audioData.begin() + position, audioData.begin() + position + actualSamplesRead, outputBuffer.begin());
+        }
+        // Plus de données : compléter de zéros
+        std::fill(outputBuffer.begin() + actualSamplesRead, outputBuffer.begin() + samplesToRead, 0.0f);
+        position += actualSamplesRead;
+        return static_cast<unsigned int>(actualSamplesRead / numChannels);
+    }
+
+    // Nombre de samples (tous canaux), quel que soit le stockage
+    size_t getNumSamples() const {
+        return compactData.size() ? compactData.size() : audioData.size();
+    }
+
+    // Longueur du son, en frames
+    size_t getNumFrames() const {
+        return numChannels ? getNumSamples() / numChannels : 0;
+    }
+
+    AdikSampleStore::Format getStorage() const { return compactData.getFormat(); }
+
+    // Change le stockage des samples. En int16 / int24, audioData est libéré ; en float, il est reconstruit.
+    // Hors du thread audio (le son ne doit pas être en cours de lecture).
+    void setStorage(AdikSampleStore::Format format) {
+        if (format == compactData.getFormat()) return;
+        if (compactData.size()) {
+            audioData = toFloat();
+            compactData.clear();
+        }
+        if (format != AdikSampleStore::FLOAT32) {
+            compactData.encode(audioData.data(), audioData.size(), format);
+            std::vector<float>().swap(audioData);
+        }
+    }
+
+    // Copie float de tous les samples (ex. pour l'enregistrement d'un projet)
+    std::vector<float> toFloat() const {
+        if (!compactData.size()) return audioData;
+        std::vector<float> samples(compactData.size());
+        compactData.decode(0, samples.size(), samples.data());
+        return samples;
+    }
+
+    // Mémoire occupée par les samples, en octets
+    size_t getMemoryBytes() const {
+        return audioData.capacity() * sizeof(float) + compactData.getMemoryBytes();
+    }
+
+    // Générateurs : le résultat est conservé dans le cache disque (AdikSoundCache),
+    // sous une clé formée des paramètres ; les démarrages suivants le relisent au lieu de le recalculer.
+    void sineWave(float freq = 440.0f, float amplitude = 1.0f, unsigned int numFrames = 44100) {
+        generateCached("sine:f=" + keyNumber(freq) + ":a=" + keyNumber(amplitude) + ":n=" + std::to_string(numFrames) + formatKey(),
+                       [&]() { renderSineWave(freq, amplitude, numFrames); });
+    }
+
+    void squareWave(float freq = 440.0f, float amplitude = 1.0f, unsigned int numFrames = 44100) {
+        generateCached("square:f=" + keyNumber(freq) + ":a=" + keyNumber(amplitude) + ":n=" + std::to_string(numFrames) + formatKey(),
+                       [&]() { renderSquareWave(freq, amplitude, numFrames); });
+    }
+
+    void whiteNoiseWave(float amplitude = 1.0f, unsigned int numFrames = 44100) {
+        generateCached("noise:a=" + keyNumber(amplitude) + ":n=" + std::to_string(numFrames) + formatKey() + noiseKey(true),
+                       [&]() { renderWhiteNoiseWave(amplitude, numFrames); });
+    }
+
+    void combinedSineNoise(float sineFreq = 440.0f, float sineAmplitudeRatio = 0.7f, float noiseAmplitudeRatio = 0.3f, unsigned int numFrames = 44100) {
+        generateCached("sinenoise:f=" + keyNumber(sineFreq) + ":s=" + keyNumber(sineAmplitudeRatio) + ":w=" + keyNumber(noiseAmplitudeRatio)
+                       + ":n=" + std::to_string(numFrames) + formatKey() + noiseKey(true),
+                       [&]() { renderCombinedSineNoise(sineFreq, sineAmplitudeRatio, noiseAmplitudeRatio, numFrames); });
+    }
+
+private:
+    // Préréglage utilisé par le constructeur, d'après le type de son demandé
+    static std::string presetName(const std::string& soundType) {
+        if (soundType.find("kick") != std::string::npos) return "kick";
+        if (soundType.find("snare") != std::string::npos) return "snare";
+        if (soundType.find("hihat") != std::string::npos || soundType.find("clap") != std::string::npos) return "noise";
+        return "tone";
+    }
+
+    void renderPreset(const std::string& preset) {
+        if (preset == "kick") {
             audioData.resize(44100 / 4 * numChannels); // Ajuster la taille pour le nombre de canaux
             for (size_t i = 0; i < audioData.size(); i += numChannels) {
                 float phase = 2.0f * PI * 100.0f * (i / numChannels) / 44100.0f; // Calculer la phase par frame
@@ -41,23 +181,25 @@ public:
                     audioData[i + c] = sample;
                 }
             }
-        } else if (soundType.find("snare") != std::string::npos) {
+        } else if (preset == "snare") {
+            AdikNoise noise(noiseSeed);
             audioData.resize(44100 / 8 * numChannels);
             for (size_t i = 0; i < audioData.size(); i += numChannels) {
-                float noise = (float)rand() / RAND_MAX * 2.0f - 1.0f;
+                float noiseSample = noise.next();
                 float tone = sin(2.0f * PI * 400.0f * (i / numChannels) / 44100.0f) * 0.3f;
                 float decay = 1.0f - (float)(i / numChannels) / (audioData.size() / numChannels);
-                float sample = (noise * 0.7f + tone * 0.3f) * decay * MAX_AMPLITUDE;
+                float sample = (noiseSample * 0.7f + tone * 0.3f) * decay * MAX_AMPLITUDE;
                 for (unsigned int c = 0; c < numChannels; ++c) {
                     audioData[i + c] = sample;
                 }
             }
-        } else if (soundType.find("hihat") != std::string::npos || soundType.find("clap") != std::string::npos) {
+        } else if (preset == "noise") {
+            AdikNoise noise(noiseSeed);
             audioData.resize(44100 / 16 * numChannels);
             for (size_t i = 0; i < audioData.size(); i += numChannels) {
-                float noise = (float)rand() / RAND_MAX * 2.0f - 1.0f;
+                float noiseSample = noise.next();
                 float decay = 1.0f - (float)(i / numChannels) / (audioData.size() / numChannels);
-                float sample = noise * decay * MAX_AMPLITUDE;
+                float sample = noiseSample * decay * MAX_AMPLITUDE;
                 for (unsigned int c = 0; c < numChannels; ++c) {
                     audioData[i + c] = sample;
                 }
@@ -71,52 +213,29 @@ public:
                 }
             }
         }
-        this->numChannels = channels; // Fixe le nombre de canaux
     }
 
+    // Suffixe de clé de cache commun : canaux et taux d'échantillonnage
+    std::string formatKey() const {
+        return ":c=" + std::to_string(numChannels) + ":sr=" + std::to_string(sampleRate);
+    }
 
-
-    // Lit les données audio dans le buffer de sortie
-    unsigned int readData(std::vector<float>& outputBuffer, unsigned int numFrames) {
-      // redimensionne le buffer de sortie pour correspondre au nombre de canaux
-      outputBuffer.resize(numFrames * numChannels, 0.0f);  
-      if (audioData.empty() || currentSamplePosition >= audioData.size()) {
-            // Remplir de zéros si le son est terminé ou vide
-            outputBuffer.resize(numFrames * numChannels, 0.0f);
-            return 0;
-        }
-
-        unsigned int samplesToRead = numFrames * numChannels; // Nombre total de samples (gauche + droite)
-        unsigned int actualSamplesRead = 0;
-
-        for (unsigned int i = 0; i < samplesToRead; ++i) {
-            if (currentSamplePosition < audioData.size()) {
-                outputBuffer[i] = audioData[currentSamplePosition];
-                currentSamplePosition++;
-                actualSamplesRead++;
-            } else {
-                outputBuffer[i] = 0.0f; // Plus de données, ajouter zéro
-            }
-        }
-        // Si nous avons lu moins que prévu (fin du son), remplir le reste avec des zéros
-        if (actualSamplesRead < samplesToRead) {
-            // outputBuffer.resize(actualSamplesRead, samplesToRead, 0.0f);
-            // std::fill(outputBuffer.begin() + actualSamplesRead, outputBuffer.begin() + samplesToRead, 0.0f);
-        }
-
-        // La fonction retourne le nombre de frames (pas de samples) qui ont été traités.
-        return actualSamplesRead / numChannels;
+    // Les sons bruités sont reproductibles (AdikNoise, graine tirée de la clé) : la clé porte
+    // le générateur pour ne pas relire les entrées produites avant, avec rand().
+    static std::string noiseKey(bool noisy) {
+        return noisy ? ":rng=xorshift32" : "";
     }
 
-    // Réinitialise la position de lecture du son
-    void resetPlayback() {
-        currentSamplePosition = 0;
+    // Paramètre flottant d'une clé de cache (représentation exacte, sans arrondi)
+    static std::string keyNumber(float value) {
+        char text[32];
+        std::snprintf(text, sizeof(text), "%a", value);
+        return text;
     }
 
-    void sineWave(float freq = 440.0f, float amplitude = 1.0f, unsigned int numFrames = 44100) {
+    void renderSineWave(float freq, float amplitude, unsigned int numFrames) {
         size_t totalSamples = numFrames * numChannels;
         audioData.resize(totalSamples);
-        currentSamplePosition = 0;
 
         float actualAmplitude = MAX_AMPLITUDE * amplitude;
         if (actualAmplitude > 1.0f) actualAmplitude = 1.0f;
@@ -136,10 +255,9 @@ public:
                   << ", Canaux = " << numChannels << std::endl;
     }
 
-    void squareWave(float freq = 440.0f, float amplitude = 1.0f, unsigned int numFrames = 44100) {
+    void renderSquareWave(float freq, float amplitude, unsigned int numFrames) {
         size_t totalSamples = numFrames * numChannels;
         audioData.resize(totalSamples);
-        currentSamplePosition = 0;
 
         float actualAmplitude = MAX_AMPLITUDE * amplitude;
         if (actualAmplitude > 1.0f) actualAmplitude = 1.0f;
@@ -166,18 +284,16 @@ public:
                   << ", Canaux = " << numChannels << std::endl;
     }
 
-    void whiteNoiseWave(float amplitude = 1.0f, unsigned int numFrames = 44100) {
+    void renderWhiteNoiseWave(float amplitude, unsigned int numFrames) {
         size_t totalSamples = numFrames * numChannels;
         audioData.resize(totalSamples);
-        currentSamplePosition = 0;
 
-        std::random_device rd;
-        std::mt19937 gen(rd());
-        // Ajuste la distribution à l'amplitude réelle souhaitée
-        std::uniform_real_distribution<float> dis(-MAX_AMPLITUDE * amplitude, MAX_AMPLITUDE * amplitude);
+        AdikNoise noise(noiseSeed);
+        // Ajuste le bruit à l'amplitude réelle souhaitée
+        const float noiseAmplitude = MAX_AMPLITUDE * amplitude;
 
         for (size_t i = 0; i < numFrames; ++i) {
-            float sampleValue = dis(gen);
+            float sampleValue = noise.next() * noiseAmplitude;
 
             for (unsigned int c = 0; c < numChannels; ++c) {
                 audioData[i * numChannels + c] = sampleValue;
@@ -188,16 +304,14 @@ public:
                   << ", Canaux = " << numChannels << std::endl;
     }
 
-    void combinedSineNoise(float sineFreq = 440.0f, float sineAmplitudeRatio = 0.7f, float noiseAmplitudeRatio = 0.3f, unsigned int numFrames = 44100) {
+    void renderCombinedSineNoise(float sineFreq, float sineAmplitudeRatio, float noiseAmplitudeRatio, unsigned int numFrames) {
         size_t totalSamples = numFrames * numChannels;
         audioData.resize(totalSamples);
-        currentSamplePosition = 0;
 
         // Générateur de bruit blanc
-        std::random_device rd;
-        std::mt19937 gen(rd());
-        // La distribution du bruit est proportionnelle à son ratio et MAX_AMPLITUDE
-        std::uniform_real_distribution<float> noise_dis(-MAX_AMPLITUDE * noiseAmplitudeRatio, MAX_AMPLITUDE * noiseAmplitudeRatio);
+        AdikNoise noise(noiseSeed);
+        // L'amplitude du bruit est proportionnelle à son ratio et MAX_AMPLITUDE
+        const float noiseAmplitude = MAX_AMPLITUDE * noiseAmplitudeRatio;
 
         // Calcul de l'amplitude réelle de la sinusoïde
         float actualSineAmplitude = MAX_AMPLITUDE * sineAmplitudeRatio;
@@ -213,7 +327,7 @@ public:
             float sineSample = actualSineAmplitude * std::sin(2.0f * PI * sineFreq * time);
 
             // Générer l'échantillon de bruit blanc
-            float noiseSample = noise_dis(gen);
+            float noiseSample = noise.next() * noiseAmplitude;
 
             // Additionner les deux échantillons
             float combinedSample = sineSample + noiseSample;
@@ -234,6 +348,26 @@ public:
                   << ", Canaux = " << numChannels << std::endl;
     }
 
+    // Remplit audioData depuis le cache disque (AdikSoundCache) si l'entrée existe,
+    // sinon appelle generate() et enregistre le résultat. Renvoie vrai si le son venait du cache.
+    template <typename Generator>
+    bool generateCached(const std::string& key, Generator generate) {
+        AdikSoundCache* cache = AdikSoundCache::getDefault();
+        cacheKey = key;
+        compactData.clear(); // Le nouveau son remplace l'ancien, en float
+        unsigned int cachedChannels = 0;
+        unsigned int cachedRate = 0;
+        if (cache && cache->lookup(key, audioData, cachedChannels, cachedRate)
+            && cachedChannels == numChannels && cachedRate == sampleRate) {
+            return true;
+        }
+        noiseSeed = AdikNoise::seedFor(key);
+        generate();
+        if (cache) {
+            cache->store(key, audioData, numChannels, sampleRate);
+        }
+        return false;
+    }
 };
 
 #endif // ADIKSOUND_H
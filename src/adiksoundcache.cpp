@@ -0,0 +1,307 @@
+#include "adiksoundcache.h"
+#include "adikchecksum.h"
+
+#include <cstring>     // Pour std::memcpy, std::memcmp
+#include <cstddef>     // Pour offsetof
+#include <cstdio>      // Pour std::rename, std::remove
+#include <cstdlib>     // Pour std::getenv, std::strtoull
+#include <cerrno>      // Pour errno, EEXIST
+#include <algorithm>   // Pour std::sort
+#include <atomic>
+#include <ctime>       // Pour clock_gettime
+#include <functional>  // Pour std::hash
+#include <thread>      // Pour std::this_thread::get_id
+#include <fstream>
+#include <iostream>
+#include <iomanip>
+#include <sstream>
+
+#include <dirent.h>    // Pour opendir, readdir
+#include <fcntl.h>     // Pour open, AT_FDCWD
+#include <sys/mman.h>  // Pour mmap, munmap
+#include <sys/stat.h>  // Pour stat, mkdir, utimensat
+#include <unistd.h>    // Pour close, getpid
+
+namespace {
+
+const char ENTRY_MAGIC[8] = {'A', 'D', 'I', 'K', 'S', 'N', 'D', '\0'};
+const uint32_t ENTRY_VERSION = 1;
+const uint64_t DATA_ALIGNMENT = 16;
+const char* ENTRY_EXTENSION = ".adks";
+const char* TMP_MARKER = ".tmp";           // Fichiers temporaires des entrées et des fichiers annexes
+const int64_t ORPHAN_AGE_NS = 600LL * 1000000000; // Un fichier temporaire plus vieux est celui d'une écriture interrompue
+
+// En-tête d'une entrée du cache, suivi de la clé puis des samples (alignés sur 16 octets)
+struct EntryHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t numChannels;
+    uint32_t sampleRate;
+    uint32_t keyLength;
+    uint64_t sampleCount;
+    uint64_t dataOffset;
+    uint32_t dataCrc;
+    uint32_t headerCrc;   // CRC-32 des champs précédents
+};
+
+// FNV-1a 64 bits : nom de fichier d'une clé
+uint64_t hashKey(const std::string& key) {
+    uint64_t hash = 0xcbf29ce484222325ull;
+    for (unsigned char c : key) {
+        hash ^= c;
+        hash *= 0x100000001b3ull;
+    }
+    return hash;
+}
+
+// Crée le répertoire et ses parents si besoin
+bool makeDirectories(const std::string& path) {
+    if (path.empty()) return false;
+    for (size_t pos = 1; pos <= path.size(); ++pos) {
+        if (pos == path.size() || path[pos] == '/') {
+            const std::string partial = path.substr(0, pos);
+            if (::mkdir(partial.c_str(), 0755) != 0 && errno != EEXIST) {
+                return false;
+            }
+        }
+    }
+    struct stat st;
+    return ::stat(path.c_str(), &st) == 0 && S_ISDIR(st.st_mode);
+}
+
+bool hasEntryExtension(const std::string& name) {
+    const size_t length = std::strlen(ENTRY_EXTENSION);
+    return name.size() > length && name.compare(name.size() - length, length, ENTRY_EXTENSION) == 0;
+}
+
+} // namespace
+
+AdikSoundCache::AdikSoundCache(const std::string& dir, uint64_t maxSize)
+    : directory(dir), maxBytes(maxSize), enabled(false),
+      hits(0), misses(0), stores(0), evictions(0), rejected(0) {
+    enabled = makeDirectories(directory);
+    if (!enabled) {
+        std::cerr << "AdikSoundCache: Répertoire '" << directory << "' inutilisable, cache désactivé." << std::endl;
+    }
+}
+
+std::string AdikSoundCache::pathForKey(const std::string& key) const {
+    std::ostringstream name;
+    name << directory << "/" << std::hex << std::setw(16) << std::setfill('0') << hashKey(key) << ENTRY_EXTENSION;
+    return name.str();
+}
+
+std::string AdikSoundCache::sidecarPath(const std::string& key, const std::string& suffix) const {
+    return pathForKey(key) + suffix;
+}
+
+bool AdikSoundCache::lookup(const std::string& key, std::vector<float>& samples,
+                            unsigned int& numChannels, unsigned int& sampleRate) {
+    if (!enabled) return false;
+    const std::string path = pathForKey(key);
+
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        misses.fetch_add(1);
+        return false;
+    }
+    struct stat st;
+    const uint8_t* data = nullptr;
+    size_t size = 0;
+    if (::fstat(fd, &st) == 0 && st.st_size >= static_cast<off_t>(sizeof(EntryHeader))) {
+        void* mapped = ::mmap(nullptr, static_cast<size_t>(st.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+        if (mapped != MAP_FAILED) {
+            data = static_cast<const uint8_t*>(mapped);
+            size = static_cast<size_t>(st.st_size);
+        }
+    }
+    ::close(fd);
+
+    bool valid = false;
+    if (data) {
+        EntryHeader header;
+        std::memcpy(&header, data, sizeof(header));
+        valid = std::memcmp(header.magic, ENTRY_MAGIC, sizeof(ENTRY_MAGIC)) == 0
+             && header.version == ENTRY_VERSION
+             && header.headerCrc == adikCrc32(&header, offsetof(EntryHeader, headerCrc))
+             && sizeof(header) + header.keyLength <= size
+             && header.keyLength == key.size()
+             && std::memcmp(data + sizeof(header), key.data(), key.size()) == 0 // Collision de hash
+             && header.dataOffset <= size
+             && header.sampleCount <= (size - header.dataOffset) / sizeof(float);
+        if (valid) {
+            const uint8_t* sampleData = data + header.dataOffset;
+            const size_t sampleBytes = static_cast<size_t>(header.sampleCount * sizeof(float));
+            valid = header.dataCrc == adikCrc32(sampleData, sampleBytes);
+            if (valid) {
+                samples.resize(static_cast<size_t>(header.sampleCount));
+                if (sampleBytes > 0) std::memcpy(samples.data(), sampleData, sampleBytes);
+                numChannels = header.numChannels;
+                sampleRate = header.sampleRate;
+            }
+        }
+        ::munmap(const_cast<uint8_t*>(data), size);
+    }
+
+    if (!valid) {
+        // Entrée corrompue, tronquée ou d'une autre clé : la supprimer, elle sera régénérée
+        rejected.fetch_add(1);
+        misses.fetch_add(1);
+        std::remove(path.c_str());
+        return false;
+    }
+    // Marquer l'entrée comme récemment utilisée (LRU)
+    ::utimensat(AT_FDCWD, path.c_str(), nullptr, 0);
+    hits.fetch_add(1);
+    return true;
+}
+
+bool AdikSoundCache::store(const std::string& key, const std::vector<float>& samples,
+                           unsigned int numChannels, unsigned int sampleRate) {
+    if (!enabled) return false;
+    const std::string path = pathForKey(key);
+
+    EntryHeader header;
+    std::memset(&header, 0, sizeof(header));
+    std::memcpy(header.magic, ENTRY_MAGIC, sizeof(ENTRY_MAGIC));
+    header.version = ENTRY_VERSION;
+    header.numChannels = numChannels;
+    header.sampleRate = sampleRate;
+    header.keyLength = static_cast<uint32_t>(key.size());
+    header.sampleCount = samples.size();
+    header.dataOffset = (sizeof(header) + key.size() + DATA_ALIGNMENT - 1) & ~(DATA_ALIGNMENT - 1);
+    header.dataCrc = adikCrc32(samples.data(), samples.size() * sizeof(float));
+    header.headerCrc = adikCrc32(&header, offsetof(EntryHeader, headerCrc));
+
+    // Fichier temporaire propre au processus, au thread et à l'écriture : plusieurs workers, ou plusieurs threads
+    // d'un même processus, peuvent écrire la même entrée
+    static std::atomic<uint64_t> tmpCounter(0);
+    const std::string tmpPath = path + TMP_MARKER + std::to_string(::getpid()) + "-"
+                              + std::to_string(std::hash<std::thread::id>()(std::this_thread::get_id())) + "-"
+                              + std::to_string(tmpCounter.fetch_add(1));
+    {
+        std::ofstream out(tmpPath, std::ios::binary | std::ios::trunc);
+        if (!out) return false;
+        const char padding[DATA_ALIGNMENT] = {0};
+        out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        out.write(key.data(), static_cast<std::streamsize>(key.size()));
+        out.write(padding, static_cast<std::streamsize>(header.dataOffset - sizeof(header) - key.size()));
+        out.write(reinterpret_cast<const char*>(samples.data()), static_cast<std::streamsize>(samples.size() * sizeof(float)));
+        if (!out) {
+            std::remove(tmpPath.c_str());
+            return false;
+        }
+    }
+    if (std::rename(tmpPath.c_str(), path.c_str()) != 0) {
+        std::remove(tmpPath.c_str());
+        return false;
+    }
+    stores.fetch_add(1);
+    evict();
+    return true;
+}
+
+void AdikSoundCache::evict() {
+    if (!enabled) return;
+    std::lock_guard<std::mutex> lock(evictionMutex);
+
+    struct Entry {
+        std::string path;
+        uint64_t size;
+        int64_t lastUse; // En nanosecondes
+    };
+    std::vector<Entry> entries;
+    std::vector<std::string> sidecars; // "<hash>.adks.<suffixe>"
+    uint64_t totalBytes = 0;
+    struct timespec now;
+    ::clock_gettime(CLOCK_REALTIME, &now);
+    const int64_t nowNs = static_cast<int64_t>(now.tv_sec) * 1000000000 + now.tv_nsec;
+
+    DIR* dir = ::opendir(directory.c_str());
+    if (!dir) return;
+    while (struct dirent* item = ::readdir(dir)) {
+        const std::string name = item->d_name;
+        if (name.find(std::string(ENTRY_EXTENSION) + ".") != std::string::npos && name.find(TMP_MARKER) != std::string::npos) {
+            // Temporaire d'une écriture : supprimé s'il est orphelin (processus interrompu avant le renommage)
+            const std::string tmpPath = directory + "/" + name;
+            struct stat st;
+            if (::stat(tmpPath.c_str(), &st) == 0
+                && nowNs - (static_cast<int64_t>(st.st_mtim.tv_sec) * 1000000000 + st.st_mtim.tv_nsec) > ORPHAN_AGE_NS) {
+                std::remove(tmpPath.c_str());
+            }
+            continue;
+        }
+        if (!hasEntryExtension(name)) {
+            if (name.find(std::string(ENTRY_EXTENSION) + ".") != std::string::npos) sidecars.push_back(directory + "/" + name);
+            continue;
+        }
+        Entry entry;
+        entry.path = directory + "/" + name;
+        struct stat st;
+        if (::stat(entry.path.c_str(), &st) != 0) continue;
+        entry.size = static_cast<uint64_t>(st.st_size);
+        entry.lastUse = static_cast<int64_t>(st.st_mtim.tv_sec) * 1000000000 + st.st_mtim.tv_nsec;
+        totalBytes += entry.size;
+        entries.push_back(entry);
+    }
+    ::closedir(dir);
+
+    if (totalBytes <= maxBytes) return;
+    std::sort(entries.begin(), entries.end(),
+              [](const Entry& a, const Entry& b) { return a.lastUse < b.lastUse; });
+    for (const auto& entry : entries) {
+        if (totalBytes <= maxBytes) break;
+        if (std::remove(entry.path.c_str()) == 0) {
+            totalBytes -= entry.size;
+            evictions.fetch_add(1);
+            for (const auto& sidecar : sidecars) {
+                if (sidecar.compare(0, entry.path.size() + 1, entry.path + ".") == 0) std::remove(sidecar.c_str());
+            }
+        }
+    }
+}
+
+std::string AdikSoundCache::conversionKey(uint32_t sourceCrc, uint64_t sourceSize,
+                                          unsigned int targetRate, unsigned int targetChannels,
+                                          const std::string& targetFormat) {
+    std::ostringstream key;
+    key << "conv:src=" << std::hex << std::setw(8) << std::setfill('0') << sourceCrc << std::dec
+        << ":len=" << sourceSize << ":sr=" << targetRate << ":c=" << targetChannels << ":fmt=" << targetFormat;
+    return key.str();
+}
+
+double AdikSoundCache::getHitRate() const {
+    const uint64_t total = hits.load() + misses.load();
+    return total > 0 ? static_cast<double>(hits.load()) / total : 0.0;
+}
+
+void AdikSoundCache::printReport() const {
+    std::cout << "AdikSoundCache: " << hits.load() << " succès / " << (hits.load() + misses.load())
+              << " requêtes (" << std::fixed << std::setprecision(1) << getHitRate() * 100.0 << std::defaultfloat << "%)"
+              << ", " << stores.load() << " entrées écrites, " << evictions.load() << " évincées, "
+              << rejected.load() << " rejetées [" << directory << "]" << std::endl;
+}
+
+AdikSoundCache* AdikSoundCache::getDefault() {
+    // Initialisation thread-safe (C++11), une seule fois par processus
+    static AdikSoundCache* instance = []() -> AdikSoundCache* {
+        std::string dir;
+        if (const char* env = std::getenv("ADIK_SOUND_CACHE_DIR")) {
+            dir = env;
+        } else if (const char* xdg = std::getenv("XDG_CACHE_HOME")) {
+            dir = std::string(xdg) + "/adikplan/sounds";
+        } else if (const char* home = std::getenv("HOME")) {
+            dir = std::string(home) + "/.cache/adikplan/sounds";
+        }
+        if (dir.empty() || dir == "none") return nullptr;
+
+        uint64_t maxMegabytes = 256;
+        if (const char* env = std::getenv("ADIK_SOUND_CACHE_MB")) {
+            maxMegabytes = std::strtoull(env, nullptr, 10);
+        }
+        static AdikSoundCache cache(dir, maxMegabytes * 1024 * 1024);
+        cache.evict(); // La limite a pu être abaissée depuis le dernier lancement
+        return cache.isEnabled() ? &cache : nullptr;
+    }();
+    return instance;
+}
@@ -0,0 +1,78 @@
+#ifndef ADIKSOUNDCACHE_H
+#define ADIKSOUNDCACHE_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <mutex>
+#include <atomic>
+
+// --- AdikSoundCache ---
+// Cache disque des sons générés ou convertis, pour raccourcir le démarrage à froid.
+// Chaque entrée est un fichier "<hash>.adks" contenant les samples float prêts à jouer,
+// identifiés par une clé texte :
+//   - paramètres du générateur, ex. "sine:f=440:a=0.5:n=44100:c=1:sr=44100"
+//   - ou hash de la source + taux et format cibles (voir conversionKey()).
+// Au démarrage suivant, le fichier est projeté en mémoire (mmap) et vérifié (CRC-32, clé complète).
+// La taille totale est bornée : les entrées les moins récemment utilisées sont supprimées (LRU,
+// d'après la date de modification, mise à jour à chaque lecture).
+//
+// Configuration par variables d'environnement (cache par défaut, voir getDefault()) :
+//   ADIK_SOUND_CACHE_DIR  répertoire du cache ("none" pour le désactiver)
+//                         (par défaut $XDG_CACHE_HOME/adikplan/sounds ou ~/.cache/adikplan/sounds)
+//   ADIK_SOUND_CACHE_MB   taille maximale en Mo (256 par défaut)
+class AdikSoundCache {
+public:
+    AdikSoundCache(const std::string& dir, uint64_t maxBytes = 256ull * 1024 * 1024);
+
+    // Cherche une entrée. En cas de succès, remplit samples, numChannels et sampleRate.
+    bool lookup(const std::string& key, std::vector<float>& samples,
+                unsigned int& numChannels, unsigned int& sampleRate);
+
+    // Enregistre une entrée (écriture atomique par renommage), puis applique la limite de taille.
+    bool store(const std::string& key, const std::vector<float>& samples,
+               unsigned int numChannels, unsigned int sampleRate);
+
+    // Supprime les entrées les plus anciennes jusqu'à repasser sous maxBytes
+    // (avec leurs fichiers annexes, voir sidecarPath), après avoir supprimé les fichiers temporaires orphelins
+    void evict();
+
+    // Fichier annexe d'une entrée ("<hash>.adks" + suffix), ex. l'analyse du son (AdikSampleAnalyzer).
+    // Il est supprimé avec l'entrée.
+    std::string sidecarPath(const std::string& key, const std::string& suffix) const;
+
+    // Clé d'un son converti : hash de la source, taux et format cibles
+    static std::string conversionKey(uint32_t sourceCrc, uint64_t sourceSize,
+                                     unsigned int targetRate, unsigned int targetChannels,
+                                     const std::string& targetFormat = "f32");
+
+    bool isEnabled() const { return enabled; }
+    const std::string& getDirectory() const { return directory; }
+
+    uint64_t getHits() const { return hits.load(); }
+    uint64_t getMisses() const { return misses.load(); }
+    double getHitRate() const;
+
+    // Affiche le taux de succès et l'activité du cache
+    void printReport() const;
+
+    // Cache partagé par tous les AdikSound, configuré par l'environnement au premier appel.
+    // Renvoie nullptr si le cache est désactivé.
+    static AdikSoundCache* getDefault();
+
+private:
+    std::string directory;
+    uint64_t maxBytes;
+    bool enabled;
+    std::mutex evictionMutex;
+
+    std::atomic<uint64_t> hits;
+    std::atomic<uint64_t> misses;
+    std::atomic<uint64_t> stores;
+    std::atomic<uint64_t> evictions;
+    std::atomic<uint64_t> rejected; // Entrées corrompues ou incohérentes
+
+    std::string pathForKey(const std::string& key) const;
+};
+
+#endif // ADIKSOUNDCACHE_H
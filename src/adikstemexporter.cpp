@@ -0,0 +1,247 @@
+#include "adikstemexporter.h"
+#include "adikplayer.h"
+#include "adikvoicerenderer.h"
+#include "adikwavwriter.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>      // Pour std::snprintf
+#include <cerrno>      // Pour errno, EEXIST
+#include <iostream>
+#include <map>
+#include <set>
+
+#include <sys/stat.h>  // Pour mkdir, stat
+
+namespace {
+
+// Crée le répertoire et ses parents si besoin
+bool makeDirectories(const std::string& path) {
+    if (path.empty()) return false;
+    for (size_t pos = 1; pos <= path.size(); ++pos) {
+        if (pos == path.size() || path[pos] == '/') {
+            if (::mkdir(path.substr(0, pos).c_str(), 0755) != 0 && errno != EEXIST) return false;
+        }
+    }
+    struct stat st;
+    return ::stat(path.c_str(), &st) == 0 && S_ISDIR(st.st_mode);
+}
+
+} // namespace
+
+AdikStemExporter::AdikStemExporter(std::shared_ptr<AdikPlayer> p)
+    : player(p), running(false), framesDone(0), framesTotal(0), succeeded(false), sampleRate(0), samplesPerStep(0.0) {
+    if (!player) {
+        std::cerr << "AdikStemExporter créé avec un AdikPlayer nul !" << std::endl;
+    }
+}
+
+AdikStemExporter::~AdikStemExporter() {
+    if (coordinator.joinable()) coordinator.join();
+}
+
+bool AdikStemExporter::start(const Options& options) {
+    if (!player || running.load()) return false;
+    if (coordinator.joinable()) coordinator.join();
+    if (!makeDirectories(options.directory)) {
+        std::cerr << "AdikStemExporter: Répertoire '" << options.directory << "' impossible à créer." << std::endl;
+        return false;
+    }
+
+    std::vector<Job> newJobs;
+    {
+        std::lock_guard<std::mutex> editLock(player->sequenceEditMutex);
+        sequenceCopies.clear();
+        passes.clear();
+        tempoMap.reset();
+        // Une copie par séquence, partagée par tous ses passages dans le morceau
+        std::map<const AdikSequence*, const AdikSequence*> copies;
+        auto addPass = [&](const std::shared_ptr<AdikSequence>& sequence) {
+            if (!sequence || sequence->lengthInSteps <= 0) return;
+            const AdikSequence*& copy = copies[sequence.get()];
+            if (!copy) {
+                sequenceCopies.push_back(std::make_shared<AdikSequence>(*sequence));
+                copy = sequenceCopies.back().get();
+            }
+            passes.push_back(copy);
+        };
+        std::shared_ptr<AdikTempoMap> map;
+        if (player->currentMode == AdikPlayer::SONG_MODE) {
+            if (player->currentSong) {
+                for (const auto& sequence : player->currentSong->sequences) addPass(sequence);
+                map = std::make_shared<AdikTempoMap>(player->currentSong->buildTempoMap());
+                map->compile(player->currentSong->getTotalSteps(), player->sampleRate, player->clock.stepsPerBeat);
+            }
+        } else {
+            std::shared_ptr<AdikSequence> sequence = player->getCurrentPlayingSequence();
+            for (int loop = 0; loop < std::max(1, options.sequenceLoops); ++loop) addPass(sequence);
+            if (sequence) {
+                // La table compilée boucle au-delà d'un passage
+                map = std::make_shared<AdikTempoMap>(sequence->tempoMap);
+                map->compile(sequence->lengthInSteps, player->sampleRate, player->clock.stepsPerBeat);
+            }
+        }
+        if (map && map->isCompiled()) tempoMap = map;
+        kit = player->getPublishedKit();
+        sampleRate = player->sampleRate;
+        samplesPerStep = AdikClock(player->sampleRate, player->tempoBPM, player->clock.stepsPerBeat).getSamplesPerStep();
+
+        // Stems : canaux ou index de pistes ayant au moins un événement
+        std::set<int> used;
+        for (const AdikSequence* sequence : passes) {
+            for (size_t t = 0; t < sequence->tracks.size(); ++t) {
+                if (sequence->tracks[t].events.size() == 0) continue;
+                used.insert(options.mode == BY_CHANNEL ? sequence->tracks[t].mixerChannelIndex : static_cast<int>(t));
+            }
+        }
+        // Routage des bus non rendu (voir AdikVoiceRenderer) : prévenir si les sorties jouent autre chose
+        bool routed = player->mixer.busList[0].gain != 1.0f;
+        for (const AdikSequence* sequence : passes) {
+            for (const auto& track : sequence->tracks) {
+                const int channel = track.mixerChannelIndex;
+                if (track.events.size() == 0 || channel < 1 || channel > static_cast<int>(player->mixer.channelList.size())) continue;
+                routed = routed || player->mixer.channelList[channel - 1].busIndex != 0;
+            }
+        }
+        if (routed) {
+            std::cout << "AdikStemExporter: Canaux routés vers des bus (ou gain du bus principal) : stems et mix exportés avant les bus."
+                      << std::endl;
+        }
+        for (int key : used) {
+            Job job;
+            char name[32];
+            if (options.mode == BY_CHANNEL) {
+                std::snprintf(name, sizeof(name), "canal-%d", key);
+                job.channel = key;
+            } else {
+                std::snprintf(name, sizeof(name), "piste-%02d", key + 1);
+                job.trackIndex = key;
+            }
+            job.stem.name = name;
+            newJobs.push_back(job);
+        }
+    }
+    if (passes.empty() || newJobs.empty() || !kit || samplesPerStep < 1.0) {
+        std::cerr << "AdikStemExporter: Rien à exporter." << std::endl;
+        return false;
+    }
+    if (options.fullMix) {
+        Job mix;
+        mix.stem.name = "mix";
+        newJobs.push_back(mix);
+    }
+    for (auto& job : newJobs) {
+        job.stem.path = options.directory + "/" + job.stem.name + ".wav";
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(resultMutex);
+        jobs = newJobs;
+        succeeded = false;
+    }
+    framesDone.store(0);
+    framesTotal.store(0);
+    running.store(true);
+    coordinator = std::thread(&AdikStemExporter::run, this, options);
+    return true;
+}
+
+double AdikStemExporter::getProgress() const {
+    const int64_t total = framesTotal.load();
+    if (total <= 0) return running.load() ? 0.0 : 1.0;
+    return std::min(1.0, static_cast<double>(framesDone.load()) / total);
+}
+
+bool AdikStemExporter::wait(std::function<void(double)> progress) {
+    while (running.load()) {
+        if (progress) progress(getProgress());
+        std::this_thread::sleep_for(std::chrono::milliseconds(200));
+    }
+    if (coordinator.joinable()) coordinator.join();
+    if (progress) progress(1.0);
+    std::lock_guard<std::mutex> lock(resultMutex);
+    return succeeded;
+}
+
+std::vector<AdikStemExporter::Stem> AdikStemExporter::getStems() {
+    std::lock_guard<std::mutex> lock(resultMutex);
+    std::vector<Stem> stems;
+    for (const auto& job : jobs) stems.push_back(job.stem);
+    return stems;
+}
+
+void AdikStemExporter::run(Options options) {
+    const auto start = std::chrono::steady_clock::now();
+    // Même durée pour tous les stems (alignés sur le mix), fin des sons comprise
+    AdikVoiceRenderer timing(passes, kit, sampleRate, samplesPerStep, tempoMap);
+    const int64_t frames = timing.getTotalFrames() + static_cast<int64_t>(std::max(0.0, options.tailSeconds) * sampleRate);
+    framesTotal.store(frames * static_cast<int64_t>(jobs.size()));
+
+    // Un stem par tâche : chaque thread prend le suivant jusqu'à épuisement (comme AdikSampleAnalyzer::analyzeAll)
+    unsigned int numThreads = options.numThreads ? options.numThreads : std::max(1u, std::thread::hardware_concurrency());
+    numThreads = static_cast<unsigned int>(std::min<size_t>(numThreads, jobs.size()));
+    std::atomic<size_t> next(0);
+    auto work = [&]() {
+        for (size_t i = next.fetch_add(1); i < jobs.size(); i = next.fetch_add(1)) {
+            const Stem stem = renderJob(jobs[i], options, frames);
+            std::lock_guard<std::mutex> lock(resultMutex);
+            jobs[i].stem = stem;
+        }
+    };
+    std::vector<std::thread> workers;
+    for (unsigned int t = 1; t < numThreads; ++t) workers.emplace_back(work);
+    work();
+    for (auto& worker : workers) worker.join();
+
+    const double elapsedMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    bool ok = true;
+    {
+        std::lock_guard<std::mutex> lock(resultMutex);
+        std::cout << "AdikStemExporter: " << jobs.size() << " fichier(s) de " << static_cast<double>(frames) / sampleRate
+                  << " s exporté(s) en " << elapsedMs << " ms sur " << numThreads << " thread(s), dans '"
+                  << options.directory << "'." << std::endl;
+        for (const auto& job : jobs) {
+            char line[192];
+            std::snprintf(line, sizeof(line), "  %-10s crête %6.1f dB, rendu %8.1f ms%s", job.stem.name.c_str(),
+                          job.stem.peak > 0.0f ? 20.0f * std::log10(job.stem.peak) : -144.0f, job.stem.renderMs,
+                          job.stem.ok ? "" : " (ÉCHEC)");
+            std::cout << line << std::endl;
+            ok = ok && job.stem.ok;
+        }
+        succeeded = ok;
+    }
+    running.store(false);
+}
+
+AdikStemExporter::Stem AdikStemExporter::renderJob(const Job& job, const Options& options, int64_t frames) {
+    const auto start = std::chrono::steady_clock::now();
+    AdikVoiceRenderer::TrackFilter filter;
+    if (job.channel >= 0) {
+        const int channel = job.channel;
+        filter = [channel](size_t, const AdikTrack& track) { return track.mixerChannelIndex == channel; };
+    } else if (job.trackIndex >= 0) {
+        const size_t trackIndex = static_cast<size_t>(job.trackIndex);
+        filter = [trackIndex](size_t t, const AdikTrack&) { return t == trackIndex; };
+    }
+    AdikVoiceRenderer renderer(passes, kit, sampleRate, samplesPerStep, tempoMap, filter);
+    AdikWavWriter writer;
+    bool ok = writer.open(job.stem.path, sampleRate, 2, options.format);
+    float peak = 0.0f;
+    if (ok) {
+        renderer.render(frames, [&](const float* samples, unsigned int numFrames) {
+            for (size_t i = 0; i < static_cast<size_t>(numFrames) * 2; ++i) {
+                peak = std::max(peak, std::fabs(samples[i]));
+            }
+            ok = writer.write(samples, numFrames) && ok;
+            framesDone.fetch_add(numFrames, std::memory_order_relaxed);
+        });
+        ok = writer.close() && ok;
+    }
+    Stem stem = job.stem;
+    stem.frames = frames;
+    stem.peak = peak;
+    stem.ok = ok;
+    stem.renderMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    return stem;
+}
@@ -0,0 +1,103 @@
+#ifndef ADIKSTEMEXPORTER_H
+#define ADIKSTEMEXPORTER_H
+
+#include <memory>
+#include <string>
+#include <vector>
+#include <thread>
+#include <atomic>
+#include <mutex>
+#include <functional>
+#include <cstdint>
+
+#include "adikformatconverter.h" // Pour AdikSampleFormat
+
+class AdikPlayer;
+class AdikSequence;
+class AdikTempoMap;
+struct AdikKit;
+
+// --- AdikStemExporter ---
+// Export des stems d'un morceau (ou de la séquence sélectionnée) : un fichier WAV par canal du mixeur ou par piste,
+// et le mix complet en option. Chaque stem est rendu par son propre AdikVoiceRenderer (mixeur et voix isolés),
+// les stems étant répartis sur un thread par cœur : l'export de N stems dure à peu près celui d'un mix sur N cœurs.
+// Le morceau, le kit et le tempo sont copiés sous AdikPlayer::sequenceEditMutex au lancement : la lecture et
+// l'édition continuent pendant l'export, qui ne touche jamais au thread audio.
+// Comme AdikVoiceRenderer, l'export somme les canaux sans le routage des bus : avec des bus configurés
+// (AdikMixer::setChannelBus, gains), ni les stems ni le mix ne sont ce que jouent les sorties du périphérique.
+class AdikStemExporter {
+public:
+    enum StemMode {
+        BY_CHANNEL = 0, // Un stem par canal du mixeur : la somme des stems est le mix exporté ("mix.wav"), pris avant
+                        // les bus (gain, sorties et mono des bus du player non appliqués)
+        BY_TRACK = 1    // Un stem par index de piste (la même piste de chaque séquence) ; une piste seule ne coupe plus
+                        // les sons des autres pistes de son canal
+    };
+
+    struct Options {
+        std::string directory = "stems";  // Créé s'il n'existe pas
+        StemMode mode = BY_CHANNEL;
+        bool fullMix = true;              // Exporte aussi le mix complet ("mix.wav")
+        int sequenceLoops = 1;            // Mode SEQUENCE : nombre de passages de la séquence sélectionnée
+        double tailSeconds = 2.0;         // Rendu prolongé après le dernier pas (fin des sons)
+        unsigned int numThreads = 0;      // 0 : un thread par cœur
+        AdikSampleFormat format = AdikSampleFormat::INT24;
+    };
+
+    struct Stem {
+        std::string name;
+        std::string path;
+        int64_t frames = 0;
+        float peak = 0.0f;
+        double renderMs = 0.0;
+        bool ok = false;
+    };
+
+    explicit AdikStemExporter(std::shared_ptr<AdikPlayer> p);
+    ~AdikStemExporter();
+
+    // Copie le morceau et lance l'export en arrière-plan. Faux si un export est en cours ou s'il n'y a rien à exporter.
+    bool start(const Options& options);
+
+    bool isRunning() const { return running.load(); }
+
+    // Avancement de l'export en cours (ou du dernier), de 0 à 1
+    double getProgress() const;
+
+    // Attend la fin de l'export ; 'progress' est appelé régulièrement avec l'avancement. Vrai si tous les stems sont écrits.
+    bool wait(std::function<void(double)> progress = nullptr);
+
+    // Résultat du dernier export terminé
+    std::vector<Stem> getStems();
+
+private:
+    // Un fichier à rendre : les pistes retenues par 'channel' (BY_CHANNEL), 'trackIndex' (BY_TRACK), ou toutes (mix)
+    struct Job {
+        Stem stem;
+        int channel = -1;
+        int trackIndex = -1;
+    };
+
+    std::shared_ptr<AdikPlayer> player;
+    std::thread coordinator;
+    std::atomic<bool> running;
+    std::atomic<int64_t> framesDone;
+    std::atomic<int64_t> framesTotal; // Écrit par le thread de l'export, lu par getProgress
+    std::mutex resultMutex;
+    std::vector<Job> jobs;
+    bool succeeded;
+
+    // Copies prises au lancement
+    std::vector<std::shared_ptr<AdikSequence>> sequenceCopies;
+    std::vector<const AdikSequence*> passes;
+    std::shared_ptr<AdikKit> kit;
+    std::shared_ptr<const AdikTempoMap> tempoMap;
+    unsigned int sampleRate;
+    double samplesPerStep;
+
+    void run(Options options);
+    // Rend un stem (thread de travail) : le résultat est rangé dans 'jobs' sous resultMutex par l'appelant
+    Stem renderJob(const Job& job, const Options& options, int64_t frames);
+};
+
+#endif // ADIKSTEMEXPORTER_H
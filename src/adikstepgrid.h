@@ -0,0 +1,397 @@
+#ifndef ADIKSTEPGRID_H
+#define ADIKSTEPGRID_H
+
+#include <vector>
+#include <algorithm> // Pour std::rotate, std::fill
+#include <cstdint>
+#include <cstddef>
+
+#include "adikevent.h"
+#include "adikeventlist.h"
+
+// --- AdikStepGrid ---
+// Grille de pas d'un instrument sur une piste, pour l'édition de motifs : un bit par pas (mots de 64 bits)
+// et, en parallèle, la vélocité, le pan et le pitch de chaque pas (quantifiés comme AdikEvent).
+// Test d'un pas en O(1), et opérations sur des mots entiers : décalage, rotation, copier/coller de mesures,
+// remplissage euclidien, tirage aléatoire avec densité. Les attributs d'un pas éteint sont sans signification.
+// La grille n'est pas lue par le thread audio : compileInto() l'écrit dans l'AdikEventList de la piste
+// (sous AdikPlayer::sequenceEditMutex, suivi de invalidateSchedule(), comme toute édition de séquence).
+class AdikStepGrid {
+public:
+    AdikInstrumentHandle instrument;
+    int stepsPerMeasure;
+
+    AdikStepGrid(AdikInstrumentHandle instr = INVALID_INSTRUMENT_HANDLE, int length = 16, int spm = 16)
+        : instrument(instr), stepsPerMeasure(spm > 0 ? spm : 16), lengthInSteps(0) {
+        resize(length);
+    }
+
+    int getLength() const { return lengthInSteps; }
+    int getNumMeasures() const { return (lengthInSteps + stepsPerMeasure - 1) / stepsPerMeasure; }
+    const std::vector<uint64_t>& getWords() const { return bits; }
+
+    // Change la longueur : les pas au-delà sont perdus, les nouveaux sont éteints
+    void resize(int length) {
+        lengthInSteps = length > 0 ? length : 0;
+        bits.resize(wordCount(lengthInSteps), 0);
+        maskTail(bits);
+        velocities.resize(lengthInSteps, AdikEventQuant::encodeVelocity(1.0f));
+        pans.resize(lengthInSteps, 0);
+        pitches.resize(lengthInSteps, 0);
+    }
+
+    // --- Pas individuels ---
+
+    bool test(int step) const {
+        return inRange(step) && ((bits[step >> 6] >> (step & 63)) & 1u) != 0;
+    }
+
+    void set(int step, float vel = 1.0f, float pan = 0.0f, float pitch = 0.0f) {
+        if (!inRange(step)) return;
+        bits[step >> 6] |= bit(step);
+        setAttributes(step, vel, pan, pitch);
+    }
+
+    void clear(int step) {
+        if (inRange(step)) bits[step >> 6] &= ~bit(step);
+    }
+
+    // Inverse le pas ; un pas allumé prend la vélocité 'vel'. Renvoie le nouvel état.
+    bool toggle(int step, float vel = 1.0f) {
+        if (!inRange(step)) return false;
+        bits[step >> 6] ^= bit(step);
+        const bool on = test(step);
+        if (on) setAttributes(step, vel, 0.0f, 0.0f);
+        return on;
+    }
+
+    void setVelocity(int step, float vel) { if (inRange(step)) velocities[step] = AdikEventQuant::encodeVelocity(vel); }
+    void setPan(int step, float pan) { if (inRange(step)) pans[step] = AdikEventQuant::encodePan(pan); }
+    void setPitch(int step, float pitch) { if (inRange(step)) pitches[step] = AdikEventQuant::encodePitch(pitch); }
+    float getVelocity(int step) const { return inRange(step) ? AdikEventQuant::decodeVelocity(velocities[step]) : 0.0f; }
+    float getPan(int step) const { return inRange(step) ? AdikEventQuant::decodePan(pans[step]) : 0.0f; }
+    float getPitch(int step) const { return inRange(step) ? AdikEventQuant::decodePitch(pitches[step]) : 0.0f; }
+
+    // Premier pas allumé à partir de 'from', ou -1 (parcours mot par mot)
+    int nextStep(int from) const {
+        if (from < 0) from = 0;
+        if (from >= lengthInSteps) return -1;
+        size_t w = static_cast<size_t>(from) >> 6;
+        uint64_t word = bits[w] & (~0ull << (from & 63));
+        while (true) {
+            if (word) return static_cast<int>((w << 6) + __builtin_ctzll(word));
+            if (++w >= bits.size()) return -1;
+            word = bits[w];
+        }
+    }
+
+    // Nombre de pas allumés
+    size_t count() const {
+        size_t n = 0;
+        for (uint64_t word : bits) n += static_cast<size_t>(__builtin_popcountll(word));
+        return n;
+    }
+
+    bool any() const {
+        for (uint64_t word : bits) {
+            if (word) return true;
+        }
+        return false;
+    }
+
+    // --- Opérations en bloc ---
+
+    void clearAll() { std::fill(bits.begin(), bits.end(), 0); }
+
+    // Éteint les pas de [firstStep, lastStep)
+    void clearRange(int firstStep, int lastStep) {
+        forEachRangeWord(firstStep, lastStep, [](uint64_t& word, uint64_t mask) { word &= ~mask; });
+    }
+
+    // Inverse les pas de [firstStep, lastStep) ; les pas allumés gardent leurs attributs précédents
+    void invertRange(int firstStep, int lastStep) {
+        forEachRangeWord(firstStep, lastStep, [](uint64_t& word, uint64_t mask) { word ^= mask; });
+    }
+
+    // Décale le motif de 'offset' pas (vers la fin si positif) ; les pas sortis sont perdus
+    void shift(int offset) {
+        if (offset == 0 || lengthInSteps == 0) return;
+        shiftWords(bits, offset, scratch);
+        maskTail(scratch);
+        bits.swap(scratch);
+        shiftAttributes(velocities, offset);
+        shiftAttributes(pans, offset);
+        shiftAttributes(pitches, offset);
+    }
+
+    // Rotation circulaire du motif de 'offset' pas sur toute la longueur
+    void rotate(int offset) {
+        if (lengthInSteps == 0) return;
+        const int n = ((offset % lengthInSteps) + lengthInSteps) % lengthInSteps;
+        if (n == 0) return;
+        // bits[i] -> bits[(i + n) % longueur] : décalage de n, plus décalage de n - longueur pour ce qui déborde
+        shiftWords(bits, n, scratch);
+        shiftWords(bits, n - lengthInSteps, wrapped);
+        for (size_t w = 0; w < scratch.size(); ++w) scratch[w] |= wrapped[w];
+        maskTail(scratch);
+        bits.swap(scratch);
+        std::rotate(velocities.begin(), velocities.end() - n, velocities.end());
+        std::rotate(pans.begin(), pans.end() - n, pans.end());
+        std::rotate(pitches.begin(), pitches.end() - n, pitches.end());
+    }
+
+    // Copie [firstStep, lastStep) dans 'clip', pas ramenés à 0
+    void copyRange(int firstStep, int lastStep, AdikStepGrid& clip) const {
+        firstStep = std::max(firstStep, 0);
+        lastStep = std::min(lastStep, lengthInSteps);
+        const int length = std::max(lastStep - firstStep, 0);
+        clip.instrument = instrument;
+        clip.stepsPerMeasure = stepsPerMeasure;
+        clip.resize(length);
+        if (length == 0) return;
+        shiftWords(bits, -firstStep, clip.scratch);
+        clip.scratch.resize(clip.bits.size());
+        clip.maskTail(clip.scratch);
+        clip.bits.swap(clip.scratch);
+        std::copy(velocities.begin() + firstStep, velocities.begin() + lastStep, clip.velocities.begin());
+        std::copy(pans.begin() + firstStep, pans.begin() + lastStep, clip.pans.begin());
+        std::copy(pitches.begin() + firstStep, pitches.begin() + lastStep, clip.pitches.begin());
+    }
+
+    // Colle 'clip' à partir de 'atStep', en remplaçant les pas qu'il couvre (le débordement est perdu)
+    void paste(const AdikStepGrid& clip, int atStep) {
+        const int first = std::max(atStep, 0);
+        const int last = std::min(atStep + clip.lengthInSteps, lengthInSteps);
+        if (first >= last) return;
+        clearRange(first, last);
+        shiftWords(clip.bits, atStep, scratch, bits.size());
+        // Le clip décalé ne contient que des pas de [atStep, atStep + longueur du clip)
+        forEachRangeWord(first, last, [&](uint64_t& word, uint64_t mask) { word |= scratch[&word - bits.data()] & mask; });
+        std::copy(clip.velocities.begin() + (first - atStep), clip.velocities.begin() + (last - atStep), velocities.begin() + first);
+        std::copy(clip.pans.begin() + (first - atStep), clip.pans.begin() + (last - atStep), pans.begin() + first);
+        std::copy(clip.pitches.begin() + (first - atStep), clip.pitches.begin() + (last - atStep), pitches.begin() + first);
+    }
+
+    void copyMeasures(int firstMeasure, int numMeasures, AdikStepGrid& clip) const {
+        copyRange(firstMeasure * stepsPerMeasure, (firstMeasure + numMeasures) * stepsPerMeasure, clip);
+    }
+
+    void pasteMeasures(const AdikStepGrid& clip, int atMeasure) {
+        paste(clip, atMeasure * stepsPerMeasure);
+    }
+
+    // Recopie la mesure 'measure' sur toutes les mesures suivantes
+    void repeatMeasure(int measure) {
+        AdikStepGrid clip;
+        copyMeasures(measure, 1, clip);
+        for (int m = measure + 1; m < getNumMeasures(); ++m) pasteMeasures(clip, m);
+    }
+
+    // Rythme euclidien : 'pulses' pas répartis au mieux sur 'patternLength' pas, décalés de 'rotation',
+    // motif répété sur [firstStep, lastStep) (toute la grille par défaut). Les autres pas de l'intervalle sont éteints.
+    void fillEuclidean(int pulses, int patternLength, int rotation = 0, float vel = 1.0f,
+                       int firstStep = 0, int lastStep = -1) {
+        if (lastStep < 0 || lastStep > lengthInSteps) lastStep = lengthInSteps;
+        firstStep = std::max(firstStep, 0);
+        if (patternLength <= 0 || firstStep >= lastStep) return;
+        pulses = std::min(std::max(pulses, 0), patternLength);
+        clearRange(firstStep, lastStep);
+        const uint16_t quantVel = AdikEventQuant::encodeVelocity(vel);
+        const int64_t r = ((rotation % patternLength) + patternLength) % patternLength;
+        for (int step = firstStep; step < lastStep; ++step) {
+            // Algorithme de Bresenham : le pas i du motif est allumé si (i * pulses) mod longueur < pulses
+            const int64_t i = (step - firstStep + r) % patternLength;
+            if ((i * pulses) % patternLength < pulses) {
+                bits[step >> 6] |= bit(step);
+                velocities[step] = quantVel;
+                pans[step] = 0;
+                pitches[step] = 0;
+            }
+        }
+    }
+
+    // Tire un nouveau motif sur [firstStep, lastStep) : chaque pas est allumé avec la probabilité 'density'
+    // (précision 1/256). Le tirage se fait 64 pas à la fois : un mot aléatoire par bit de 'density', combinés
+    // par ET/OU. Reproductible pour une même graine ; 'seed' est avancé pour le tirage suivant.
+    void randomize(float density, uint64_t& seed, float vel = 1.0f, int firstStep = 0, int lastStep = -1) {
+        if (lastStep < 0 || lastStep > lengthInSteps) lastStep = lengthInSteps;
+        firstStep = std::max(firstStep, 0);
+        if (firstStep >= lastStep) return;
+        const int level = std::min(std::max(static_cast<int>(density * 256.0f + 0.5f), 0), 256);
+        if (seed == 0) seed = 0x9E3779B97F4A7C15ull;
+        const uint16_t quantVel = AdikEventQuant::encodeVelocity(vel);
+        forEachRangeWord(firstStep, lastStep, [&](uint64_t& word, uint64_t mask) {
+            uint64_t random = 0;
+            if (level >= 256) {
+                random = ~0ull;
+            } else {
+                // Bits de 'level' du plus faible au plus fort : 1 -> OU, 0 -> ET avec un mot aléatoire
+                for (int b = 0; b < 8; ++b) {
+                    const uint64_t r = nextRandom(seed);
+                    random = ((level >> b) & 1) ? (random | r) : (random & r);
+                }
+            }
+            const uint64_t added = random & mask & ~word;
+            word = (word & ~mask) | (random & mask);
+            for (uint64_t a = added; a; a &= a - 1) {
+                const size_t step = (static_cast<size_t>(&word - bits.data()) << 6) + __builtin_ctzll(a);
+                velocities[step] = quantVel;
+                pans[step] = 0;
+                pitches[step] = 0;
+            }
+        });
+    }
+
+    // Combinaisons mot à mot avec une grille de même découpage (les attributs de 'other' sont repris là où il ajoute un pas)
+    void merge(const AdikStepGrid& other) {
+        const size_t n = std::min(bits.size(), other.bits.size());
+        for (size_t w = 0; w < n; ++w) {
+            for (uint64_t a = other.bits[w] & ~bits[w]; a; a &= a - 1) {
+                const size_t step = (w << 6) + __builtin_ctzll(a);
+                if (static_cast<int>(step) >= lengthInSteps) break;
+                velocities[step] = other.velocities[step];
+                pans[step] = other.pans[step];
+                pitches[step] = other.pitches[step];
+            }
+            bits[w] |= other.bits[w];
+        }
+        maskTail(bits);
+    }
+
+    void intersect(const AdikStepGrid& other) {
+        for (size_t w = 0; w < bits.size(); ++w) bits[w] &= w < other.bits.size() ? other.bits[w] : 0;
+    }
+
+    void subtract(const AdikStepGrid& other) {
+        const size_t n = std::min(bits.size(), other.bits.size());
+        for (size_t w = 0; w < n; ++w) bits[w] &= ~other.bits[w];
+    }
+
+    // --- Conversion vers et depuis les événements de la piste ---
+
+    // Remplit la grille avec les événements de 'instrument' (le dernier événement d'un pas donne ses attributs)
+    void readFrom(const AdikEventList& events) {
+        clearAll();
+        for (size_t i = 0; i < events.size(); ++i) {
+            const int step = events.steps[i];
+            if (events.instruments[i] != instrument || !inRange(step)) continue;
+            bits[step >> 6] |= bit(step);
+            velocities[step] = events.velocities[i];
+            pans[step] = events.pans[i];
+            pitches[step] = events.pitches[i];
+        }
+    }
+
+    // Remplace les événements de 'instrument' sur [0, longueur) par ceux de la grille, en une seule fusion triée.
+    // Les événements des autres instruments restent en place ; au même pas, celui de la grille vient après eux.
+    void compileInto(AdikEventList& events) const {
+        AdikEventList& merged = compiled;
+        merged.clear();
+        merged.reserve(events.size() + count());
+        size_t i = 0;
+        for (int step = nextStep(0); step >= 0; step = nextStep(step + 1)) {
+            for (; i < events.size() && events.steps[i] <= step; ++i) {
+                if (!isReplaced(events, i)) appendFrom(merged, events, i);
+            }
+            merged.steps.push_back(step);
+            merged.instruments.push_back(instrument);
+            merged.velocities.push_back(velocities[step]);
+            merged.pans.push_back(pans[step]);
+            merged.pitches.push_back(pitches[step]);
+        }
+        for (; i < events.size(); ++i) {
+            if (!isReplaced(events, i)) appendFrom(merged, events, i);
+        }
+        std::swap(events, merged);
+    }
+
+private:
+    int lengthInSteps;
+    std::vector<uint64_t> bits;      // Pas allumés, bit (pas % 64) du mot (pas / 64)
+    std::vector<uint16_t> velocities; // Attributs par pas, quantifiés comme dans AdikEvent
+    std::vector<int16_t> pans;
+    std::vector<int16_t> pitches;
+    std::vector<uint64_t> scratch;   // Mots de travail, gardés entre deux éditions (pas d'allocation en régime établi)
+    std::vector<uint64_t> wrapped;
+    mutable AdikEventList compiled;
+
+    static size_t wordCount(int length) { return (static_cast<size_t>(length) + 63) / 64; }
+    static uint64_t bit(int step) { return 1ull << (step & 63); }
+    bool inRange(int step) const { return step >= 0 && step < lengthInSteps; }
+
+    void setAttributes(int step, float vel, float pan, float pitch) {
+        velocities[step] = AdikEventQuant::encodeVelocity(vel);
+        pans[step] = AdikEventQuant::encodePan(pan);
+        pitches[step] = AdikEventQuant::encodePitch(pitch);
+    }
+
+    // Éteint les bits au-delà de la longueur dans le dernier mot
+    void maskTail(std::vector<uint64_t>& words) const {
+        words.resize(wordCount(lengthInSteps));
+        if (!words.empty() && (lengthInSteps & 63)) words.back() &= (1ull << (lengthInSteps & 63)) - 1;
+    }
+
+    // Appelle func(mot, masque des pas de [firstStep, lastStep) dans ce mot) pour chaque mot touché
+    template <typename Func>
+    void forEachRangeWord(int firstStep, int lastStep, Func func) {
+        firstStep = std::max(firstStep, 0);
+        lastStep = std::min(lastStep, lengthInSteps);
+        if (firstStep >= lastStep) return;
+        const size_t firstWord = static_cast<size_t>(firstStep) >> 6;
+        const size_t lastWord = static_cast<size_t>(lastStep - 1) >> 6;
+        for (size_t w = firstWord; w <= lastWord; ++w) {
+            uint64_t mask = ~0ull;
+            if (w == firstWord) mask &= ~0ull << (firstStep & 63);
+            if (w == lastWord && (lastStep & 63)) mask &= (1ull << (lastStep & 63)) - 1;
+            func(bits[w], mask);
+        }
+    }
+
+    // dst = src décalé de 'offset' bits (le bit i passe en i + offset), sur 'numWords' mots (ceux de src par défaut)
+    static void shiftWords(const std::vector<uint64_t>& src, int offset, std::vector<uint64_t>& dst, size_t numWords = 0) {
+        const int64_t n = static_cast<int64_t>(numWords ? numWords : src.size());
+        dst.assign(static_cast<size_t>(n), 0);
+        const int64_t wordShift = offset >= 0 ? offset / 64 : -((-static_cast<int64_t>(offset) + 63) / 64);
+        const int bitShift = static_cast<int>(offset - wordShift * 64); // 0..63
+        for (int64_t w = 0; w < n; ++w) {
+            const int64_t s = w - wordShift; // Les bits de dst[w] viennent de src[s] et de src[s - 1]
+            uint64_t value = 0;
+            if (s >= 0 && s < static_cast<int64_t>(src.size())) value |= src[s] << bitShift;
+            if (bitShift && s - 1 >= 0 && s - 1 < static_cast<int64_t>(src.size())) value |= src[s - 1] >> (64 - bitShift);
+            dst[w] = value;
+        }
+    }
+
+    template <typename T>
+    void shiftAttributes(std::vector<T>& values, int offset) {
+        const int n = lengthInSteps;
+        if (offset >= n || -offset >= n) return; // Plus aucun pas allumé : attributs sans signification
+        if (offset > 0) {
+            std::copy_backward(values.begin(), values.end() - offset, values.end());
+        } else {
+            std::copy(values.begin() - offset, values.end(), values.begin());
+        }
+    }
+
+    bool isReplaced(const AdikEventList& events, size_t i) const {
+        return events.instruments[i] == instrument && inRange(events.steps[i]);
+    }
+
+    static void appendFrom(AdikEventList& out, const AdikEventList& events, size_t i) {
+        out.steps.push_back(events.steps[i]);
+        out.instruments.push_back(events.instruments[i]);
+        out.velocities.push_back(events.velocities[i]);
+        out.pans.push_back(events.pans[i]);
+        out.pitches.push_back(events.pitches[i]);
+    }
+
+    // xorshift64* : rapide, reproductible, suffisant pour des motifs
+    static uint64_t nextRandom(uint64_t& state) {
+        state ^= state >> 12;
+        state ^= state << 25;
+        state ^= state >> 27;
+        return state * 0x2545F4914F6CDD1Dull;
+    }
+};
+
+#endif // ADIKSTEPGRID_H
@@ -0,0 +1,184 @@
+#ifndef ADIKTEMPOMAP_H
+#define ADIKTEMPOMAP_H
+
+#include <vector>
+#include <algorithm> // Pour std::upper_bound, std::stable_sort
+#include <cmath>     // Pour std::log, std::exp, std::ceil, std::fabs
+#include <cstdint>   // Pour int64_t
+#include <iostream>
+
+// --- AdikTempoMap ---
+// Carte de tempo d'un morceau (ou d'une séquence) : une liste de points de tempo,
+// chacun précisant comment le tempo évolue jusqu'au point suivant
+// (saut, rampe linéaire ou rampe exponentielle).
+// compile() la transforme en une table des positions de début de chaque pas,
+// en samples, calculées par intégration exacte de la durée des pas :
+//     samples(x1, x2) = 60 * sampleRate / stepsPerBeat * intégrale de x1 à x2 de dx / bpm(x)
+// Le thread audio n'y fait ensuite que des lectures de table.
+class AdikTempoMap {
+public:
+    enum CurveType {
+        TEMPO_STEP,        // Tempo constant jusqu'au point suivant
+        TEMPO_LINEAR,      // Rampe linéaire (en BPM) jusqu'au point suivant
+        TEMPO_EXPONENTIAL  // Rampe exponentielle jusqu'au point suivant
+    };
+
+    struct TempoPoint {
+        int step;         // Pas (absolu dans le morceau ou la séquence)
+        double bpm;       // Tempo à ce pas
+        CurveType curve;  // Évolution du tempo jusqu'au point suivant
+    };
+
+    std::vector<TempoPoint> points; // Triés par pas croissant
+
+    // Table compilée : stepStartSamples[i] est la position exacte (fractionnaire) du début du pas i,
+    // pour i dans [0, compiledTotalSteps]. Au-delà, la table boucle (morceau ou séquence rejoué).
+    std::vector<double> stepStartSamples;
+    int compiledTotalSteps = 0;
+    unsigned int compiledSampleRate = 0;
+    int compiledStepsPerBeat = 0;
+
+    bool empty() const { return points.empty(); }
+    bool isCompiled() const { return compiledTotalSteps > 0 && !stepStartSamples.empty(); }
+
+    // Ajoute (ou remplace) un point de tempo
+    void addPoint(int step, double bpm, CurveType curve = TEMPO_STEP) {
+        if (bpm <= 0.0 || step < 0) {
+            std::cerr << "Erreur: Point de tempo invalide (pas " << step << ", " << bpm << " BPM)." << std::endl;
+            return;
+        }
+        for (auto& point : points) {
+            if (point.step == step) {
+                point.bpm = bpm;
+                point.curve = curve;
+                return;
+            }
+        }
+        points.push_back(TempoPoint{step, bpm, curve});
+        std::stable_sort(points.begin(), points.end(),
+                         [](const TempoPoint& a, const TempoPoint& b) { return a.step < b.step; });
+    }
+
+    void clear() {
+        points.clear();
+        stepStartSamples.clear();
+        compiledTotalSteps = 0;
+    }
+
+    // Tempo au pas (fractionnaire) donné
+    double tempoAtStep(double step) const {
+        if (points.empty()) return 0.0;
+        size_t i = segmentIndexAt(step);
+        if (step <= points[i].step || i + 1 >= points.size()) return points[i].bpm;
+        const TempoPoint& a = points[i];
+        const TempoPoint& b = points[i + 1];
+        const double t = (step - a.step) / static_cast<double>(b.step - a.step);
+        switch (a.curve) {
+            case TEMPO_LINEAR: return a.bpm + (b.bpm - a.bpm) * t;
+            case TEMPO_EXPONENTIAL: return a.bpm * std::pow(b.bpm / a.bpm, t);
+            default: return a.bpm;
+        }
+    }
+
+    // Construit la table des positions de pas pour un morceau de 'totalSteps' pas
+    void compile(int totalSteps, unsigned int sampleRate, int stepsPerBeat = 4) {
+        stepStartSamples.clear();
+        compiledTotalSteps = 0;
+        if (points.empty() || totalSteps <= 0 || sampleRate == 0 || stepsPerBeat <= 0) return;
+
+        compiledSampleRate = sampleRate;
+        compiledStepsPerBeat = stepsPerBeat;
+        const double samplesPerStepAtOneBpm = 60.0 * sampleRate / stepsPerBeat;
+
+        stepStartSamples.resize(totalSteps + 1);
+        stepStartSamples[0] = 0.0;
+        for (int i = 0; i < totalSteps; ++i) {
+            stepStartSamples[i + 1] = stepStartSamples[i]
+                                    + samplesPerStepAtOneBpm * integrateInverseTempo(i, i + 1);
+        }
+        compiledTotalSteps = totalSteps;
+    }
+
+    // Durée totale d'un passage de la table, en samples (fractionnaire)
+    double getLoopLengthSamples() const {
+        return isCompiled() ? stepStartSamples[compiledTotalSteps] : 0.0;
+    }
+
+    // Premier sample du pas absolu donné (la table boucle au-delà de compiledTotalSteps). O(1).
+    int64_t sampleForStep(int64_t step) const {
+        if (!isCompiled()) return 0;
+        if (step < 0) step = 0;
+        const int64_t loops = step / compiledTotalSteps;
+        const int64_t rest = step % compiledTotalSteps;
+        return static_cast<int64_t>(std::ceil(loops * getLoopLengthSamples() + stepStartSamples[rest]));
+    }
+
+    // Position musicale (en pas fractionnaires) du sample donné. O(log n).
+    double stepPositionAtSample(int64_t sample) const {
+        if (!isCompiled() || sample <= 0) return 0.0;
+        const double loopLength = getLoopLengthSamples();
+        const int64_t loops = static_cast<int64_t>(std::floor(sample / loopLength));
+        const double rest = sample - loops * loopLength;
+        auto it = std::upper_bound(stepStartSamples.begin(), stepStartSamples.end(), rest);
+        int step = static_cast<int>(it - stepStartSamples.begin()) - 1;
+        if (step >= compiledTotalSteps) step = compiledTotalSteps - 1;
+        const double start = stepStartSamples[step];
+        const double length = stepStartSamples[step + 1] - start;
+        return static_cast<double>(loops) * compiledTotalSteps + step + (length > 0.0 ? (rest - start) / length : 0.0);
+    }
+
+private:
+    // Index du dernier point dont le pas est <= step (0 si step précède le premier point)
+    size_t segmentIndexAt(double step) const {
+        auto it = std::upper_bound(points.begin(), points.end(), step,
+                                   [](double s, const TempoPoint& p) { return s < p.step; });
+        return it == points.begin() ? 0 : static_cast<size_t>(it - points.begin()) - 1;
+    }
+
+    // Intégrale de dx / bpm(x) entre les pas x1 et x2 (x1 < x2), calculée segment par segment
+    double integrateInverseTempo(double x1, double x2) const {
+        double total = 0.0;
+        size_t i = segmentIndexAt(x1);
+        double x = x1;
+        // Avant le premier point : tempo du premier point
+        if (x < points[0].step) {
+            const double end = std::min(x2, static_cast<double>(points[0].step));
+            total += (end - x) / points[0].bpm;
+            x = end;
+        }
+        while (x < x2) {
+            const bool last = (i + 1 >= points.size());
+            const double segmentEnd = last ? x2 : std::min(x2, static_cast<double>(points[i + 1].step));
+            if (segmentEnd > x) {
+                total += integrateSegment(i, x, segmentEnd);
+            }
+            x = segmentEnd;
+            ++i;
+            if (last) break;
+        }
+        return total;
+    }
+
+    double integrateSegment(size_t i, double x1, double x2) const {
+        const TempoPoint& a = points[i];
+        // Après le dernier point, ou en saut de tempo : tempo constant
+        if (i + 1 >= points.size() || a.curve == TEMPO_STEP) {
+            return (x2 - x1) / a.bpm;
+        }
+        const TempoPoint& b = points[i + 1];
+        const double length = static_cast<double>(b.step - a.step);
+        if (a.curve == TEMPO_LINEAR) {
+            const double slope = (b.bpm - a.bpm) / length;
+            if (std::fabs(slope) < 1e-12) return (x2 - x1) / a.bpm;
+            const double bpm1 = a.bpm + slope * (x1 - a.step);
+            const double bpm2 = a.bpm + slope * (x2 - a.step);
+            return std::log(bpm2 / bpm1) / slope;
+        }
+        // TEMPO_EXPONENTIAL : bpm(x) = a.bpm * exp(rate * (x - a.step))
+        const double rate = std::log(b.bpm / a.bpm) / length;
+        if (std::fabs(rate) < 1e-12) return (x2 - x1) / a.bpm;
+        return (std::exp(-rate * (x1 - a.step)) - std::exp(-rate * (x2 - a.step))) / (rate * a.bpm);
+    }
+};
+
+#endif // ADIKTEMPOMAP_H
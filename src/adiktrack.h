@@ -6,15 +6,15 @@
 #include <memory> // Pour std::shared_ptr si AdikEvent était un pointeur
 #include <iostream>
 
-// IMPORTANT : AdikEvent.h DOIT être inclus avant AdikTrack.h
-// car AdikTrack contient un std::vector<AdikEvent>.
-// Et AdikEvent.h inclut déjà AdikInstrument.h, donc l'ordre est respecté.
-#include "adikevent.h"
+// IMPORTANT : AdikEventList.h DOIT être inclus avant AdikTrack.h
+// car AdikTrack contient un AdikEventList (événements stockés en SoA).
+#include "adikeventlist.h"
+#include "adikstepgrid.h"
 
 class AdikTrack {
 public:
     std::string name;
-    std::vector<AdikEvent> events; // Liste des événements pour cette piste
+    AdikEventList events;          // Événements de cette piste, triés par pas (SoA)
     float volume;                  // Volume de la piste (0.0f à 1.0f)
     bool isMuted;                  // Si la piste est coupée
     bool isSoloed;                 // Si la piste est en solo
@@ -27,18 +27,29 @@ public:
     }
 
     // Ajoute un événement à la piste
-    void addEvent(std::shared_ptr<AdikInstrument> instr, int step, float vel = 1.0f, float pan = 0.0f, float pitch = 0.0f) {
-        events.emplace_back(instr, step, vel, pan, pitch);
-        // std::cout << "  Ajout d'événement: Instrument '" << (instr ? instr->name : "N/A") << "' au pas " << step << " sur la piste '" << name << "'." << std::endl;
+    void addEvent(AdikInstrumentHandle instr, int step, float vel = 1.0f, float pan = 0.0f, float pitch = 0.0f) {
+        events.add(AdikEvent(instr, step, vel, pan, pitch));
     }
 
-    // Récupère tous les événements qui se produisent à un pas donné
-    std::vector<AdikEvent*> getEventsAtStep(int step) const {
-        std::vector<AdikEvent*> eventsAtStep;
-        for (auto& event : events) {
-            if (event.step == step) {
-                eventsAtStep.push_back(const_cast<AdikEvent*>(&event)); // Nécessaire car 'events' est const dans une méthode const
-            }
+    // Grille de pas de l'instrument 'instr' sur 'lengthInSteps' pas, lue depuis les événements de la piste
+    AdikStepGrid getStepGrid(AdikInstrumentHandle instr, int lengthInSteps, int stepsPerMeasure = 16) const {
+        AdikStepGrid grid(instr, lengthInSteps, stepsPerMeasure);
+        grid.readFrom(events);
+        return grid;
+    }
+
+    // Remplace les événements de l'instrument de la grille par ceux de la grille (voir AdikStepGrid::compileInto)
+    void applyStepGrid(const AdikStepGrid& grid) {
+        grid.compileInto(events);
+    }
+
+    // Récupère une copie de tous les événements qui se produisent à un pas donné.
+    // Pour le chemin audio, préférer events.rangeAtStep() qui n'alloue pas.
+    std::vector<AdikEvent> getEventsAtStep(int step) const {
+        std::vector<AdikEvent> eventsAtStep;
+        std::pair<size_t, size_t> range = events.rangeAtStep(step);
+        for (size_t i = range.first; i < range.second; ++i) {
+            eventsAtStep.push_back(events.get(i));
         }
         return eventsAtStep;
     }
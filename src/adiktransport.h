@@ -12,6 +12,8 @@
 
 
 // --- adiktransport.h ---
+// Les commandes de transport sont exécutées par le thread audio (AdikPlayer::postTransportCommand),
+// et les positions lues dans l'instantané qu'il publie (AdikPlayer::readTimingSnapshot).
 class AdikTransport {
 private:
     std::shared_ptr<AdikPlayer> player; // Pointeur vers l'instance du AdikPlayer à contrôler
@@ -28,7 +30,11 @@ public:
     // ::play: pour jouer la séquence ou le morceau courant
     void play() {
         if (player) {
-            player->start();
+            if (player->currentMode == AdikPlayer::SONG_MODE && (!player->currentSong || player->currentSong->sequences.empty())) {
+                std::cerr << "[TRANSPORT] Aucun morceau ou séquence dans le morceau à jouer en mode SONG." << std::endl;
+                return;
+            }
+            player->postTransportCommand(AdikControlCommand::PLAY);
             std::cout << "[TRANSPORT] Lecture démarrée." << std::endl;
         }
     }
@@ -36,9 +42,13 @@ public:
     // ::pause: pour mettre en pause la séquence ou le morceau courant, au step en courant
     void pause() {
         if (player) {
-            if (player->_playing) {
-                player->_playing = false; // Mettre directement la variable à false
-                std::cout << "[TRANSPORT] Lecture en pause au pas " << player->currentStepInSequence << "." << std::endl;
+            AdikTimingSnapshot snapshot;
+            std::shared_ptr<const AdikTempoMap> map;
+            const bool known = player->readTimingSnapshot(snapshot, map);
+            if (known ? snapshot.playing : player->isPlaying()) {
+                player->postTransportCommand(AdikControlCommand::PAUSE);
+                std::cout << "[TRANSPORT] Lecture en pause au pas " << (known ? snapshot.currentStepInSequence : 0)
+                          << "." << std::endl;
             } else {
                 std::cout << "[TRANSPORT] Le lecteur n'est pas en lecture, impossible de mettre en pause." << std::endl;
             }
@@ -48,12 +58,7 @@ public:
     // ::stop: pour remettre à 0 la séquence ou le morceau courant
     void stop() {
         if (player) {
-            player->stop(); // Arrête la lecture
-            player->currentStepInSequence = 0; // Remet le pas courant à 0
-            player->currentSampleInStep = 0;   // Remet le sample courant à 0
-            if (player->currentMode == AdikPlayer::SONG_MODE) {
-                player->currentSequenceIndexInSong = 0; // Remet l'index de séquence du morceau à 0
-            }
+            player->postTransportCommand(AdikControlCommand::STOP); // Arrête la lecture, remet le pas, le sample et l'horloge au début
             std::cout << "[TRANSPORT] Lecture arrêtée et réinitialisée." << std::endl;
         }
     }
@@ -61,55 +66,17 @@ public:
     // ::setPosition, en step, pour déplacer la séquence ou le morceau à un step donné
     void setPosition(int step) {
         if (player) {
-            std::shared_ptr<AdikSequence> currentSeq = nullptr;
-            if (player->currentMode == AdikPlayer::SEQUENCE_MODE) {
-                if (player->selectedSequenceInPlayerIndex >= 0 && player->selectedSequenceInPlayerIndex < player->sequenceList.size()) {
-                    currentSeq = player->sequenceList[player->selectedSequenceInPlayerIndex];
-                }
-            } else { // SONG_MODE
-                if (player->currentSong && player->currentSequenceIndexInSong >= 0 && player->currentSequenceIndexInSong < player->currentSong->sequences.size()) {
-                    currentSeq = player->currentSong->sequences[player->currentSequenceIndexInSong];
-                }
-            }
-
-            if (currentSeq) {
-                // S'assurer que le pas est dans les limites de la séquence ou du morceau
-                int maxSteps = (player->currentMode == AdikPlayer::SEQUENCE_MODE) ?
-                                currentSeq->lengthInSteps : player->currentSong->getTotalSteps(); // Si en mode song, on prend le total des steps du song.
-
-                int targetStep = std::max(0, std::min(step, maxSteps - 1)); // Clamper la valeur
-                
-                if (player->currentMode == AdikPlayer::SONG_MODE) {
-                    // Trouver la bonne séquence et le bon pas dans cette séquence pour le mode SONG
-                    int songAbsoluteStep = targetStep;
-                    int seqIndex = 0;
-                    int stepInSeq = 0;
-                    player->currentSong->getSequenceAndStepFromAbsoluteStep(songAbsoluteStep, seqIndex, stepInSeq);
-                    
-                    player->currentSequenceIndexInSong = seqIndex;
-                    player->currentStepInSequence = stepInSeq;
-
-                } else { // SEQUENCE_MODE
-                    player->currentStepInSequence = targetStep;
-                }
-                
-                player->currentSampleInStep = 0; // Toujours réinitialiser le sample dans le pas
-                std::cout << "[TRANSPORT] Position définie au pas " << targetStep << "." << std::endl;
-            } else {
-                std::cerr << "[TRANSPORT] Aucune séquence ou morceau actif pour définir la position." << std::endl;
-            }
+            // Borné à la longueur courante par le thread audio (AdikPlayer::locateStep), ignoré sans séquence ni morceau
+            player->postTransportCommand(AdikControlCommand::LOCATE, std::max(0, step));
+            std::cout << "[TRANSPORT] Position demandée au pas " << std::max(0, step) << "." << std::endl;
         }
     }
 
     // ::rewind: pour reculer en step, par défaut un step
     void rewind(int stepsToRewind = 1) {
         if (player) {
-            int currentAbsoluteStep = player->currentStepInSequence;
-            if (player->currentMode == AdikPlayer::SONG_MODE && player->currentSong) {
-                currentAbsoluteStep = player->currentSong->getAbsoluteStep(player->currentSequenceIndexInSong, player->currentStepInSequence);
-            }
             
-            setPosition(currentAbsoluteStep - stepsToRewind);
+            setPosition(getAbsoluteStep() - stepsToRewind);
             std::cout << "[TRANSPORT] Reculé de " << stepsToRewind << " pas." << std::endl;
         }
     }
@@ -117,16 +84,44 @@ public:
     // ::foward: pour avancer en step, par défaut un step
     void forward(int stepsToForward = 1) {
         if (player) {
-            int currentAbsoluteStep = player->currentStepInSequence;
-            if (player->currentMode == AdikPlayer::SONG_MODE && player->currentSong) {
-                currentAbsoluteStep = player->currentSong->getAbsoluteStep(player->currentSequenceIndexInSong, player->currentStepInSequence);
-            }
 
-            setPosition(currentAbsoluteStep + stepsToForward);
+            setPosition(getAbsoluteStep() + stepsToForward);
             std::cout << "[TRANSPORT] Avancé de " << stepsToForward << " pas." << std::endl;
         }
     }
 
+    // ::getAbsoluteStep: pas qui sera joué à la prochaine frontière, dans la séquence ou dans le morceau (mode SONG)
+    int getAbsoluteStep() const {
+        AdikTimingSnapshot snapshot;
+        std::shared_ptr<const AdikTempoMap> map;
+        if (!player || !player->readTimingSnapshot(snapshot, map)) return 0; // Aucun bloc audio traité : début
+        if (snapshot.mode == AdikPlayer::SONG_MODE && player->currentSong) {
+            return player->currentSong->getAbsoluteStep(snapshot.currentSequenceIndexInSong, snapshot.currentStepInSequence);
+        }
+        return snapshot.currentStepInSequence;
+    }
+
+    // ::getPositionTicks: position musicale du transport, en ticks (AdikClock::TICKS_PER_BEAT par battement)
+    double getPositionTicks() const {
+        AdikTimingSnapshot snapshot;
+        std::shared_ptr<const AdikTempoMap> map; // Garde la carte de l'horloge copiée pendant la lecture
+        return player && player->readTimingSnapshot(snapshot, map) ? snapshot.clock.getTickPosition() : 0.0;
+    }
+
+    // ::getPositionSamples: position du transport, en samples
+    long long getPositionSamples() const {
+        AdikTimingSnapshot snapshot;
+        std::shared_ptr<const AdikTempoMap> map;
+        return player && player->readTimingSnapshot(snapshot, map) ? snapshot.clock.samplePosition : 0;
+    }
+
+    // ::getPositionSeconds: position du transport, en secondes
+    double getPositionSeconds() const {
+        AdikTimingSnapshot snapshot;
+        std::shared_ptr<const AdikTempoMap> map;
+        return player && player->readTimingSnapshot(snapshot, map) ? snapshot.clock.getSecondsPosition() : 0.0;
+    }
+
     // ::printInfo: pour afficher des infos sur la séquence ou le morceau en cours,
     // le nom, la mesure, le step courant, l'état du player: lecture, en pause, ou arrêté.
     void printInfo() const {
@@ -137,29 +132,39 @@ public:
 
         std::cout << "\n--- État du Transport ---" << std::endl;
 
+        // Position et état publiés par le thread audio (au début, arrêté, avant le premier bloc)
+        AdikTimingSnapshot snapshot{};
+        std::shared_ptr<const AdikTempoMap> map; // Garde la carte de l'horloge copiée pendant la lecture
+        const bool known = player->readTimingSnapshot(snapshot, map);
+        if (!known) snapshot.mode = player->currentMode;
+        const int64_t stepStart = known ? snapshot.clock.sampleForStep(snapshot.clock.nextStep - 1) : 0;
+        const int64_t stepEnd = known ? snapshot.clock.sampleForStep(snapshot.clock.nextStep) : 0;
+        const int64_t sampleInStep = known && snapshot.clock.nextStep > 0 ? snapshot.clock.samplePosition - stepStart : 0;
+
         // État de la lecture
         std::string playState = "Arrêté";
-        if (player->_playing) {
+        if (snapshot.playing) {
             playState = "En Lecture";
-        } else if (player->currentSampleInStep > 0 || player->currentStepInSequence > 0) {
+        } else if (sampleInStep > 0 || snapshot.currentStepInSequence > 0) {
             playState = "En Pause"; // Si n'est pas en lecture mais a déjà joué ou est positionné
         }
         std::cout << "État du Player : " << playState << std::endl;
 
         // Infos sur le tempo
-        std::cout << "Tempo : " << player->tempoBPM << " BPM" << std::endl;
+        std::cout << "Tempo : " << player->getCurrentTempo() << " BPM"
+                  << (player->getPublishedTempoMap() ? " (carte de tempo)" : "") << std::endl;
 
         std::shared_ptr<AdikSequence> currentSeq = nullptr;
         std::string currentItemName = "N/A";
-        int currentAbsoluteStep = player->currentStepInSequence;
+        int currentAbsoluteStep = snapshot.currentStepInSequence;
         int currentMeasure = 0;
         int stepInMeasure = 0;
         int totalSteps = 0;
         int totalMeasures = 0;
 
-        if (player->currentMode == AdikPlayer::SEQUENCE_MODE) {
-            if (player->selectedSequenceInPlayerIndex >= 0 && player->selectedSequenceInPlayerIndex < player->sequenceList.size()) {
-                currentSeq = player->sequenceList[player->selectedSequenceInPlayerIndex];
+        if (snapshot.mode == AdikPlayer::SEQUENCE_MODE) {
+            if (snapshot.selectedSequenceInPlayerIndex >= 0 && snapshot.selectedSequenceInPlayerIndex < static_cast<int>(player->sequenceList.size())) {
+                currentSeq = player->sequenceList[snapshot.selectedSequenceInPlayerIndex];
                 currentItemName = currentSeq->name;
                 totalSteps = currentSeq->lengthInSteps;
                 totalMeasures = currentSeq->numberOfMeasures;
@@ -168,14 +173,15 @@ public:
             }
             std::cout << "Mode : SÉQUENCE" << std::endl;
         } else { // SONG_MODE
-            if (player->currentSong && player->currentSequenceIndexInSong >= 0 && player->currentSequenceIndexInSong < player->currentSong->sequences.size()) {
-                currentSeq = player->currentSong->sequences[player->currentSequenceIndexInSong];
+            if (player->currentSong && snapshot.currentSequenceIndexInSong >= 0 &&
+                snapshot.currentSequenceIndexInSong < static_cast<int>(player->currentSong->sequences.size())) {
+                currentSeq = player->currentSong->sequences[snapshot.currentSequenceIndexInSong];
                 currentItemName = player->currentSong->name + " (Séquence courante: " + currentSeq->name + ")";
                 totalSteps = player->currentSong->getTotalSteps(); // Total de steps du morceau
                 totalMeasures = player->currentSong->getTotalMeasures(); // Total de mesures du morceau
 
                 // Calculer le pas absolu dans le morceau
-                currentAbsoluteStep = player->currentSong->getAbsoluteStep(player->currentSequenceIndexInSong, player->currentStepInSequence);
+                currentAbsoluteStep = player->currentSong->getAbsoluteStep(snapshot.currentSequenceIndexInSong, snapshot.currentStepInSequence);
                 
                 // Calculer la mesure et le pas dans cette mesure pour le morceau entier
                 // C'est un peu plus complexe car chaque séquence peut avoir un nombre de steps/mesure différent,
@@ -196,8 +202,13 @@ public:
         // Afficher la progression dans le step actuel
         std::cout << "Progression dans le pas : "
                   << std::fixed << std::setprecision(2)
-                  << (static_cast<float>(player->currentSampleInStep) / player->samplesPerStep) * 100.0f
+                  << (stepEnd > stepStart ? static_cast<float>(sampleInStep) / (stepEnd - stepStart) * 100.0f : 0.0f)
                   << "%" << std::endl;
+        std::cout << "Position : " << (known ? snapshot.clock.getTickPosition() : 0.0) << " ticks, "
+                  << (known ? snapshot.clock.samplePosition : 0) << " samples, "
+                  << std::setprecision(3) << (known ? snapshot.clock.getSecondsPosition() : 0.0) << " s" << std::endl;
+        std::cout << "Xruns : " << player->xrunMonitor.getUnderflowCount() << " sortie, "
+                  << player->xrunMonitor.getOverflowCount() << " entrée" << std::endl;
         std::cout << "-------------------------" << std::endl;
     }
 };
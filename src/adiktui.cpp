@@ -3,144 +3,457 @@
 #include "audioinfo.h"
 #include "audioengine.h"
 #include "adiktransport.h" // Inclure la nouvelle classe AdikTransport
+#include "adikscheduler.h"
 
 #include <iostream>
 #include <chrono>
 #include <thread>
 #include <vector>
+#include <mutex>
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <clocale>
+
+namespace {
+
+const int DEFAULT_TUI_FPS = 30;
+const int MENU_ROWS = 10;            // Lignes 0 à 9 : menu (statique)
+const int INSTRUMENT_COLUMN = 50;    // Liste des instruments, à droite du menu
+const int TRANSPORT_ROW = 11;
+const int METERS_ROW = 12;           // 2 lignes de canaux + 1 ligne de sortie
+const int GRID_ROW = 16;
+const int GRID_NAME_WIDTH = 10;
+const int GRID_REFRESH_FRAMES = 15;  // Relecture de la grille (éditions) toutes les 15 trames
+const int METER_WIDTH = 10;
+const float METER_FLOOR_DB = -48.0f;
+
+// Longueur du vumètre pour une crête linéaire
+int meterLength(float peak) {
+    if (peak <= 0.0f) return 0;
+    float db = 20.0f * std::log10(peak);
+    float fraction = (db - METER_FLOOR_DB) / -METER_FLOOR_DB;
+    fraction = std::max(0.0f, std::min(1.0f, fraction));
+    return static_cast<int>(fraction * METER_WIDTH + 0.5f);
+}
+
+// Forme d'onde miniature d'un son, lue dans son cache de crêtes (sans parcourir les samples)
+std::string waveformThumbnail(const AdikInstrument& instrument) {
+    const int WAVEFORM_WIDTH = 8;
+    const char shades[] = " .:-=#";
+    float minima[WAVEFORM_WIDTH];
+    float maxima[WAVEFORM_WIDTH];
+    const AdikPeakCache& cache = instrument.analysis.peakCache;
+    cache.query(0, cache.getNumFrames(), WAVEFORM_WIDTH, minima, maxima);
+    std::string thumbnail = "[";
+    for (int c = 0; c < WAVEFORM_WIDTH; ++c) {
+        const float peak = std::max(std::fabs(minima[c]), maxima[c]);
+        const int length = meterLength(peak); // 0 à METER_WIDTH, échelle en dB des vumètres
+        thumbnail += shades[(length * 5 + METER_WIDTH - 1) / METER_WIDTH];
+    }
+    return thumbnail + "]";
+}
+
+} // namespace
 
 // Constructor
-AdikTUI::AdikTUI(std::shared_ptr<AdikPlayer> player) : gPlayer(player) {
+AdikTUI::AdikTUI(std::shared_ptr<AdikPlayer> player)
+    : gPlayer(player), frameIntervalMs(1000 / DEFAULT_TUI_FPS), cacheRows(0), cacheCols(0),
+      gridStepsPerMeasure(0), gridSequenceIndex(-1), gridMode(-1), framesSinceGridRefresh(0),
+      hasSnapshot(false), lastMeterBlock(0), lastMeterTime(std::chrono::steady_clock::now()),
+      savedCoutBuffer(nullptr), savedCerrBuffer(nullptr) {
+    if (const char* env = std::getenv("ADIK_TUI_FPS")) {
+        int fps = std::atoi(env);
+        if (fps > 0 && fps <= 120) frameIntervalMs = 1000 / fps;
+    }
+
+    logFile.open("adiktui.log", std::ios::out | std::ios::trunc);
+    if (logFile) {
+        savedCoutBuffer = std::cout.rdbuf(logFile.rdbuf());
+        savedCerrBuffer = std::cerr.rdbuf(logFile.rdbuf());
+    }
+
     // Initialize ncurses
+    setlocale(LC_ALL, "");  // Caractères accentués du menu
     initscr();              // Initialize the screen structure
     cbreak();               // Read characters one by one, without waiting for Enter
     noecho();               // Don't display typed characters
     keypad(stdscr, TRUE);   // Enable reading of special keys (arrows, F-keys)
+    curs_set(0);            // Pas de curseur clignotant au milieu de la grille
 }
 
 // Destructor
 AdikTUI::~AdikTUI() {
     // Clean up ncurses
     endwin(); // Restore the terminal to its original state
+    if (savedCoutBuffer) std::cout.rdbuf(savedCoutBuffer);
+    if (savedCerrBuffer) std::cerr.rdbuf(savedCerrBuffer);
     std::cout << "Application terminée. Au revoir !" << std::endl;
 }
 
+// --- Écriture incrémentale ---
+
+// Vide la copie de l'écran : tout sera réécrit à la prochaine trame (démarrage, redimensionnement)
+void AdikTUI::resetScreenCache() {
+    cacheRows = LINES;
+    cacheCols = COLS;
+    screenCache.assign(static_cast<size_t>(cacheRows) * cacheCols, static_cast<chtype>(0));
+    hasSnapshot = false;
+    clear();
+    printMenu();
+}
+
+// Écrit une cellule seulement si elle a changé
+void AdikTUI::putCell(int row, int col, chtype cell) {
+    if (row < 0 || row >= cacheRows || col < 0 || col >= cacheCols) return;
+    chtype& cached = screenCache[static_cast<size_t>(row) * cacheCols + col];
+    if (cached == cell) return;
+    cached = cell;
+    mvaddch(row, col, cell);
+}
+
+// Écrit un texte ASCII, complété par des espaces jusqu'à 'width' (si width >= 0)
+void AdikTUI::putText(int row, int col, const std::string& text, int width, attr_t attr) {
+    int length = width >= 0 ? width : static_cast<int>(text.size());
+    for (int i = 0; i < length; ++i) {
+        unsigned char c = i < static_cast<int>(text.size()) ? static_cast<unsigned char>(text[i]) : ' ';
+        putCell(row, col + i, static_cast<chtype>(c) | attr);
+    }
+}
+
 // Helper function to display status messages at the bottom of the screen
+// (affiché à la prochaine trame)
 void AdikTUI::displayStatus(const std::string& msg) {
-    mvprintw(LINES - 1, 0, "%s", msg.c_str());
-    clrtoeol(); // Clear to the end of the line to erase previous messages
-    refresh();  // Refresh the screen to display changes
+    _msgText = msg;
+    if (cacheRows > 0) {
+        // Le message peut contenir des accents : la ligne est réécrite en entier, hors screenCache
+        mvprintw(cacheRows - 1, 0, "%s", msg.c_str());
+        clrtoeol(); // Clear to the end of the line to erase previous messages
+    }
 }
 
 // Helper function to print the main menu
+// Partie statique, dessinée une seule fois (et après un redimensionnement)
 void AdikTUI::printMenu() {
-    clear(); // Clear the screen before printing the menu
-    mvprintw(0, 0, "--- AdikPlayer UI Alpha ---\n");
-    mvprintw(1, 0, "Appuyez sur 'Q' pour quitter.\n");
-    mvprintw(2, 0, "1: Jouer Sine Wave (440Hz)\n");
-    mvprintw(3, 0, "2: Jouer Square Wave (220Hz)\n");
-    mvprintw(4, 0, "3: Jouer Kick\n");
-    mvprintw(5, 0, "4: Jouer Snare\n");
-    mvprintw(6, 0, "d: Afficher status du mixeur\n");
-    mvprintw(7, 0, "s: Toggle Séquenceur Play/Stop\n");
-    mvprintw(8, 0, "p: Avancer dans la Séquence (si en mode STEP)\n");
-    mvprintw(9, 0, "\n--- Appuyez sur une touche ---\n");
+    mvprintw(0, 0, "--- AdikPlayer UI Alpha ---");
+    mvprintw(1, 0, "Appuyez sur 'Q' pour quitter.");
+    mvprintw(2, 0, "1: Jouer Sine Wave (440Hz)");
+    mvprintw(3, 0, "2: Jouer Square Wave (220Hz)");
+    mvprintw(4, 0, "3: Jouer Kick");
+    mvprintw(5, 0, "4: Jouer Snare");
+    mvprintw(6, 0, "d: Afficher status du mixeur");
+    mvprintw(7, 0, "Espace: Séquenceur Play/Pause, v: Pause");
+    mvprintw(8, 0, "p: Démonstration");
+    mvprintw(9, 0, "--- Appuyez sur une touche ---");
 
     // Display instrument list if available
-    if (gPlayer) {
-        for (size_t i = 0; i < gPlayer->instrumentList.size(); i++) {
-            const auto& instru = gPlayer->instrumentList[i];
-            mvprintw(10 + i, 0, "Index %zu: %s (%s)\n", i, instru->id.c_str(), instru->name.c_str());
+    const std::shared_ptr<AdikKit> kit = gPlayer ? gPlayer->getPublishedKit() : nullptr;
+    if (kit) {
+        for (size_t i = 0; i < kit->instruments.size() && i < static_cast<size_t>(MENU_ROWS); i++) {
+            const auto& instru = kit->instruments[i];
+            if (!instru) continue; // Instrument retiré
+            const std::string entry = std::to_string(i) + ": " + waveformThumbnail(*instru) + " " + instru->id + " (" + instru->name + ")";
+            mvaddnstr(static_cast<int>(i), INSTRUMENT_COLUMN, entry.c_str(), std::max(0, COLS - INSTRUMENT_COLUMN));
         }
     }
-    refresh();
+    if (!_msgText.empty()) displayStatus(_msgText);
+}
+
+// --- Commandes vers le thread audio ---
+
+void AdikTUI::postTrigger(int instruIndex, int64_t sampleTime) {
+    AdikControlCommand command = AdikControlCommand();
+    command.type = AdikControlCommand::TRIGGER;
+    command.sampleTime = sampleTime;
+    command.instrument = gPlayer->getInstrumentHandleAt(static_cast<size_t>(instruIndex));
+    command.mixerChannelIndex = instruIndex + 1; // Comme AdikPlayer::playInstrument
+    command.velocity = 1.0f;
+    if (!gPlayer->postControlCommand(command)) {
+        displayStatus("File de commandes pleine.");
+    }
+}
+
+void AdikTUI::postTransport(uint32_t type) {
+    AdikControlCommand command = AdikControlCommand();
+    command.type = type;
+    command.sampleTime = AdikControlCommand::IMMEDIATE;
+    if (!gPlayer->postControlCommand(command)) {
+        displayStatus("File de commandes pleine.");
+    }
 }
 
 // Demo function (moved to AdikTUI as it's triggered by TUI)
+// Le second instrument est planifié 2 secondes plus tard sur le flux audio, sans bloquer l'affichage.
 void AdikTUI::demo1() {
     if (!gPlayer) return;
 
-    // Play the first instrument (Synth Sine, index 0)
-    gPlayer->playInstrument(5);
-    displayStatus("Playing instrument 5...");
-    std::this_thread::sleep_for(std::chrono::seconds(2)); // Requires <chrono> and <thread>
+    postTrigger(5);
+    const int64_t later = gPlayer->streamSamplePosition.load(std::memory_order_relaxed)
+                        + 2 * static_cast<int64_t>(gPlayer->sampleRate);
+    postTrigger(6, later);
+}
+
+// --- Trame ---
+
+// Relit les pas de la séquence affichée. Hors du thread audio : le verrou n'est partagé
+// qu'avec le planificateur et les éditions.
+void AdikTUI::refreshGrid(const AdikDisplaySnapshot& snapshot) {
+    std::lock_guard<std::mutex> lock(gPlayer->sequenceEditMutex);
+    std::shared_ptr<AdikSequence> sequence;
+    if (snapshot.mode == AdikPlayer::SONG_MODE) {
+        if (gPlayer->currentSong && snapshot.sequenceIndex >= 0 &&
+            snapshot.sequenceIndex < static_cast<int>(gPlayer->currentSong->sequences.size())) {
+            sequence = gPlayer->currentSong->sequences[snapshot.sequenceIndex];
+        }
+    } else if (snapshot.sequenceIndex >= 0 && snapshot.sequenceIndex < static_cast<int>(gPlayer->sequenceList.size())) {
+        sequence = gPlayer->sequenceList[snapshot.sequenceIndex];
+    }
 
-    // Play the second instrument (Synth Square, index 1)
-    gPlayer->playInstrument(6);
-    displayStatus("Playing instrument 6...");
+    gridSequenceIndex = sequence ? snapshot.sequenceIndex : -1;
+    gridMode = snapshot.mode;
+    framesSinceGridRefresh = 0;
+    if (!sequence) {
+        gridTracks.clear();
+        gridSequenceName.clear();
+        return;
+    }
+
+    gridSequenceName = sequence->name;
+    gridStepsPerMeasure = sequence->stepsPerMeasure;
+    gridTracks.resize(sequence->tracks.size());
+    for (size_t t = 0; t < sequence->tracks.size(); ++t) {
+        const AdikTrack& track = sequence->tracks[t];
+        GridTrack& row = gridTracks[t];
+        row.name = track.name;
+        row.cells.assign(static_cast<size_t>(std::max(0, sequence->lengthInSteps)), '.');
+        for (int32_t step : track.events.steps) {
+            if (step >= 0 && step < sequence->lengthInSteps) row.cells[step] = 'x';
+        }
+        if (track.isMuted) {
+            for (char& c : row.cells) if (c == 'x') c = 'm';
+        }
+    }
 }
 
-// Main key handler function
-void AdikTUI::keyHandler() {
-    printMenu(); // Display the initial menu
+void AdikTUI::drawTransport(const AdikDisplaySnapshot& snapshot, int row) {
+    char line[128];
+    const double seconds = gPlayer->sampleRate ? static_cast<double>(snapshot.samplePosition) / gPlayer->sampleRate : 0.0;
+    std::snprintf(line, sizeof(line), "%-5s %-4s  Pas: %3d  Tempo: %6.2f  Temps: %7.2fs  DSP: %5.1f%%  Xruns: %llu  Q: %d",
+                  snapshot.playing ? "PLAY" : "STOP",
+                  snapshot.mode == AdikPlayer::SONG_MODE ? "SONG" : "SEQ",
+                  snapshot.playheadStep + 1, snapshot.tempoBPM, seconds, snapshot.dspLoad * 100.0f,
+                  static_cast<unsigned long long>(snapshot.xrunCount), snapshot.qualityLevel);
+    // Un nouvel xrun est signalé en gras jusqu'à la trame suivante
+    const bool newXrun = hasSnapshot && snapshot.xrunCount != lastSnapshot.xrunCount;
+    putText(row, 0, line, cacheCols, (snapshot.playing || newXrun) ? A_BOLD : A_NORMAL);
+}
 
-    if (gPlayer) {
-        gPlayer->playInstrument(0);
+// Vumètre : RMS en '#', crête (avec retombée) en '=', crête maintenue en '|', '!' en cas de saturation
+void AdikTUI::drawMeter(int row, int col, const AdikMeterBallistics& meter) {
+    const int rmsLength = meterLength(meter.getRms());
+    const int peakLength = meterLength(meter.getPeak());
+    const int heldLength = meterLength(meter.getHeldPeak());
+    putCell(row, col, '[');
+    for (int k = 0; k < METER_WIDTH; ++k) {
+        chtype cell = '-';
+        if (k < rmsLength) cell = '#';
+        else if (k < peakLength) cell = '=';
+        if (heldLength > 0 && k == heldLength - 1 && k >= rmsLength) cell = '|';
+        putCell(row, col + 1 + k, cell);
     }
-    
-    int key;
-    while ((key = getch()) != 'Q') { // Read keys until 'Q' is pressed
-        switch (key) {
-            case 'd':
-                if (gPlayer) {
-                    gPlayer->mixer.displayMixerStatus(); // Display mixer status
-                    _msgText = "Statut du mixeur affiché.";
-                } else {
-                    _msgText = "Erreur: Player non initialisé.";
-                }
-                displayStatus(_msgText);
-                break;
-            case 's':
-                // This is an assumption of the function in AdikPlayer for toggling
-                // gPlayer->togglePlayback(); // If you have such a function
-                beep(); // A simple beep for now
-                _msgText = "Séquenceur: Fonctionnalité non implémentée (toggle Play/Stop).";
-                displayStatus(_msgText);
-                break;
-            case 'p':
-                demo1();
-                _msgText = "Démonstration lancée.";
-                displayStatus(_msgText);
-                break;
-
-            case 'v':
-                gPlayer->stop();
-                _msgText = "Séquenceur mis en pause.";
-                displayStatus(_msgText);
-                break;
-
-            case ' ': // Nouvelle case pour la barre d'espace
-                if (gPlayer) {
-                    if (gPlayer->isPlaying()) { 
-                        gPlayer->stop();
-                        _msgText = "Séquenceur mis en pause.";
-                    } else {
-                        gPlayer->start();
-                        _msgText = "Séquenceur démarré.";
-                    }
-                } else {
-                    _msgText = "Erreur: Player non initialisé.";
-                }
-                displayStatus(_msgText);
-                break;
-
-            default:
-                // Manage key from '0' to '9'
-                if (key >= '0' && key <= '9') {
-                    int instruIndex = key - '0';
-                    if (gPlayer && instruIndex < gPlayer->instrumentList.size()) {
-                        gPlayer->playInstrument(instruIndex);
-                        _msgText = "Jouer l'instrument " + std::to_string(instruIndex) + ".";
-                    } else {
-                        _msgText = "Index d'instrument invalide ou player non initialisé.";
-                    }
+    putCell(row, col + 1 + METER_WIDTH, meter.isClipping() ? ('!' | A_BOLD) : static_cast<chtype>(']'));
+}
+
+// Activité et niveau de chaque canal (4 par ligne), puis maître et sorties.
+// Les mesures viennent du mixeur (AdikMixer::meterSnapshot) ; maintien et retombée sont calculés ici.
+void AdikTUI::drawMeters(const AdikDisplaySnapshot& snapshot, int row) {
+    AdikMeterSnapshot meters;
+    const bool hasMeters = gPlayer->mixer.meterSnapshot.read(meters);
+    const auto now = std::chrono::steady_clock::now();
+    const float elapsed = std::chrono::duration<float>(now - lastMeterTime).count();
+    lastMeterTime = now;
+    // Flux arrêté : plus de nouveau bloc, les vumètres retombent sur le silence
+    const bool fresh = hasMeters && meters.block != lastMeterBlock;
+    if (hasMeters) lastMeterBlock = meters.block;
+    const AdikMeterLevel silence = AdikMeterLevel();
+    auto levelOf = [&](const AdikMeterLevel& level) {
+        if (fresh) return level;
+        AdikMeterLevel idle = level; // Cumuls inchangés : pas de nouvel intervalle de RMS
+        idle.peak = idle.windowPeak = idle.rms = 0.0f;
+        return idle;
+    };
+
+    const int cellWidth = METER_WIDTH + 6; // "1X[" + barre + "] "
+    for (int i = 0; i < AdikDisplaySnapshot::MAX_CHANNELS; ++i) {
+        const bool exists = hasMeters && i < meters.numChannels;
+        channelMeters[i].update(levelOf(exists ? meters.channels[i] : silence), elapsed);
+        const int r = row + i / 4;
+        const int c = (i % 4) * (cellWidth + 1);
+        putCell(r, c, static_cast<chtype>('1' + i));
+        putCell(r, c + 1, snapshot.channelActive[i] ? ('X' | A_BOLD) : static_cast<chtype>('.'));
+        drawMeter(r, c + 2, channelMeters[i]);
+    }
+
+    // Maître, puis les 3 premières sorties du périphérique
+    masterMeter.update(levelOf(hasMeters ? meters.master : silence), elapsed);
+    putCell(row + 2, 0, 'M');
+    putCell(row + 2, 1, ' ');
+    drawMeter(row + 2, 2, masterMeter);
+    for (int o = 0; o < 3; ++o) {
+        const int c = (o + 1) * (cellWidth + 1);
+        if (!hasMeters || o >= meters.numOutputs) {
+            putText(row + 2, c, "", cellWidth);
+            continue;
+        }
+        outputMeters[o].update(levelOf(meters.outputs[o]), elapsed);
+        putCell(row + 2, c, 'S');
+        putCell(row + 2, c + 1, static_cast<chtype>('1' + o));
+        drawMeter(row + 2, c + 2, outputMeters[o]);
+    }
+}
+
+// Grille de pas : une ligne par piste, séparateur à chaque mesure, tête de lecture en vidéo inverse
+void AdikTUI::drawGrid(const AdikDisplaySnapshot& snapshot, int row) {
+    std::string header = gridSequenceIndex < 0 ? "(aucune sequence)" : "Sequence " + std::to_string(gridSequenceIndex) + ": ";
+    if (gridSequenceIndex >= 0) {
+        // Nom limité à l'ASCII (écriture cellule par cellule)
+        for (char c : gridSequenceName) header += (static_cast<unsigned char>(c) < 0x80) ? c : '?';
+    }
+    putText(row, 0, header, cacheCols);
+
+    const int lastRow = cacheRows - 2; // La dernière ligne est celle des messages
+    for (int r = row + 1; r <= lastRow; ++r) {
+        const size_t t = static_cast<size_t>(r - row - 1);
+        if (t >= gridTracks.size()) {
+            putText(r, 0, "", cacheCols);
+            continue;
+        }
+        const GridTrack& track = gridTracks[t];
+        std::string name = track.name.substr(0, GRID_NAME_WIDTH - 1);
+        for (char& c : name) if (static_cast<unsigned char>(c) >= 0x80) c = '?';
+        putText(r, 0, name, GRID_NAME_WIDTH);
+
+        int col = GRID_NAME_WIDTH;
+        for (size_t step = 0; step < track.cells.size() && col < cacheCols; ++step) {
+            if (gridStepsPerMeasure > 0 && step % gridStepsPerMeasure == 0) putCell(r, col++, '|');
+            const bool isPlayhead = static_cast<int>(step) == snapshot.playheadStep;
+            putCell(r, col++, static_cast<chtype>(track.cells[step]) | (isPlayhead ? A_REVERSE : A_NORMAL));
+        }
+        if (col < cacheCols) putCell(r, col++, '|');
+        while (col < cacheCols) putCell(r, col++, ' ');
+    }
+}
+
+void AdikTUI::renderFrame() {
+    if (LINES != cacheRows || COLS != cacheCols) resetScreenCache();
+
+    AdikDisplaySnapshot snapshot;
+    if (!gPlayer->displaySnapshot.read(snapshot)) return; // Aucun bloc audio encore traité
+
+    ++framesSinceGridRefresh;
+    if (!hasSnapshot || snapshot.sequenceIndex != gridSequenceIndex || snapshot.mode != gridMode ||
+        framesSinceGridRefresh >= GRID_REFRESH_FRAMES) {
+        refreshGrid(snapshot);
+    }
+
+    drawTransport(snapshot, TRANSPORT_ROW);
+    drawMeters(snapshot, METERS_ROW);
+    drawGrid(snapshot, GRID_ROW);
+
+    // Changements de qualité : vers le journal (std::cout est redirigé)
+    gPlayer->qualityController.printNewTransitions(gPlayer->sampleRate);
+
+    lastSnapshot = snapshot;
+    hasSnapshot = true;
+    refresh(); // ncurses n'envoie au terminal que les cellules modifiées
+}
+
+// --- Clavier ---
+
+bool AdikTUI::handleKey(int key) {
+    switch (key) {
+        case 'Q':
+            return false;
+        case KEY_RESIZE:
+            resetScreenCache();
+            break;
+        case 'd': {
+            std::string status = "Mixeur: [";
+            for (int i = 0; i < lastSnapshot.numChannels; ++i) {
+                status += lastSnapshot.channelActive[i] ? "X" : ".";
+            }
+            displayStatus(status + "]");
+            break;
+        }
+        case 's':
+            beep(); // A simple beep for now
+            displayStatus("Utilisez Espace pour Play/Pause.");
+            break;
+        case 'p':
+            demo1();
+            displayStatus("Démonstration lancée.");
+            break;
+
+        case 'v':
+            postTransport(AdikControlCommand::PAUSE);
+            displayStatus("Séquenceur mis en pause.");
+            break;
+
+        case ' ': // Nouvelle case pour la barre d'espace
+            // L'état de lecture vient de l'instantané : pas de lecture concurrente de AdikPlayer
+            if (hasSnapshot && lastSnapshot.playing) {
+                postTransport(AdikControlCommand::PAUSE);
+                displayStatus("Séquenceur mis en pause.");
+            } else {
+                postTransport(AdikControlCommand::PLAY);
+                displayStatus("Séquenceur démarré.");
+            }
+            break;
+
+        default:
+            // Manage key from '0' to '9'
+            if (key >= '0' && key <= '9') {
+                int instruIndex = key - '0';
+                const std::shared_ptr<AdikKit> kit = gPlayer->getPublishedKit();
+                if (kit && instruIndex < static_cast<int>(kit->instruments.size()) && kit->instruments[instruIndex]) {
+                    postTrigger(instruIndex);
+                    displayStatus("Jouer l'instrument " + std::to_string(instruIndex) + ".");
                 } else {
-                    _msgText = "Touche '" + std::string(1, (char)key) + "' (" + std::to_string(key) + ") non reconnue. Appuyez sur 'Q' pour quitter.";
+                    displayStatus("Index d'instrument invalide.");
                 }
-                displayStatus(_msgText);
-                break;
+            } else {
+                displayStatus("Touche '" + std::string(1, (char)key) + "' (" + std::to_string(key) + ") non reconnue. Appuyez sur 'Q' pour quitter.");
+            }
+            break;
+    }
+    return true;
+}
+
+// Main key handler function
+// Boucle à cadence fixe : getch() attend au plus jusqu'à la prochaine trame,
+// les touches sont traitées dès leur arrivée mais l'écran n'est redessiné qu'une fois par trame.
+void AdikTUI::keyHandler() {
+    if (!gPlayer) return;
+    resetScreenCache();
+    postTrigger(0);
+
+    using Clock = std::chrono::steady_clock;
+    const Clock::duration frameInterval = std::chrono::milliseconds(frameIntervalMs);
+    Clock::time_point nextFrame = Clock::now();
+    bool running = true;
+    while (running) {
+        Clock::time_point now = Clock::now();
+        if (now >= nextFrame) {
+            renderFrame();
+            nextFrame += frameInterval;
+            if (nextFrame <= now) nextFrame = now + frameInterval; // Retard (terminal lent) : pas de rattrapage
         }
-        printMenu(); // Redraw menu after each action
+
+        const auto wait = std::chrono::duration_cast<std::chrono::milliseconds>(nextFrame - Clock::now()).count();
+        timeout(static_cast<int>(std::max<long long>(0, wait)));
+        int key = getch();
+        if (key != ERR) running = handleKey(key);
     }
 }
 
@@ -157,6 +470,10 @@ int main() {
 
     // 2. Créer une instance de AdikPlayer
     gPlayer->initParams(globalAudioInfo); // Initialiser AdikPlayer avec AudioInfo
+    // Sons par défaut : combien ont été relus depuis le cache disque
+    if (AdikSoundCache* soundCache = AdikSoundCache::getDefault()) {
+        soundCache->printReport();
+    }
 
     // 3. Créer une instance du moteur audio
     AudioEngine audioEngine;
@@ -173,11 +490,19 @@ int main() {
     if (audioEngine.start()) { // start() no longer needs parameters, they are stored in audioEngine.audioSetup
         std::cout << "Lecture en cours... (Appuyez sur Entrée pour arrêter)" << std::endl;
 
-        // 5. Instancier la classe AdikTUI et lancer l'interface Text et la gestion des touches
-        AdikTUI adikTUI(gPlayer);
-        adikTUI.keyHandler();
+        // 5. Planifier les événements à l'avance, hors du thread audio
+        AdikScheduler scheduler(gPlayer, 100.0);
+        scheduler.start();
+
+        // 6. Instancier la classe AdikTUI et lancer l'interface Text et la gestion des touches
+        {
+            AdikTUI adikTUI(gPlayer);
+            adikTUI.keyHandler();
+        } // Terminal restauré : le bilan ci-dessous s'affiche normalement
 
         gPlayer->stop();
+        scheduler.stop();
+        audioEngine.printInfo(); // Charge DSP et xruns de la session
         audioEngine.stop();
         audioEngine.close();
     } else {
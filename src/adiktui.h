@@ -5,7 +5,21 @@
 #include <ncurses.h>
 #include <string>
 #include <memory>
+#include <vector>
+#include <fstream>
+#include <iostream>
+#include <chrono>
 
+// --- AdikTUI ---
+// Interface texte (ncurses) : menu, grille de pas de la séquence jouée, tête de lecture,
+// activité et crêtes des canaux du mixeur.
+// L'affichage est redessiné à cadence fixe (ADIK_TUI_FPS, 30 par défaut) à partir de
+// AdikPlayer::displaySnapshot, publié par le thread audio : l'interface ne lit jamais
+// l'état du thread audio directement et ne prend aucun verrou qu'il pourrait attendre.
+// Seules les cellules modifiées depuis la trame précédente sont réécrites (copie de l'écran
+// dans screenCache), ce qui garde le débit très faible, même à travers SSH.
+// Les commandes (déclenchements, transport) passent par AdikPlayer::controlQueue ;
+// l'interface en est alors l'unique producteur.
 class AdikTUI {
 public:
     // Constructor
@@ -18,13 +32,60 @@ public:
     void keyHandler();
 
 private:
+    // Grille de pas d'une séquence, relue périodiquement sous AdikPlayer::sequenceEditMutex
+    struct GridTrack {
+        std::string name;
+        std::string cells; // Un caractère par pas : 'x' (événement) ou '.'
+    };
+
     std::shared_ptr<AdikPlayer> gPlayer;
     std::string _msgText;
 
+    int frameIntervalMs;                  // Intervalle entre deux trames
+    std::vector<chtype> screenCache;      // Dernier contenu écrit, cellule par cellule
+    int cacheRows, cacheCols;
+
+    std::vector<GridTrack> gridTracks;
+    std::string gridSequenceName;
+    int gridStepsPerMeasure;
+    int gridSequenceIndex;                // Séquence affichée (-1 : aucune)
+    int gridMode;
+    int framesSinceGridRefresh;
+
+    AdikDisplaySnapshot lastSnapshot;
+    bool hasSnapshot;
+    // Maintien de crête et retombée des vumètres (canaux, 3 premières sorties, maître)
+    AdikMeterBallistics channelMeters[AdikMeterSnapshot::MAX_CHANNELS];
+    AdikMeterBallistics outputMeters[3];
+    AdikMeterBallistics masterMeter;
+    uint64_t lastMeterBlock;
+    std::chrono::steady_clock::time_point lastMeterTime;
+
+    // Les messages std::cout/std::cerr (thread audio compris) iraient écrire au milieu de l'écran :
+    // ils sont redirigés vers un journal tant que l'interface est active.
+    std::ofstream logFile;
+    std::streambuf* savedCoutBuffer;
+    std::streambuf* savedCerrBuffer;
+
     // Private helper functions for UI display
     void displayStatus(const std::string& msg);
     void printMenu();
     void demo1(); // If demo1 specifically relates to TUI actions
+
+    bool handleKey(int key);             // Renvoie false pour quitter
+    void postTrigger(int instruIndex, int64_t sampleTime = AdikControlCommand::IMMEDIATE);
+    void postTransport(uint32_t type);
+
+    void resetScreenCache();
+    void putCell(int row, int col, chtype cell);
+    void putText(int row, int col, const std::string& text, int width = -1, attr_t attr = A_NORMAL);
+
+    void refreshGrid(const AdikDisplaySnapshot& snapshot);
+    void renderFrame();
+    void drawTransport(const AdikDisplaySnapshot& snapshot, int row);
+    void drawGrid(const AdikDisplaySnapshot& snapshot, int row);
+    void drawMeters(const AdikDisplaySnapshot& snapshot, int row);
+    void drawMeter(int row, int col, const AdikMeterBallistics& meter);
 };
 
 #endif // ADIKTUI_H
@@ -0,0 +1,125 @@
+#ifndef ADIKVOICERENDERER_H
+#define ADIKVOICERENDERER_H
+
+#include <memory>
+#include <vector>
+#include <functional>
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+
+#include "audioinfo.h"
+#include "adikplayer.h"   // Pour AdikPlayer::forEachAudibleEvent
+#include "adikmixer.h"
+#include "adikkit.h"
+#include "adiktempomap.h"
+#include "adikrealtime.h"
+
+// --- AdikVoiceRenderer ---
+// Rendu hors ligne d'un enchaînement de séquences avec un mixeur privé : mêmes voix (une par canal) et mêmes
+// gains que le mixeur du player, chaque pas déclenché au sample près. Aucun état n'est partagé avec le player
+// ni avec un autre rendu : plusieurs rendus peuvent tourner en parallèle (AdikStemExporter).
+// Les séquences, le kit et la carte de tempo sont des copies, qui ne doivent pas changer pendant le rendu.
+// Sortie stéréo entrelacée (somme des canaux, sans le routage des bus du player).
+class AdikVoiceRenderer {
+public:
+    // Pistes rendues : filter(index de la piste dans sa séquence, piste) ; toutes si vide. Solo et mute restent appliqués.
+    typedef std::function<bool(size_t, const AdikTrack&)> TrackFilter;
+
+    static const unsigned int BLOCK_FRAMES = 512;
+
+    // 'passes' : séquences jouées l'une après l'autre, une fois chacune (non possédées).
+    // 'tempoMap' : carte compilée (pas absolus), ou nullptr pour un tempo fixe de 'samplesPerStep'.
+    AdikVoiceRenderer(const std::vector<const AdikSequence*>& passes, std::shared_ptr<AdikKit> kit, unsigned int sampleRate,
+                      double samplesPerStep, std::shared_ptr<const AdikTempoMap> tempoMap = nullptr,
+                      TrackFilter filter = TrackFilter())
+        : passes(passes), kit(kit), tempoMap(tempoMap), samplesPerStep(samplesPerStep), filter(filter),
+          totalSteps(0), position(0), nextStep(0), passIndex(0), stepInPass(0),
+          block(static_cast<size_t>(BLOCK_FRAMES) * 2, 0.0f) {
+        for (const AdikSequence* sequence : passes) {
+            if (sequence && sequence->lengthInSteps > 0) totalSteps += sequence->lengthInSteps;
+        }
+        mixer.initParams(AudioInfo(sampleRate, 2, 32, BLOCK_FRAMES));
+    }
+
+    int64_t getTotalSteps() const { return totalSteps; }
+
+    // Premier sample du pas absolu 'step'
+    int64_t sampleForStep(int64_t step) const {
+        if (tempoMap) return tempoMap->sampleForStep(step);
+        return static_cast<int64_t>(std::ceil(step * samplesPerStep));
+    }
+
+    // Durée de l'enchaînement, sans la fin des derniers sons
+    int64_t getTotalFrames() const { return sampleForStep(totalSteps); }
+
+    // Vrai tant qu'une voix du mixeur privé joue (fin des sons après le dernier pas)
+    bool hasActiveVoices() const {
+        for (const auto& channel : mixer.channelList) {
+            if (channel.isActive) return true;
+        }
+        return false;
+    }
+
+    // Rend les 'numFrames' frames suivantes (le rendu continue après le dernier pas : fin des sons).
+    // sink(const float* stéréo entrelacé, unsigned int frames) reçoit chaque bloc. Renvoie le nombre de frames rendues.
+    template <typename Sink>
+    int64_t render(int64_t numFrames, Sink sink) {
+        AdikRealtime::flushDenormals(); // Mêmes calculs que sur le thread audio
+        const int64_t end = position + numFrames;
+        while (position < end) {
+            while (nextStep < totalSteps && sampleForStep(nextStep) <= position) {
+                triggerStep();
+            }
+            // Bloc coupé au pas suivant : chaque pas démarre au début d'un bloc
+            int64_t blockEnd = std::min<int64_t>(position + BLOCK_FRAMES, end);
+            if (nextStep < totalSteps) blockEnd = std::min(blockEnd, sampleForStep(nextStep));
+            const unsigned int frames = static_cast<unsigned int>(blockEnd - position);
+            mixer.mixChannels(block.data(), frames, 2);
+            sink(static_cast<const float*>(block.data()), frames);
+            position = blockEnd;
+        }
+        return numFrames;
+    }
+
+private:
+    std::vector<const AdikSequence*> passes;
+    std::shared_ptr<AdikKit> kit;
+    std::shared_ptr<const AdikTempoMap> tempoMap;
+    double samplesPerStep;
+    TrackFilter filter;
+    int64_t totalSteps;
+    AdikMixer mixer;
+
+    // Position du rendu
+    int64_t position;   // Prochaine frame à rendre
+    int64_t nextStep;   // Prochain pas absolu à déclencher
+    size_t passIndex;   // Séquence de ce pas dans 'passes'
+    int stepInPass;
+    std::vector<float> block;
+
+    void triggerStep() {
+        while (passIndex < passes.size() && (!passes[passIndex] || stepInPass >= passes[passIndex]->lengthInSteps)) {
+            passIndex++;
+            stepInPass = 0;
+        }
+        if (passIndex >= passes.size()) {
+            nextStep = totalSteps;
+            return;
+        }
+        const AdikSequence& sequence = *passes[passIndex];
+        const AdikTrack* first = sequence.tracks.empty() ? nullptr : &sequence.tracks[0];
+        AdikPlayer::forEachAudibleEvent(sequence, stepInPass, 0,
+                                        [&](const AdikTrack& track, const AdikEvent& event, float finalVelocity) {
+            if (filter && !filter(static_cast<size_t>(&track - first), track)) return;
+            std::shared_ptr<AdikInstrument> instrument = kit ? kit->get(event.instrument) : nullptr;
+            if (instrument) {
+                mixer.routeSound(track.mixerChannelIndex, instrument, finalVelocity, event.getPan(), event.getPitch());
+            }
+        });
+        stepInPass++;
+        nextStep++;
+    }
+};
+
+#endif // ADIKVOICERENDERER_H
@@ -0,0 +1,21 @@
+#ifndef ADIKVOICETRIGGER_H
+#define ADIKVOICETRIGGER_H
+
+#include <cstdint>
+
+#include "adikevent.h" // Pour AdikInstrumentHandle
+
+// Déclenchement de voix horodaté, produit à l'avance par AdikScheduler
+// et consommé par le thread audio quand son instant tombe dans le bloc courant.
+// Tout est déjà résolu : solo/mute, vélocité * volume de piste, canal du mixeur.
+struct AdikVoiceTrigger {
+    int64_t sampleTime;                 // Instant du déclenchement, en samples du transport
+    uint32_t generation;                // Génération de planification (voir AdikPlayer::scheduleGeneration)
+    AdikInstrumentHandle instrument;    // Instrument à jouer
+    int mixerChannelIndex;              // Canal du mixeur (1-based)
+    float velocity;                     // Vélocité finale (événement * piste)
+    float pan;
+    float pitch;
+};
+
+#endif // ADIKVOICETRIGGER_H
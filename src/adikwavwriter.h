@@ -0,0 +1,140 @@
+#ifndef ADIKWAVWRITER_H
+#define ADIKWAVWRITER_H
+
+#include <cstdio>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <iostream>
+
+#include "adikformatconverter.h"
+
+// --- AdikWavWriter ---
+// Écriture d'un fichier WAV (PCM 16 ou 24 bits, ou float 32 bits) à partir de frames float entrelacées.
+// La conversion passe par AdikFormatConverter, comme la sortie carte son : même arrondi, même dither.
+// Les tailles de l'en-tête sont complétées à close().
+class AdikWavWriter {
+public:
+    AdikWavWriter() : file(nullptr), sampleRate(0), dataBytes(0) {}
+    ~AdikWavWriter() { close(); }
+
+    AdikWavWriter(const AdikWavWriter&) = delete;
+    AdikWavWriter& operator=(const AdikWavWriter&) = delete;
+
+    bool open(const std::string& path, unsigned int rate, unsigned int numChannels, AdikSampleFormat format,
+              AdikFormatConverter::Dither dither = AdikFormatConverter::DITHER_TPDF) {
+        close();
+        file = std::fopen(path.c_str(), "wb");
+        if (!file) {
+            std::cerr << "AdikWavWriter: Impossible de créer '" << path << "'." << std::endl;
+            return false;
+        }
+        filePath = path;
+        sampleRate = rate;
+        dataBytes = 0;
+        converter.configure(format, numChannels, format == AdikSampleFormat::FLOAT32 ? AdikFormatConverter::DITHER_NONE : dither);
+        if (!writeHeader()) {
+            close();
+            return false;
+        }
+        return true;
+    }
+
+    // Ajoute 'numFrames' frames entrelacées
+    bool write(const float* interleaved, size_t numFrames) {
+        if (!file) return false;
+        const unsigned int channels = converter.getNumChannels();
+        const size_t sampleBytes = AdikFormatConverter::bytesPerSample(converter.getFormat());
+        converted.resize(numFrames * channels * sampleBytes);
+        converter.convert(interleaved, converted.data(), numFrames);
+
+        size_t bytes = converted.size();
+        if (converter.getFormat() == AdikSampleFormat::INT24) {
+            // Conteneur 32 bits cadré à gauche -> 3 octets par sample (petit-boutiste)
+            const size_t count = numFrames * channels;
+            for (size_t i = 0; i < count; ++i) {
+                std::memmove(&converted[i * 3], &converted[i * 4 + 1], 3);
+            }
+            bytes = count * 3;
+        }
+        if (std::fwrite(converted.data(), 1, bytes, file) != bytes) {
+            std::cerr << "AdikWavWriter: Erreur d'écriture dans '" << filePath << "'." << std::endl;
+            return false;
+        }
+        dataBytes += bytes;
+        return true;
+    }
+
+    // Complète l'en-tête et ferme le fichier
+    bool close() {
+        if (!file) return true;
+        bool ok = true;
+        if (dataBytes % 2) { // Les blocs RIFF sont alignés sur 2 octets
+            ok = std::fputc(0, file) != EOF;
+        }
+        ok = ok && std::fseek(file, 0, SEEK_SET) == 0 && writeHeader();
+        ok = (std::fclose(file) == 0) && ok;
+        file = nullptr;
+        if (!ok) {
+            std::cerr << "AdikWavWriter: Fichier '" << filePath << "' incomplet." << std::endl;
+        }
+        return ok;
+    }
+
+    bool isOpen() const { return file != nullptr; }
+    uint64_t getDataBytes() const { return dataBytes; }
+
+private:
+    std::FILE* file;
+    std::string filePath;
+    unsigned int sampleRate;
+    uint64_t dataBytes;
+    AdikFormatConverter converter;
+    std::vector<unsigned char> converted;
+
+    static void put16(std::vector<unsigned char>& out, uint16_t value) {
+        out.push_back(value & 0xFF);
+        out.push_back(value >> 8);
+    }
+
+    static void put32(std::vector<unsigned char>& out, uint32_t value) {
+        for (int i = 0; i < 4; ++i) out.push_back((value >> (8 * i)) & 0xFF);
+    }
+
+    // En-tête RIFF/WAVE : "fmt " (PCM = 1, float IEEE = 3, avec bloc "fact"), puis "data"
+    bool writeHeader() {
+        const AdikSampleFormat format = converter.getFormat();
+        const bool isFloat = format == AdikSampleFormat::FLOAT32;
+        const uint16_t channels = static_cast<uint16_t>(converter.getNumChannels());
+        const uint16_t bitsPerSample = format == AdikSampleFormat::INT16 ? 16 : (format == AdikSampleFormat::INT24 ? 24 : 32);
+        const uint16_t blockAlign = channels * (bitsPerSample / 8);
+        const uint32_t data = static_cast<uint32_t>(dataBytes);
+        const uint32_t fmtSize = isFloat ? 18 : 16;
+        const uint32_t factSize = isFloat ? 12 : 0;
+        const uint32_t riffSize = 4 + (8 + fmtSize) + factSize + (8 + data + (data % 2));
+
+        std::vector<unsigned char> header;
+        header.insert(header.end(), { 'R', 'I', 'F', 'F' });
+        put32(header, riffSize);
+        header.insert(header.end(), { 'W', 'A', 'V', 'E', 'f', 'm', 't', ' ' });
+        put32(header, fmtSize);
+        put16(header, isFloat ? 3 : 1);
+        put16(header, channels);
+        put32(header, sampleRate);
+        put32(header, sampleRate * blockAlign);
+        put16(header, blockAlign);
+        put16(header, bitsPerSample);
+        if (isFloat) {
+            put16(header, 0); // cbSize
+            header.insert(header.end(), { 'f', 'a', 'c', 't' });
+            put32(header, 4);
+            put32(header, blockAlign ? data / blockAlign : 0);
+        }
+        header.insert(header.end(), { 'd', 'a', 't', 'a' });
+        put32(header, data);
+        return std::fwrite(header.data(), 1, header.size(), file) == header.size();
+    }
+};
+
+#endif // ADIKWAVWRITER_H
@@ -0,0 +1,107 @@
+#ifndef ADIKXRUNMONITOR_H
+#define ADIKXRUNMONITOR_H
+
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <vector>
+#include <iostream>
+
+#include "adikseqlock.h"
+
+// Incident de flux (xrun) signalé par le driver audio, avec le contexte du callback qui l'a reçu
+struct AdikXrunIncident {
+    enum Flags : uint32_t {
+        UNDERFLOW = 1, // Sortie : le périphérique a manqué de données
+        OVERFLOW = 2   // Entrée : des données du périphérique ont été perdues
+    };
+
+    uint32_t flags;
+    int64_t streamFrame;    // Position du flux (frames) au début du callback qui a reçu l'incident
+    uint64_t block;         // Numéro du bloc audio
+    float dspLoad;          // Charge DSP de ce callback
+    float previousDspLoad;  // Charge DSP du callback précédent (celui qui a pu arriver en retard)
+    int activeVoices;       // Canaux du mixeur actifs pendant ce callback
+};
+
+// --- AdikXrunMonitor ---
+// Comptage des xruns (compteurs atomiques) et historique des derniers incidents.
+// record() est appelé par le thread audio : ni verrou, ni allocation, ni affichage.
+// L'historique est un anneau de HISTORY_SIZE cases publiées chacune par AdikSeqLock :
+// n'importe quel thread peut le relire pendant que le thread audio continue d'écrire.
+//
+// Lecture d'un incident : une charge DSP proche de 1 (ou au-delà) au callback précédent ou courant
+// indique une surcharge de la machine (le rendu n'a pas tenu le temps réel) ; une charge faible
+// indique un incident côté pilote ou système (ordonnancement, autre processus, périphérique).
+class AdikXrunMonitor {
+public:
+    static const size_t HISTORY_SIZE = 64;
+    static constexpr float OVERLOAD_THRESHOLD = 0.9f;
+
+    AdikXrunMonitor() : underflows(0), overflows(0), incidents(0) {}
+
+    // Thread audio
+    void record(uint32_t flags, int64_t streamFrame, uint64_t block, float dspLoad, float previousDspLoad, int activeVoices) {
+        if (flags & AdikXrunIncident::UNDERFLOW) underflows.fetch_add(1, std::memory_order_relaxed);
+        if (flags & AdikXrunIncident::OVERFLOW) overflows.fetch_add(1, std::memory_order_relaxed);
+        const uint64_t index = incidents.load(std::memory_order_relaxed);
+        AdikXrunIncident incident;
+        incident.flags = flags;
+        incident.streamFrame = streamFrame;
+        incident.block = block;
+        incident.dspLoad = dspLoad;
+        incident.previousDspLoad = previousDspLoad;
+        incident.activeVoices = activeVoices;
+        history[index % HISTORY_SIZE].write(incident);
+        incidents.store(index + 1, std::memory_order_release);
+    }
+
+    uint64_t getUnderflowCount() const { return underflows.load(std::memory_order_relaxed); }
+    uint64_t getOverflowCount() const { return overflows.load(std::memory_order_relaxed); }
+    uint64_t getIncidentCount() const { return incidents.load(std::memory_order_acquire); }
+
+    // Copie les derniers incidents (au plus maxCount), du plus ancien au plus récent
+    size_t getRecentIncidents(std::vector<AdikXrunIncident>& out, size_t maxCount = HISTORY_SIZE) const {
+        out.clear();
+        const uint64_t count = getIncidentCount();
+        uint64_t available = count < HISTORY_SIZE ? count : HISTORY_SIZE;
+        if (available > maxCount) available = maxCount;
+        for (uint64_t i = count - available; i < count; ++i) {
+            AdikXrunIncident incident;
+            if (history[i % HISTORY_SIZE].read(incident)) {
+                out.push_back(incident);
+            }
+        }
+        return out.size();
+    }
+
+    static bool isOverload(const AdikXrunIncident& incident) {
+        return incident.dspLoad >= OVERLOAD_THRESHOLD || incident.previousDspLoad >= OVERLOAD_THRESHOLD;
+    }
+
+    void printReport(unsigned int sampleRate, size_t maxIncidents = 8) const {
+        std::cout << "Xruns: " << getUnderflowCount() << " sous-alimentation(s), "
+                  << getOverflowCount() << " débordement(s)" << std::endl;
+        std::vector<AdikXrunIncident> recent;
+        getRecentIncidents(recent, maxIncidents);
+        for (const AdikXrunIncident& incident : recent) {
+            char line[160];
+            std::snprintf(line, sizeof(line), "  bloc %llu, frame %lld (%.3f s): %s%s, charge %.0f%% (préc. %.0f%%), %d voix -> %s",
+                          static_cast<unsigned long long>(incident.block), static_cast<long long>(incident.streamFrame),
+                          sampleRate ? static_cast<double>(incident.streamFrame) / sampleRate : 0.0,
+                          (incident.flags & AdikXrunIncident::UNDERFLOW) ? "sortie" : "",
+                          (incident.flags & AdikXrunIncident::OVERFLOW) ? " entrée" : "",
+                          incident.dspLoad * 100.0f, incident.previousDspLoad * 100.0f, incident.activeVoices,
+                          isOverload(incident) ? "surcharge" : "pilote/système");
+            std::cout << line << std::endl;
+        }
+    }
+
+private:
+    std::atomic<uint64_t> underflows;
+    std::atomic<uint64_t> overflows;
+    std::atomic<uint64_t> incidents;
+    AdikSeqLock<AdikXrunIncident> history[HISTORY_SIZE];
+};
+
+#endif // ADIKXRUNMONITOR_H
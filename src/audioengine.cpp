@@ -2,11 +2,77 @@
 #include "adikplayer.h"
 #include <iostream>      // Pour std::cout, std::cerr
 #include <algorithm>     // Pour std::fill
+#include <chrono>        // Pour la mesure de la charge DSP
 
 
+bool AudioEngine::start() {
+    if (!audioDriver) {
+        std::cerr << "AudioEngine: Driver audio non initialisé. Appelez init() d'abord." << std::endl;
+        return false;
+    }
+
+    if (!playerInstance) {
+        std::cerr << "AudioEngine: Instance de AdikPlayer non fournie à init()." << std::endl;
+        return false;
+    }
+
+    // Mémoire : verrouillée puis touchée page par page, avant que le thread audio n'existe.
+    // Le pré-chargement est fait même si mlockall échoue : les pages sont au moins présentes au démarrage.
+    AdikRealtimeReport& report = audioDriver->getRealtimeReport();
+    if (realtimeOptions.lockMemory) {
+        AdikRealtime::lockMemory(report);
+        report.prefaultedBytes = playerInstance->prefaultMemory();
+    }
+    audioDriver->setRealtimeOptions(realtimeOptions);
+
+    std::cout << "AudioEngine: Démarrage du flux audio..." << std::endl;
+    // Appelez la méthode startStream du driver RtAudio, en passant le playerInstance comme userData.
+    // Indiqué au Player avant le premier callback : un projet chargé ensuite est adopté par le thread audio.
+    playerInstance->streamActive.store(true);
+    _running = audioDriver->startStream(audioInfo.sampleRate, audioInfo.bufferSize, audioInfo.numChannels, audioInfo.bitDepth,
+                                        playerInstance.get());
+    playerInstance->streamActive.store(_running);
+    if (_running) {
+        audioDriver->waitThreadSetup(1000);
+        report.print(realtimeOptions);
+    }
+    return _running;
+}
+
+void AudioEngine::notifyStreamStopped() {
+    if (playerInstance) playerInstance->streamActive.store(false);
+}
+
+const AdikXrunMonitor* AudioEngine::getXrunMonitor() const {
+    return playerInstance ? &playerInstance->xrunMonitor : nullptr;
+}
+
+void AudioEngine::printInfo() const {
+    std::cout << "\n--- Moteur audio ---" << std::endl;
+    audioInfo.display();
+    std::cout << "Format de sortie : " << AdikFormatConverter::formatName(getOutputFormat())
+              << (_running ? " (flux démarré)" : " (flux arrêté)") << std::endl;
+    if (!playerInstance) return;
+    std::cout << "Blocs traités : " << playerInstance->processedBlocks.load()
+              << ", charge DSP : " << playerInstance->dspLoad.load() * 100.0f << "% (crête "
+              << playerInstance->dspLoadPeak.load() * 100.0f << "%)" << std::endl;
+    playerInstance->xrunMonitor.printReport(audioInfo.sampleRate);
+    std::cout << "Qualité : niveau " << playerInstance->qualityController.getLevel() << " ("
+              << AdikQualityController::levelName(playerInstance->qualityController.getLevel()) << "), "
+              << playerInstance->qualityController.getTransitionCount() << " changement(s), "
+              << playerInstance->mixer.stolenVoices.load() << " voix coupée(s), "
+              << playerInstance->mixer.retiredVoices.load() << " voix libérée(s) sur silence" << std::endl;
+    playerInstance->mixer.printMeters();
+    if (audioDriver && audioDriver->isThreadSetupDone()) {
+        audioDriver->getRealtimeReport().print(realtimeOptions);
+    }
+    std::cout << "--------------------" << std::endl;
+}
+
 // Votre fonction processAudioCallback existante, qui sera appelée par le wrapper.
 // Elle doit toujours être non-static pour être liée globalement.
-void processAudioCallback(float* outputBuffer, unsigned int numSamples, void* userData) {
+// outputBuffer : numSamples frames de numChannels samples entrelacés (sorties du périphérique).
+void processAudioCallback(float* outputBuffer, unsigned int numSamples, unsigned int numChannels, unsigned int streamStatus, void* userData) {
     // Si votre simulateRealtimePlayback passait un int pour numSamples,
     // vous devrez ajuster sa déclaration ou faire un cast ici.
     // Ou mieux, uniformiser sur unsigned int. Je l'ai mis à unsigned int ici.
@@ -16,65 +82,97 @@ void processAudioCallback(float* outputBuffer, unsigned int numSamples, void* us
 
     // std::cout << "\nprocessAudioCallback après caster playerData \n";
     if (!playerData) {
-        std::fill(outputBuffer, outputBuffer + (numSamples * 2), 0.0f); // *2 pour stéréo
+        std::fill(outputBuffer, outputBuffer + static_cast<size_t>(numSamples) * numChannels, 0.0f);
         return;
     }
 
-    // Récupérer la séquence en cours de lecture
-    std::shared_ptr<AdikSequence> currentPlayingSequence = nullptr;
-    if (playerData->currentMode == AdikPlayer::SEQUENCE_MODE) {
-        if (playerData->selectedSequenceInPlayerIndex >= 0 && playerData->selectedSequenceInPlayerIndex < playerData->sequenceList.size()) {
-            currentPlayingSequence = playerData->sequenceList[playerData->selectedSequenceInPlayerIndex];
-        }
-    } else { // SONG_MODE
-        if (playerData->currentSong && playerData->currentSequenceIndexInSong >= 0 && playerData->currentSequenceIndexInSong < playerData->currentSong->sequences.size()) {
-            currentPlayingSequence = playerData->currentSong->sequences[playerData->currentSequenceIndexInSong];
-        }
-    }
+    const auto callbackStart = std::chrono::steady_clock::now();
 
-    if (!currentPlayingSequence) {
-        std::fill(outputBuffer, outputBuffer + (numSamples * 2), 0.0f); // *2 pour stéréo
-        return;
+    // Projet chargé par un autre thread (AdikPlayer::publishProject) : adopté avant tout le reste du bloc
+    playerData->applyPendingProject();
+
+    // Kit publié sans frontière à attendre (changement immédiat, transport arrêté) : activé avant tout déclenchement
+    if (const AdikKit* kit = playerData->dueKit(nullptr)) {
+        playerData->activateKit(kit);
     }
 
-    // Préparer un buffer mono temporaire si votre mixeur produit du mono
-    // et que le buffer de sortie de RtAudio est stéréo.
-    // Si votre mixeur gère directement le stéréo, vous n'avez pas besoin de ça.
-    // Supposons que votre mixeur sort du mono pour l'instant et qu'on doit le copier en stéréo.
-    std::vector<float> mixedBuffer(numSamples * 2, 0.0f);
-    // std::fill(monoBuffer.begin(), monoBuffer.end(), 0.0f);
-    // std::cout << "processAudioCallback, préparer le monoBuffer:  \n";
-
-    // Boucle pour remplir le buffer audio sample par sample
-    // Note: Cette boucle est la logique d'avancement du séquenceur,
-    // et ne doit être exécutée qu'une seule fois par appel de callback RtAudio.
-    // Le `playerData->currentSampleInStep` doit être mis à jour correctement.
-    // Votre logique actuelle est par sample, mais RtAudio donne des blocs.
-    // Nous devons adapter la logique du Player pour qu'elle corresponde aux blocs.
+    // Rendus figés retirés (événements modifiés) : leurs voix s'arrêtent, les événements ont repris
+    playerData->stopStaleFrozenVoices();
+
+    // Commandes de contrôle (déclenchements distants, transport) dont l'instant tombe dans ce bloc
+    const int64_t streamStart = playerData->streamSamplePosition.load(std::memory_order_relaxed);
+    playerData->applyControlCommands(streamStart, numSamples);
+
+    // Prendre en compte les changements de tempo et de carte de tempo publiés par les autres threads
+    playerData->applyPendingTempo();
+
+    // Récupérer la séquence en cours de lecture. Transport arrêté, ni sequenceList ni currentSong ne sont lus.
+    std::shared_ptr<AdikSequence> currentPlayingSequence;
+    if (playerData->isPlaying()) currentPlayingSequence = playerData->getCurrentPlayingSequence();
 
     // Pour un callback orienté bloc (comme RtAudio) :
-    // Avancez le séquenceur sur la base du nombre total de samples traités.
-    for (unsigned int i = 0; i < numSamples; ++i) {
-        if (playerData->isPlaying() && currentPlayingSequence) {
-            playerData->currentSampleInStep++;
-            // std::cout << "\a";  
-            if (playerData->currentSampleInStep >= playerData->samplesPerStep) {
+    // Les frontières de pas sont calculées par l'horloge (AdikClock) à partir de sa position
+    // en samples, et non par accumulation d'un nombre entier de samples par pas : pas de dérive.
+    if (currentPlayingSequence && playerData->isPlaying()) {
+        AdikClock& clock = playerData->clock;
+        const int64_t blockStart = clock.samplePosition;
+        const int64_t blockEnd = blockStart + numSamples;
+        const bool scheduled = playerData->schedulerEnabled.load();
+        while (currentPlayingSequence && clock.sampleForStep(clock.nextStep) < blockEnd) {
+            // Changement de kit sur sa frontière musicale : les déclenchements planifiés avant ce pas jouent l'ancien kit
+            if (const AdikKit* kit = playerData->dueKit(currentPlayingSequence.get())) {
+                if (scheduled) {
+                    const int64_t stepStart = std::max(clock.sampleForStep(clock.nextStep), blockStart);
+                    playerData->dispatchScheduledTriggers(blockStart, static_cast<unsigned int>(stepStart - blockStart));
+                }
+                playerData->activateKit(kit);
+            }
+            // Rendus figés de la séquence : une voix par rendu, au sample près en mode planifié comme les déclenchements
+            if (playerData->frozenTrackMask(currentPlayingSequence.get())) {
+                const int64_t stepStart = std::max(clock.sampleForStep(clock.nextStep), blockStart);
+                const unsigned int offset = static_cast<unsigned int>(stepStart - blockStart);
+                if (scheduled) playerData->dispatchScheduledTriggers(blockStart, offset);
+                playerData->triggerFrozenVoices(currentPlayingSequence.get(), scheduled ? offset : 0);
+            }
+            if (scheduled) {
+                // Les événements ont déjà été résolus par AdikScheduler : on ne fait qu'avancer la position
+                playerData->moveToNextStep(currentPlayingSequence);
+            } else {
                 playerData->advanceStep(currentPlayingSequence);
-                playerData->currentSampleInStep = 0;
             }
+            clock.nextStep++;
+            // En mode SONG, advanceStep a pu passer à la séquence suivante
+            currentPlayingSequence = playerData->getCurrentPlayingSequence();
+        }
+        if (scheduled) {
+            playerData->dispatchScheduledTriggers(blockStart, numSamples);
         }
+        clock.samplePosition = blockEnd;
+        playerData->currentSampleInStep = blockEnd - clock.sampleForStep(clock.nextStep - 1);
     }
+    playerData->publishTimingSnapshot();
 
-    // std::cout << "\a";
-    // Demander au mixeur de mixer tous les canaux pour ce buffer (monoBuffer)
-    playerData->mixer.mixChannels(mixedBuffer, numSamples);
+    // Le mixeur écrit directement dans le buffer du périphérique (une passe d'entrelacement pour toutes les sorties)
+    playerData->mixer.mixChannels(outputBuffer, numSamples, numChannels);
 
-    // Copier le buffer mono vers le buffer de sortie stéréo de RtAudio
-    // Si votre mixeur produit déjà du stéréo, supprimez cette section et
-    // modifiez mixChannels pour écrire directement dans 'out'.
-    for (unsigned int i = 0; i < numSamples; ++i) {
-        outputBuffer[i * 2] = mixedBuffer[i*2];     // Canal gauche
-        outputBuffer[i * 2 + 1] = mixedBuffer[i*2 +1]; // Canal droit
+    // Position du flux et charge DSP (durée de traitement / durée audio du bloc)
+    playerData->streamSamplePosition.store(streamStart + numSamples, std::memory_order_relaxed);
+    const double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - callbackStart).count();
+    const float load = static_cast<float>(elapsed * playerData->sampleRate / numSamples);
+    const float previousLoad = playerData->dspLoad.load(std::memory_order_relaxed);
+    playerData->dspLoad.store(load, std::memory_order_relaxed);
+    if (load > playerData->dspLoadPeak.load(std::memory_order_relaxed)) {
+        playerData->dspLoadPeak.store(load, std::memory_order_relaxed);
     }
-}
+    const uint64_t block = playerData->processedBlocks.fetch_add(1, std::memory_order_relaxed);
+    const int activeVoices = playerData->mixer.getActiveChannelCount();
 
+    // Surcharge : dégradation progressive de la qualité, appliquée à partir du bloc suivant
+    const int qualityLevel = playerData->qualityController.update(load, block, streamStart, activeVoices);
+    playerData->mixer.setQualityLimits(playerData->qualityController.getVoiceLimit(qualityLevel), qualityLevel >= 1);
+    if (streamStatus) {
+        // Xrun signalé par le driver : on garde le contexte pour distinguer surcharge et incident pilote
+        playerData->xrunMonitor.record(streamStatus, streamStart, block, load, previousLoad, activeVoices);
+    }
+    playerData->publishDisplaySnapshot();
+}
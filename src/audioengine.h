@@ -8,10 +8,12 @@
 
 // Forward declaration de AdikPlayer (si nécessaire, ici car on passe son pointeur)
 class AdikPlayer;
+class AdikXrunMonitor;
 
 // Déclaration de la fonction de rappel principale, toujours visible globalement.
 // Elle sera l'interface entre le driver audio et votre logique de mixage.
-extern void processAudioCallback(float* outputBuffer, unsigned int numSamples, void* userData);
+// streamStatus : incidents signalés par le driver pour ce callback (AdikXrunIncident::Flags)
+extern void processAudioCallback(float* outputBuffer, unsigned int numSamples, unsigned int numChannels, unsigned int streamStatus, void* userData);
 
 class AudioEngine {
 public:
@@ -25,6 +27,9 @@ public:
     AudioInfo audioInfo; // Stocke les paramètres audio pour référence
     bool _running = false;
 
+    // Mise en condition temps réel appliquée par start() (ADIK_RT, ADIK_RT_PRIORITY, ADIK_RT_CPU, ADIK_RT_MLOCK)
+    AdikRealtimeOptions realtimeOptions = AdikRealtimeOptions::fromEnvironment();
+
     // Constructeur
     AudioEngine() : playerInstance(nullptr) {
         std::cout << "AudioEngine: Constructeur appelé." << std::endl;
@@ -70,26 +75,38 @@ public:
 
 
     /**
-     * @brief Démarre le flux audio.
-     * @param sampleRate Le taux d'échantillonnage (doit être le même que celui d'init).
-     * @param bufferSize Le nombre de samples par buffer (doit être le même que celui d'init).
+     * @brief Démarre le flux audio, après la mise en condition temps réel :
+     * verrouillage de la mémoire et pré-chargement des samples et des buffers (ici),
+     * puis ordonnancement, affinité, FTZ/DAZ et pile sur le thread audio (premier callback).
+     * Le rapport des étapes est affiché une fois le thread audio réglé.
      * @return True si le démarrage réussit, False sinon.
      */
-    bool start() {
-        if (!audioDriver) {
-            std::cerr << "AudioEngine: Driver audio non initialisé. Appelez init() d'abord." << std::endl;
-            return false;
-        }
+    bool start();
 
-        if (!playerInstance) {
-            std::cerr << "AudioEngine: Instance de AdikPlayer non fournie à init()." << std::endl;
-            return false;
-        }
+    /**
+     * @brief Réglages temps réel (avant start()).
+     */
+    void setRealtimeOptions(const AdikRealtimeOptions& options) { realtimeOptions = options; }
+
+    /**
+     * @brief Rapport de la mise en condition temps réel (nullptr sans driver).
+     */
+    const AdikRealtimeReport* getRealtimeReport() const {
+        return audioDriver ? &audioDriver->getRealtimeReport() : nullptr;
+    }
+
+    /**
+     * @brief Choisit le dither appliqué aux formats entiers (AudioInfo::bitDepth 16 ou 24). Avant start().
+     */
+    void setDither(AdikFormatConverter::Dither mode) {
+        if (audioDriver) audioDriver->setDither(mode);
+    }
 
-        std::cout << "AudioEngine: Démarrage du flux audio..." << std::endl;
-        // Appelez la méthode startStream du driver RtAudio, en passant le playerInstance comme userData.
-        _running = true;
-        return audioDriver->startStream(audioInfo.sampleRate, audioInfo.bufferSize, playerInstance.get());
+    /**
+     * @brief Format effectivement négocié avec le périphérique (valide après start()).
+     */
+    AdikSampleFormat getOutputFormat() const {
+        return audioDriver ? audioDriver->getFormat() : AdikSampleFormat::FLOAT32;
     }
 
     /**
@@ -100,11 +117,22 @@ public:
             std::cout << "AudioEngine: Arrêt du flux audio..." << std::endl;
             audioDriver->stopStream(); // Assurez-vous que cette méthode existe et est publique dans RtAudioDriver
             _running = false;
+            notifyStreamStopped();
         } else {
             std::cerr << "AudioEngine: Driver audio non initialisé pour l'arrêt." << std::endl;
         }
     }
 
+    /**
+     * @brief Xruns du flux : compteurs et derniers incidents (nullptr sans player).
+     */
+    const AdikXrunMonitor* getXrunMonitor() const;
+
+    /**
+     * @brief Affiche le format du flux, la charge DSP et les derniers xruns.
+     */
+    void printInfo() const;
+
     /**
      * @brief Test si le driver audio est lancé.
     */
@@ -119,12 +147,16 @@ public:
             std::cout << "AudioEngine: Fermeture du driver audio..." << std::endl;
             audioDriver->closeStream();
             audioDriver.reset(); // Libère le unique_ptr et détruit l'objet RtAudioDriver
+            notifyStreamStopped();
             playerInstance = nullptr; // Réinitialise le pointeur aussi
         } else {
             std::cerr << "AudioEngine: Driver audio déjà fermé ou non initialisé." << std::endl;
         }
      }
 
+private:
+    // Le Player adopte de nouveau les projets lui-même (voir AdikPlayer::publishProject)
+    void notifyStreamStopped();
 };
 
 #endif // AUDIOENGINE_H
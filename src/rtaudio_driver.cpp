@@ -1,5 +1,9 @@
 #include "rtaudio_driver.h" // Incluez le header de la classe RtAudioDriver
 #include "audioengine.h"    // Incluez le header de processAudioCallback
+#include <algorithm>        // Pour std::min, std::max
+#include <chrono>
+#include <thread>           // Pour std::this_thread::sleep_for
+#include "adikxrunmonitor.h" // Pour AdikXrunIncident::Flags
 
 // ============================================================================
 // Implémentation du wrapper de callback de RtAudio.
@@ -10,24 +14,96 @@ extern "C" { // Assure la liaison C pour la fonction de rappel
                                       unsigned int nFrames,
                                       double streamTime, RtAudioStreamStatus status, 
                                       void *userData) {
-        // Gérer les erreurs de statut du flux si nécessaire
-        if (status) {
-            std::cerr << "RtAudio callback status message: " << status << std::endl;
-        }
-
-        // Caster le buffer de sortie au type float* (assumé RTAUDIO_FLOAT32)
-        float *out = static_cast<float*>(outputBuffer);
+        // Les xruns (status) sont comptés par processAudioCallback (AdikXrunMonitor), sans affichage ici
+        unsigned int streamStatus = 0;
+        if (status & RTAUDIO_OUTPUT_UNDERFLOW) streamStatus |= AdikXrunIncident::UNDERFLOW;
+        if (status & RTAUDIO_INPUT_OVERFLOW) streamStatus |= AdikXrunIncident::OVERFLOW;
 
-        // Appeler votre fonction processAudioCallback existante
+        // userData est le driver : il rend le bus float puis le convertit au format du flux.
         // C'est ici que le pont entre RtAudio et votre logique audio se fait.
-        processAudioCallback(out, nFrames, userData);
+        static_cast<RtAudioDriver*>(userData)->render(outputBuffer, nFrames, streamStatus);
 
         return 0; // Retourne 0 pour indiquer le succès à RtAudio
     }
 }
 
+// Rend le bus float (processAudioCallback) puis le convertit au format du périphérique.
+// En float32, le mixage est écrit directement dans le buffer de RtAudio.
+void RtAudioDriver::render(void* outputBuffer, unsigned int numFrames, unsigned int streamStatus) {
+    if (!threadSetupDone.load(std::memory_order_relaxed)) {
+        setupAudioThread();
+    }
+    if (format == AdikSampleFormat::FLOAT32) {
+        processAudioCallback(static_cast<float*>(outputBuffer), numFrames, numChannels, streamStatus, userData);
+        return;
+    }
+    // Par tranches de la taille du buffer alloué, si RtAudio demande plus que prévu
+    const unsigned int capacity = static_cast<unsigned int>(floatBuffer.size() / numChannels);
+    unsigned char* out = static_cast<unsigned char*>(outputBuffer);
+    const size_t frameBytes = numChannels * AdikFormatConverter::bytesPerSample(format);
+    while (numFrames > 0) {
+        const unsigned int chunk = std::min(numFrames, capacity);
+        processAudioCallback(floatBuffer.data(), chunk, numChannels, streamStatus, userData);
+        streamStatus = 0; // Compté une seule fois
+        converter.convert(floatBuffer.data(), out, chunk);
+        out += chunk * frameBytes;
+        numFrames -= chunk;
+    }
+}
+
+// Une seule fois, sur le thread audio : les réglages (MXCSR, affinité, ordonnancement) sont propres au thread.
+// Les erreurs sont gardées en codes errno ; le rapport est publié par threadSetupDone (release).
+void RtAudioDriver::setupAudioThread() {
+    realtimeReport.denormalsFlushed = AdikRealtime::flushDenormals();
+    if (realtimeOptions.cpu >= 0) {
+        realtimeReport.affinitySet = AdikRealtime::setAffinity(realtimeOptions.cpu, realtimeReport.affinityError);
+    }
+    if (realtimeOptions.enabled) {
+        realtimeReport.realtimeScheduling = AdikRealtime::ensureRealtimeScheduling(
+            realtimeOptions.priority, realtimeReport.threadPriority, realtimeReport.schedulingError);
+    }
+    if (realtimeOptions.lockMemory) {
+        realtimeReport.stackPrefaultedBytes = AdikRealtime::prefaultStack(realtimeOptions.stackPrefaultBytes);
+    }
+    realtimeReport.threadSetupDone = true;
+    threadSetupDone.store(true, std::memory_order_release);
+}
+
+bool RtAudioDriver::waitThreadSetup(unsigned int timeoutMs) const {
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeoutMs);
+    while (!isThreadSetupDone()) {
+        if (std::chrono::steady_clock::now() >= deadline) return false;
+        std::this_thread::sleep_for(std::chrono::milliseconds(2));
+    }
+    return true;
+}
+
+RtAudioFormat RtAudioDriver::toRtAudioFormat(AdikSampleFormat fmt) {
+    switch (fmt) {
+        case AdikSampleFormat::INT16: return RTAUDIO_SINT16;
+        case AdikSampleFormat::INT24: return RTAUDIO_SINT32; // 24 bits cadrés à gauche dans 32 bits
+        default: return RTAUDIO_FLOAT32;
+    }
+}
+
+// Garde le format demandé s'il est natif pour le périphérique (pas de conversion dans RtAudio),
+// sinon le format natif le plus proche. Si le périphérique n'annonce rien, le format demandé
+// est gardé et RtAudio convertit.
+AdikSampleFormat RtAudioDriver::chooseFormat(AdikSampleFormat requested, RtAudioFormat nativeFormats) {
+    static const AdikSampleFormat preferences[3][3] = {
+        { AdikSampleFormat::FLOAT32, AdikSampleFormat::INT24, AdikSampleFormat::INT16 },
+        { AdikSampleFormat::INT16, AdikSampleFormat::INT24, AdikSampleFormat::FLOAT32 },
+        { AdikSampleFormat::INT24, AdikSampleFormat::FLOAT32, AdikSampleFormat::INT16 },
+    };
+    const AdikSampleFormat* order = preferences[static_cast<int>(requested)];
+    for (int i = 0; i < 3; ++i) {
+        if (nativeFormats & toRtAudioFormat(order[i])) return order[i];
+    }
+    return requested;
+}
+
 // Implémentation de RtAudioDriver::startStream
-bool RtAudioDriver::startStream(unsigned int sampleRate, unsigned int bufferSize, void* userData) {
+bool RtAudioDriver::startStream(unsigned int sampleRate, unsigned int bufferSize, unsigned int channels, unsigned int bitDepth, void* playerData) {
     if (isStreamOpen) {
         std::cerr << "Erreur: Le flux audio est déjà ouvert." << std::endl;
         return false;
@@ -40,20 +116,53 @@ bool RtAudioDriver::startStream(unsigned int sampleRate, unsigned int bufferSize
 
     RtAudio::StreamParameters parameters;
     parameters.deviceId = audio.getDefaultOutputDevice();
-    parameters.nChannels = 2; // Stéréo
+    parameters.nChannels = channels > 0 ? channels : 2;
     parameters.firstChannel = 0;
 
+    const RtAudio::DeviceInfo deviceInfo = audio.getDeviceInfo(parameters.deviceId);
+    if (deviceInfo.outputChannels < parameters.nChannels) {
+        std::cerr << "Erreur: Le périphérique '" << deviceInfo.name << "' n'a que " << deviceInfo.outputChannels
+                  << " sorties (" << parameters.nChannels << " demandées)." << std::endl;
+        return false;
+    }
+
     unsigned int calculatedBufferSize = bufferSize;
 
+    const AdikSampleFormat requested = AdikFormatConverter::formatForBitDepth(bitDepth);
+    format = chooseFormat(requested, deviceInfo.nativeFormats);
+    if (format != requested) {
+        std::cout << "Format " << AdikFormatConverter::formatName(requested) << " non natif pour le périphérique, utilisation de "
+                  << AdikFormatConverter::formatName(format) << "." << std::endl;
+    }
+    userData = playerData;
+    numChannels = parameters.nChannels;
+
+    // Thread audio en SCHED_FIFO si le système le permet (sinon RtAudio garde l'ordonnancement normal,
+    // et setupAudioThread réessaie puis note l'échec dans le rapport)
+    RtAudio::StreamOptions options;
+    if (realtimeOptions.enabled) {
+        options.flags |= RTAUDIO_SCHEDULE_REALTIME;
+        options.priority = realtimeOptions.priority;
+    }
+    threadSetupDone.store(false);
+    realtimeReport.threadSetupDone = false;
+
     try {
-        audio.openStream(&parameters, nullptr, RTAUDIO_FLOAT32, sampleRate, &calculatedBufferSize, &rtAudioCallbackWrapper, userData);
+        audio.openStream(&parameters, nullptr, toRtAudioFormat(format), sampleRate, &calculatedBufferSize, &rtAudioCallbackWrapper, this, &options);
+
+        // Allocations hors du callback
+        converter.configure(format, numChannels, dither);
+        floatBuffer.assign(static_cast<size_t>(std::max(calculatedBufferSize, bufferSize)) * numChannels, 0.0f);
 
         audio.startStream();
         isStreamOpen = true;
         std::cout << "Flux audio RtAudio démarré avec succès !" << std::endl;
         std::cout << "  Sample Rate: " << sampleRate << std::endl;
         std::cout << "  Buffer Size (effective): " << calculatedBufferSize << std::endl;
-        std::cout << "  Output Device: " << audio.getDeviceInfo(parameters.deviceId).name << std::endl;
+        std::cout << "  Format: " << AdikFormatConverter::formatName(format);
+        if (format != AdikSampleFormat::FLOAT32) std::cout << ", dither: " << AdikFormatConverter::ditherName(dither);
+        std::cout << std::endl;
+        std::cout << "  Output Device: " << deviceInfo.name << " (" << numChannels << " sorties)" << std::endl;
         return true;
 
     } catch (RtAudioError &e) {
@@ -6,11 +6,17 @@
 #include <iostream>   // Pour les messages de console
 #include <vector>     // Pour gérer les buffers
 #include <stdexcept>  // Pour la gestion des erreurs
+#include <atomic>
+
+#include "adikrealtime.h"
+
+#include "adikformatconverter.h"
 
 // Forward declaration pour la fonction de callback globale.
 // Cette fonction sera implémentée dans un .cpp séparé (e.g., audioengine.cpp)
 // et sera passée à RtAudio.
-extern void processAudioCallback(float* outputBuffer, unsigned int numSamples, void* userData);
+// streamStatus : incidents signalés par le driver pour ce callback (AdikXrunIncident::Flags)
+extern void processAudioCallback(float* outputBuffer, unsigned int numSamples, unsigned int numChannels, unsigned int streamStatus, void* userData);
 
 /*
  * @brief Une classe utilitaire pour initialiser et gérer RtAudio.
@@ -20,19 +26,54 @@ extern void processAudioCallback(float* outputBuffer, unsigned int numSamples, v
  */
 class RtAudioDriver {
 public:
-    RtAudioDriver() : audio(RtAudio::UNSPECIFIED), isStreamOpen(false) {}
+    RtAudioDriver() : audio(RtAudio::UNSPECIFIED), isStreamOpen(false), userData(nullptr),
+                      format(AdikSampleFormat::FLOAT32), dither(AdikFormatConverter::DITHER_TPDF),
+                      numChannels(2), threadSetupDone(false) {}
 
     ~RtAudioDriver() {
         closeStream(); // Assure la fermeture propre du flux à la destruction de l'objet
     }
-    bool startStream(unsigned int sampleRate, unsigned int bufferSize, void* userData); // Déclaration
+    // numChannels : sorties du périphérique utilisées (à partir de la première).
+    // bitDepth : 16, 24 (dans 32 bits) ou 32 (float). Le format est négocié avec les formats natifs
+    // du périphérique (voir chooseFormat) ; getFormat() donne le format retenu.
+    bool startStream(unsigned int sampleRate, unsigned int bufferSize, unsigned int numChannels, unsigned int bitDepth, void* userData); // Déclaration
     void stopStream();
     void closeStream(); // Déclaration
 
+    // Dither des formats entiers (à régler avant startStream)
+    void setDither(AdikFormatConverter::Dither mode) { dither = mode; }
+    AdikSampleFormat getFormat() const { return format; }
+
+    // Mise en condition temps réel (à régler avant startStream). Le flux est ouvert avec
+    // RTAUDIO_SCHEDULE_REALTIME ; le premier callback règle ensuite le thread audio lui-même
+    // (FTZ/DAZ, affinité, SCHED_FIFO si RtAudio ne l'a pas obtenu, pile) et remplit le rapport.
+    void setRealtimeOptions(const AdikRealtimeOptions& options) { realtimeOptions = options; }
+    const AdikRealtimeOptions& getRealtimeOptions() const { return realtimeOptions; }
+    // Champs "thread audio" valides seulement après isThreadSetupDone()
+    AdikRealtimeReport& getRealtimeReport() { return realtimeReport; }
+    bool isThreadSetupDone() const { return threadSetupDone.load(std::memory_order_acquire); }
+    bool waitThreadSetup(unsigned int timeoutMs) const;
+
+    // Appelé par le callback RtAudio : rend 'numFrames' frames dans le buffer du périphérique
+    void render(void* outputBuffer, unsigned int numFrames, unsigned int streamStatus);
 
 private:
     RtAudio audio;
     bool isStreamOpen;
+    void* userData;                  // Transmis à processAudioCallback (AdikPlayer)
+    AdikSampleFormat format;
+    AdikFormatConverter::Dither dither;
+    AdikFormatConverter converter;
+    std::vector<float> floatBuffer;  // Bus float avant conversion (formats entiers), alloué à l'ouverture
+    unsigned int numChannels;
+
+    AdikRealtimeOptions realtimeOptions;
+    AdikRealtimeReport realtimeReport;
+    std::atomic<bool> threadSetupDone;
+    void setupAudioThread();         // Thread audio, premier callback
+
+    static AdikSampleFormat chooseFormat(AdikSampleFormat requested, RtAudioFormat nativeFormats);
+    static RtAudioFormat toRtAudioFormat(AdikSampleFormat fmt);
 };
 
 #endif // RTAUDIO_DRIVER_H